@@ -0,0 +1,67 @@
+import * as fs from 'fs';
+import { performance } from 'perf_hooks';
+import { ConfigParser } from '../src/util/config-parser';
+
+/**
+ * Compares the single pass config parser to the previous line based parser.
+ *
+ * Usage: npm run bench:config-parser -- [path to a config.cpp] [iterations]
+ * Without a path, a synthetic config.cpp similar to a large mod's CfgVehicles is generated
+ * (kept to what the legacy parser understands, i.e. one property per line and no backslashes in arrays).
+ */
+
+const generateConfig = (classCount: number): string => {
+    const lines: string[] = ['class CfgPatches', '{', '\tclass BenchMod', '\t{', '\t\tunits[] = {};', '\t\trequiredAddons[] = {"DZ_Data"};', '\t};', '};', 'class CfgVehicles', '{'];
+    lines.push('\tclass Inventory_Base;');
+    for (let i = 0; i < classCount; i++) {
+        lines.push(
+            `\tclass BenchItem_${i}: ${i ? `BenchItem_${i - 1}` : 'Inventory_Base'}`,
+            '\t{',
+            '\t\tscope = 2;',
+            `\t\tdisplayName = "Bench Item ${i}";`,
+            `\t\tdescriptionShort = "Generated item number ${i}";`,
+            `\t\tmodel = "\\bench\\items\\item_${i}.p3d";`,
+            `\t\tweight = ${(i % 1000) + 0.5};`,
+            '\t\tcanBeSplit = false;',
+            '\t\titemSize[] = {2,3};',
+            `\t\thiddenSelectionsTextures[] = {"bench/data/item_${i}_co.paa","bench/data/item_${i}_nohq.paa"};`,
+            '\t\tclass DamageSystem',
+            '\t\t{',
+            '\t\t\tclass GlobalHealth',
+            '\t\t\t{',
+            '\t\t\t\tclass Health',
+            '\t\t\t\t{',
+            '\t\t\t\t\thitpoints = 100;',
+            '\t\t\t\t\thealthLevels[] = {{1,{"a.rvmat"}},{0.7,{"b.rvmat"}},{0,{"c.rvmat"}}};',
+            '\t\t\t\t};',
+            '\t\t\t};',
+            '\t\t};',
+            '\t};',
+        );
+    }
+    lines.push('};', '');
+    return lines.join('\n');
+};
+
+const time = (name: string, iterations: number, fn: () => any): number => {
+    // warmup
+    fn();
+    const start = performance.now();
+    for (let i = 0; i < iterations; i++) {
+        fn();
+    }
+    const avg = (performance.now() - start) / iterations;
+    console.log(`${name.padEnd(10)} ${avg.toFixed(1).padStart(10)} ms/parse`);
+    return avg;
+};
+
+const [file, iterationsArg] = process.argv.slice(2);
+const iterations = Number(iterationsArg) || 5;
+const input = file ? fs.readFileSync(file, { encoding: 'utf-8' }) : generateConfig(20000);
+
+console.log(`Input: ${file ?? 'generated'} (${(input.length / 1024 / 1024).toFixed(1)} MB), ${iterations} iterations`);
+
+const parser = new ConfigParser();
+const current = time('cfg2json', iterations, () => parser.cfg2json(input));
+const legacy = time('legacy', iterations, () => parser.cfg2jsonLegacy(input));
+console.log(`Speedup: ${(legacy / current).toFixed(1)}x`);
@@ -99,7 +99,12 @@ export class ConfigFileHelper extends IService {
         }
     }
 
-    public createDefaultConfig(): void {
+    /**
+     * Creates a config with default values if there is none and exits the process afterwards
+     * @param exit whether to exit if the config was created
+     * @returns whether a new config was created
+     */
+    public createDefaultConfig(exit: boolean = true): boolean {
 
         const cfgPath = this.getConfigFilePath();
 
@@ -111,12 +116,18 @@ export class ConfigFileHelper extends IService {
             defaultConfig.ingameApiKey = randomUUID();
             defaultConfig.rconPassword = randomUUID();
             defaultConfig.serverCfg.passwordAdmin = randomUUID();
+            defaultConfig.clusterKey = randomUUID();
 
             // linux specifics
             if (detectOS() !== 'windows') {
                 defaultConfig.serverExe = 'DayZServer';
             }
 
+            // instances share the workshop files instead of copying them, if they can be hardlinked
+            if (this.paths.getInstanceName() && this.paths.sameFilesystem(this.paths.sharedCwd(), this.paths.cwd())) {
+                defaultConfig.linkModFiles = 'hardlink';
+            }
+
             this.fs.writeFileSync(
                 cfgPath,
                 commentJson.stringify(defaultConfig, null, 2),
@@ -128,12 +139,13 @@ export class ConfigFileHelper extends IService {
             console.log('Adjust the config to fit your needs and restart the manager!');
             console.log('\n\n');
 
-            if (typeof global.it === 'function') {
-                return;
+            if (exit && typeof global.it !== 'function') {
+                origExit(0); // end process
             }
-            origExit(0); // end process
+            return true;
         }
 
+        return false;
     }
 
 }
@@ -353,7 +353,8 @@ export enum EventTypeEnum {
     kickAll = 'kickAll',
     lock = 'lock',
     unlock = 'unlock',
-    backup = 'backup'
+    backup = 'backup',
+    rollout = 'rollout'
 }
 
 export type EventType = keyof typeof EventTypeEnum;
@@ -375,6 +376,8 @@ export class Event {
      * 'kickAll' - kicks all players
      * 'lock' - locks the server (probably not working)
      * 'unlock' - unlocks the server (probably not working)
+     * 'backup' - creates backup of mpmissions folder
+     * 'rollout' - cluster controller only, executes the command in params[0] (i.e. 'restart' or 'updatemods') on all agents, one after another
      *
      * @required
      */
@@ -465,6 +468,32 @@ export class Config {
      */
     public loglevel: number = 1;
 
+    /**
+     * Number of worker threads for cpu and disk heavy tasks (i.e. comparing, copying and syncing mods, creating and restoring backups, parsing ingame reports)
+     * These tasks would otherwise block the manager, so RCON and the web interface stall while they are running.
+     *
+     * 0 runs them in the manager thread
+     * When running multiple instances, the workers are shared and only the setting of the first instance is applied.
+     */
+    @Reflect.metadata('config-range', [0, 16])
+    public workerThreads: number = 2;
+
+    /**
+     * Time in milliseconds the manager may be blocked before a warning with the tasks running at that time is logged
+     * 0 disables the warnings, the lag is still exposed in the metrics
+     */
+    public eventLoopLagWarning: number = 500;
+
+    /**
+     * Continuously profiles the cpu usage of the manager with a low sampling rate.
+     * The value is the length of one profile in minutes, the last profiles are kept in the profiles folder of the manager
+     * and can be opened with the chrome dev tools or speedscope.
+     *
+     * 0 disables the continuous profiling, profiles can still be captured on demand (see the cpuprofile command)
+     */
+    @Reflect.metadata('config-range', [0, 1440])
+    public continuousProfiling: number = 0;
+
     // /////////////////////////// Admins /////////////////////////////////////
     /**
      * The web or discord users allowed to use the web interface or the bot commands and which of them
@@ -523,6 +552,31 @@ export class Config {
      */
     public publishWebServer: boolean = false;
 
+    /**
+     * Whether to cache the responses of read heavy requests (i.e. server info, metrics, backups) for a few seconds
+     *
+     * Cached responses are dropped as soon as the data changes (config reload, mission file written, backup created, new metrics).
+     * Turn this off if you change mission files or backups outside of the server manager and need to see the changes instantly.
+     */
+    public webResponseCache: boolean = true;
+
+    /**
+     * Whether to expose the manager and server metrics for Prometheus on `/metrics` of the web server
+     *
+     * The endpoint requires basic auth with one of the admins configured above (any user level)
+     * or the prometheusMetricsToken.
+     * The values are kept in memory, so scraping does not touch the metrics database.
+     */
+    public prometheusMetrics: boolean = true;
+
+    /**
+     * Token to scrape `/metrics` without the credentials of an admin
+     *
+     * Sent by Prometheus as `Authorization: Bearer <token>` (authorization.credentials in the scrape config).
+     * The token only grants access to the metrics. Leave empty to allow basic auth only.
+     */
+    public prometheusMetricsToken: string = '';
+
     /**
      * The port of the ingame REST API
      *
@@ -582,6 +636,60 @@ export class Config {
     @Reflect.metadata('config-type-skip', true)
     public mapHost: string | any = 'https://mr-guard.de/dayz-maps';
 
+    // /////////////////////////// Cluster ////////////////////////////////////
+    /**
+     * Role of this manager when managing servers on multiple hosts
+     *
+     * off - standalone manager
+     * controller - accepts agents on the clusterPort and lets you manage all of them from its web interface
+     * agent - runs the server of this host and streams its state, metrics and logs to the controller (clusterController)
+     *
+     * Agents do not start the web interface, use the one of the controller instead.
+     */
+    public clusterMode: 'off' | 'controller' | 'agent' = 'off';
+
+    /**
+     * The port the controller accepts agents on
+     */
+    @Reflect.metadata('config-range', [0, 65535])
+    public clusterPort: number = 2320;
+
+    /**
+     * Whether the controller accepts agents from other hosts (0.0.0.0) or only from localhost
+     * The controller only accepts unencrypted connections, so this requires clusterAllowInsecure.
+     * Prefer a reverse proxy with a SSL Cert in front of the controller, so the agents can connect via wss://
+     */
+    public publishClusterPort: boolean = false;
+
+    /**
+     * The address of the controller the agent connects to, i.e. "wss://cluster.example.com"
+     * Unencrypted addresses (ws://) of other hosts are refused unless clusterAllowInsecure is enabled.
+     */
+    public clusterController: string = '';
+
+    /**
+     * Whether to allow unencrypted cluster connections between hosts (ws://)
+     * The clusterKey and the commands (including the users and their permissions) are sent in plain text then,
+     * so only enable this in trusted networks (i.e. a VPN).
+     */
+    public clusterAllowInsecure: boolean = false;
+
+    /**
+     * Shared secret of the controller and its agents, must be the same on all of them.
+     * Connections without the key are rejected, so the cluster is disabled while this is empty.
+     */
+    public clusterKey: string = '';
+
+    /**
+     * The name of the agent shown on the controller, defaults to "hostname-instanceId"
+     */
+    public clusterAgentName: string = '';
+
+    /**
+     * Time (in seconds) the controller waits after one agent finished a rolled out restart or update before starting the next
+     */
+    public clusterStagger: number = 300;
+
     // /////////////////////////// Discord ////////////////////////////////////
 
     /**
@@ -606,6 +714,23 @@ export class Config {
         mode: DiscordChannelType | DiscordChannelType[]
     }[] = [];
 
+    /**
+     * Time in milliseconds messages to the same channel are collected and sent as a single message
+     * This keeps busy rcon relays within the discord rate limits
+     *
+     * 0 sends messages right away (still one at a time within the rate limits)
+     */
+    @Reflect.metadata('config-range', [0, 60000])
+    public discordMessageCoalescing: number = 1000;
+
+    /**
+     * Max amount of messages queued per channel
+     * If a channel receives more messages than it can send, the oldest rcon relay messages are dropped
+     * Admin messages and notifications are never dropped
+     */
+    @Reflect.metadata('config-range', [1, 10000])
+    public discordMaxQueuedMessages: number = 100;
+
     // /////////////////////////// DayZ ///////////////////////////////////////
 
     /**
@@ -752,6 +877,27 @@ export class Config {
      */
     public serverLaunchParams: string[] = [];
 
+    /**
+     * CPU cores (starting at 0) the server process is pinned to.
+     * Empty to let the server run on all cores (also if the manager is pinned with managerCpuAffinity).
+     */
+    public serverCpuAffinity: number[] = [];
+
+    /**
+     * CPU cores (starting at 0) the manager and all processes started by it (i.e. SteamCMD) are pinned to.
+     * Should not overlap with serverCpuAffinity, so updates, mod copies and backups do not compete with the server.
+     * Empty to let the manager run on all cores.
+     * When running multiple instances, only the setting of the first instance is applied.
+     */
+    public managerCpuAffinity: number[] = [];
+
+    /**
+     * Run maintenance processes (i.e. SteamCMD updates) with a lower cpu and io priority.
+     * Mod copies and backups run in worker threads of the manager, which can not be prioritized separately.
+     * Use managerCpuAffinity to keep them away from the server instead.
+     */
+    public maintenanceLowPriority: boolean = false;
+
     /**
      * Time (in ms) between each server check
      */
@@ -829,6 +975,8 @@ export class Config {
      * - go to the backup folder
      * - copy the mpmissions_{date} you want to restore into the server folder
      * - rename the copied folder back to mpmissions
+     * For deduplicated backups (see backupDeduplicate), run the restorebackup command first,
+     * which restores the backup to restored/mpmissions_{date} in the backup folder.
      */
     public backupPath: string = 'backups';
 
@@ -838,6 +986,15 @@ export class Config {
      */
     public backupMaxAge: number = 7;
 
+    /**
+     * Whether to store backups deduplicated instead of copying the mpmissions folder.
+     * Files are split into chunks and each unique chunk is stored only once (compressed) in the backup folder,
+     * so backups only cost the changed parts of the files.
+     * Unchanged files (same size and modification time) are not read again.
+     * Deduplicated backups are listed as mpmissions_{date}.json and have to be restored with the restorebackup command.
+     */
+    public backupDeduplicate: boolean = false;
+
     // /////////////////////////// Steam ////////////////////////////////////////
     /**
      * Path to steam CMD
@@ -883,6 +1040,13 @@ export class Config {
      */
     public steamMetaPath: string = 'SteamMeta';
 
+    /**
+     * How long (in seconds) the workshop details of mods (update timestamps, sizes, titles) are cached, before they are requested again.
+     * The cache is persisted in the steamMetaPath, so restarts of the manager do not need to request them again.
+     * If the steam api is not reachable, the last known details are used.
+     */
+    public steamWorkshopMetaCacheTime: number = 300;
+
     /**
      * List of Mod IDs (workshop id, not modname!) to be downloaded from steam and used as mods.
      *
@@ -968,9 +1132,29 @@ export class Config {
 
     /**
      * Whether to deep compare mods instead of just checking for update timestamps
+     * Only used if copyModIncremental is disabled.
      */
     public copyModDeepCompare: boolean = false;
 
+    /**
+     * Whether to copy mods file by file, so only files which changed since the last copy are copied.
+     * Changes are detected with a manifest of file sizes, timestamps and hashes kept in the steamMetaPath.
+     * If disabled, changed mods are deleted and copied again completely.
+     */
+    public copyModIncremental: boolean = true;
+
+    /**
+     * Whether to install mods as a tree of links to the workshop files instead of copying them (value off/hardlink/symlink)
+     * Unlike linkModDirs, the file and folder names are lowercased in the server dir only (on linux),
+     * so the workshop files stay untouched and validating the mods does not download them again.
+     * The links are updated incrementally, so installing mods is almost instant.
+     * hardlink requires the workshop and the server to be on the same filesystem.
+     * Takes precedence over linkModDirs and copyModIncremental.
+     * Configs created for instances started with --instances default to hardlink if the instance and the shared workshop
+     * are on the same filesystem, so all instances share the files of one workshop cache instead of copying them.
+     */
+    public linkModFiles: 'off' | 'hardlink' | 'symlink' = 'off';
+
     /**
      * How many mods to update at the same time via SteamCMD.
      * Setting this to a too high value will increase the chance to get timeouts.
@@ -987,6 +1171,41 @@ export class Config {
      */
     public updateModsMaxBatchFileSize: number = 1_000_000_000;
 
+    /**
+     * How many SteamCMD instances download mods in parallel.
+     * Each additional instance uses its own copy of SteamCMD and its own workshop folder next to the configured ones (i.e. Workshop-1, SteamCMD-1).
+     * Mods stay in the workshop folder they were downloaded with first, so only new mods are distributed to the additional instances.
+     */
+    public updateModsWorkers: number = 1;
+
+    /**
+     * Whether to prepare server and mod updates in a copy of the server folder (serverPath + "-staged") while the server is running.
+     * The prepared folder is swapped in when the server is restarted, so the restart does not wait for downloads and copies.
+     * The previous server folder is kept (serverPath + "-previous") until the updated server stayed started for stagedUpdatesVerifyTime
+     * and is restored at the next start if it did not.
+     * Note: updates are only checked in the staged folder, so updateServerBeforeServerStart and updateModsBeforeServerStart are ignored.
+     * Mods must be copied (linkModDirs and linkModFiles disabled), because the workshop files are updated while the server is running.
+     * Staged updates are not prepared otherwise.
+     */
+    public stagedUpdates: boolean = false;
+
+    /**
+     * Paths relative to the server folder, which belong to the running server and are moved to the updated server folder instead of being updated.
+     * The profiles folder and the server cfg are always included, if they are inside the server folder.
+     */
+    public stagedUpdatesStatePaths: string[] = ['mpmissions', 'ban.txt', 'whitelist.txt', 'priority.txt'];
+
+    /**
+     * How long (in seconds) a swapped in update has to stay started, before it is considered successful.
+     * If the server stops or is restarted before that, the previous server folder is restored.
+     */
+    public stagedUpdatesVerifyTime: number = 120;
+
+    /**
+     * How often (in minutes) to prepare staged updates while the server is running. 0 disables the automatic preparation.
+     */
+    public stagedUpdatesPrepareIntervall: number = 60;
+
     // /////////////////////////// Events ///////////////////////////////////////
 
     /**
@@ -1004,6 +1223,7 @@ export class Config {
      * 'lock' - locks the server (probably not working)
      * 'unlock' - unlocks the server (probably not working)
      * 'backup' - creates backup of mpmissions folder
+     * 'rollout' - cluster controller only, executes the command in params[0] (i.e. 'restart' or 'updatemods') on all agents, one after another
      *
      *
      * CRON - Format:
@@ -1106,6 +1326,18 @@ export class Config {
      */
     public metricMaxAge: number = 2_592_000_000;
 
+    /**
+     * Sample detailed telemetry of the server process every second (Linux only)
+     * Includes per-thread cpu usage, memory, swap, io, context switches and open file descriptors.
+     * The latest samples are kept in memory and rolled up into the metrics every metric tick.
+     */
+    public serverTelemetry: boolean = false;
+
+    /**
+     * Amount of telemetry samples (one per second) kept in memory
+     */
+    public serverTelemetryBufferSize: number = 300;
+
     // /////////////////////////// Hooks ///////////////////////////////////////
     /**
      * Hooks to define custom behaviour when certain events happen
@@ -1164,6 +1396,33 @@ export class Config {
      */
     public dataDump: boolean = false;
 
+    /**
+     * Build a class database (weapons, items, clothing etc.) from the configs in the server and mod pbos.
+     * It is updated after game and mod updates, without the server having to be started with dataDump.
+     * Only changed pbos are read again. The classes can be queried with the classdb command.
+     */
+    public classDatabase: boolean = false;
+
+    /**
+     * Time (in seconds) between heartbeats written by the ingame mod.
+     * The heartbeat is written from the server's script thread, so it stops if the script thread freezes.
+     * Set to 0 to disable the heartbeat.
+     */
+    public ingameHeartbeatIntervall: number = 1.0;
+
+    /**
+     * Time (in seconds) without heartbeat after which the server is considered frozen.
+     * Only checked after the first heartbeat of the running server was received.
+     * Set to 0 to disable the heartbeat check.
+     */
+    public ingameHeartbeatDeadline: number = 30;
+
+    /**
+     * Whether to force a restart of the server if the heartbeat deadline was missed.
+     * If disabled, only a warning is sent to the admin channels.
+     */
+    public ingameHeartbeatRestart: boolean = false;
+
     // /////////////////////////// ServerCfg ///////////////////////////////////////
     /**
      * serverCfg
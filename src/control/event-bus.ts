@@ -33,13 +33,18 @@ export class EventBus extends IService {
     public emit(name: InternalEventTypes.LOG_ENTRY, logEntryEvent: LogEntryEvent): void;
     public emit(name: InternalEventTypes.MOD_UPDATED, status: ModUpdatedStatus): void;
     public emit(name: InternalEventTypes.GAME_UPDATED, status: GameUpdatedStatus): void;
+    public emit(name: InternalEventTypes.MISSION_FILE_WRITTEN, file: string): void;
+    public emit(name: InternalEventTypes.BACKUP_CREATED, backup: string): void;
+    public emit(name: InternalEventTypes.BACKUP_REMOVED, backups: string[]): void;
+    public emit(name: InternalEventTypes.CONFIG_RELOADED): void;
     public emit(
         name: InternalEventTypes.INTERNAL_MOD_INSTALL
-        | InternalEventTypes.GET_INTERNAL_MODS,
+        | InternalEventTypes.GET_INTERNAL_MODS
+        | InternalEventTypes.SERVER_PRE_START,
         data: any,
     ): void;
-    public emit(name: InternalEventTypes, data?: any): void {
-        this.EVENT_EMITTER.emit(name, data);
+    public emit(name: InternalEventTypes, ...data: any[]): void {
+        this.EVENT_EMITTER.emit(name, ...data);
     }
 
     public on(name: InternalEventTypes.DISCORD_MESSAGE, listener: (message: DiscordMessage) => Promise<any>): Listener;
@@ -48,9 +53,14 @@ export class EventBus extends IService {
     public on(name: InternalEventTypes.LOG_ENTRY, listener: (logEntryEvent: LogEntryEvent) => Promise<any>): Listener;
     public on(name: InternalEventTypes.MOD_UPDATED, listener: (status: ModUpdatedStatus) => Promise<any>): Listener;
     public on(name: InternalEventTypes.GAME_UPDATED, listener: (status: GameUpdatedStatus) => Promise<any>): Listener;
+    public on(name: InternalEventTypes.MISSION_FILE_WRITTEN, listener: (file: string) => Promise<any>): Listener;
+    public on(name: InternalEventTypes.BACKUP_CREATED, listener: (backup: string) => Promise<any>): Listener;
+    public on(name: InternalEventTypes.BACKUP_REMOVED, listener: (backups: string[]) => Promise<any>): Listener;
+    public on(name: InternalEventTypes.CONFIG_RELOADED, listener: () => Promise<any>): Listener;
     public on(
         name: InternalEventTypes.GET_INTERNAL_MODS
-        | InternalEventTypes.INTERNAL_MOD_INSTALL,
+        | InternalEventTypes.INTERNAL_MOD_INSTALL
+        | InternalEventTypes.SERVER_PRE_START,
         listener: () => Promise<any>,
     ): Listener;
     public on(name: InternalEventTypes, listener: (...data: any[]) => Promise<any>): Listener {
@@ -0,0 +1,165 @@
+import * as path from 'path';
+import { container, DependencyContainer, inject, injectable, InjectionToken, singleton } from 'tsyringe';
+import { ManagerController } from './manager-controller';
+import { ConfigFileHelper } from '../config/config-file-helper';
+import { LoggerFactory } from '../services/loggerfactory';
+import { Paths } from '../services/paths';
+import { Processes, ProcessSpawner, WindowsProcessFetcher } from '../services/processes';
+import { TaskTracker } from '../services/task-tracker';
+import { WorkerPool } from '../services/worker-pool';
+import { IService } from '../types/service';
+import { FSAPI, InjectionTokens } from '../util/apis';
+import { LogLevel } from '../util/logger';
+
+export interface ManagerInstance {
+    name: string;
+    dir: string;
+    injector: DependencyContainer;
+    controller: ManagerController;
+}
+
+/**
+ * Runs multiple server instances in one manager process.
+ *
+ * Every instance gets its own child container, so it has its own config, monitor, rcon etc.
+ * SteamCMD and the workshop live in the working dir of the supervisor and are shared by all instances,
+ * the process list is shared as well, so the processes are only scanned once for all instances.
+ * All instances share one event loop, so they also share the tracked tasks and the worker threads.
+ */
+@singleton()
+@injectable()
+export class InstanceSupervisor extends IService {
+
+    /** services which are created once and used by all instances */
+    public static readonly SHARED_SERVICES: InjectionToken<any>[] = [
+        ProcessSpawner,
+        WindowsProcessFetcher,
+        Processes,
+        TaskTracker,
+        WorkerPool,
+    ];
+
+    /** the root container the instances are created from */
+    public injector: DependencyContainer = container;
+
+    public readonly instances: ManagerInstance[] = [];
+
+    public constructor(
+        loggerFactory: LoggerFactory,
+        private paths: Paths,
+        @inject(InjectionTokens.fs) private fs: FSAPI,
+    ) {
+        super(loggerFactory.createLogger('Supervisor'));
+    }
+
+    /**
+     * @param argv the process args
+     * @returns the instance dirs passed with --instances dir1,dir2 or undefined if not running with instances
+     */
+    public static getInstanceDirs(argv: string[]): string[] | undefined {
+        let value: string | undefined;
+        const idx = argv.indexOf('--instances');
+        if (idx !== -1) {
+            value = argv[idx + 1];
+        } else {
+            value = argv.find((x) => x.startsWith('--instances='))?.slice('--instances='.length);
+        }
+        if (value === undefined) {
+            return undefined;
+        }
+        return value
+            .split(',')
+            .map((x) => x.trim())
+            .filter((x) => !!x);
+    }
+
+    private createInstance(dir: string, sharedDir: string): ManagerInstance {
+        const instanceDir = this.paths.isAbsolute(dir) ? dir : path.join(sharedDir, dir);
+        const name = path.basename(instanceDir);
+        if (this.instances.some((x) => x.name === name)) {
+            throw new Error(`Instance names must be unique, found "${name}" twice`);
+        }
+        this.fs.mkdirSync(instanceDir, { recursive: true });
+
+        // every registered class gets its own instance per instance, everything else is resolved from the root
+        const injector = this.injector.createChildContainer();
+        for (const [token, registrations] of ((this.injector as any)._registry).entries()) {
+            const registration = registrations[registrations.length - 1];
+            if (
+                !registration?.provider?.useClass
+                || token === InstanceSupervisor
+                || InstanceSupervisor.SHARED_SERVICES.indexOf(token) !== -1
+            ) {
+                continue;
+            }
+            injector.register(token, registration.provider, registration.options);
+        }
+
+        injector.resolve(LoggerFactory).instance = name;
+        injector.resolve(Paths).setInstance(name, instanceDir, sharedDir);
+
+        const controller = injector.resolve(ManagerController);
+        controller.injector = injector;
+        controller.instance = name;
+        controller.processOwner = !this.instances.length;
+
+        return {
+            name,
+            dir: instanceDir,
+            injector,
+            controller,
+        };
+    }
+
+    /**
+     * @param dirs the working dirs of the instances, relative to the working dir of the supervisor
+     * @returns false if default configs had to be created and the instances were not started
+     */
+    public async start(dirs: string[]): Promise<boolean> {
+        const sharedDir = this.paths.cwd();
+
+        // shared services are created by the root, before an instance can create its own
+        for (const token of InstanceSupervisor.SHARED_SERVICES) {
+            this.injector.resolve(token);
+        }
+        // the instances reuse the process scans of each other
+        this.injector.resolve(Processes).setScanSharing(dirs.length > 1);
+
+        for (const dir of dirs) {
+            this.instances.push(this.createInstance(dir, sharedDir));
+        }
+
+        // create all missing configs at once, so they can be adjusted before the next start
+        const created = this.instances.filter(
+            (x) => x.injector.resolve(ConfigFileHelper).createDefaultConfig(false),
+        );
+        if (created.length) {
+            this.log.log(LogLevel.IMPORTANT, `Created default configs for: ${created.map((x) => x.name).join(', ')}`);
+            return false;
+        }
+
+        process.title = `Server-Manager Supervisor ${this.instances.map((x) => x.name).join(', ')}`;
+        this.log.log(LogLevel.IMPORTANT, `Starting ${this.instances.length} instances in ${sharedDir}`);
+
+        await Promise.all(this.instances.map(async (x) => {
+            try {
+                await x.controller.start();
+            } catch (e) {
+                this.log.log(LogLevel.ERROR, `Failed to start instance ${x.name}: ${e?.message}`, e);
+            }
+        }));
+
+        return true;
+    }
+
+    public async stop(): Promise<void> {
+        for (const instance of this.instances) {
+            try {
+                await instance.controller.stop();
+            } catch (e) {
+                this.log.log(LogLevel.ERROR, `Failed to stop instance ${instance.name}`, e);
+            }
+        }
+    }
+
+}
@@ -5,7 +5,7 @@ import { Logger, LogLevel } from '../util/logger';
 import { IStatefulService } from '../types/service';
 import { Requirements } from '../services/requirements';
 import { ConfigWatcher } from '../services/config-watcher';
-import { container, injectable, Lifecycle, registry, singleton } from 'tsyringe';
+import { container, DependencyContainer, injectable, Lifecycle, registry, singleton } from 'tsyringe';
 import { LoggerFactory } from '../services/loggerfactory';
 import { ServerDetector } from '../services/server-detector';
 import { IngameReport } from '../services/ingame-report';
@@ -30,6 +30,20 @@ import { IngameREST } from '../interface/ingame-rest';
 import { SyberiaCompat } from '../services/syberia-compat';
 import { DiscordEventConverter } from '../services/discord-event-converter';
 import { ConfigFileHelper } from '../config/config-file-helper';
+import { ServerTelemetry } from '../services/server-telemetry';
+import { IngameHeartbeat } from '../services/ingame-heartbeat';
+import { ResourceProfiles } from '../services/resource-profiles';
+import { StagedUpdates } from '../services/staged-updates';
+import { ClassDatabase } from '../services/class-database';
+import { RestartTracer } from '../services/restart-tracer';
+import { Prometheus } from '../services/prometheus';
+import { ClusterController } from '../services/cluster-controller';
+import { ClusterAgent } from '../services/cluster-agent';
+import { WorkerPool } from '../services/worker-pool';
+import { EventLoopMonitor } from '../services/event-loop-monitor';
+import { ManagerProfiler } from '../services/manager-profiler';
+import { EventBus } from './event-bus';
+import { InternalEventTypes } from '../types/events';
 
 @singleton()
 @registry([
@@ -52,6 +66,33 @@ import { ConfigFileHelper } from '../config/config-file-helper';
 
     // standalone services
     {
+    token: Prometheus,
+    useClass: Prometheus,
+    options: { lifecycle: Lifecycle.Singleton },
+    },
+    {
+    token: EventLoopMonitor,
+    useClass: EventLoopMonitor,
+    options: { lifecycle: Lifecycle.Singleton },
+    },
+    {
+    token: WorkerPool,
+    useClass: WorkerPool,
+    options: { lifecycle: Lifecycle.Singleton },
+    },
+    {
+    // early, so the continuous profiles cover the startup of the other services
+    token: ManagerProfiler,
+    useClass: ManagerProfiler,
+    options: { lifecycle: Lifecycle.Singleton },
+    },
+    {
+    // before the monitor, so the first state changes are traced
+    token: RestartTracer,
+    useClass: RestartTracer,
+    options: { lifecycle: Lifecycle.Singleton },
+    },
+    {
     token: Monitor,
     useClass: Monitor,
     options: { lifecycle: Lifecycle.Singleton },
@@ -86,6 +127,26 @@ import { ConfigFileHelper } from '../config/config-file-helper';
     useClass: MetricsCollector,
     options: { lifecycle: Lifecycle.Singleton },
     },
+    {
+    token: ServerTelemetry,
+    useClass: ServerTelemetry,
+    options: { lifecycle: Lifecycle.Singleton },
+    },
+    {
+    token: IngameHeartbeat,
+    useClass: IngameHeartbeat,
+    options: { lifecycle: Lifecycle.Singleton },
+    },
+    {
+    token: StagedUpdates,
+    useClass: StagedUpdates,
+    options: { lifecycle: Lifecycle.Singleton },
+    },
+    {
+    token: ClassDatabase,
+    useClass: ClassDatabase,
+    options: { lifecycle: Lifecycle.Singleton },
+    },
 
     // interfaces
     {
@@ -99,6 +160,11 @@ import { ConfigFileHelper } from '../config/config-file-helper';
     options: { lifecycle: Lifecycle.Singleton },
     },
     {
+    token: ClusterController,
+    useClass: ClusterController,
+    options: { lifecycle: Lifecycle.Singleton },
+    },
+    {
     token: REST,
     useClass: REST,
     options: { lifecycle: Lifecycle.Singleton },
@@ -109,6 +175,12 @@ import { ConfigFileHelper } from '../config/config-file-helper';
     options: { lifecycle: Lifecycle.Singleton },
     },
     {
+    // after the monitor and the interface, so the agent reports a complete state
+    token: ClusterAgent,
+    useClass: ClusterAgent,
+    options: { lifecycle: Lifecycle.Singleton },
+    },
+    {
     token: SyberiaCompat,
     useClass: SyberiaCompat,
     options: { lifecycle: Lifecycle.Singleton },
@@ -129,6 +201,18 @@ export class ManagerController {
 
     private log: Logger;
 
+    /** the container this controller was resolved from, differs per instance when running multiple instances */
+    public injector: DependencyContainer = container;
+
+    /** name of the instance if this controller is supervised together with other instances */
+    public instance?: string;
+
+    /**
+     * whether this controller applies the settings which affect the whole process (i.e. the cpu affinity of the manager),
+     * only the first instance does when running multiple instances
+     */
+    public processOwner = true;
+
     public constructor(
         loggerFactory: LoggerFactory,
         private configWatcher: ConfigWatcher,
@@ -140,6 +224,9 @@ export class ManagerController {
         private discord: DiscordBot,
         private discordEvents: DiscordEventConverter,
         private configFileHelper: ConfigFileHelper,
+        private resourceProfiles: ResourceProfiles,
+        private eventBus: EventBus,
+        private workerPool: WorkerPool,
     ) {
         this.log = loggerFactory.createLogger('Bootstrap');
     }
@@ -163,11 +250,12 @@ export class ManagerController {
                 proto = Object.getPrototypeOf(proto);
             }
 
-            if (protos.includes(IStatefulService.name)) {
+            // services shared by all instances are started and stopped by the first one
+            if (protos.includes(IStatefulService.name) && (this.processOwner || this.injector.isRegistered(token))) {
                 statefulServices.push(token);
             }
         }
-        return statefulServices.map((x) => container.resolve(x));
+        return statefulServices.map((x) => this.injector.resolve(x));
     }
 
     public async stop(force?: boolean): Promise<void> {
@@ -219,19 +307,32 @@ export class ManagerController {
         );
 
         this.manager.config = config;
+        this.eventBus.emit(InternalEventTypes.CONFIG_RELOADED);
 
-        // apply initial log level
+        // apply initial log level, instances only change the level of their own loggers
         const { loglevel } = config;
         if (typeof loglevel === 'number' && loglevel >= LogLevel.DEBUG && loglevel <= LogLevel.ERROR) {
-            Logger.defaultLogLevel = loglevel;
+            if (this.instance) {
+                Logger.INSTANCE_LOG_LEVELS[this.instance] = loglevel;
+            } else {
+                Logger.defaultLogLevel = loglevel;
+            }
         }
 
-        // set the process title
-        process.title = `Server-Manager ${this.manager.getServerExePath()}`;
+        // set the process title, the supervisor names the process when running instances
+        if (!this.instance) {
+            process.title = `Server-Manager ${this.manager.getServerExePath()}`;
+        }
 
-        // check any requirements before even starting
-        if (!this.skipInit) {
-            await this.requirements.check();
+        // pin the manager before it starts any maintenance work
+        if (this.processOwner) {
+            await this.resourceProfiles.applyManagerProfile();
+        } else if (config.managerCpuAffinity?.length) {
+            this.log.log(LogLevel.WARN, 'managerCpuAffinity affects all instances and is only applied from the config of the first instance');
+        }
+        // the workers are shared by all instances
+        if (this.processOwner) {
+            this.workerPool.setSize(config.workerThreads);
         }
 
         this.log.log(LogLevel.DEBUG, 'Setting up services..');
@@ -240,7 +341,9 @@ export class ManagerController {
         this.log.log(LogLevel.DEBUG, 'Services are set up');
         try {
 
+            // check any requirements before even starting, instances must not exit the process
             if (!this.skipInit) {
+                await this.requirements.check(!this.instance);
                 await this.initialSetup();
             }
 
@@ -256,6 +359,11 @@ export class ManagerController {
             }
         } catch (e) {
             this.log.log(LogLevel.ERROR, `Setup failed: ${e?.message}`, e);
+            if (this.instance) {
+                // only this instance failed, the others keep running
+                this.working = false;
+                throw e;
+            }
             process['origExit'](1);
         }
 
@@ -318,7 +426,8 @@ export class ManagerController {
 
         // Mods
         if (!await this.steamCmd.checkMods() || this.manager.config.updateModsOnStartup) {
-            if (!await this.steamCmd.updateAllMods()) {
+            // install the updated mods while the rest is downloading
+            if (!await this.steamCmd.updateAllMods({ install: true })) {
                 throw new Error('Updating Mods failed');
             }
         }
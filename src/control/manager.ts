@@ -83,7 +83,16 @@ export class Manager {
         if (!level) {
             return true;
         }
-        const userLevel = this.getUserLevel(userId);
+        return this.isLevelAllowed(this.getUserLevel(userId), level);
+    }
+
+    /**
+     * @returns whether a user with the given userLevel has the permissions of level
+     */
+    public isLevelAllowed(userLevel: UserLevel, level: UserLevel): boolean {
+        if (!level) {
+            return true;
+        }
         if (!userLevel) {
             return false;
         }
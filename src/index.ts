@@ -1,6 +1,7 @@
 import 'reflect-metadata';
 import './util/exit-capture';
 import { ManagerController } from './control/manager-controller';
+import { InstanceSupervisor } from './control/instance-supervisor';
 import { isRunFromWindowsGUI } from './util/is-run-from-gui';
 import * as childProcess from 'child_process';
 import * as fs from 'fs';
@@ -15,6 +16,9 @@ const helpText = `
         --skip-init       Skip the init process (requirements check, server update, mod update)
         --start-locked    Activates the server restart lock so it does not start the dayz server when the manager starts
         --skip-events     Skips execution of scheduled events
+        --instances <dir1>,<dir2>
+                          Runs one server instance per dir in this process, each dir has its own config.
+                          SteamCMD and the workshop in the current dir are shared by all instances
 `;
 
 if (process.argv.includes('--help')) {
@@ -67,6 +71,15 @@ void (async () => {
         }
     });
 
+    const instanceDirs = InstanceSupervisor.getInstanceDirs(process.argv);
+    if (instanceDirs?.length) {
+        if (!await container.resolve(InstanceSupervisor).start(instanceDirs)) {
+            // configs were created and need to be adjusted first
+            origExit(0);
+        }
+        return;
+    }
+
     await container.resolve(ManagerController).start();
 
 })();
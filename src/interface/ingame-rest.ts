@@ -21,6 +21,8 @@ interface IngameConfig {
     key: string;
     useApiForReport: boolean;
     reportInterval: number;
+    dataDump: boolean;
+    heartbeatInterval: number;
 }
 
 @singleton()
@@ -70,6 +72,7 @@ export class IngameREST extends IStatefulService {
                 useApiForReport: this.manager.config.ingameReportViaRest || false,
                 reportInterval: this.manager.config.ingameReportIntervall || 30.0,
                 dataDump: this.manager.config.dataDump || false,
+                heartbeatInterval: this.manager.config.ingameHeartbeatIntervall ?? 1.0,
             } as IngameConfig),
             { encoding: 'utf-8' },
         );
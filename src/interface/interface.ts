@@ -8,7 +8,7 @@ import { MissionFiles } from '../services/mission-files';
 import { Monitor } from '../services/monitor';
 import { SystemReporter } from '../services/system-reporter';
 import { RCON } from '../services/rcon';
-import { SteamCMD } from '../services/steamcmd';
+import { SteamCMD, SteamMetaData } from '../services/steamcmd';
 import { CommandMap, Request, RequestTemplate, Response, ResponsePartHandler } from '../types/interface';
 import { IService } from '../types/service';
 import { LogLevel } from '../util/logger';
@@ -16,6 +16,16 @@ import { makeTable } from '../util/table';
 import { constants as HTTP } from 'http2';
 import { ConfigFileHelper } from '../config/config-file-helper';
 import { ServerDetector } from '../services/server-detector';
+import { ServerTelemetry } from '../services/server-telemetry';
+import { ResourceProfiles } from '../services/resource-profiles';
+import { StagedUpdates } from '../services/staged-updates';
+import { ClassDatabase } from '../services/class-database';
+import { RestartTracer } from '../services/restart-tracer';
+import { InternalEventTypes } from '../types/events';
+import { MetricEntryEvent } from '../types/metrics';
+import { ResponseCache } from './response-cache';
+import { ClusterController } from '../services/cluster-controller';
+import { ManagerProfiler } from '../services/manager-profiler';
 
 /* istanbul ignore next */
 const parseBoolean = (val: any): boolean => true === val || 'true' === val;
@@ -23,6 +33,9 @@ const parseBoolean = (val: any): boolean => true === val || 'true' === val;
 /* istanbul ignore next */
 const parseNumber = (val: any): number => typeof val === 'number' ? val : Number(val);
 
+/* istanbul ignore next */
+const parseNumberList = (val: any): number[] => Array.isArray(val) ? val.map(parseNumber) : String(val).split(',').map(parseNumber);
+
 @singleton()
 @injectable()
 export class Interface extends IService {
@@ -38,10 +51,19 @@ export class Interface extends IService {
         private serverDetector: ServerDetector,
         private metrics: Metrics,
         private steamCmd: SteamCMD,
+        private steamMetaData: SteamMetaData,
         private logReader: LogReader,
         private backup: Backups,
         private missionFiles: MissionFiles,
         private configFileHelper: ConfigFileHelper,
+        private serverTelemetry: ServerTelemetry,
+        private resourceProfiles: ResourceProfiles,
+        private stagedUpdates: StagedUpdates,
+        private classDatabase: ClassDatabase,
+        private responseCache: ResponseCache,
+        private restartTracer: RestartTracer,
+        private clusterController: ClusterController,
+        private managerProfiler: ManagerProfiler,
     ) {
         super(loggerFactory.createLogger('Manager'));
         this.setupCommandMap();
@@ -189,6 +211,23 @@ export class Interface extends IService {
                 noResponse: true,
                 action: /* istanbul ignore next */ (req, params) => this.rcon.unwhitelistTxt(params.steamid),
             })],
+            ['importguids', RequestTemplate.build({
+                method: 'post',
+                level: 'moderate',
+                params: [{ name: 'list' }, { name: 'guids' }],
+                disableDiscord: true,
+                action: /* istanbul ignore next */ (req, params) => this.rcon.importGuids(
+                    params.list,
+                    Array.isArray(params.guids) ? params.guids : String(params.guids).split(/[\s;,]+/),
+                ),
+            })],
+            ['exportguids', RequestTemplate.build({
+                method: 'get',
+                level: 'moderate',
+                params: [{ name: 'list', location: 'query' }],
+                disableDiscord: true,
+                action: /* istanbul ignore next */ (req, params) => this.rcon.exportGuids(params.list),
+            })],
             ['restart', RequestTemplate.build({
                 method: 'post',
                 level: 'manage',
@@ -218,8 +257,34 @@ export class Interface extends IService {
                 level: 'manage',
                 disableDiscord: true,
                 params: [{ name: 'type', location: 'query' }, { name: 'since', optional: true, location: 'query', parse: parseNumber }],
+                cache: {
+                    ttl: 10000,
+                    invalidateOn: [InternalEventTypes.METRIC_ENTRY],
+                    // metrics of different types are pushed all the time, only the requested type is outdated
+                    invalidates: (params, event: MetricEntryEvent) => params.type === event?.type,
+                },
                 action: (req, params) => this.metrics.fetchMetrics(params.type, params.since ? Number(params.since) : undefined),
             })],
+            ['servertelemetry', RequestTemplate.build({
+                method: 'get',
+                level: 'manage',
+                disableDiscord: true,
+                params: [{ name: 'since', optional: true, location: 'query', parse: parseNumber }],
+                action: (req, params) => this.serverTelemetry.getSamples(params.since ? Number(params.since) : undefined),
+            })],
+            ['restartcycles', RequestTemplate.build({
+                method: 'get',
+                level: 'manage',
+                disableDiscord: true,
+                params: [{ name: 'since', optional: true, location: 'query', parse: parseNumber }],
+                action: (req, params) => this.restartTracer.getTrace(params.since ? Number(params.since) : undefined),
+            })],
+            ['resourceprofiles', RequestTemplate.build({
+                method: 'get',
+                level: 'manage',
+                disableDiscord: true,
+                action: () => this.resourceProfiles.getEffectiveSettings(),
+            })],
             ['deleteMetrics', RequestTemplate.build({
                 method: 'delete',
                 level: 'admin',
@@ -256,6 +321,7 @@ export class Interface extends IService {
                 method: 'get',
                 level: 'admin',
                 disableDiscord: true,
+                cache: { ttl: 60000, invalidateOn: [InternalEventTypes.CONFIG_RELOADED] },
                 action: () => this.configFileHelper.getConfigFileContent(this.configFileHelper.getConfigFilePath()),
             })],
             ['updateconfig', RequestTemplate.build({
@@ -282,6 +348,25 @@ export class Interface extends IService {
                     force: params?.force,
                 }),
             })],
+            ['modsmeta', RequestTemplate.build({
+                method: 'get',
+                level: 'view',
+                disableDiscord: true,
+                params: [{ name: 'refresh', optional: true, parse: parseBoolean }],
+                action: (req, params) => this.steamMetaData.getModsMetaData(
+                    this.manager.getCombinedModIdList(),
+                    {
+                        // served from the cache unless requested otherwise
+                        cachedOnly: !params?.refresh,
+                    },
+                ),
+            })],
+            ['modupdatetimeline', RequestTemplate.build({
+                method: 'get',
+                level: 'view',
+                disableDiscord: true,
+                action: () => this.steamCmd.lastModUpdateTimeline ?? null,
+            })],
             ['updateserver', RequestTemplate.build({
                 method: 'post',
                 level: 'manage',
@@ -291,6 +376,53 @@ export class Interface extends IService {
                     validate: params?.validate,
                 }),
             })],
+            ['stageupdate', RequestTemplate.build({
+                method: 'post',
+                level: 'manage',
+                disableDiscord: true,
+                action: () => this.stagedUpdates.prepare(),
+            })],
+            ['stagedupdate', RequestTemplate.build({
+                method: 'get',
+                level: 'view',
+                disableDiscord: true,
+                action: () => this.stagedUpdates.getStatus(),
+            })],
+            ['classdb', RequestTemplate.build({
+                method: 'get',
+                level: 'view',
+                disableDiscord: true,
+                params: [
+                    ...['classname', 'root', 'base', 'name'].map((name) => ({ name, location: 'query' as const, optional: true })),
+                    { name: 'scope', location: 'query', optional: true, parse: parseNumber },
+                    { name: 'offset', location: 'query', optional: true, parse: parseNumber },
+                    { name: 'limit', location: 'query', optional: true, parse: parseNumber },
+                ],
+                action: (req, params) => {
+                    if (params.classname) {
+                        return this.classDatabase.getClass(params.classname, params.root || undefined);
+                    }
+                    return this.classDatabase.query({
+                        root: params.root,
+                        baseClass: params.base,
+                        name: params.name,
+                        scope: params.scope === undefined ? undefined : parseNumber(params.scope),
+                        offset: params.offset === undefined ? undefined : parseNumber(params.offset),
+                        limit: params.limit === undefined ? undefined : parseNumber(params.limit),
+                    });
+                },
+            })],
+            ['classdbstatus', RequestTemplate.build({
+                method: 'get',
+                level: 'view',
+                disableDiscord: true,
+                action: () => this.classDatabase.getStatus(),
+            })],
+            ['updateclassdb', RequestTemplate.build({
+                method: 'post',
+                level: 'manage',
+                action: () => this.classDatabase.update(),
+            })],
             ['backup', RequestTemplate.build({
                 method: 'post',
                 level: 'manage',
@@ -300,8 +432,15 @@ export class Interface extends IService {
             ['getbackups', RequestTemplate.build({
                 method: 'get',
                 level: 'manage',
+                cache: { ttl: 60000, invalidateOn: [InternalEventTypes.BACKUP_CREATED, InternalEventTypes.BACKUP_REMOVED] },
                 action: () => this.backup.getBackups(),
             })],
+            ['restorebackup', RequestTemplate.build({
+                method: 'post',
+                level: 'manage',
+                params: [{ name: 'backup' }],
+                action: (req, params) => this.backup.restoreBackup(params.backup),
+            })],
             ['writemissionfile', RequestTemplate.build({
                 method: 'post',
                 level: 'manage',
@@ -321,18 +460,54 @@ export class Interface extends IService {
                 params: [{ name: 'file', location: 'query' }],
                 action: (req, params) => this.missionFiles.readMissionFile(params.file),
             })],
+            ['readmissioneconomy', RequestTemplate.build({
+                method: 'get',
+                level: 'manage',
+                disableDiscord: true,
+                params: [
+                    { name: 'file', location: 'query' },
+                    ...['name', 'category', 'tag', 'usage', 'value'].map((name) => ({ name, location: 'query' as const, optional: true })),
+                    { name: 'bbox', location: 'query', optional: true, parse: parseNumberList },
+                    { name: 'offset', location: 'query', optional: true, parse: parseNumber },
+                    { name: 'limit', location: 'query', optional: true, parse: parseNumber },
+                ],
+                action: (req, params) => {
+                    // without filters, the whole parsed file is returned
+                    if (Object.keys(params).every((x) => x === 'file' || params[x] === undefined)) {
+                        return this.missionFiles.readMissionEconomy(params.file);
+                    }
+                    return this.missionFiles.queryMissionEconomy(params.file, {
+                        name: params.name,
+                        category: params.category,
+                        tag: params.tag,
+                        usage: params.usage,
+                        value: params.value,
+                        bbox: params.bbox === undefined ? undefined : parseNumberList(params.bbox),
+                        offset: params.offset === undefined ? undefined : parseNumber(params.offset),
+                        limit: params.limit === undefined ? undefined : parseNumber(params.limit),
+                    });
+                },
+            })],
+            ['readmissioneconomyfiles', RequestTemplate.build({
+                method: 'post',
+                level: 'manage',
+                disableDiscord: true,
+                params: [{ name: 'files' }],
+                action: (req, params) => Promise.all(this.getFileList(params).map((x) => this.missionFiles.readMissionEconomy(x))),
+            })],
             ['readmissionfiles', RequestTemplate.build({
                 method: 'post',
                 level: 'manage',
                 disableDiscord: true,
                 params: [{ name: 'files' }],
-                action: (req, params) => Promise.all(params.files.map((x: string) => this.missionFiles.readMissionFile(x))),
+                action: (req, params) => Promise.all(this.getFileList(params).map((x) => this.missionFiles.readMissionFile(x))),
             })],
             ['readmissiondir', RequestTemplate.build({
                 method: 'get',
                 level: 'manage',
                 disableDiscord: true,
                 params: [{ name: 'dir', location: 'query' }],
+                cache: { ttl: 30000, invalidateOn: [InternalEventTypes.MISSION_FILE_WRITTEN] },
                 action: async (req, params) => this.missionFiles.readMissionDir(params.dir),
             })],
             ['writeprofilefile', RequestTemplate.build({
@@ -372,8 +547,110 @@ export class Interface extends IService {
                 method: 'get',
                 level: 'view',
                 disableDiscord: true,
+                cache: { ttl: 10000, invalidateOn: [InternalEventTypes.CONFIG_RELOADED] },
                 action: () => this.manager.getServerInfo(),
             })],
+            ['cachestats', RequestTemplate.build({
+                method: 'get',
+                level: 'manage',
+                disableDiscord: true,
+                action: () => this.responseCache.getStats(),
+            })],
+            ['cpuprofile', RequestTemplate.build({
+                method: 'post',
+                level: 'admin',
+                disableDiscord: true,
+                params: [{ name: 'seconds', optional: true, parse: parseNumber }],
+                action: (req, params) => this.managerProfiler.captureCpuProfile(parseNumber(params.seconds ?? 10)),
+            })],
+            ['heapprofile', RequestTemplate.build({
+                method: 'post',
+                level: 'admin',
+                disableDiscord: true,
+                params: [{ name: 'seconds', optional: true, parse: parseNumber }],
+                action: (req, params) => this.managerProfiler.captureHeapProfile(parseNumber(params.seconds ?? 10)),
+            })],
+            ['heapsnapshot', RequestTemplate.build({
+                method: 'post',
+                level: 'admin',
+                disableDiscord: true,
+                action: () => this.managerProfiler.takeHeapSnapshot(),
+            })],
+            ['activehandles', RequestTemplate.build({
+                method: 'get',
+                level: 'admin',
+                disableDiscord: true,
+                action: () => this.managerProfiler.dumpActiveHandles(),
+            })],
+            ['profiles', RequestTemplate.build({
+                method: 'get',
+                level: 'admin',
+                disableDiscord: true,
+                action: () => this.managerProfiler.getProfiles(),
+            })],
+            ['agents', RequestTemplate.build({
+                method: 'get',
+                level: 'view',
+                action: this.getAgents,
+            })],
+            ['agentlogs', RequestTemplate.build({
+                method: 'get',
+                level: 'manage',
+                disableDiscord: true,
+                params: [
+                    { name: 'agent', location: 'query' },
+                    { name: 'type', optional: true, location: 'query' },
+                    { name: 'since', optional: true, location: 'query', parse: parseNumber },
+                ],
+                action: (req, params) => this.clusterController.getAgentLogs(
+                    params.agent,
+                    params.type,
+                    params.since ? Number(params.since) : undefined,
+                ),
+            })],
+            ['agentmetrics', RequestTemplate.build({
+                method: 'get',
+                level: 'manage',
+                disableDiscord: true,
+                params: [
+                    { name: 'agent', location: 'query' },
+                    { name: 'type', location: 'query' },
+                    { name: 'since', optional: true, location: 'query', parse: parseNumber },
+                ],
+                action: (req, params) => this.clusterController.getAgentMetrics(
+                    params.agent,
+                    params.type,
+                    params.since ? Number(params.since) : undefined,
+                ),
+            })],
+            ['agentrequest', RequestTemplate.build({
+                method: 'post',
+                level: 'view',
+                disableDiscord: true,
+                params: [{ name: 'agent' }, { name: 'command' }, { name: 'body', optional: true }],
+                action: this.agentRequest,
+            })],
+            ['rollout', RequestTemplate.build({
+                method: 'post',
+                level: 'manage',
+                params: [
+                    { name: 'command' },
+                    { name: 'body', optional: true },
+                    { name: 'stagger', optional: true, parse: parseNumber },
+                ],
+                action: (req, params) => this.clusterController.rollout(
+                    this.checkClusterCommand(req, params.command),
+                    req.user,
+                    params.body,
+                    params.stagger ? Number(params.stagger) * 1000 : undefined,
+                ),
+            })],
+            ['rollouts', RequestTemplate.build({
+                method: 'get',
+                level: 'manage',
+                disableDiscord: true,
+                action: () => this.clusterController.getRollouts(),
+            })],
         ]);
     }
 
@@ -389,6 +666,14 @@ export class Interface extends IService {
         );
     }
 
+    private getFileList(params: any): string[] {
+        const files = params?.files;
+        if (!Array.isArray(files) || files.some((x) => typeof x !== 'string')) {
+            throw new Response(HTTP.HTTP_STATUS_BAD_REQUEST, 'files must be an array of file names');
+        }
+        return files;
+    }
+
     private acceptsText(req: Request): boolean {
         return !!req?.accept?.startsWith('text');
     }
@@ -437,15 +722,69 @@ export class Interface extends IService {
         return this.rcon.getBans();
     };
 
+    private getAgents = async (req: Request): Promise<any> => {
+        const agents = this.clusterController.getAgents();
+        if (this.acceptsText(req)) {
+            if (!agents.length) {
+                return 'No agents connected';
+            }
+            return makeTable([
+                ['Name', 'Version', 'Address', 'State', 'Players', 'CPU', 'RAM'],
+                ...agents.map((x) => [
+                    x.name,
+                    x.version,
+                    x.address,
+                    x.state.serverState ?? '-',
+                    x.state.players ?? '-',
+                    x.state.cpu !== undefined ? `${x.state.cpu}%` : '-',
+                    x.state.mem !== undefined ? `${x.state.mem} / ${x.state.memTotal} MB` : '-',
+                ]),
+            ]).join('\n');
+        }
+        return agents;
+    };
+
+    /**
+     * @returns the command if it may be executed on the agents by the user
+     */
+    private checkClusterCommand(req: Request, command: string): string {
+        const template = this.commandMap.get(command);
+        if (!template || template.disableRest) {
+            throw new Response(HTTP.HTTP_STATUS_BAD_REQUEST, `Unknown command: ${command}`);
+        }
+        if (req.forwarded || (template.level && !this.manager.isUserOfLevel(req.user, template.level))) {
+            throw new Response(HTTP.HTTP_STATUS_UNAUTHORIZED, 'You are not allowed to do that');
+        }
+        return command;
+    }
+
+    private agentRequest = async (req: Request, params: Record<string, any>): Promise<any> => {
+        const forward = new Request();
+        forward.resource = this.checkClusterCommand(req, params.command);
+        forward.accept = req.accept;
+        // params are passed in both locations, the agent picks the one the command expects
+        forward.body = params.body;
+        forward.query = params.body;
+        forward.user = req.user;
+
+        const response = await this.clusterController.request(params.agent, forward);
+        if (response.status < 200 || response.status >= 300) {
+            throw response;
+        }
+        return response.body;
+    };
+
     // apply RBAC and audit
     private async actionRbacCheck(req: Request, x: RequestTemplate): Promise<Response | null> {
         if (x.level) {
-            const user = this.manager.config?.admins?.find((admin) => admin.userId === req.user);
-            if (
-                !user
-                || !req.user
-                || !this.manager.isUserOfLevel(req.user, x.level)
-            ) {
+            const user = req.forwarded
+                ? { userId: req.user }
+                : this.manager.config?.admins?.find((admin) => admin.userId === req.user);
+            // forwarded users are not known to the agent, but the controller asserts their level
+            const allowed = req.forwarded
+                ? this.manager.isLevelAllowed(req.userLevel, x.level)
+                : this.manager.isUserOfLevel(req.user, x.level);
+            if (!user || !req.user || !allowed) {
                 return new Response(
                     HTTP.HTTP_STATUS_UNAUTHORIZED,
                     'You are not allowed to do that',
@@ -529,15 +868,33 @@ export class Interface extends IService {
             return (req.canStream && responsePartHandler) ? responsePartHandler(part) : undefined;
         }
 
+        if (template.cache && !template.noResponse) {
+            return this.responseCache.fetch(
+                req.resource,
+                template.cache,
+                JSON.stringify([req.accept, resolvedParams]),
+                () => this.executeAction(req, template, resolvedParams, responsePartHandlerWrapper),
+                resolvedParams,
+            );
+        }
+        return this.executeAction(req, template, resolvedParams, responsePartHandlerWrapper);
+    }
+
+    private async executeAction(
+        req: Request,
+        template: RequestTemplate,
+        resolvedParams: Record<string, any>,
+        responsePartHandler: ResponsePartHandler,
+    ): Promise<Response> {
         try {
             if (template.noResponse) {
-                await template.action(req, resolvedParams, { partialResponseCallback: responsePartHandlerWrapper });
+                await template.action(req, resolvedParams, { partialResponseCallback: responsePartHandler });
                 return new Response(
                     HTTP.HTTP_STATUS_OK,
                     'Done',
                 );
             } else {
-                const result = await template.action(req, resolvedParams, { partialResponseCallback: responsePartHandlerWrapper });
+                const result = await template.action(req, resolvedParams, { partialResponseCallback: responsePartHandler });
                 if (!result) {
                     return new Response(HTTP.HTTP_STATUS_NOT_FOUND, 'Action had no results');
                 }
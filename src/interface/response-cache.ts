@@ -0,0 +1,209 @@
+import { injectable, singleton } from 'tsyringe';
+import { Manager } from '../control/manager';
+import { EventBus } from '../control/event-bus';
+import { LoggerFactory } from '../services/loggerfactory';
+import { InternalEventTypes } from '../types/events';
+import { Response, ResponseCacheCommandStats, ResponseCacheOptions, ResponseCacheStats } from '../types/interface';
+import { IService } from '../types/service';
+import { LogLevel } from '../util/logger';
+import { constants as HTTP } from 'http2';
+
+interface CacheEntry {
+    expires: number;
+    response: Promise<Response>;
+    params?: Record<string, any>;
+}
+
+interface CommandCache {
+    options: ResponseCacheOptions;
+    /** increased on every invalidation, so responses computed before it are not stored */
+    generation: number;
+    entries: Map<string, CacheEntry>;
+    stats: Omit<ResponseCacheCommandStats, 'entries'>;
+}
+
+/**
+ * Caches the responses of read heavy interface commands.
+ *
+ * Entries expire after the ttl of the command or as soon as one of its invalidation events is emitted.
+ * Concurrent requests for the same entry share a single execution.
+ */
+@singleton()
+@injectable()
+export class ResponseCache extends IService {
+
+    /** max amount of different requests (params) cached per command */
+    public static readonly MAX_ENTRIES = 100;
+
+    private commands = new Map<string, CommandCache>();
+    private eventCommands = new Map<InternalEventTypes, Set<string>>();
+
+    public constructor(
+        loggerFactory: LoggerFactory,
+        private manager: Manager,
+        private eventBus: EventBus,
+    ) {
+        super(loggerFactory.createLogger('ResponseCache'));
+    }
+
+    public isEnabled(): boolean {
+        return this.manager.config?.webResponseCache !== false;
+    }
+
+    public async fetch(
+        command: string,
+        options: ResponseCacheOptions,
+        key: string,
+        execute: () => Promise<Response>,
+        params?: Record<string, any>,
+    ): Promise<Response> {
+        if (!this.isEnabled() || !(options?.ttl > 0)) {
+            return execute();
+        }
+
+        const cache = this.getCommandCache(command, options);
+        const now = Date.now();
+        const cached = cache.entries.get(key);
+        if (cached && cached.expires > now) {
+            cache.stats.hits++;
+            return this.copy(await cached.response);
+        }
+        cache.stats.misses++;
+
+        const generation = cache.generation;
+        const entry: CacheEntry = {
+            params,
+            // pending entries are shared until they resolve
+            expires: Number.MAX_SAFE_INTEGER,
+            response: execute().then((response) => {
+                if (response?.status !== HTTP.HTTP_STATUS_OK || cache.generation !== generation) {
+                    this.dropEntry(cache, key, entry);
+                } else {
+                    if (typeof response.body !== 'string') {
+                        response.serializedBody = JSON.stringify(response.body);
+                    }
+                    entry.expires = Date.now() + options.ttl;
+                }
+                return response;
+            }),
+        };
+        entry.response.catch(/* istanbul ignore next */ () => this.dropEntry(cache, key, entry));
+
+        cache.entries.delete(key);
+        cache.entries.set(key, entry);
+        this.evict(cache, now);
+
+        return this.copy(await entry.response);
+    }
+
+    public invalidate(command?: string): void {
+        for (const [name, cache] of this.commands) {
+            if (!command || name === command) {
+                cache.generation++;
+                cache.stats.invalidations++;
+                cache.entries.clear();
+            }
+        }
+    }
+
+    public getStats(): ResponseCacheStats {
+        const commands: Record<string, ResponseCacheCommandStats> = {};
+        for (const [name, cache] of this.commands) {
+            commands[name] = {
+                ...cache.stats,
+                entries: cache.entries.size,
+            };
+        }
+        return {
+            enabled: this.isEnabled(),
+            commands,
+        };
+    }
+
+    private getCommandCache(command: string, options: ResponseCacheOptions): CommandCache {
+        let cache = this.commands.get(command);
+        if (!cache) {
+            cache = {
+                options,
+                generation: 0,
+                entries: new Map(),
+                stats: { hits: 0, misses: 0, invalidations: 0 },
+            };
+            this.commands.set(command, cache);
+            for (const event of options.invalidateOn ?? []) {
+                this.listen(event, command);
+            }
+        }
+        return cache;
+    }
+
+    private listen(event: InternalEventTypes, command: string): void {
+        let commands = this.eventCommands.get(event);
+        if (!commands) {
+            commands = new Set();
+            this.eventCommands.set(event, commands);
+            this.eventBus.on(
+                event as any,
+                /* istanbul ignore next */ async (...data: any[]) => this.onEvent(event, ...data),
+            );
+        }
+        commands.add(command);
+    }
+
+    private onEvent(event: InternalEventTypes, ...data: any[]): void {
+        for (const command of this.eventCommands.get(event) ?? []) {
+            const cache = this.commands.get(command);
+            if (cache?.options.invalidates) {
+                this.invalidateMatching(cache, (params) => cache.options.invalidates(params ?? {}, ...data));
+                continue;
+            }
+            this.log.log(LogLevel.DEBUG, `Invalidating ${command} because of ${event}`);
+            this.invalidate(command);
+        }
+    }
+
+    private invalidateMatching(cache: CommandCache, matches: (params?: Record<string, any>) => boolean): void {
+        let invalidated = false;
+        for (const [key, entry] of cache.entries) {
+            // pending entries are dropped as well, so their result is not stored
+            if (matches(entry.params)) {
+                cache.entries.delete(key);
+                invalidated = true;
+            }
+        }
+        if (invalidated) {
+            cache.stats.invalidations++;
+        }
+    }
+
+    private dropEntry(cache: CommandCache, key: string, entry: CacheEntry): void {
+        if (cache.entries.get(key) === entry) {
+            cache.entries.delete(key);
+        }
+    }
+
+    private evict(cache: CommandCache, now: number): void {
+        if (cache.entries.size <= ResponseCache.MAX_ENTRIES) {
+            return;
+        }
+        for (const [key, entry] of cache.entries) {
+            if (entry.expires <= now) {
+                cache.entries.delete(key);
+            }
+        }
+        // entries are kept in insertion order, so the oldest are dropped first
+        for (const key of cache.entries.keys()) {
+            if (cache.entries.size <= ResponseCache.MAX_ENTRIES) {
+                break;
+            }
+            cache.entries.delete(key);
+        }
+    }
+
+    private copy(response: Response): Response {
+        const copy = new Response(response.status, response.body, response.uuid);
+        copy.serializedBody = response.serializedBody;
+        return copy;
+    }
+
+}
@@ -3,6 +3,7 @@ import * as ws from 'ws';
 import * as basicAuth from 'express-basic-auth';
 import * as compression from 'compression';
 import * as path from 'path';
+import * as crypto from 'crypto';
 import { loggerMiddleware } from '../middleware/logger';
 
 import { Manager } from '../control/manager';
@@ -17,6 +18,9 @@ import { InternalEventTypes } from '../types/events';
 import { Listener } from 'eventemitter2';
 import { WebsocketCommand, WebsocketListenerEvent, WebsocketListenerType, WebsocketMessage } from '../types/websocket';
 import { Interface } from './interface';
+import { Prometheus } from '../services/prometheus';
+import { PromRegistry } from '../util/prometheus';
+import { ManagerProfiler } from '../services/manager-profiler';
 
 @singleton()
 @injectable()
@@ -40,6 +44,8 @@ export class REST extends IStatefulService {
         private manager: Manager,
         private eventBus: EventBus,
         private eventInterface: Interface,
+        private prometheus: Prometheus,
+        private managerProfiler: ManagerProfiler,
     ) {
         super(loggerFactory.createLogger('REST'));
     }
@@ -50,6 +56,12 @@ export class REST extends IStatefulService {
     }
 
     public async start(): Promise<void> {
+        // agents are managed through the UI of the cluster controller
+        if (this.manager.config?.clusterMode === 'agent') {
+            this.log.log(LogLevel.INFO, 'Web interface is disabled in cluster agent mode');
+            return;
+        }
+
         this.express = this.createExpress();
 
         this.port = this.manager.getWebPort();
@@ -72,6 +84,14 @@ export class REST extends IStatefulService {
             /* istanbul ignore next */
             (req, res) => res.send(this.manager.APP_VERSION),
         );
+        if (this.manager.config.prometheusMetrics !== false) {
+            this.express.get(
+                '/metrics',
+                this.createMetricsAuth(),
+                /* istanbul ignore next */
+                (req, res) => this.handleMetrics(req, res),
+            );
+        }
         this.express.use(
             '/api',
             this.router,
@@ -204,12 +224,23 @@ export class REST extends IStatefulService {
         }
     }
 
-    private websocketRespond(socket: ws, response: Response | ResponsePart): Promise<void> {
-        return new Promise((resolve, reject) => {
-            socket.send(JSON.stringify({
+    private serializeWsResponse(response: Response | ResponsePart): string {
+        const serializedBody = (response as Response)?.serializedBody;
+        if (serializedBody === undefined) {
+            return JSON.stringify({
                 cmd: WebsocketCommand.RESPONSE,
                 data: response,
-            } as WebsocketMessage<Response>), (e) => {
+            } as WebsocketMessage<Response>);
+        }
+        // cached responses embed the already serialized body
+        const { status, uuid } = response as Response;
+        const head = JSON.stringify({ status, uuid }).slice(0, -1);
+        return `{"cmd":${JSON.stringify(WebsocketCommand.RESPONSE)},"data":${head},"body":${serializedBody}}}`;
+    }
+
+    private websocketRespond(socket: ws, response: Response | ResponsePart): Promise<void> {
+        return new Promise((resolve, reject) => {
+            socket.send(this.serializeWsResponse(response), (e) => {
                 if (e) {
                     reject(e);
                 } else {
@@ -297,13 +328,51 @@ export class REST extends IStatefulService {
         res.sendFile(path.join(this.UI_FILES, 'index.html'));
     }
 
-    private async setupRouter(): Promise<void> {
-
+    private createBasicAuth(): express.RequestHandler {
         const users: { [k: string]: string } = {};
         for (const user of (this.manager.config?.admins ?? [])) {
             users[user.userId] = user.password;
         }
-        this.router.use((basicAuth as any)({ users, challenge: false }));
+        return (basicAuth as any)({ users, challenge: false });
+    }
+
+    /**
+     * basic auth with an admin or the metrics token as bearer token
+     */
+    private createMetricsAuth(): express.RequestHandler {
+        const basic = this.createBasicAuth();
+        const token = this.manager.config?.prometheusMetricsToken;
+        if (!token) {
+            return basic;
+        }
+        const expected = crypto.createHash('sha256').update(`Bearer ${token}`).digest();
+        return (req, res, next) => {
+            // compare hashes, so the comparison takes the same time regardless of the length
+            const actual = crypto.createHash('sha256').update(req.headers.authorization ?? '').digest();
+            if (crypto.timingSafeEqual(actual, expected)) {
+                next();
+                return;
+            }
+            basic(req, res, next);
+        };
+    }
+
+    private handleMetrics(req: express.Request, res: express.Response): void {
+        res.status(200).type(PromRegistry.CONTENT_TYPE).send(this.prometheus.render());
+    }
+
+    private async setupRouter(): Promise<void> {
+
+        this.router.use(this.createBasicAuth());
+
+        // profiles are streamed, they are too large to be sent as the body of a command
+        this.router.get(
+            '/profile',
+            /* istanbul ignore next */
+            (req, res) => {
+                void this.handleProfileDownload(req, res);
+            },
+        );
 
         const commandMap = this.eventInterface.commandMap || new Map();
         for (const [resource, command] of commandMap) {
@@ -335,23 +404,50 @@ export class REST extends IStatefulService {
             return;
         }
 
-        const base64Credentials = req.headers.authorization?.split(' ')[1];
-        const username = base64Credentials
-            ? Buffer.from(base64Credentials, 'base64')?.toString('utf-8')?.split(':')[0]
-            : '';
-
         const internalRequest = new Request();
         internalRequest.accept = req.headers.accept ?? 'application/json';
         internalRequest.body = req.body;
         internalRequest.query = req.query;
         internalRequest.resource = resource;
-        internalRequest.user = username;
+        internalRequest.user = this.getUsername(req);
 
         const internalResponse = await this.eventInterface.execute(internalRequest);
 
+        if (internalResponse.serializedBody !== undefined) {
+            res.status(internalResponse.status).type('json').send(internalResponse.serializedBody);
+            return;
+        }
         res.status(internalResponse.status).send(internalResponse.body);
     }
 
+    private getUsername(req: express.Request): string {
+        const base64Credentials = req.headers.authorization?.split(' ')[1];
+        return base64Credentials
+            ? Buffer.from(base64Credentials, 'base64')?.toString('utf-8')?.split(':')[0]
+            : '';
+    }
+
+    private async handleProfileDownload(req: express.Request, res: express.Response): Promise<void> {
+        if (!this.manager.isUserOfLevel(this.getUsername(req), 'admin')) {
+            res.sendStatus(401);
+            return;
+        }
+
+        try {
+            const { profile, stream } = await this.managerProfiler.openProfile(String(req.query.file ?? ''));
+            stream.on('error', (e) => {
+                this.log.log(LogLevel.ERROR, `Failed to send profile ${profile.file}`, e);
+                res.destroy(e);
+            });
+            res.status(200)
+                .attachment(profile.file)
+                .set('Content-Length', String(profile.size));
+            stream.pipe(res);
+        } catch (e) {
+            res.status(e?.status ?? 500).send(e?.body ?? e?.message);
+        }
+    }
+
     public stop(): Promise<void> {
         return new Promise<void>((r, e) => {
             if (!this.server || !this.server.listening) {
@@ -7,15 +7,24 @@ import { IService } from '../types/service';
 import { LoggerFactory } from './loggerfactory';
 import { FSAPI, InjectionTokens } from '../util/apis';
 import { inject, injectable, singleton } from 'tsyringe';
+import { BackupStore } from '../util/backup-store';
+import { EventBus } from '../control/event-bus';
+import { WorkerPool } from './worker-pool';
+import { InternalEventTypes } from '../types/events';
 
 @singleton()
 @injectable()
 export class Backups extends IService {
 
+    // store operations are serialized, so the garbage collection never sees chunks of a running backup
+    private storeQueue: Promise<any> = Promise.resolve();
+
     public constructor(
         loggerFactory: LoggerFactory,
         private manager: Manager,
         private paths: Paths,
+        private eventBus: EventBus,
+        private workerPool: WorkerPool,
         @inject(InjectionTokens.fs) private fs: FSAPI,
     ) {
         super(loggerFactory.createLogger('Backups'));
@@ -37,12 +46,48 @@ export class Backups extends IService {
 
         this.log.log(LogLevel.IMPORTANT, `Creating backup ${curMarker}`);
 
-        const curBackup = path.join(backups, curMarker);
-        await this.paths.copyDirFromTo(mpmissions, curBackup);
+        if (this.manager.config.backupDeduplicate) {
+            const result = await this.withStore((store) => this.workerPool.run('createBackup', mpmissions, store.dir, curMarker));
+            this.log.log(
+                LogLevel.INFO,
+                `Backup ${curMarker} done: ${result.files} files (${result.reused} unchanged), `
+                    + `${result.newChunks} of ${result.chunks} chunks new (${result.newBytes} bytes)`,
+            );
+        } else {
+            const curBackup = path.join(backups, curMarker);
+            await this.paths.copyDirFromTo(mpmissions, curBackup);
+        }
+        this.eventBus.emit(InternalEventTypes.BACKUP_CREATED, curMarker);
 
         void this.cleanup();
     }
 
+    /**
+     * Queues an operation on the deduplicated backups, the expensive ones (hashing and compressing the chunks) run in the worker pool
+     */
+    private withStore<T>(action: (store: BackupStore) => Promise<T>): Promise<T> {
+        const store = new BackupStore(this.fs, this.getBackupDir());
+        const result = this.storeQueue.then(() => action(store));
+        this.storeQueue = result.catch(/* istanbul ignore next */ () => undefined);
+        return result;
+    }
+
+    /**
+     * Restores a deduplicated backup into the given folder.
+     * Defaults to a folder in the backup path, so the current mpmissions folder is never overwritten while the server runs.
+     *
+     * @returns the folder the backup was restored to
+     */
+    public async restoreBackup(backup: string, target?: string): Promise<string> {
+        if (!/^mpmissions_[\w-]+$/.test(backup ?? '')) {
+            throw new Error(`Invalid backup name: ${backup}`);
+        }
+        const restorePath = target || path.join(this.getBackupDir(), 'restored', backup);
+        this.log.log(LogLevel.IMPORTANT, `Restoring backup ${backup} to ${restorePath}`);
+        await this.withStore((store) => this.workerPool.run('restoreBackup', backup, store.dir, restorePath));
+        return restorePath;
+    }
+
     private getBackupDir(): string {
         if (this.paths.isAbsolute(this.manager.config.backupPath)) {
             return this.manager.config.backupPath;
@@ -62,6 +107,12 @@ export class Backups extends IService {
                     file,
                     mtime: stats.mtime.getTime(),
                 });
+            } else if (file.startsWith('mpmissions_') && file.endsWith('.json')) {
+                // deduplicated backup manifest
+                foundBackups.push({
+                    file: file.slice(0, -'.json'.length),
+                    mtime: stats.mtime.getTime(),
+                });
             }
         }
         return foundBackups;
@@ -70,11 +121,28 @@ export class Backups extends IService {
     public async cleanup(): Promise<void> {
         const now = new Date().valueOf();
         const backups = await this.getBackups();
+        const removed: string[] = [];
+        let removedManifests = false;
         for (const backup of backups) {
             if ((now - backup.mtime) > (this.manager.config.backupMaxAge * 24 * 60 * 60 * 1000)) {
-                await this.paths.removeLink(backup.file);
+                const fullPath = path.join(this.getBackupDir(), backup.file);
+                if (this.fs.existsSync(`${fullPath}.json`)) {
+                    await this.withStore((store) => store.remove(backup.file));
+                    removedManifests = true;
+                } else {
+                    await this.paths.removeLink(fullPath);
+                }
+                removed.push(backup.file);
             }
         }
+        if (removed.length) {
+            this.eventBus.emit(InternalEventTypes.BACKUP_REMOVED, removed);
+        }
+
+        if (removedManifests) {
+            const removedChunks = await this.withStore((store) => this.workerPool.run('collectBackupChunks', store.dir));
+            this.log.log(LogLevel.INFO, `Removed ${removedChunks} unreferenced backup chunks`);
+        }
     }
 
 }
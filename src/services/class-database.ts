@@ -0,0 +1,560 @@
+import { inject, injectable, singleton } from 'tsyringe';
+import * as path from 'path';
+import * as crypto from 'crypto';
+import { Manager } from '../control/manager';
+import { IStatefulService } from '../types/service';
+import { LoggerFactory } from './loggerfactory';
+import { Paths } from './paths';
+import { SteamCMD, SteamMetaData } from './steamcmd';
+import { EventBus } from '../control/event-bus';
+import { FSAPI, InjectionTokens } from '../util/apis';
+import { LogLevel } from '../util/logger';
+import { InternalEventTypes } from '../types/events';
+import { WorkerPool } from './worker-pool';
+import { TaskTracker } from './task-tracker';
+import { PboReader } from '../util/pbo-reader';
+import { ConfigParser } from '../util/config-parser';
+import { isConfigBin, parseConfigBin } from '../util/config-bin-parser';
+import {
+    ClassDatabaseIndex,
+    ClassDatabasePbo,
+    ClassDatabaseStatus,
+    ClassDatabaseUpdateResult,
+    ClassQuery,
+    ClassQueryResult,
+    ResolvedClass,
+} from '../types/class-database';
+
+interface PboSource {
+    file: string;
+    source: string;
+}
+
+const MAX_INHERITANCE_DEPTH = 64;
+
+const isClass = (value: any): boolean => !!value && typeof value === 'object' && !Array.isArray(value);
+
+/**
+ * Class hierarchy database built from the configs in the server and mod pbos.
+ *
+ * The config of each pbo is parsed once and stored in the database dir,
+ * so updates only parse the pbos which changed since the last update.
+ * The configs are merged in the order of their CfgPatches requiredAddons (load order otherwise),
+ * like the game does, and classes are resolved with their inherited properties on request.
+ */
+@singleton()
+@injectable()
+export class ClassDatabase extends IStatefulService {
+
+    public readonly DB_DIR = 'classdb';
+    public readonly INDEX_FILE = 'index.json';
+    public readonly VERSION = 1;
+
+    private index?: ClassDatabaseIndex;
+    private merged?: Record<string, any>;
+    // "root/class" (lower case) -> source of the last definition
+    private classSources = new Map<string, string>();
+    // root (lower case) -> class (lower case) -> class
+    private lookups = new Map<string, Map<string, string>>();
+    private resolved = new Map<string, ResolvedClass>();
+
+    private updateChain: Promise<any> = Promise.resolve();
+    private queuedUpdate?: Promise<ClassDatabaseUpdateResult>;
+    private status: ClassDatabaseStatus = { pbos: 0, classes: 0, updating: false };
+
+    public constructor(
+        loggerFactory: LoggerFactory,
+        private manager: Manager,
+        private paths: Paths,
+        private steamCmd: SteamCMD,
+        private steamMetaData: SteamMetaData,
+        private eventBus: EventBus,
+        private workerPool: WorkerPool,
+        private taskTracker: TaskTracker,
+        @inject(InjectionTokens.fs) private fs: FSAPI,
+    ) {
+        super(loggerFactory.createLogger('ClassDatabase'));
+
+        this.eventBus.on(
+            InternalEventTypes.MOD_UPDATED,
+            /* istanbul ignore next */ async (status) => {
+                if (status?.success) this.scheduleUpdate();
+            },
+        );
+        this.eventBus.on(
+            InternalEventTypes.GAME_UPDATED,
+            /* istanbul ignore next */ async (status) => {
+                if (status?.success) this.scheduleUpdate();
+            },
+        );
+    }
+
+    public async start(): Promise<void> {
+        this.scheduleUpdate();
+    }
+
+    public async stop(): Promise<void> {
+        await this.updateChain;
+    }
+
+    private scheduleUpdate(): void {
+        if (!this.manager.config?.classDatabase) {
+            return;
+        }
+        this.update().catch(/* istanbul ignore next */ (e) => {
+            this.log.log(LogLevel.ERROR, 'Failed to update the class database', e);
+        });
+    }
+
+    public getDatabasePath(): string {
+        return path.join(this.steamMetaData.getMetaDataPath(), this.DB_DIR);
+    }
+
+    public getStatus(): ClassDatabaseStatus {
+        return { ...this.status };
+    }
+
+    private getIndex(): ClassDatabaseIndex {
+        if (!this.index) {
+            try {
+                const index: ClassDatabaseIndex = JSON.parse(
+                    this.fs.readFileSync(path.join(this.getDatabasePath(), this.INDEX_FILE), { encoding: 'utf-8' }),
+                );
+                if (index?.version === this.VERSION) {
+                    this.index = index;
+                }
+            } catch {
+                // nothing indexed yet
+            }
+            this.index = this.index ?? { version: this.VERSION, pbos: {} };
+        }
+        return this.index;
+    }
+
+    private async findDir(parent: string, name: string): Promise<string | undefined> {
+        try {
+            const found = (await this.fs.promises.readdir(parent))
+                .find((x) => x.toLowerCase() === name.toLowerCase());
+            return found ? path.join(parent, found) : undefined;
+        } catch {
+            return undefined;
+        }
+    }
+
+    private async listSourcePbos(dir: string | undefined, source: string): Promise<PboSource[]> {
+        if (!dir) {
+            return [];
+        }
+        return (await this.fs.promises.readdir(dir))
+            .filter((x) => x.toLowerCase().endsWith('.pbo'))
+            .sort()
+            .map((x) => ({ file: path.join(dir, x), source }));
+    }
+
+    /**
+     * @returns the pbos of the server, the workshop mods and the local mods in load order
+     */
+    public async listPbos(): Promise<PboSource[]> {
+        const serverPath = this.manager.getServerPath();
+        const pbos: PboSource[] = [
+            ...await this.listSourcePbos(await this.findDir(serverPath, 'dta'), 'vanilla'),
+            ...await this.listSourcePbos(await this.findDir(serverPath, 'addons'), 'vanilla'),
+        ];
+        for (const modId of this.manager.getCombinedModIdList()) {
+            const modDir = this.steamCmd.getWsModDir(modId);
+            pbos.push(...await this.listSourcePbos(
+                await this.findDir(modDir, 'addons'),
+                this.steamCmd.getWsModName(modId) || modId,
+            ));
+        }
+        for (const localMod of this.manager.config.localMods ?? []) {
+            pbos.push(...await this.listSourcePbos(
+                await this.findDir(this.paths.resolve(serverPath, localMod), 'addons'),
+                localMod,
+            ));
+        }
+        return pbos;
+    }
+
+    /**
+     * Reads all configs (config.bin or config.cpp) in the pbo, merged in the order of the entries
+     */
+    public async readPboConfig(file: string): Promise<Record<string, any> | undefined> {
+        const pbo = await PboReader.open(this.fs, file);
+        try {
+            const configs = pbo.entries.filter((x) => /(^|\\)config\.(bin|cpp)$/i.test(PboReader.normalizeName(x.name)));
+            if (!configs.length) {
+                return undefined;
+            }
+
+            const result: Record<string, any> = {};
+            let includes: Map<string, string> | undefined;
+            for (const entry of configs) {
+                const name = PboReader.normalizeName(entry.name);
+                // prefer the binarized config if both exist
+                if (name.endsWith('.cpp') && pbo.getEntry(name.replace(/cpp$/, 'bin'))) {
+                    continue;
+                }
+                const data = await pbo.readEntry(entry);
+                // parsing blocks the event loop, so the monitor can attribute lag to the pbo
+                if (isConfigBin(data)) {
+                    this.mergeConfig(result, this.taskTracker.trackSync(`parseConfigBin ${file}`, () => parseConfigBin(data)));
+                    continue;
+                }
+                // includes are resolved synchronously, so the includable files are read beforehand
+                if (!includes) {
+                    includes = new Map();
+                    for (const include of pbo.entries.filter((x) => /\.(hpp|h|inc)$/i.test(x.name))) {
+                        includes.set(PboReader.normalizeName(include.name), (await pbo.readEntry(include)).toString('utf-8'));
+                    }
+                }
+                const config = this.taskTracker.trackSync(
+                    `parseConfigCpp ${file}`,
+                    () => this.parseConfigCpp(pbo.prefix, includes, name, data.toString('utf-8')),
+                );
+                this.mergeConfig(result, config);
+            }
+            return result;
+        } finally {
+            await pbo.close();
+        }
+    }
+
+    private parseConfigCpp(pboPrefix: string, includes: Map<string, string>, name: string, content: string): any {
+        const prefix = PboReader.normalizeName(pboPrefix);
+
+        return new ConfigParser().cfg2json(content, {
+            file: name,
+            include: (include, from) => {
+                let target = PboReader.normalizeName(include);
+                if (include.startsWith('\\') || include.startsWith('/')) {
+                    // absolute includes are only resolved within this pbo
+                    if (!prefix || !target.startsWith(`${prefix}\\`)) {
+                        return undefined;
+                    }
+                    target = target.slice(prefix.length + 1);
+                } else {
+                    const fromDir = (from ?? '').split('\\').slice(0, -1);
+                    target = path.win32.normalize([...fromDir, target].join('\\')).toLowerCase();
+                }
+                const found = includes.get(target);
+                return found === undefined ? undefined : { file: target, content: found };
+            },
+        });
+    }
+
+    /**
+     * @param sourceName tracks the source of the top level config classes' classes
+     * @param root used internally while merging a top level config class
+     */
+    private mergeConfig(target: Record<string, any>, source: Record<string, any>, sourceName?: string, root?: string): void {
+        for (const key of Object.keys(source)) {
+            const value = source[key];
+            if (isClass(value) && isClass(target[key])) {
+                // only the top level is passed on, deeper classes are not tracked
+                this.mergeConfig(target[key], value, root === undefined ? sourceName : undefined, key);
+            } else {
+                target[key] = value;
+                if (sourceName && root === undefined && isClass(value)) {
+                    // new top level class, all of its classes are from this source
+                    for (const name of Object.keys(value).filter((x) => isClass(value[x]))) {
+                        this.classSources.set(`${key}/${name}`.toLowerCase(), sourceName);
+                    }
+                }
+            }
+            if (sourceName && root !== undefined && isClass(value)) {
+                this.classSources.set(`${root}/${key}`.toLowerCase(), sourceName);
+            }
+        }
+    }
+
+    /**
+     * Updates the configs of the changed pbos and rebuilds the class hierarchy.
+     * Only one update runs at a time, calls during an update are combined into one following update.
+     */
+    public update(): Promise<ClassDatabaseUpdateResult> {
+        if (!this.queuedUpdate) {
+            this.queuedUpdate = this.updateChain.then(() => {
+                this.queuedUpdate = undefined;
+                return this.runUpdate();
+            });
+            this.updateChain = this.queuedUpdate.catch(/* istanbul ignore next */ () => undefined);
+        }
+        return this.queuedUpdate;
+    }
+
+    private async runUpdate(): Promise<ClassDatabaseUpdateResult> {
+        const start = new Date().valueOf();
+        this.status.updating = true;
+        try {
+            const index = this.getIndex();
+            const dbPath = this.getDatabasePath();
+            await this.fs.promises.mkdir(dbPath, { recursive: true });
+
+            const pbos = await this.listPbos();
+            const result: ClassDatabaseUpdateResult = {
+                pbos: pbos.length,
+                parsed: 0,
+                removed: 0,
+                failed: 0,
+                classes: 0,
+                duration: 0,
+            };
+
+            const current = new Set<string>();
+            for (const { file, source } of pbos) {
+                current.add(file);
+                const stat = await this.fs.promises.stat(file);
+                const known = index.pbos[file];
+                if (known && known.mtime === stat.mtime.getTime() && known.size === stat.size && known.source === source) {
+                    continue;
+                }
+
+                result.parsed++;
+                const entry: ClassDatabasePbo = {
+                    file,
+                    source,
+                    mtime: stat.mtime.getTime(),
+                    size: stat.size,
+                    patches: [],
+                    requiredAddons: [],
+                };
+                try {
+                    const config = await this.readPboConfig(file);
+                    if (config) {
+                        entry.configFile = `${crypto.createHash('sha1').update(file).digest('hex')}.json`;
+                        const patches = isClass(config.CfgPatches) ? config.CfgPatches : {};
+                        for (const patch of Object.keys(patches).filter((x) => isClass(patches[x]))) {
+                            entry.patches.push(patch);
+                            entry.requiredAddons.push(...(patches[patch].requiredAddons ?? []).filter((x: any) => typeof x === 'string'));
+                        }
+                        await this.fs.promises.writeFile(path.join(dbPath, entry.configFile), JSON.stringify(config));
+                    }
+                } catch (e) {
+                    result.failed++;
+                    entry.error = e?.message ?? String(e);
+                    this.log.log(LogLevel.WARN, `Failed to read the config of ${file}`, e);
+                }
+                if (known?.configFile && !entry.configFile) {
+                    await this.removeConfigFile(known.configFile);
+                }
+                index.pbos[file] = entry;
+            }
+
+            for (const file of Object.keys(index.pbos).filter((x) => !current.has(x))) {
+                if (index.pbos[file].configFile) {
+                    await this.removeConfigFile(index.pbos[file].configFile);
+                }
+                delete index.pbos[file];
+                result.removed++;
+            }
+
+            if (result.parsed || result.removed || !this.merged) {
+                await this.fs.promises.writeFile(path.join(dbPath, this.INDEX_FILE), JSON.stringify(index));
+                await this.rebuild(pbos.map((x) => index.pbos[x.file]));
+            }
+
+            result.classes = this.status.classes;
+            result.duration = new Date().valueOf() - start;
+            this.status.pbos = pbos.length;
+            this.status.lastUpdate = new Date().valueOf();
+            this.status.lastResult = result;
+            this.log.log(
+                LogLevel.INFO,
+                `Class database updated: ${result.parsed} of ${result.pbos} pbos parsed, ${result.removed} removed, ${result.classes} classes (${result.duration}ms)`,
+            );
+            return result;
+        } finally {
+            this.status.updating = false;
+        }
+    }
+
+    private async removeConfigFile(configFile: string): Promise<void> {
+        try {
+            await this.fs.promises.unlink(path.join(this.getDatabasePath(), configFile));
+        } catch {
+            // already gone
+        }
+    }
+
+    /**
+     * @returns the pbos sorted, so required addons are merged before the pbos requiring them
+     */
+    private sortPbos(pbos: ClassDatabasePbo[]): ClassDatabasePbo[] {
+        const byPatch = new Map<string, ClassDatabasePbo>();
+        for (const pbo of pbos) {
+            for (const patch of pbo.patches) {
+                byPatch.set(patch.toLowerCase(), pbo);
+            }
+        }
+
+        const sorted: ClassDatabasePbo[] = [];
+        const visited = new Set<ClassDatabasePbo>();
+        const visit = (pbo: ClassDatabasePbo): void => {
+            // cyclic requirements keep the load order
+            if (visited.has(pbo)) return;
+            visited.add(pbo);
+            for (const required of pbo.requiredAddons) {
+                const dependency = byPatch.get(required.toLowerCase());
+                if (dependency) {
+                    visit(dependency);
+                }
+            }
+            sorted.push(pbo);
+        };
+        pbos.forEach(visit);
+        return sorted;
+    }
+
+    private async rebuild(pbos: ClassDatabasePbo[]): Promise<void> {
+        const merged: Record<string, any> = {};
+        this.classSources.clear();
+        this.lookups.clear();
+        this.resolved.clear();
+
+        for (const pbo of this.sortPbos(pbos.filter((x) => !!x?.configFile))) {
+            try {
+                const config = await this.workerPool.run('readJson', path.join(this.getDatabasePath(), pbo.configFile));
+                this.taskTracker.trackSync(`mergeConfig ${pbo.file}`, () => this.mergeConfig(merged, config, pbo.source));
+            } catch (e) {
+                this.log.log(LogLevel.WARN, `Failed to load the config of ${pbo.file}`, e);
+            }
+        }
+
+        let classes = 0;
+        for (const root of Object.keys(merged).filter((x) => isClass(merged[x]))) {
+            classes += Object.keys(merged[root]).filter((x) => isClass(merged[root][x])).length;
+        }
+        this.merged = merged;
+        this.status.classes = classes;
+    }
+
+    private findRoot(root: string): string | undefined {
+        if (!this.merged) {
+            return undefined;
+        }
+        const lowerRoot = root.toLowerCase();
+        return Object.keys(this.merged).find((x) => x.toLowerCase() === lowerRoot && isClass(this.merged[x]));
+    }
+
+    private getLookup(root: string): Map<string, string> {
+        const lowerRoot = root.toLowerCase();
+        let lookup = this.lookups.get(lowerRoot);
+        if (!lookup) {
+            lookup = new Map();
+            const rootClass = this.merged[root];
+            for (const name of Object.keys(rootClass)) {
+                if (isClass(rootClass[name])) {
+                    lookup.set(name.toLowerCase(), name);
+                }
+            }
+            this.lookups.set(lowerRoot, lookup);
+        }
+        return lookup;
+    }
+
+    private getParentNames(root: string, classname: string): string[] {
+        const lookup = this.getLookup(root);
+        const parents: string[] = [];
+        let current = this.merged[root][classname];
+        while (current?.__inherited && parents.length < MAX_INHERITANCE_DEPTH) {
+            const parent = lookup.get(String(current.__inherited).toLowerCase());
+            if (!parent) {
+                parents.push(current.__inherited);
+                break;
+            }
+            parents.push(parent);
+            current = this.merged[root][parent];
+        }
+        return parents;
+    }
+
+    private resolveProperties(base: Record<string, any>, own: Record<string, any>): Record<string, any> {
+        const result = { ...base };
+        for (const key of Object.keys(own)) {
+            if (key === '__inherited') continue;
+            // nested classes extend the nested class of the same name in the parent
+            result[key] = isClass(own[key])
+                ? this.resolveProperties(isClass(base[key]) ? base[key] : {}, own[key])
+                : own[key];
+        }
+        return result;
+    }
+
+    private resolveClass(root: string, classname: string, depth: number = 0): ResolvedClass | undefined {
+        const name = this.getLookup(root).get(classname.toLowerCase());
+        if (!name) {
+            return undefined;
+        }
+        const cacheKey = `${root}/${name}`.toLowerCase();
+        const cached = this.resolved.get(cacheKey);
+        if (cached) {
+            return cached;
+        }
+
+        const own = this.merged[root][name];
+        const parent = own.__inherited && depth < MAX_INHERITANCE_DEPTH
+            ? this.resolveClass(root, own.__inherited, depth + 1)
+            : undefined;
+        const resolved: ResolvedClass = {
+            classname: name,
+            root,
+            source: this.classSources.get(cacheKey) ?? '',
+            parents: parent ? [parent.classname, ...parent.parents] : (own.__inherited ? [own.__inherited] : []),
+            properties: this.resolveProperties(parent?.properties ?? {}, own),
+        };
+        this.resolved.set(cacheKey, resolved);
+        return resolved;
+    }
+
+    /**
+     * @param classname the class (case insensitive)
+     * @param root the top level config class, i.e. CfgVehicles, CfgWeapons, CfgMagazines or CfgAmmo
+     * @returns the class with its inherited properties
+     */
+    public getClass(classname: string, root: string = 'CfgVehicles'): ResolvedClass | undefined {
+        const rootKey = this.findRoot(root);
+        return rootKey ? this.resolveClass(rootKey, classname) : undefined;
+    }
+
+    public isKindOf(classname: string, baseClass: string, root: string = 'CfgVehicles'): boolean {
+        const rootKey = this.findRoot(root);
+        const name = rootKey && this.getLookup(rootKey).get(classname.toLowerCase());
+        if (!name) {
+            return false;
+        }
+        const lowerBase = baseClass.toLowerCase();
+        return [name, ...this.getParentNames(rootKey, name)].some((x) => x.toLowerCase() === lowerBase);
+    }
+
+    private getInheritedValue(root: string, classname: string, property: string): any {
+        for (const name of [classname, ...this.getParentNames(root, classname)]) {
+            const value = this.merged[root][name]?.[property];
+            if (value !== undefined) {
+                return value;
+            }
+        }
+        return undefined;
+    }
+
+    public query(query: ClassQuery): ClassQueryResult {
+        const rootKey = this.findRoot(query.root || 'CfgVehicles');
+        if (!rootKey) {
+            return { total: 0, items: [] };
+        }
+
+        const lowerName = query.name?.toLowerCase();
+        const matching = [...this.getLookup(rootKey).values()]
+            .filter((x) => !lowerName || x.toLowerCase().includes(lowerName))
+            .filter((x) => !query.baseClass || this.isKindOf(x, query.baseClass, rootKey))
+            .filter((x) => query.scope === undefined || Number(this.getInheritedValue(rootKey, x, 'scope')) === query.scope);
+
+        const offset = Math.max(0, query.offset ?? 0);
+        const limit = query.limit ? Math.max(0, query.limit) : matching.length;
+        return {
+            total: matching.length,
+            items: matching.slice(offset, offset + limit).map((x) => this.resolveClass(rootKey, x)),
+        };
+    }
+
+}
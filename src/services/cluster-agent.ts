@@ -0,0 +1,265 @@
+import * as os from 'os';
+import * as ws from 'ws';
+import { injectable, singleton } from 'tsyringe';
+import { Listener } from 'eventemitter2';
+import { IStatefulService } from '../types/service';
+import { LoggerFactory } from './loggerfactory';
+import { Manager } from '../control/manager';
+import { Monitor } from './monitor';
+import { EventBus } from '../control/event-bus';
+import { Interface } from '../interface/interface';
+import { ClusterController } from './cluster-controller';
+import { InternalEventTypes } from '../types/events';
+import { LogLevel } from '../util/logger';
+import { AgentEvents, AgentHello, AgentState } from '../types/cluster';
+import { WebsocketCommand, WebsocketMessage } from '../types/websocket';
+import { Request, Response } from '../types/interface';
+import { LogEntryEvent } from '../types/log-reader';
+import { MetricEntryEvent, MetricType, MetricTypeEnum } from '../types/metrics';
+import { ServerState } from '../types/monitor';
+
+/**
+ * Connects this manager to the cluster controller.
+ *
+ * The agent keeps running the server of this host on its own and streams a compact state, the logs and some metrics
+ * to the controller over a single websocket. Requests of the controller are executed like requests of the web interface.
+ */
+@singleton()
+@injectable()
+export class ClusterAgent extends IStatefulService {
+
+    /** metrics streamed to the controller, all other metrics are only kept on the agent */
+    public static readonly STREAMED_METRICS: MetricType[] = [
+        MetricTypeEnum.SYSTEM,
+        MetricTypeEnum.PLAYERS,
+        MetricTypeEnum.RESTART_CYCLE,
+    ];
+
+    /** maximum amount of logs and metrics kept while disconnected */
+    public static readonly MAX_PENDING = 1000;
+
+    /** time (in ms) logs and metrics are collected before they are sent together */
+    public flushDelay = 1000;
+    public reconnectDelay = 10000;
+
+    private socket?: ws;
+    private running = false;
+    private listeners: Listener[] = [];
+
+    private state: AgentState = {};
+    private pending: AgentEvents = { logs: [], metrics: [] };
+
+    public constructor(
+        loggerFactory: LoggerFactory,
+        private manager: Manager,
+        private monitor: Monitor,
+        private eventBus: EventBus,
+        private eventInterface: Interface,
+    ) {
+        super(loggerFactory.createLogger('ClusterAgent'));
+    }
+
+    /* istanbul ignore next function for easier tests */
+    public createSocket(address: string, key: string): ws {
+        return new ws(address, { headers: { authorization: `Bearer ${key}` } });
+    }
+
+    public async start(): Promise<void> {
+        if (this.manager.config?.clusterMode !== 'agent') {
+            return;
+        }
+        if (!this.manager.config.clusterKey || !this.manager.config.clusterController) {
+            this.log.log(LogLevel.ERROR, 'Cluster agent needs the clusterController and the clusterKey to connect');
+            return;
+        }
+        if (!this.manager.config.clusterAllowInsecure && !this.isSecureAddress(this.manager.config.clusterController)) {
+            this.log.log(
+                LogLevel.ERROR,
+                'Cluster agent does not connect to other hosts unencrypted, use a wss:// address or enable clusterAllowInsecure',
+            );
+            return;
+        }
+
+        this.running = true;
+        this.listeners.push(
+            this.eventBus.on(
+                InternalEventTypes.MONITOR_STATE_CHANGE,
+                async (state: ServerState) => this.updateState({ serverState: state }),
+            ),
+            this.eventBus.on(
+                InternalEventTypes.LOG_ENTRY,
+                async (event: LogEntryEvent) => this.queueEvent('logs', event),
+            ),
+            this.eventBus.on(
+                InternalEventTypes.METRIC_ENTRY,
+                async (event: MetricEntryEvent) => this.onMetric(event),
+            ),
+        );
+        this.connect();
+    }
+
+    public async stop(): Promise<void> {
+        this.running = false;
+        this.listeners.forEach((x) => x.off());
+        this.listeners = [];
+        this.timers.removeAllTimers();
+
+        const socket = this.socket;
+        this.socket = undefined;
+        socket?.close(1001);
+
+        this.state = {};
+        this.pending = { logs: [], metrics: [] };
+    }
+
+    public getName(): string {
+        return this.manager.config?.clusterAgentName || `${os.hostname()}-${this.manager.config?.instanceId}`;
+    }
+
+    public isConnected(): boolean {
+        return this.socket?.readyState === ws.OPEN;
+    }
+
+    /**
+     * @returns whether the address is encrypted or does not leave this host
+     */
+    private isSecureAddress(address: string): boolean {
+        try {
+            const url = new URL(address);
+            return url.protocol === 'wss:' || ['localhost', '127.0.0.1', '[::1]'].includes(url.hostname);
+        } catch {
+            return false;
+        }
+    }
+
+    private connect(): void {
+        const socket = this.createSocket(this.manager.config.clusterController, this.manager.config.clusterKey);
+        this.socket = socket;
+
+        socket.on('open', () => {
+            this.log.log(LogLevel.IMPORTANT, `Connected to the cluster controller as ${this.getName()}`);
+            this.send<AgentHello>(WebsocketCommand.AGENT_HELLO, {
+                name: this.getName(),
+                version: this.manager.APP_VERSION,
+                instanceId: this.manager.config.instanceId,
+            });
+
+            // the controller gets the full state after every (re)connect
+            Object.assign(this.state, {
+                serverState: this.monitor.serverState,
+                restartLock: this.monitor.restartLock,
+            });
+            this.send(WebsocketCommand.AGENT_STATE, this.state);
+            this.flush();
+        });
+        socket.on('message', (message) => this.handleMessage(message));
+        socket.on('error', (e) => {
+            this.log.log(LogLevel.DEBUG, `Cluster connection error: ${e?.message}`);
+        });
+        socket.on('close', (code: number) => {
+            if (this.socket !== socket) {
+                return;
+            }
+            this.socket = undefined;
+            if (code === ClusterController.CLOSE_REPLACED) {
+                // reconnecting would only replace the other agent again
+                this.log.log(LogLevel.ERROR, `Another agent connected as ${this.getName()}, set a unique clusterAgentName`);
+            } else if (this.running) {
+                this.log.log(LogLevel.WARN, `Not connected to the cluster controller, retrying in ${this.reconnectDelay / 1000}s`);
+                this.timers.addTimeout('reconnect', () => this.connect(), this.reconnectDelay);
+            }
+        });
+    }
+
+    private send<T>(cmd: WebsocketCommand, data: T): void {
+        if (this.isConnected()) {
+            this.socket!.send(JSON.stringify({ cmd, data } as WebsocketMessage<T>));
+        }
+    }
+
+    private updateState(update: AgentState): void {
+        const changed: AgentState = {};
+        for (const key of Object.keys(update)) {
+            if (update[key] !== this.state[key]) {
+                changed[key] = update[key];
+            }
+        }
+        if (!Object.keys(changed).length) {
+            return;
+        }
+        Object.assign(this.state, changed);
+        this.send(WebsocketCommand.AGENT_STATE, changed);
+    }
+
+    private onMetric(event: MetricEntryEvent): void {
+        const value = event?.entry?.value;
+        if (event?.type === MetricTypeEnum.SYSTEM && value?.system) {
+            this.updateState({
+                serverState: value.serverState,
+                cpu: value.system.cpuTotal,
+                mem: value.system.mem,
+                memTotal: value.system.memTotal,
+            });
+        } else if (event?.type === MetricTypeEnum.PLAYERS) {
+            this.updateState({ players: value?.length ?? 0 });
+        }
+
+        if (ClusterAgent.STREAMED_METRICS.indexOf(event?.type) !== -1) {
+            this.queueEvent('metrics', event);
+        }
+    }
+
+    private queueEvent<K extends keyof AgentEvents>(kind: K, event: AgentEvents[K][number]): void {
+        const queue = this.pending[kind] as AgentEvents[K][number][];
+        queue.push(event);
+        if (queue.length > ClusterAgent.MAX_PENDING) {
+            queue.shift();
+        }
+        if (!this.timers.getTimer('flush')) {
+            this.timers.addTimeout('flush', () => this.flush(), this.flushDelay);
+        }
+    }
+
+    private flush(): void {
+        this.timers.removeTimer('flush');
+        if (!this.isConnected() || (!this.pending.logs.length && !this.pending.metrics.length)) {
+            return;
+        }
+        this.send(WebsocketCommand.AGENT_EVENTS, this.pending);
+        this.pending = { logs: [], metrics: [] };
+    }
+
+    private handleMessage(message: ws.Data): void {
+        const str = typeof message === 'string' ? message : message?.toString();
+        try {
+            const data = JSON.parse(str) as WebsocketMessage<Request>;
+            if (data?.cmd === WebsocketCommand.REQUEST) {
+                void this.handleRequest(data.data);
+            } else {
+                this.log.log(LogLevel.INFO, 'Received unknown cluster cmd', data?.cmd);
+            }
+        } catch (e) {
+            this.log.log(LogLevel.ERROR, 'Failed to parse cluster message', e);
+        }
+    }
+
+    private async handleRequest(request: Request): Promise<void> {
+        const internalRequest = new Request();
+        internalRequest.accept = request?.accept ?? 'application/json';
+        internalRequest.body = request?.body;
+        internalRequest.query = request?.query;
+        internalRequest.resource = request?.resource;
+        internalRequest.user = request?.user;
+        internalRequest.userLevel = request?.userLevel;
+        internalRequest.forwarded = true;
+
+        const response = await this.eventInterface.execute(internalRequest);
+        // i.e. lockrestart has no event of its own
+        this.updateState({ restartLock: this.monitor.restartLock });
+        this.send<Response>(
+            WebsocketCommand.RESPONSE,
+            new Response(response.status, response.body, request?.uuid),
+        );
+    }
+
+}
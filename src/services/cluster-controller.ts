@@ -0,0 +1,387 @@
+import * as http from 'http';
+import * as ws from 'ws';
+import { timingSafeEqual } from 'crypto';
+import { injectable, singleton } from 'tsyringe';
+import { constants as HTTP } from 'http2';
+import { IStatefulService } from '../types/service';
+import { LoggerFactory } from './loggerfactory';
+import { Manager } from '../control/manager';
+import { LogLevel } from '../util/logger';
+import { RingBuffer } from '../util/ring-buffer';
+import { AgentEvents, AgentHello, AgentInfo, AgentState, Rollout, RolloutStep } from '../types/cluster';
+import { WebsocketCommand, WebsocketMessage } from '../types/websocket';
+import { Request, Response } from '../types/interface';
+import { LogEntryEvent, LogType } from '../types/log-reader';
+import { MetricEntryEvent, MetricType } from '../types/metrics';
+import { UserLevel } from '../config/config';
+
+interface AgentConnection {
+    socket: ws;
+    info: AgentInfo;
+    logs: RingBuffer<LogEntryEvent>;
+    metrics: RingBuffer<MetricEntryEvent>;
+}
+
+interface PendingRequest {
+    agent: string;
+    resolve: (response: Response) => void;
+}
+
+/**
+ * Accepts the connections of the cluster agents and executes commands on them.
+ *
+ * The controller is the single UI of the cluster. Updates and restarts are rolled out one agent after another,
+ * so the hosts are not all down or downloading at the same time.
+ */
+@singleton()
+@injectable()
+export class ClusterController extends IStatefulService {
+
+    /** amount of logs and metrics kept per agent */
+    public static readonly BUFFER_SIZE = 500;
+    public static readonly MAX_ROLLOUTS = 20;
+
+    /** close code for connections replaced by a newer connection of an agent with the same name */
+    public static readonly CLOSE_REPLACED = 4001;
+
+    /** time (in ms) to wait for the response of an agent */
+    public requestTimeout = 30 * 60 * 1000;
+
+    private server?: ws.Server;
+    private agents = new Map<string, AgentConnection>();
+
+    private requestIdx = 0;
+    private pendingRequests = new Map<string, PendingRequest>();
+
+    private rolloutIdx = 0;
+    private rollouts: Rollout[] = [];
+    private rolloutWaits = new Set<() => void>();
+
+    public constructor(
+        loggerFactory: LoggerFactory,
+        private manager: Manager,
+    ) {
+        super(loggerFactory.createLogger('ClusterCtrl'));
+    }
+
+    public isActive(): boolean {
+        return !!this.server;
+    }
+
+    public async start(): Promise<void> {
+        if (this.manager.config?.clusterMode !== 'controller') {
+            return;
+        }
+        if (!this.manager.config.clusterKey) {
+            this.log.log(LogLevel.ERROR, 'Cluster controller needs a clusterKey to accept agents');
+            return;
+        }
+        if (this.manager.config.publishClusterPort && !this.manager.config.clusterAllowInsecure) {
+            this.log.log(
+                LogLevel.ERROR,
+                'Cluster controller does not accept unencrypted connections from other hosts, '
+                    + 'use a reverse proxy with SSL or enable clusterAllowInsecure',
+            );
+            return;
+        }
+
+        const server = new ws.Server({
+            host: this.manager.config.publishClusterPort ? '0.0.0.0' : '127.0.0.1',
+            port: this.manager.config.clusterPort,
+            verifyClient: (info: { req: http.IncomingMessage }) => this.verifyKey(info.req?.headers?.authorization),
+        });
+        this.server = server;
+        server.on('connection', (socket: ws, req: http.IncomingMessage) => this.onConnection(socket, req));
+        server.on('error', /* istanbul ignore next */ (e) => {
+            this.log.log(LogLevel.ERROR, 'Cluster server failed', e);
+        });
+
+        await new Promise<void>((r) => server.once('listening', () => r()));
+        this.log.log(LogLevel.IMPORTANT, `Cluster controller listening on ${this.manager.config.clusterPort}`);
+    }
+
+    public async stop(): Promise<void> {
+        this.timers.removeAllTimers();
+
+        const server = this.server;
+        this.server = undefined;
+        for (const agent of [...this.agents.values()]) {
+            agent.socket.close(1001);
+        }
+        this.agents.clear();
+        this.resolvePending(() => true, HTTP.HTTP_STATUS_SERVICE_UNAVAILABLE, 'Cluster controller stopped');
+        this.rolloutWaits.forEach((x) => x());
+        this.rolloutWaits.clear();
+
+        if (server) {
+            await new Promise<void>((r) => server.close(() => r()));
+        }
+    }
+
+    private verifyKey(authorization?: string): boolean {
+        const expected = Buffer.from(`Bearer ${this.manager.config.clusterKey}`);
+        const actual = Buffer.from(authorization || '');
+        return expected.length === actual.length && timingSafeEqual(expected, actual);
+    }
+
+    private onConnection(socket: ws, req: http.IncomingMessage): void {
+        const address = req?.socket?.remoteAddress || '';
+        let agentName: string | undefined;
+
+        socket.on('message', (message: ws.Data) => {
+            let data: WebsocketMessage<any>;
+            try {
+                data = JSON.parse(typeof message === 'string' ? message : message?.toString());
+            } catch (e) {
+                this.log.log(LogLevel.ERROR, `Failed to parse message of agent ${agentName || address}`, e);
+                return;
+            }
+
+            if (!agentName) {
+                if (data?.cmd !== WebsocketCommand.AGENT_HELLO || !data.data?.name) {
+                    socket.close(1008, 'Expected hello');
+                    return;
+                }
+                agentName = this.registerAgent(socket, address, data.data);
+                return;
+            }
+
+            // a newer connection of the same agent replaced this one
+            const agent = this.agents.get(agentName);
+            if (agent?.socket !== socket) {
+                return;
+            }
+            agent.info.lastSeen = new Date().valueOf();
+            this.handleAgentMessage(agent, data);
+        });
+
+        socket.on('close', () => {
+            const agent = agentName ? this.agents.get(agentName) : undefined;
+            if (agent?.socket !== socket) {
+                return;
+            }
+            this.agents.delete(agentName);
+            this.log.log(LogLevel.WARN, `Agent ${agentName} disconnected`);
+            this.resolvePending(
+                (x) => x.agent === agentName,
+                HTTP.HTTP_STATUS_SERVICE_UNAVAILABLE,
+                `Agent ${agentName} disconnected`,
+            );
+        });
+        socket.on('error', (e) => {
+            this.log.log(LogLevel.DEBUG, `Connection error of agent ${agentName || address}: ${e?.message}`);
+        });
+    }
+
+    private registerAgent(socket: ws, address: string, hello: AgentHello): string {
+        const existing = this.agents.get(hello.name);
+        if (existing) {
+            this.log.log(LogLevel.WARN, `Agent ${hello.name} reconnected, closing the old connection`);
+            existing.socket.close(ClusterController.CLOSE_REPLACED, 'Replaced by a newer connection');
+            this.resolvePending(
+                (x) => x.agent === hello.name,
+                HTTP.HTTP_STATUS_SERVICE_UNAVAILABLE,
+                `Agent ${hello.name} reconnected`,
+            );
+        }
+
+        const now = new Date().valueOf();
+        this.agents.set(hello.name, {
+            socket,
+            info: {
+                name: hello.name,
+                version: hello.version,
+                instanceId: hello.instanceId,
+                address,
+                connectedSince: now,
+                lastSeen: now,
+                state: {},
+            },
+            logs: new RingBuffer(ClusterController.BUFFER_SIZE),
+            metrics: new RingBuffer(ClusterController.BUFFER_SIZE),
+        });
+        this.log.log(LogLevel.IMPORTANT, `Agent ${hello.name} (${hello.version}) connected from ${address}`);
+        return hello.name;
+    }
+
+    private handleAgentMessage(agent: AgentConnection, data: WebsocketMessage<any>): void {
+        switch (data?.cmd) {
+            case WebsocketCommand.AGENT_STATE: {
+                Object.assign(agent.info.state, data.data as AgentState);
+                break;
+            }
+            case WebsocketCommand.AGENT_EVENTS: {
+                const events = data.data as AgentEvents;
+                (events?.logs || []).forEach((x) => agent.logs.push(x));
+                (events?.metrics || []).forEach((x) => agent.metrics.push(x));
+                break;
+            }
+            case WebsocketCommand.RESPONSE: {
+                const response = data.data as Response;
+                const pending = this.pendingRequests.get(response?.uuid);
+                if (pending?.agent === agent.info.name) {
+                    this.finishRequest(response.uuid, new Response(response.status, response.body));
+                }
+                break;
+            }
+            default: {
+                this.log.log(LogLevel.INFO, `Received unknown cmd from agent ${agent.info.name}`, data?.cmd);
+            }
+        }
+    }
+
+    private finishRequest(uuid: string, response: Response): void {
+        const pending = this.pendingRequests.get(uuid);
+        if (pending) {
+            this.pendingRequests.delete(uuid);
+            this.timers.removeTimer(uuid);
+            pending.resolve(response);
+        }
+    }
+
+    private resolvePending(filter: (x: PendingRequest) => boolean, status: number, msg: string): void {
+        for (const [uuid, pending] of [...this.pendingRequests.entries()]) {
+            if (filter(pending)) {
+                this.finishRequest(uuid, new Response(status, msg));
+            }
+        }
+    }
+
+    public getAgents(): AgentInfo[] {
+        return [...this.agents.values()]
+            .map((x) => x.info)
+            .sort((a, b) => a.name.localeCompare(b.name));
+    }
+
+    public getAgentLogs(name: string, type?: LogType, since?: number): LogEntryEvent[] | undefined {
+        return this.agents.get(name)?.logs.toArray(
+            (x) => (!type || x.type === type) && (!since || x.entry?.timestamp > since),
+        );
+    }
+
+    public getAgentMetrics(name: string, type: MetricType, since?: number): MetricEntryEvent[] | undefined {
+        return this.agents.get(name)?.metrics.toArray(
+            (x) => x.type === type && (!since || x.entry?.timestamp > since),
+        );
+    }
+
+    /**
+     * Executes a request on an agent
+     * @param agent name of the agent
+     * @param request the request, the user must already be authorized.
+     * The agents check the userLevel of the request, which defaults to the level of the user
+     */
+    public request(agent: string, request: Request): Promise<Response> {
+        const connection = this.agents.get(agent);
+        if (!connection) {
+            return Promise.resolve(new Response(HTTP.HTTP_STATUS_NOT_FOUND, `Agent ${agent} is not connected`));
+        }
+
+        const uuid = `cluster-${++this.requestIdx}`;
+        return new Promise<Response>((resolve) => {
+            this.pendingRequests.set(uuid, { agent, resolve });
+            this.timers.addTimeout(
+                uuid,
+                () => this.finishRequest(
+                    uuid,
+                    new Response(HTTP.HTTP_STATUS_GATEWAY_TIMEOUT, `Agent ${agent} did not respond`),
+                ),
+                this.requestTimeout,
+            );
+
+            const forwarded: Request = {
+                resource: request.resource,
+                accept: request.accept,
+                body: request.body,
+                query: request.query,
+                user: request.user,
+                userLevel: request.userLevel ?? this.manager.getUserLevel(request.user),
+                uuid,
+            };
+            connection.socket.send(JSON.stringify({
+                cmd: WebsocketCommand.REQUEST,
+                data: forwarded,
+            } as WebsocketMessage<Request>));
+        });
+    }
+
+    public getRollouts(): Rollout[] {
+        return [...this.rollouts];
+    }
+
+    /**
+     * Executes a command on all connected agents, one after another
+     * @param command the interface command
+     * @param user the user starting the rollout
+     * @param body the body of the command
+     * @param stagger time (in ms) between two agents, defaults to the configured clusterStagger
+     * @param userLevel level of the user on the agents, for users which are not admins (i.e. scheduled events)
+     * @returns the started rollout, which is updated while it is running
+     */
+    public rollout(command: string, user: string, body?: any, stagger?: number, userLevel?: UserLevel): Rollout {
+        const rollout: Rollout = {
+            id: ++this.rolloutIdx,
+            command,
+            stagger: stagger ?? (this.manager.config.clusterStagger ?? 300) * 1000,
+            created: new Date().valueOf(),
+            steps: this.getAgents().map((x) => ({ agent: x.name, status: 'pending' } as RolloutStep)),
+        };
+        this.rollouts.push(rollout);
+        if (this.rollouts.length > ClusterController.MAX_ROLLOUTS) {
+            this.rollouts.shift();
+        }
+
+        this.log.log(LogLevel.IMPORTANT, `Rolling out '${command}' to ${rollout.steps.length} agent(s)`);
+        void this.runRollout(rollout, user, body, userLevel);
+        return rollout;
+    }
+
+    private async runRollout(rollout: Rollout, user: string, body?: any, userLevel?: UserLevel): Promise<void> {
+        for (let i = 0; i < rollout.steps.length; i++) {
+            const step = rollout.steps[i];
+            if (!this.agents.has(step.agent)) {
+                step.status = 'skipped';
+                continue;
+            }
+
+            step.status = 'running';
+            step.start = new Date().valueOf();
+            const request = new Request();
+            request.resource = rollout.command;
+            request.body = body;
+            request.user = user;
+            request.userLevel = userLevel;
+            const response = await this.request(step.agent, request);
+            step.end = new Date().valueOf();
+            step.responseStatus = response.status;
+            step.status = response.status >= 200 && response.status < 300 ? 'done' : 'failed';
+            this.log.log(
+                step.status === 'done' ? LogLevel.INFO : LogLevel.WARN,
+                `Rollout ${rollout.id}: '${rollout.command}' on ${step.agent} ${step.status} (${response.status})`,
+            );
+
+            const remaining = rollout.steps.slice(i + 1).some((x) => this.agents.has(x.agent));
+            if (remaining && rollout.stagger > 0 && this.server) {
+                await new Promise<void>((r) => {
+                    const wakeup = (): void => {
+                        this.rolloutWaits.delete(wakeup);
+                        this.timers.removeTimer(`rollout-${rollout.id}`);
+                        r();
+                    };
+                    this.rolloutWaits.add(wakeup);
+                    this.timers.addTimeout(`rollout-${rollout.id}`, wakeup, rollout.stagger);
+                });
+            }
+            if (!this.server) {
+                break;
+            }
+        }
+        rollout.steps
+            .filter((x) => x.status === 'pending')
+            .forEach((x) => {
+                x.status = 'skipped';
+            });
+        rollout.done = new Date().valueOf();
+    }
+
+}
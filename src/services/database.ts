@@ -1,9 +1,12 @@
 import * as sqlite3 from 'better-sqlite3';
+import * as path from 'path';
 import { Manager } from '../control/manager';
 import { IStatefulService } from '../types/service';
 import { LogLevel } from '../util/logger';
 import { injectable, singleton } from 'tsyringe';
 import { LoggerFactory } from './loggerfactory';
+import { Paths } from './paths';
+import { TaskTracker } from './task-tracker';
 
 /* istanbul ignore next */
 export class Sqlite3Wrapper {
@@ -16,9 +19,21 @@ export class Sqlite3Wrapper {
     }
 
     private db: sqlite3.Database;
+    private name: string;
 
-    public constructor(file: string, opts?: sqlite3.Options) {
+    /**
+     * @param taskTracker tracks the queries, which block the event loop until they are done
+     */
+    public constructor(file: string, opts?: sqlite3.Options, private taskTracker?: TaskTracker) {
         this.db = Sqlite3Wrapper.createDb(file, opts);
+        this.name = path.basename(file);
+    }
+
+    private track<T>(sql: string, query: () => T): T {
+        if (!this.taskTracker) {
+            return query();
+        }
+        return this.taskTracker.trackSync(`sqlite ${this.name} ${String(sql).trim().split(/\s+/).slice(0, 3).join(' ')}`, query);
     }
 
     /**
@@ -27,8 +42,7 @@ export class Sqlite3Wrapper {
      * @param params the params
      */
     public run(sql: string, ...params: any[]): sqlite3.RunResult {
-        const stmt = this.db.prepare(sql);
-        return stmt.run(params);
+        return this.track(sql, () => this.db.prepare(sql).run(params));
     }
 
     /**
@@ -37,8 +51,7 @@ export class Sqlite3Wrapper {
      * @param params the params
      */
     public first(sql: string, ...params: any[]): any {
-        const stmt = this.db.prepare(sql);
-        return stmt.get(params);
+        return this.track(sql, () => this.db.prepare(sql).get(params));
     }
 
     /**
@@ -47,8 +60,7 @@ export class Sqlite3Wrapper {
      * @param params the params
      */
     public all(sql: string, ...params: any[]): any[] {
-        const stmt = this.db.prepare(sql);
-        return stmt.all(params);
+        return this.track(sql, () => this.db.prepare(sql).all(params));
     }
 
     /**
@@ -57,8 +69,7 @@ export class Sqlite3Wrapper {
      * @param params the params
      */
     public allRaw(sql: string, ...params: any[]): any[] {
-        const stmt = this.db.prepare(sql);
-        return stmt.raw().all(params);
+        return this.track(sql, () => this.db.prepare(sql).raw().all(params));
     }
 
     /**
@@ -67,7 +78,7 @@ export class Sqlite3Wrapper {
      * @param params the params
      */
     public transaction(fn: (db: sqlite3.Database) => any): any[] {
-        return this.db.transaction(fn)(this.db);
+        return this.track('transaction', () => this.db.transaction(fn)(this.db));
     }
 
     public close(): void {
@@ -106,6 +117,8 @@ export class Database extends IStatefulService {
     public constructor(
         loggerFactory: LoggerFactory,
         public manager: Manager,
+        private paths: Paths,
+        private taskTracker: TaskTracker,
     ) {
         super(loggerFactory.createLogger('Database'));
         this.log.log(LogLevel.INFO, `Database Setup: node ${process.versions.node} : v${process.versions.modules}-${process.platform}-${process.arch}`);
@@ -138,8 +151,10 @@ export class Database extends IStatefulService {
             this.databases.set(
                 type,
                 new Sqlite3Wrapper(
-                    dbConfig.file,
+                    // each instance keeps its own databases
+                    path.join(this.paths.cwd(), dbConfig.file),
                     dbConfig.opts,
+                    this.taskTracker,
                 ),
             );
         }
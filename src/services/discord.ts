@@ -13,6 +13,7 @@ import { LoggerFactory } from './loggerfactory';
 import { EventBus } from '../control/event-bus';
 import { InternalEventTypes } from '../types/events';
 import { DiscordMessage, isDiscordChannelType } from '../types/discord';
+import { DiscordChannelQueue, DiscordQueueOptions, DiscordQueueStats } from '../util/discord-queue';
 
 @singleton()
 @injectable()
@@ -21,8 +22,15 @@ export class DiscordBot extends IStatefulService {
     public client: Client | undefined;
     private ready = false;
 
+    /** discord allows 5 messages per 5 seconds per channel */
+    public static readonly RATE_LIMIT = 5;
+    public static readonly RATE_LIMIT_WINDOW = 5000;
+
     private msgQueue: DiscordMessage[] = [];
 
+    // outbound queues by channel id
+    private channelQueues = new Map<string, DiscordChannelQueue>();
+
     public debug: boolean = false;
 
     public constructor(
@@ -117,6 +125,15 @@ export class DiscordBot extends IStatefulService {
 
     public async stop(): Promise<void> {
         this.ready = false;
+        const queues = [...this.channelQueues.values()];
+        this.channelQueues.clear();
+        for (const queue of queues) {
+            try {
+                await queue.drain();
+            } finally {
+                queue.dispose();
+            }
+        }
         if (this.client) {
             await this.client.destroy();
             this.client = undefined;
@@ -146,20 +163,63 @@ export class DiscordBot extends IStatefulService {
                 ).join(', '),
             );
         }
-        for (const x of matching) {
-            try {
-                if (message.message) {
-                    await (x as TextChannel).send(message.message);
-                }
-                if (message.embeds?.length) {
-                    for (const embed of message.embeds) {
-                        await (x as TextChannel).send({ embeds: [embed] });
-                    }
-                }
-            } catch (e) {
-                this.log.log(LogLevel.ERROR, `Error relaying message to channel: ${x.name}`, e);
-            }
+        const lowPriority = message.lowPriority ?? message.type === 'rcon';
+        await Promise.all(matching.map(
+            (x) => this.getChannelQueue(x as TextChannel).push(message.message, message.embeds, lowPriority),
+        ));
+    }
+
+    private getChannelQueue(channel: TextChannel): DiscordChannelQueue {
+        let queue = this.channelQueues.get(channel.id ?? channel.name);
+        if (!queue) {
+            queue = new DiscordChannelQueue(
+                (payload) => channel.send(payload),
+                () => this.getQueueOptions(),
+                /* istanbul ignore next */ (e) => this.log.log(LogLevel.ERROR, `Error relaying message to channel: ${channel.name}`, e),
+            );
+            this.channelQueues.set(channel.id ?? channel.name, queue);
+        }
+        return queue;
+    }
+
+    private getQueueOptions(): DiscordQueueOptions {
+        return {
+            coalesceWindow: this.manager.config.discordMessageCoalescing ?? 1000,
+            maxQueueSize: this.manager.config.discordMaxQueuedMessages || 100,
+            rateLimit: DiscordBot.RATE_LIMIT,
+            rateLimitWindow: DiscordBot.RATE_LIMIT_WINDOW,
+        };
+    }
+
+    /**
+     * @returns the combined stats of all channel queues or undefined if the bot is not running
+     */
+    public getQueueStats(): DiscordQueueStats | undefined {
+        if (!this.client) {
+            return undefined;
+        }
+        const total: DiscordQueueStats = {
+            depth: this.msgQueue.length,
+            sent: 0,
+            requests: 0,
+            dropped: 0,
+            failed: 0,
+            avgLatency: 0,
+            maxLatency: 0,
+        };
+        let latencySum = 0;
+        for (const queue of this.channelQueues.values()) {
+            const stats = queue.getStats();
+            total.depth += stats.depth;
+            total.sent += stats.sent;
+            total.requests += stats.requests;
+            total.dropped += stats.dropped;
+            total.failed += stats.failed;
+            total.maxLatency = Math.max(total.maxLatency, stats.maxLatency);
+            latencySum += stats.avgLatency * stats.sent;
         }
+        total.avgLatency = total.sent ? Math.round(latencySum / total.sent) : 0;
+        return total;
     }
 
 }
@@ -0,0 +1,117 @@
+import { injectable, singleton } from 'tsyringe';
+import { IntervalHistogram, monitorEventLoopDelay } from 'perf_hooks';
+import { IStatefulService } from '../types/service';
+import { LoggerFactory } from './loggerfactory';
+import { Manager } from '../control/manager';
+import { Prometheus } from './prometheus';
+import { TaskTracker, TrackedTask } from './task-tracker';
+import { LogLevel } from '../util/logger';
+import { RingBuffer } from '../util/ring-buffer';
+
+export interface LagSpike {
+    timestamp: number;
+    /** time in ms the event loop was blocked */
+    lag: number;
+    tasks: TrackedTask[];
+}
+
+/**
+ * Measures how long the event loop of the manager is blocked
+ * and logs the tasks which were running when it was blocked for too long.
+ *
+ * The delay distribution since the previous scrape is exposed as dzsm_event_loop_lag_seconds.
+ */
+@singleton()
+@injectable()
+export class EventLoopMonitor extends IStatefulService {
+
+    /** interval (in ms) of the lag measurement */
+    public static readonly INTERVAL = 100;
+    public static readonly SPIKES_KEPT = 20;
+
+    /** resolution of the event loop delay sampling in ms */
+    public static readonly RESOLUTION = 20;
+
+    /** the event loop is shared by all instances, so only one monitor checks it for spikes */
+    private static spikeMonitor?: EventLoopMonitor;
+
+    private lastTick = 0;
+    private spikes = new RingBuffer<LagSpike>(EventLoopMonitor.SPIKES_KEPT);
+    private delay?: IntervalHistogram;
+
+    public constructor(
+        loggerFactory: LoggerFactory,
+        private manager: Manager,
+        private prometheus: Prometheus,
+        private taskTracker: TaskTracker,
+    ) {
+        super(loggerFactory.createLogger('EventLoop'));
+        this.prometheus.registry.addCollector(() => this.collect());
+    }
+
+    public async start(): Promise<void> {
+        if (!EventLoopMonitor.spikeMonitor) {
+            EventLoopMonitor.spikeMonitor = this;
+        }
+        if (EventLoopMonitor.spikeMonitor === this) {
+            this.lastTick = this.taskTracker.now();
+            this.timers.addInterval('lag', () => this.tick(), EventLoopMonitor.INTERVAL);
+        }
+        this.delay?.disable();
+        this.delay = monitorEventLoopDelay({ resolution: EventLoopMonitor.RESOLUTION });
+        this.delay.enable();
+    }
+
+    public async stop(): Promise<void> {
+        this.timers.removeAllTimers();
+        if (EventLoopMonitor.spikeMonitor === this) {
+            EventLoopMonitor.spikeMonitor = undefined;
+        }
+        this.delay?.disable();
+        this.delay = undefined;
+        this.prometheus.eventLoopLag.reset();
+    }
+
+    public getSpikes(): LagSpike[] {
+        return this.spikes.toArray();
+    }
+
+    private collect(): void {
+        const delay = this.delay;
+        // max stays 0 until the first sample
+        if (!(delay?.max > 0)) {
+            return;
+        }
+        // the delay includes the sampling resolution
+        const toSeconds = (nanos: number): number => Math.max(0, nanos / 1e6 - EventLoopMonitor.RESOLUTION) / 1000;
+        const gauge = this.prometheus.eventLoopLag;
+        gauge.set(toSeconds(delay.mean), { stat: 'mean' });
+        gauge.set(toSeconds(delay.percentile(50)), { stat: 'p50' });
+        gauge.set(toSeconds(delay.percentile(99)), { stat: 'p99' });
+        gauge.set(toSeconds(delay.max), { stat: 'max' });
+        // values cover the time since the last scrape
+        delay.reset();
+    }
+
+    private tick(): void {
+        const now = this.taskTracker.now();
+        const lag = Math.max(0, now - this.lastTick - EventLoopMonitor.INTERVAL);
+        this.lastTick = now;
+
+        const threshold = this.manager.config?.eventLoopLagWarning ?? 500;
+        if (!threshold || lag < threshold) {
+            return;
+        }
+
+        const tasks = this.taskTracker.getTasksBetween(now - lag, now);
+        this.spikes.push({ timestamp: now, lag, tasks });
+        const taskList = tasks
+            .map((x) => `${x.name}${x.worker ? ' (worker)' : ''} ${(x.end ?? now) - x.start}ms`)
+            .join(', ');
+        this.log.log(
+            LogLevel.WARN,
+            `Event loop was blocked for ${lag}ms, running tasks: ${taskList || 'unknown (not tracked)'}`,
+        );
+    }
+
+}
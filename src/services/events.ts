@@ -11,6 +11,7 @@ import { Monitor } from './monitor';
 import { Backups } from './backups';
 import { EventBus } from '../control/event-bus';
 import { InternalEventTypes } from '../types/events';
+import { ClusterController } from './cluster-controller';
 
 @singleton()
 @injectable()
@@ -27,6 +28,7 @@ export class Events extends IStatefulService {
         private rcon: RCON,
         private backup: Backups,
         private eventBus: EventBus,
+        private clusterController: ClusterController,
     ) {
         super(logerFactory.createLogger('Events'));
     }
@@ -136,6 +138,18 @@ export class Events extends IStatefulService {
                 this.runTask(event, () => this.backup.createBackup());
                 break;
             }
+            case 'rollout': {
+                if (!this.clusterController.isActive() || !event.params?.[0]) {
+                    this.log.log(
+                        LogLevel.ERROR,
+                        `Rollout task '${event.name}' needs the cluster controller and a command. Check your config!`,
+                    );
+                    break;
+                }
+                // the events user is not an admin of the agents, so the level is passed explicitly
+                this.runTask(event, async () => this.clusterController.rollout(event.params[0], 'events', undefined, undefined, 'admin'));
+                break;
+            }
             default: {
                 break;
             }
@@ -0,0 +1,155 @@
+import { inject, injectable, singleton } from 'tsyringe';
+import * as path from 'path';
+import { Manager } from '../control/manager';
+import { IStatefulService } from '../types/service';
+import { LoggerFactory } from './loggerfactory';
+import { Monitor } from './monitor';
+import { EventBus } from '../control/event-bus';
+import { FSAPI, InjectionTokens } from '../util/apis';
+import { LogLevel } from '../util/logger';
+import { ServerState } from '../types/monitor';
+import { InternalEventTypes } from '../types/events';
+
+@singleton()
+@injectable()
+export class IngameHeartbeat extends IStatefulService {
+
+    public readonly HEARTBEAT_FILE = 'DZSM-HEARTBEAT.txt';
+
+    public checkIntervall = 500;
+
+    // null means the heartbeat file was not read yet since the server (re)started
+    private lastCounter: string | null = null;
+    private lastBeat = 0;
+    private armed = false;
+    private missed = false;
+    private checkRunning = false;
+
+    public constructor(
+        loggerFactory: LoggerFactory,
+        private manager: Manager,
+        private monitor: Monitor,
+        private eventBus: EventBus,
+        @inject(InjectionTokens.fs) private fs: FSAPI,
+    ) {
+        super(loggerFactory.createLogger('IngameHeartbeat'));
+    }
+
+    public async start(): Promise<void> {
+        await this.stop();
+
+        if (!(this.manager.config.ingameHeartbeatIntervall > 0) || !(this.manager.config.ingameHeartbeatDeadline > 0)) {
+            return;
+        }
+
+        this.timers.addInterval(
+            'check',
+            /* istanbul ignore next */ () => {
+                if (this.checkRunning) return;
+                this.checkRunning = true;
+                const cb = (): void => {
+                    this.checkRunning = false;
+                };
+                this.check().then(cb, cb);
+            },
+            this.checkIntervall,
+        );
+    }
+
+    public async stop(): Promise<void> {
+        this.timers.removeAllTimers();
+        this.checkRunning = false;
+        this.reset();
+    }
+
+    /**
+     * @returns the time of the last heartbeat or undefined if the heartbeat of the current server was not detected yet
+     */
+    public get lastHeartbeat(): number | undefined {
+        return this.armed ? this.lastBeat : undefined;
+    }
+
+    private reset(): void {
+        this.lastCounter = null;
+        this.lastBeat = 0;
+        this.armed = false;
+        this.missed = false;
+    }
+
+    private async readCounter(): Promise<string> {
+        try {
+            return (await this.fs.promises.readFile(
+                path.join(this.manager.getProfilesPath(), this.HEARTBEAT_FILE),
+                { encoding: 'utf-8' },
+            )).trim();
+        } catch {
+            return '';
+        }
+    }
+
+    /**
+     * @returns true if the heartbeat deadline was missed by this check
+     */
+    public async check(): Promise<boolean> {
+        if (this.monitor.serverState !== ServerState.STARTED) {
+            this.reset();
+            return false;
+        }
+
+        const counter = await this.readCounter();
+        const now = new Date().valueOf();
+
+        // the file might still contain the counter of the previous server, so only changes count as heartbeat
+        if (this.lastCounter === null) {
+            this.lastCounter = counter;
+            return false;
+        }
+
+        if (counter !== this.lastCounter) {
+            this.lastCounter = counter;
+            this.lastBeat = now;
+            if (!this.armed) {
+                this.log.log(LogLevel.INFO, 'Detected server heartbeat');
+                this.armed = true;
+            } else if (this.missed) {
+                this.log.log(LogLevel.IMPORTANT, 'Server heartbeat recovered');
+            }
+            this.missed = false;
+            return false;
+        }
+
+        if (!this.armed || this.missed || (now - this.lastBeat) < (this.manager.config.ingameHeartbeatDeadline * 1000)) {
+            return false;
+        }
+
+        this.missed = true;
+        await this.handleMissedHeartbeat(now - this.lastBeat);
+        return true;
+    }
+
+    private async handleMissedHeartbeat(elapsed: number): Promise<void> {
+        const restart = this.manager.config.ingameHeartbeatRestart
+            && !this.manager.config.lockServerRestart
+            && !this.monitor.restartLock;
+
+        const msg = `WARNING: No server heartbeat for ${Math.round(elapsed / 1000)}s, the server script thread is probably frozen!`
+            + (restart ? ' Restarting...' : '');
+        this.log.log(LogLevel.WARN, msg);
+        this.eventBus.emit(
+            InternalEventTypes.DISCORD_MESSAGE,
+            {
+                type: 'admin',
+                message: msg,
+            },
+        );
+
+        if (restart) {
+            try {
+                await this.monitor.killServer(true);
+            } catch (e) {
+                this.log.log(LogLevel.ERROR, 'Failed to kill the frozen server', e);
+            }
+        }
+    }
+
+}
@@ -1,6 +1,6 @@
 import { Manager } from '../control/manager';
-import { IngameReportContainer } from '../types/ingame-report';
-import { MetricTypeEnum } from '../types/metrics';
+import { IngameFrameTimesMetric, IngameReportContainer, IngameReportProfilerZone } from '../types/ingame-report';
+import { MetricTypeEnum, MetricWrapper } from '../types/metrics';
 import * as path from 'path';
 import { Paths } from '../services/paths';
 import { LogLevel } from '../util/logger';
@@ -8,9 +8,12 @@ import { IStatefulService } from '../types/service';
 import { inject, injectable, singleton } from 'tsyringe';
 import { LoggerFactory } from './loggerfactory';
 import { Metrics } from './metrics';
+import { RestartTracer } from './restart-tracer';
+import { Prometheus } from './prometheus';
 import { FSAPI, InjectionTokens } from '../util/apis';
 import { EventBus } from '../control/event-bus';
 import { InternalEventTypes } from '../types/events';
+import { WorkerPool } from './worker-pool';
 
 @singleton()
 @injectable()
@@ -23,6 +26,9 @@ export class IngameReport extends IStatefulService {
     public readonly EXPANSION_VEHICLES_MOD_ID = '2291785437';
     public readonly EXPANSION_BUNDLE_MOD_ID = '2572331007';
 
+    // amount of profiler zones stored per report
+    public maxProfilerZones: number = 50;
+
     public intervalTimeout: number = 1000;
     public readTimeout: number = 1000;
     private lastTickTimestamp: number = 0;
@@ -34,6 +40,9 @@ export class IngameReport extends IStatefulService {
         private metrics: Metrics,
         private paths: Paths,
         private eventBus: EventBus,
+        private restartTracer: RestartTracer,
+        private prometheus: Prometheus,
+        private workerPool: WorkerPool,
         @inject(InjectionTokens.fs) private fs: FSAPI,
     ) {
         super(loggerFactory.createLogger('IngameReport'));
@@ -80,8 +89,8 @@ export class IngameReport extends IStatefulService {
                     this.lastTickTimestamp = modified;
                     await new Promise((r) => setTimeout(r, this.readTimeout));
 
-                    const content = `${this.fs.readFileSync(this.tickFilePath)}`;
-                    const parsed = JSON.parse(content);
+                    // large reports (many vehicles) take a while to parse
+                    const parsed = await this.workerPool.run('readJson', this.tickFilePath);
 
                     await this.processIngameReport(parsed);
                 } else {
@@ -99,6 +108,9 @@ export class IngameReport extends IStatefulService {
         const timestamp = new Date().valueOf();
 
         this.log.log(LogLevel.INFO, `Server sent ingame report: ${report?.players?.length ?? 0} players, ${report?.vehicles?.length ?? 0} vehicles`);
+        this.restartTracer.end('firstReport');
+        this.prometheus.players.set(report?.players?.length ?? 0, { source: 'ingame' });
+        this.prometheus.vehicles.set(report?.vehicles?.length ?? 0);
 
         void this.metrics.pushMetricValue(
             MetricTypeEnum.INGAME_PLAYERS,
@@ -115,6 +127,40 @@ export class IngameReport extends IStatefulService {
                 value: report?.vehicles ?? [],
             },
         );
+
+        // older mod versions do not send frame times
+        if (report?.frameTimes?.frames) {
+            void this.metrics.pushMetricValue<MetricWrapper<IngameFrameTimesMetric>>(
+                MetricTypeEnum.INGAME_FRAMETIMES,
+                {
+                    timestamp,
+                    value: {
+                        ...report.frameTimes,
+                        players: report.players?.length ?? 0,
+                        vehicles: report.vehicles?.length ?? 0,
+                    },
+                },
+            );
+        }
+
+        if (report?.profilerZones?.length) {
+            const zones = [...report.profilerZones]
+                .sort((a, b) => b.total - a.total)
+                .slice(0, this.maxProfilerZones);
+
+            this.log.log(
+                LogLevel.DEBUG,
+                `Top script profiler zones: ${zones.slice(0, 5).map((x) => `${x.name} (${x.total.toFixed(1)}ms)`).join(', ')}`,
+            );
+
+            void this.metrics.pushMetricValue<MetricWrapper<IngameReportProfilerZone[]>>(
+                MetricTypeEnum.INGAME_PROFILER,
+                {
+                    timestamp,
+                    value: zones,
+                },
+            );
+        }
     }
 
     public async installMod(): Promise<void> {
@@ -13,6 +13,7 @@ import { FSAPI, InjectionTokens } from '../util/apis';
 import { EventBus } from '../control/event-bus';
 import { InternalEventTypes } from '../types/events';
 import { dzsmDebugLogReader } from '../config/constants';
+import { Prometheus } from './prometheus';
 
 export interface LogContainer {
     logFiles?: FileDescriptor[];
@@ -49,6 +50,7 @@ export class LogReader extends IStatefulService {
         loggerFactory: LoggerFactory,
         private manager: Manager,
         private eventBus: EventBus,
+        private prometheus: Prometheus,
         @inject(InjectionTokens.fs) private fs: FSAPI,
     ) {
         super(loggerFactory.createLogger('LogReader'));
@@ -144,6 +146,8 @@ export class LogReader extends IStatefulService {
                     });
                     logContainer.tail.on('line', (line) => {
                         if (line) {
+                            this.prometheus.logLines.inc({ type });
+                            this.prometheus.logBytes.inc({ type }, Buffer.byteLength(line));
                             if (process.env['DZSM_DEBUG_LOG_READER'] === 'true' || dzsmDebugLogReader) {
                                 this.log.log(LogLevel.DEBUG, `${type} - ${line}`);
                             }
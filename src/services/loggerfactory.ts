@@ -5,8 +5,11 @@ import { Logger } from '../util/logger';
 @injectable()
 export class LoggerFactory {
 
+    /** name of the instance which is added to each log line, when running multiple instances */
+    public instance?: string;
+
     public createLogger(context: string): Logger {
-        return new Logger(context);
+        return new Logger(context, this.instance);
     }
 
 }
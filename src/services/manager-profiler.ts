@@ -0,0 +1,323 @@
+import * as inspector from 'inspector';
+import * as path from 'path';
+import { Readable } from 'stream';
+import { constants as HTTP } from 'http2';
+import { inject, injectable, singleton } from 'tsyringe';
+import { IStatefulService, TimerHandler } from '../types/service';
+import { LoggerFactory } from './loggerfactory';
+import { Manager } from '../control/manager';
+import { Paths } from './paths';
+import { FSAPI, InjectionTokens } from '../util/apis';
+import { LogLevel } from '../util/logger';
+import { Response } from '../types/interface';
+import { ActiveHandle, ActiveHandlesDump, PROFILE_EXTENSIONS, ProfileFile, ProfileType } from '../types/profiler';
+
+/**
+ * Captures cpu and heap profiles of the running manager with the inspector,
+ * so high cpu or memory usage can be diagnosed without restarting the manager with inspector flags.
+ *
+ * The profiles cover the whole process (all instances) and are written to the profiles folder of the manager.
+ * So only one instance profiles continuously and a profile type is only captured once at a time, even when requested by different instances.
+ * The cpu and heap profiles can be opened with the chrome dev tools or speedscope.
+ */
+@singleton()
+@injectable()
+export class ManagerProfiler extends IStatefulService {
+
+    public static readonly DIR = 'profiles';
+
+    /** max duration of on demand profiles in seconds */
+    public static readonly MAX_DURATION = 300;
+
+    /** sampling interval in µs of on demand cpu profiles */
+    public static readonly SAMPLING_INTERVAL = 1000;
+
+    /** the continuous profiler samples less often, so its overhead stays negligible */
+    public static readonly CONTINUOUS_SAMPLING_INTERVAL = 10000;
+    public static readonly CONTINUOUS_KEPT = 12;
+
+    /** average bytes between samples of the sampling heap profiler */
+    public static readonly HEAP_SAMPLING_INTERVAL = 32768;
+
+    private static capturing = new Set<ProfileType>();
+    private static continuousProfiler?: ManagerProfiler;
+    private continuousSession?: inspector.Session;
+
+    public constructor(
+        loggerFactory: LoggerFactory,
+        private manager: Manager,
+        private paths: Paths,
+        @inject(InjectionTokens.fs) private fs: FSAPI,
+    ) {
+        super(loggerFactory.createLogger('Profiler'));
+    }
+
+    public async start(): Promise<void> {
+        const minutes = this.manager.config?.continuousProfiling;
+        if (!(minutes > 0)) {
+            return;
+        }
+        if (ManagerProfiler.continuousProfiler && ManagerProfiler.continuousProfiler !== this) {
+            this.log.log(LogLevel.INFO, 'Continuous profiling is already running for another instance');
+            return;
+        }
+        ManagerProfiler.continuousProfiler = this;
+        await this.startContinuous(minutes * 60000);
+    }
+
+    public async stop(): Promise<void> {
+        this.timers.removeAllTimers();
+        const session = this.continuousSession;
+        this.continuousSession = undefined;
+        if (session) {
+            await this.writeContinuous(session);
+            session.disconnect();
+        }
+        if (ManagerProfiler.continuousProfiler === this) {
+            ManagerProfiler.continuousProfiler = undefined;
+        }
+    }
+
+    public getDir(): string {
+        return path.join(this.paths.cwd(), ManagerProfiler.DIR);
+    }
+
+    public isContinuous(): boolean {
+        return !!this.continuousSession;
+    }
+
+    /**
+     * @param seconds duration of the profile
+     * @returns the profile file
+     */
+    public async captureCpuProfile(seconds: number): Promise<ProfileFile> {
+        return this.capture('cpu', async (session) => {
+            await this.post(session, 'Profiler.enable');
+            await this.post(session, 'Profiler.setSamplingInterval', { interval: ManagerProfiler.SAMPLING_INTERVAL });
+            await this.post(session, 'Profiler.start');
+            await this.wait(seconds);
+            const { profile } = await this.post(session, 'Profiler.stop');
+            return this.writeProfile('cpu', JSON.stringify(profile));
+        });
+    }
+
+    /**
+     * Samples the allocations, which is a lot cheaper than a heap snapshot and shows where memory is allocated
+     * @param seconds duration of the profile
+     * @returns the profile file
+     */
+    public async captureHeapProfile(seconds: number): Promise<ProfileFile> {
+        return this.capture('heap', async (session) => {
+            await this.post(session, 'HeapProfiler.enable');
+            await this.post(session, 'HeapProfiler.startSampling', { samplingInterval: ManagerProfiler.HEAP_SAMPLING_INTERVAL });
+            await this.wait(seconds);
+            const { profile } = await this.post(session, 'HeapProfiler.stopSampling');
+            return this.writeProfile('heap', JSON.stringify(profile));
+        });
+    }
+
+    /**
+     * Blocks the manager while the snapshot is taken and needs about as much memory as the heap itself.
+     * @returns the snapshot file
+     */
+    public async takeHeapSnapshot(): Promise<ProfileFile> {
+        return this.capture('heapsnapshot', async (session) => {
+            const file = path.join(this.getDir(), this.getFileName('heapsnapshot'));
+            const out = this.fs.createWriteStream(file);
+            const written = new Promise((r, e) => out.on('finish', r).on('error', e));
+
+            // the snapshot is streamed in chunks, so it never has to fit into a single string
+            session.on('HeapProfiler.addHeapSnapshotChunk', (msg) => {
+                out.write(msg.params.chunk);
+            });
+            try {
+                await this.post(session, 'HeapProfiler.takeHeapSnapshot', { reportProgress: false });
+            } finally {
+                out.end();
+                await written;
+            }
+            return this.getProfileFile(path.basename(file));
+        });
+    }
+
+    /**
+     * Shows what keeps the manager busy, i.e. growing amounts of sockets or timers
+     * @returns the dump, which is written to the profiles folder as well
+     */
+    public async dumpActiveHandles(): Promise<ActiveHandlesDump> {
+        const resources: Record<string, number> = {};
+        // only available since node 16.14
+        for (const type of ((process as any).getActiveResourcesInfo?.() ?? []) as string[]) {
+            resources[type] = (resources[type] ?? 0) + 1;
+        }
+
+        const dump: ActiveHandlesDump = {
+            timestamp: Date.now(),
+            resources,
+            handles: ((process as any)._getActiveHandles?.() ?? []).map((x) => this.describeHandle(x)),
+            timers: TimerHandler.getActiveTimers(),
+            memory: process.memoryUsage(),
+        };
+
+        await this.ensureDir();
+        await this.writeProfile('handles', JSON.stringify(dump, null, 2));
+        return dump;
+    }
+
+    /**
+     * @returns the files in the profiles folder, the newest first
+     */
+    public async getProfiles(): Promise<ProfileFile[]> {
+        const dir = this.getDir();
+        if (!this.fs.existsSync(dir)) {
+            return [];
+        }
+        const files = await this.fs.promises.readdir(dir);
+        return (await Promise.all(files.map((x) => this.getProfileFile(x))))
+            .filter((x) => !!x)
+            .sort((a, b) => b.created - a.created);
+    }
+
+    /**
+     * Profiles (especially heap snapshots) can be as large as the heap, so they are streamed instead of being read into memory
+     * @returns the profile and a stream of its content
+     */
+    public async openProfile(file: string): Promise<{ profile: ProfileFile, stream: Readable }> {
+        const dir = path.resolve(this.getDir());
+        const filePath = path.resolve(dir, file || '');
+        // only plain file names, nothing outside of the profiles folder
+        const profile = (file && path.basename(file) === file && path.dirname(filePath) === dir)
+            ? await this.getProfileFile(file)
+            : undefined;
+        if (!profile) {
+            throw new Response(HTTP.HTTP_STATUS_NOT_FOUND, `Profile ${file} not found`);
+        }
+        return { profile, stream: this.fs.createReadStream(filePath) };
+    }
+
+    public createSession(): inspector.Session {
+        return new inspector.Session();
+    }
+
+    private async capture(type: ProfileType, fn: (session: inspector.Session) => Promise<ProfileFile>): Promise<ProfileFile> {
+        if (ManagerProfiler.capturing.has(type)) {
+            throw new Response(HTTP.HTTP_STATUS_CONFLICT, `A ${type} profile is already being captured`);
+        }
+        ManagerProfiler.capturing.add(type);
+        const session = this.createSession();
+        try {
+            session.connect();
+            await this.ensureDir();
+            this.log.log(LogLevel.IMPORTANT, `Capturing ${type} profile`);
+            const file = await fn(session);
+            this.log.log(LogLevel.IMPORTANT, `Captured ${type} profile: ${file.file}`);
+            return file;
+        } finally {
+            session.disconnect();
+            ManagerProfiler.capturing.delete(type);
+        }
+    }
+
+    private async startContinuous(duration: number): Promise<void> {
+        const session = this.createSession();
+        session.connect();
+        await this.post(session, 'Profiler.enable');
+        await this.post(session, 'Profiler.setSamplingInterval', { interval: ManagerProfiler.CONTINUOUS_SAMPLING_INTERVAL });
+        await this.post(session, 'Profiler.start');
+        this.continuousSession = session;
+        this.log.log(LogLevel.INFO, `Continuous profiling started, writing a profile every ${duration / 60000} minutes`);
+
+        this.timers.addInterval(
+            'continuous',
+            async () => {
+                if (this.continuousSession === session) {
+                    await this.writeContinuous(session);
+                    // the next profile starts where the previous ended
+                    await this.post(session, 'Profiler.start');
+                }
+            },
+            duration,
+        );
+    }
+
+    private async writeContinuous(session: inspector.Session): Promise<void> {
+        try {
+            const { profile } = await this.post(session, 'Profiler.stop');
+            await this.ensureDir();
+            await this.writeProfile('continuous', JSON.stringify(profile));
+
+            const outdated = (await this.getProfiles())
+                .filter((x) => x.type === 'continuous')
+                .slice(ManagerProfiler.CONTINUOUS_KEPT);
+            for (const x of outdated) {
+                await this.fs.promises.unlink(path.join(this.getDir(), x.file));
+            }
+        } catch (e) {
+            this.log.log(LogLevel.WARN, 'Failed to write continuous profile', e);
+        }
+    }
+
+    private post(session: inspector.Session, method: string, params?: Record<string, any>): Promise<any> {
+        return new Promise((resolve, reject) => {
+            session.post(method, params, (e, result) => (e ? reject(e) : resolve(result)));
+        });
+    }
+
+    private wait(seconds: number): Promise<void> {
+        const ms = Math.min(Math.max(0, seconds || 0), ManagerProfiler.MAX_DURATION) * 1000;
+        return new Promise((r) => setTimeout(r, ms));
+    }
+
+    private async ensureDir(): Promise<void> {
+        await this.fs.promises.mkdir(this.getDir(), { recursive: true });
+    }
+
+    private getFileName(type: ProfileType): string {
+        const timestamp = new Date().toISOString().replace(/[:.]/g, '-');
+        return `${type}-${timestamp}${PROFILE_EXTENSIONS[type]}`;
+    }
+
+    private async writeProfile(type: ProfileType, content: string): Promise<ProfileFile> {
+        const file = this.getFileName(type);
+        await this.fs.promises.writeFile(path.join(this.getDir(), file), content);
+        return this.getProfileFile(file);
+    }
+
+    private async getProfileFile(file: string): Promise<ProfileFile | undefined> {
+        const type = file.split('-')[0] as ProfileType;
+        if (!PROFILE_EXTENSIONS[type] || !file.endsWith(PROFILE_EXTENSIONS[type])) {
+            return undefined;
+        }
+        try {
+            const stat = await this.fs.promises.stat(path.join(this.getDir(), file));
+            return { file, type, size: stat.size, created: stat.mtime.getTime() };
+        } catch {
+            return undefined;
+        }
+    }
+
+    private describeHandle(handle: any): ActiveHandle {
+        const type = handle?.constructor?.name || typeof handle;
+        let details: string | undefined;
+        if (typeof handle?.pid === 'number') {
+            details = `pid ${handle.pid}${handle.spawnfile ? ` (${handle.spawnfile})` : ''}`;
+        } else if (handle?.remoteAddress) {
+            details = `${handle.localAddress}:${handle.localPort} -> ${handle.remoteAddress}:${handle.remotePort}`;
+        } else if (typeof handle?.address === 'function') {
+            try {
+                const address = handle.address();
+                details = typeof address === 'string' ? address : (address && `${address.address}:${address.port}`);
+            } catch {
+                // i.e. closed sockets
+            }
+        } else if (typeof handle?.fd === 'number') {
+            details = `fd ${handle.fd}`;
+        }
+        return {
+            type,
+            details: details || undefined,
+            refed: typeof handle?.hasRef === 'function' ? handle.hasRef() : undefined,
+        };
+    }
+
+}
@@ -7,6 +7,7 @@ import { LoggerFactory } from './loggerfactory';
 import { RCON } from './rcon';
 import { SystemReporter } from './system-reporter';
 import { Metrics } from './metrics';
+import { DiscordBot } from './discord';
 
 @singleton()
 @injectable()
@@ -20,6 +21,7 @@ export class MetricsCollector extends IStatefulService {
         private metrics: Metrics,
         private rcon: RCON,
         private systemReporter: SystemReporter,
+        private discord: DiscordBot,
     ) {
         super(loggerFactory.createLogger('MetricsCollector'));
     }
@@ -51,6 +53,8 @@ export class MetricsCollector extends IStatefulService {
 
         await this.pushMetric(MetricTypeEnum.SYSTEM, () => this.systemReporter.getSystemReport());
 
+        await this.pushMetric(MetricTypeEnum.DISCORD_QUEUE, async () => this.discord.getQueueStats());
+
         if (this.manager.config.metricMaxAge && this.manager.config.metricMaxAge > 0) {
             this.metrics.deleteMetrics(this.manager.config.metricMaxAge);
         }
@@ -3,6 +3,9 @@ import { IStatefulService } from '../types/service';
 import { Database, DatabaseTypes } from './database';
 import { injectable, singleton } from 'tsyringe';
 import { LoggerFactory } from './loggerfactory';
+import { EventBus } from '../control/event-bus';
+import { InternalEventTypes } from '../types/events';
+import { Prometheus } from './prometheus';
 
 @singleton()
 @injectable()
@@ -11,6 +14,8 @@ export class Metrics extends IStatefulService {
     public constructor(
         loggerFactory: LoggerFactory,
         private database: Database,
+        private eventBus: EventBus,
+        private prometheus: Prometheus,
     ) {
         super(loggerFactory.createLogger('Metrics'));
     }
@@ -31,6 +36,7 @@ export class Metrics extends IStatefulService {
     }
 
     public async pushMetricValue<T extends MetricWrapper<any>>(type: MetricType, value: T): Promise<void> {
+        const timer = this.prometheus.dbWriteDuration.startTimer({ operation: 'insert', table: type });
         this.database.getDatabase(DatabaseTypes.METRICS).run(
             `
                 INSERT INTO ${type} (timestamp, value) VALUES (?, ?)
@@ -38,15 +44,19 @@ export class Metrics extends IStatefulService {
             value.timestamp,
             JSON.stringify(value.value),
         );
+        timer();
+        this.eventBus.emit(InternalEventTypes.METRIC_ENTRY, { type, entry: value });
     }
 
     public deleteMetrics(maxAge: number): void {
 
         const delTs = new Date().valueOf() - maxAge;
         for (const key of Object.keys(MetricTypeEnum)) {
+            const timer = this.prometheus.dbWriteDuration.startTimer({ operation: 'delete', table: key });
             this.database.getDatabase(DatabaseTypes.METRICS).run(`
                 DELETE FROM ${key} WHERE timestamp < ?
             `, delTs);
+            timer();
         }
 
     }
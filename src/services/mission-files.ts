@@ -9,17 +9,33 @@ import { Hooks } from './hooks';
 import { FSAPI, InjectionTokens } from '../util/apis';
 import { LogLevel } from '../util/logger';
 import { Paths } from './paths';
+import { parseXml } from '../util/xml-parser';
+import { EconomyIndex, EconomyQuery, EconomyQueryResult } from '../util/economy-index';
+import { EventBus } from '../control/event-bus';
+import { InternalEventTypes } from '../types/events';
+import { TaskTracker } from './task-tracker';
+
+interface EconomyCacheEntry {
+    mtime: number;
+    size: number;
+    index: Promise<EconomyIndex>;
+}
 
 @singleton()
 @injectable()
 export class MissionFiles extends IService {
 
+    // parsed economy xmls by file path, reparsed when the file changes
+    private economyCache = new Map<string, EconomyCacheEntry>();
+
     public constructor(
         loggerFactory: LoggerFactory,
         private manager: Manager,
         private backup: Backups,
         private hooks: Hooks,
         private paths: Paths,
+        private eventBus: EventBus,
+        private taskTracker: TaskTracker,
         @inject(InjectionTokens.fs) private fs: FSAPI,
     ) {
         super(loggerFactory.createLogger('MissionFiles'));
@@ -81,6 +97,51 @@ export class MissionFiles extends IService {
         return this.readFile(filePath);
     }
 
+    private async getEconomyIndex(filePath: string): Promise<EconomyIndex> {
+        const stat = await this.fs.promises.stat(filePath);
+        const cached = this.economyCache.get(filePath);
+        if (cached && cached.mtime === stat.mtime.getTime() && cached.size === stat.size) {
+            return cached.index;
+        }
+
+        this.log.log(LogLevel.DEBUG, `Parsing economy file ${filePath}`);
+        const index = this.readFile(filePath).then((content) => this.taskTracker.trackSync(
+            `parseEconomy ${filePath}`,
+            () => new EconomyIndex(parseXml(content)),
+        ));
+        const entry: EconomyCacheEntry = {
+            mtime: stat.mtime.getTime(),
+            size: stat.size,
+            index,
+        };
+        this.economyCache.set(filePath, entry);
+        index.catch(() => {
+            if (this.economyCache.get(filePath) === entry) {
+                this.economyCache.delete(filePath);
+            }
+        });
+        return index;
+    }
+
+    /**
+     * @returns the parsed xml (in the same structure as xml2js) of a mission file, which is cached until the file changes
+     */
+    public async readMissionEconomy(file: string): Promise<any> {
+        const filePath = await this.getMissionPath(file);
+        if (!filePath) {
+            return null;
+        }
+        return (await this.getEconomyIndex(filePath)).content;
+    }
+
+    public async queryMissionEconomy(file: string, query: EconomyQuery): Promise<EconomyQueryResult> {
+        const filePath = await this.getMissionPath(file);
+        if (!filePath) {
+            return null;
+        }
+        return (await this.getEconomyIndex(filePath)).query(query);
+    }
+
     private async readDir(dirPath: string): Promise<string[]> {
         if (!dirPath) {
             return [];
@@ -117,6 +178,7 @@ export class MissionFiles extends IService {
         }
         await this.fs.promises.mkdir(path.dirname(filePath), { recursive: true });
         await this.fs.promises.writeFile(filePath, content);
+        this.economyCache.delete(filePath);
 
         await this.hooks.executeHooks(HookTypeEnum.missionChanged);
     }
@@ -130,7 +192,10 @@ export class MissionFiles extends IService {
             return;
         }
         const filePath = await this.getMissionPath(file);
-        return this.writeFile(filePath, content, createBackup);
+        await this.writeFile(filePath, content, createBackup);
+        if (filePath) {
+            this.eventBus.emit(InternalEventTypes.MISSION_FILE_WRITTEN, filePath);
+        }
     }
 
     public async writeProfileFile(
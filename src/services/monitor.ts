@@ -11,6 +11,7 @@ import { InternalEventTypes } from '../types/events';
 import { ServerStarter } from './server-starter';
 import { ServerDetector } from './server-detector';
 import { Paths } from './paths';
+import { RestartTracer } from './restart-tracer';
 import * as path from 'path';
 
 export type ServerStateListener = (state: ServerState) => any;
@@ -42,6 +43,7 @@ export class Monitor extends IStatefulService {
         private serverStarter: ServerStarter,
         private serverDetector: ServerDetector,
         private paths: Paths,
+        private restartTracer: RestartTracer,
         @inject(InjectionTokens.fs) private fs: FSAPI,
     ) {
         super(loggerFactory.createLogger('Monitor'));
@@ -84,10 +86,16 @@ export class Monitor extends IStatefulService {
 
     public async killServer(force?: boolean): Promise<boolean> {
         if (this.internalServerState === ServerState.STARTING || this.serverState === ServerState.STARTED) {
+            this.restartTracer.beginCycle('restart');
             this.internalServerState = ServerState.STOPPING;
         }
 
-        return this.serverStarter.killServer(force);
+        const killed = await this.restartTracer.span('shutdown', () => this.serverStarter.killServer(force));
+        // ends once the monitor notices the server is gone
+        if (this.internalServerState !== ServerState.STOPPED) {
+            this.restartTracer.begin('stopDetection');
+        }
+        return killed;
     }
 
     public async start(): Promise<void> {
@@ -103,6 +111,17 @@ export class Monitor extends IStatefulService {
                 if (this.tickRunning) {
                     return;
                 }
+
+                // check right away if the server process exited in between the regular polls
+                if (
+                    this.internalServerState === ServerState.STARTED
+                    && this.lastTick < new Date().valueOf()
+                    && this.serverDetector.hasServerExited()
+                ) {
+                    this.log.log(LogLevel.WARN, 'Detected server process exit');
+                    this.lastTick = 0;
+                }
+
                 if (
                     (new Date().valueOf() - this.lastTick)
                         > this.manager.config.serverProcessPollIntervall
@@ -137,6 +156,9 @@ export class Monitor extends IStatefulService {
             return;
         }
 
+        // the start up grace period skips ticks, so it ends with the next one
+        this.restartTracer.end('startupGrace');
+
         try {
             let needsRestart = true;
 
@@ -176,6 +198,7 @@ export class Monitor extends IStatefulService {
 
             if (needsRestart) {
                 this.log.log(LogLevel.IMPORTANT, 'Server not found. Starting...');
+                this.restartTracer.beginCycle(this.initialStart ? 'start' : 'crash');
                 this.internalServerState = ServerState.STARTING;
                 await this.serverStarter.startServer(this.initialStart);
                 this.log.log(LogLevel.IMPORTANT, 'Server start initiated...');
@@ -183,6 +206,8 @@ export class Monitor extends IStatefulService {
                 this.initialStart = false;
 
                 // give the server a minute to start up
+                this.restartTracer.begin('boot');
+                this.restartTracer.begin('startupGrace');
                 this.skipLoop(60000);
             } else if (!this.manager.config.disableStuckCheck) {
                 await this.checkPossibleStuckState();
@@ -5,30 +5,8 @@ import { inject, injectable, singleton } from 'tsyringe';
 import { CHILDPROCESSAPI, FSAPI, InjectionTokens } from '../util/apis';
 import { IService } from '../types/service';
 import { LoggerFactory } from './loggerfactory';
-
-export const copySync = (fs: FSAPI, source: string, target: string): void => {
-
-    // src=somedir/test target=tmp -> tmp/test
-    if (fs.lstatSync(source).isDirectory()) {
-        if (!fs.existsSync(target)) {
-            fs.mkdirSync(target, { recursive: true });
-        }
-        fs.readdirSync(source).forEach((file) => {
-            const curSource = path.join(source, file);
-            const curTarget = path.join(target, file);
-            if (fs.lstatSync(curSource).isDirectory()) {
-                copySync(fs, curSource, curTarget);
-            } else {
-                fs.copyFileSync(curSource, curTarget);
-            }
-        });
-    } else {
-        if (!fs.existsSync(target)) {
-            fs.mkdirSync(target, { recursive: true });
-        }
-        fs.copyFileSync(source, path.join(target, path.basename(source)));
-    }
-};
+import { DirSyncOptions } from '../util/dir-sync';
+import { WorkerPool } from './worker-pool';
 
 @singleton()
 @injectable()
@@ -36,8 +14,13 @@ export class Paths extends IService {
 
     private workingDir: string = process.cwd();
 
+    /** working dir of the supervisor, when running as one of multiple instances */
+    private sharedDir?: string;
+    private instanceName?: string;
+
     public constructor(
         loggerFactory: LoggerFactory,
+        private workerPool: WorkerPool,
         @inject(InjectionTokens.fs) private fs: FSAPI,
         @inject(InjectionTokens.childProcess) private childProcess: CHILDPROCESSAPI,
     ) {
@@ -54,6 +37,29 @@ export class Paths extends IService {
         return this.resolve(this.workingDir);
     }
 
+    /**
+     * Runs this manager as one of multiple instances supervised by one process
+     * @param name name of the instance
+     * @param instanceDir working dir of the instance (config, server, metrics etc.)
+     * @param sharedDir working dir for the files shared by all instances (steamcmd, workshop)
+     */
+    public setInstance(name: string, instanceDir: string, sharedDir: string): void {
+        this.instanceName = name;
+        this.workingDir = instanceDir;
+        this.sharedDir = sharedDir;
+    }
+
+    public getInstanceName(): string | undefined {
+        return this.instanceName;
+    }
+
+    /**
+     * @returns the working dir for files shared by all instances, the normal working dir if not running as instance
+     */
+    public sharedCwd(): string {
+        return this.resolve(this.sharedDir ?? this.workingDir);
+    }
+
     /* istanbul ignore next */
     public resolve(...parts: string[]): string {
         if (this.isAbsolute(parts[0])) {
@@ -68,6 +74,17 @@ export class Paths extends IService {
         return path.isAbsolute(fspath) || /^[a-zA-Z]:[/\\].*/.test(fspath);
     }
 
+    /**
+     * @returns whether both paths exist and are on the same filesystem (i.e. files can be hardlinked)
+     */
+    public sameFilesystem(p1: string, p2: string): boolean {
+        try {
+            return this.fs.statSync(p1).dev === this.fs.statSync(p2).dev;
+        } catch {
+            return false;
+        }
+    }
+
     public samePath(p1: string, p2: string): boolean {
 
         if (!p1 || !p2) return false;
@@ -219,7 +236,7 @@ export class Paths extends IService {
                 }
             }
 
-            copySync(this.fs, source, target);
+            await this.workerPool.run('copyDir', source, target);
 
             return true;
         } catch (e) {
@@ -228,5 +245,28 @@ export class Paths extends IService {
         }
     }
 
+    /**
+     * copies only the files which changed since the last sync and removes the ones which do not exist in the source anymore
+     */
+    public async syncDirFromTo(source: string, target: string, opts: DirSyncOptions): Promise<boolean> {
+        try {
+            const result = await this.workerPool.run('syncDir', source, target, opts);
+            if (result.collisions?.length) {
+                this.log.log(
+                    LogLevel.WARN,
+                    `Skipped files in ${source} whose lower case names are already used by other files: ${result.collisions.join(', ')}`,
+                );
+            }
+            this.log.log(
+                LogLevel.DEBUG,
+                `Synced ${source} to ${target}: ${result.copied} copied, ${result.removed} removed, ${result.unchanged} unchanged`,
+            );
+            return true;
+        } catch (e) {
+            this.log.log(LogLevel.ERROR, `Error syncing ${source} to ${target}`, e);
+            return false;
+        }
+    }
+
 }
 
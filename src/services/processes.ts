@@ -51,6 +51,8 @@ export interface ProcessSpawnOpts {
     stdOutHandler: (data: string) => any;
     stdErrHandler: (data: string) => any;
     pty: boolean;
+    /** run with a lower cpu and io priority, i.e. for maintenance jobs */
+    lowPriority: boolean;
 }
 
 export interface IProcessSpawner {
@@ -65,6 +67,8 @@ export interface IProcessSpawner {
 @injectable()
 export class ProcessSpawner extends IService implements IProcessSpawner {
 
+    public readonly LOW_PRIORITY_NICE = 10;
+
     private logCommands = false;
 
     public constructor(
@@ -89,6 +93,12 @@ export class ProcessSpawner extends IService implements IProcessSpawner {
             );
         }
 
+        if (opts?.lowPriority && detectOS() !== 'windows') {
+            // without an explicit io class, the io priority is derived from the nice value
+            args = ['-n', `${this.LOW_PRIORITY_NICE}`, cmd, ...(args ?? [])];
+            cmd = 'nice';
+        }
+
         if (opts?.pty) {
             return this.spawnForOutputPty(cmd, args, opts);
         }
@@ -101,6 +111,9 @@ export class ProcessSpawner extends IService implements IProcessSpawner {
                     args,
                     opts?.spawnOpts,
                 );
+                if (opts?.lowPriority) {
+                    this.lowerPriority(spawnedProcess.pid);
+                }
 
                 let stdout = '';
 
@@ -174,6 +187,18 @@ export class ProcessSpawner extends IService implements IProcessSpawner {
         });
     }
 
+    private lowerPriority(pid?: number): void {
+        // on linux the process is already started with nice
+        if (!pid || detectOS() !== 'windows') {
+            return;
+        }
+        try {
+            os.setPriority(pid, os.constants.priority.PRIORITY_BELOW_NORMAL);
+        } catch (e) {
+            this.log.log(LogLevel.DEBUG, `Failed to lower the priority of process ${pid}`, e);
+        }
+    }
+
     private async spawnForOutputPty(
         cmd: string,
         args?: string[],
@@ -190,6 +215,9 @@ export class ProcessSpawner extends IService implements IProcessSpawner {
                         useConpty: false,
                     },
                 );
+                if (opts?.lowPriority) {
+                    this.lowerPriority(pty.pid);
+                }
 
                 let inputHandlerSet = false;
                 if (opts?.spawnOpts?.stdio === 'inherit' || opts?.spawnOpts?.stdio?.[0] === 'inherit') {
@@ -265,6 +293,21 @@ export class ProcessSpawner extends IService implements IProcessSpawner {
 
 }
 
+interface TrackedProcess {
+    pid: string;
+    startTime: string;
+}
+
+interface ScannedProcess {
+    entry: ProcessEntry;
+    startTime: string;
+}
+
+interface ProcessScan {
+    done?: number;
+    result: Promise<ScannedProcess[]>;
+}
+
 export interface IProcessFetcher {
     getProcessList(exeName?: string): Promise<ProcessEntry[]>;
 }
@@ -284,6 +327,11 @@ export class WindowsProcessFetcher extends IService implements IProcessFetcher {
     }
 
     public async getProcessList(exeName?: string): Promise<ProcessEntry[]> {
+        return (await this.getAllProcesses())
+            .filter((x) => this.paths.samePath(x?.ExecutablePath, exeName));
+    }
+
+    public async getAllProcesses(): Promise<ProcessEntry[]> {
         const result = await this.spawner.spawnForOutput(
             'cmd',
             [
@@ -321,8 +369,7 @@ export class WindowsProcessFetcher extends IService implements IProcessFetcher {
                         let proc = new ProcessEntry();
                         x.forEach((y) => proc = merge(proc, { [y[0]]: y[1] }));
                         return proc;
-                    })
-                    .filter((x) => this.paths.samePath(x?.ExecutablePath, exeName)),
+                    }),
             );
         }
         return procs;
@@ -336,6 +383,14 @@ export class Processes extends IService implements IProcessSpawner, IProcessFetc
 
     public static pageSize: number | null = null;
 
+    /** full scans finished less than this ago are reused, if multiple instances share the process list */
+    public static readonly SCAN_TTL = 1000;
+
+    private trackedProcesses = new Map<string, TrackedProcess[]>();
+
+    private lastScan?: ProcessScan;
+    private scanTtl = 0;
+
     public constructor(
         loggerFactory: LoggerFactory,
         private spawner: ProcessSpawner,
@@ -346,11 +401,23 @@ export class Processes extends IService implements IProcessSpawner, IProcessFetc
         super(loggerFactory.createLogger('Processes'));
     }
 
+    /**
+     * @param shared whether multiple instances use the process list, so finished scans are reused for a short time
+     */
+    public setScanSharing(shared: boolean): void {
+        this.scanTtl = shared ? Processes.SCAN_TTL : 0;
+    }
+
 
     public async getProcessList(exeName?: string): Promise<ProcessEntry[]> {
 
         if (detectOS() === 'windows') {
-            return this.windowsProcessFetcher.getProcessList(exeName);
+            const winProcesses = (await this.scanAll(
+                async () => (await this.windowsProcessFetcher.getAllProcesses())
+                    .map((x) => ({ entry: x, startTime: x.CreationDate })),
+            )).filter((x) => this.paths.samePath(x.entry.ExecutablePath, exeName));
+            this.trackProcesses(exeName, winProcesses.map((x) => ({ pid: x.entry.ProcessId, startTime: x.startTime })));
+            return winProcesses.map((x) => x.entry);
         }
 
         if (!Processes.pageSize) {
@@ -367,51 +434,135 @@ export class Processes extends IService implements IProcessSpawner, IProcessFetc
                 Processes.pageSize = 4096; // some default
             }
         }
-        return await this.fs.promises.readdir('/proc')
-            .then(
-                /* istanbul ignore next */ (result) => Promise.all(
-                    result.map(
-                        /* istanbul ignore next */ async (pid) => {
-                            if (!Number(pid)) return;
-                            try {
-                                const stat = await this.fs.promises.stat(`/proc/${pid}`);
-                                if (stat?.isDirectory() && stat.uid === process.getuid()) {
-                                    const now = new Date().valueOf();
-                                    const uptime = os.uptime();
-                                    const details = await Promise.all([
-                                        this.fs.promises.readlink(`/proc/${pid}/exe`, { encoding: 'utf-8' }),
-                                        this.fs.promises.readFile(`/proc/${pid}/cmdline`, { encoding: 'utf-8' }),
-                                        this.fs.promises.readFile(`/proc/${pid}/stat`, { encoding: 'utf-8' }),
-                                        this.fs.promises.readFile(`/proc/${pid}/statm`, { encoding: 'utf-8' }),
-                                    ]);
-
-                                    // see https://man7.org/linux/man-pages/man5/proc.5.html
-                                    const pstat = details[2].split(' ');
-                                    const pstatm = details[3].split(' ');
-
-                                    /* eslint-disable @typescript-eslint/naming-convention */
-                                    return {
-                                        Name: pid,
-                                        ProcessId: pid,
-                                        ExecutablePath: details[0],
-                                        CommandLine: details[1].split('\0').join(' ').trim(),
-                                        PrivatePageCount: String(Number(pstatm[0]) * Processes.pageSize),
-                                        CreationDate: String(now - (uptime - Number(pstat[21]) / 100) * 1000),
-                                        UserModeTime: String(Number(pstat[13]) * 1000),
-                                        KernelModeTime: String(Number(pstat[14]) * 1000),
-                                    }
-                                    /* eslint-enable @typescript-eslint/naming-convention */
-                                }
-                            } catch {}
-                            return null;
-                        },
-                    ),
-                ),
-            )
-            .then( /* istanbul ignore next */(list) => list
-                .filter(/* istanbul ignore next */ (x) => !!x?.ExecutablePath)
-                .filter(/* istanbul ignore next */ (x) => this.paths.samePath(x?.ExecutablePath, exeName)),
+
+        // only re-read the processes found last time, a full scan is only needed if one of them is gone
+        const tracked = exeName ? this.trackedProcesses.get(exeName) : undefined;
+        if (tracked?.length) {
+            const trackedList = await Promise.all(
+                tracked.map(/* istanbul ignore next */ (x) => this.readLinuxProcess(x.pid)),
             );
+            if (trackedList.every(
+                /* istanbul ignore next */ (x, i) => x?.startTime === tracked[i].startTime
+                    && this.paths.samePath(x.entry.ExecutablePath, exeName),
+            )) {
+                return trackedList.map(/* istanbul ignore next */ (x) => x.entry);
+            }
+        }
+
+        const list = (await this.scanAll(
+            () => this.fs.promises.readdir('/proc')
+                .then(
+                    /* istanbul ignore next */ (result) => Promise.all(
+                        result.map(
+                            /* istanbul ignore next */ (pid) => this.readLinuxProcess(pid),
+                        ),
+                    ),
+                )
+                .then(/* istanbul ignore next */ (result) => result.filter(/* istanbul ignore next */ (x) => !!x?.entry.ExecutablePath)),
+        )).filter(/* istanbul ignore next */ (x) => this.paths.samePath(x.entry.ExecutablePath, exeName));
+
+        this.trackProcesses(exeName, list.map(/* istanbul ignore next */ (x) => ({ pid: x.entry.ProcessId, startTime: x.startTime })));
+        return list.map(/* istanbul ignore next */ (x) => x.entry);
+    }
+
+    /**
+     * Scans all processes, running scans are shared and just finished ones as well if scan sharing is enabled
+     */
+    private scanAll(scan: () => Promise<ScannedProcess[]>): Promise<ScannedProcess[]> {
+        const last = this.lastScan;
+        if (last && (!last.done || Date.now() - last.done < this.scanTtl)) {
+            return last.result;
+        }
+
+        const current: ProcessScan = {
+            result: scan().then(
+                (result) => {
+                    current.done = Date.now();
+                    return result;
+                },
+                (e) => {
+                    // failed scans are not reused
+                    if (this.lastScan === current) {
+                        this.lastScan = undefined;
+                    }
+                    throw e;
+                },
+            ),
+        };
+        this.lastScan = current;
+        return current.result;
+    }
+
+    /* istanbul ignore next */
+    private async readLinuxProcess(pid: string): Promise<ScannedProcess | null> {
+        if (!Number(pid)) return null;
+        try {
+            const stat = await this.fs.promises.stat(`/proc/${pid}`);
+            if (stat?.isDirectory() && stat.uid === process.getuid()) {
+                const now = new Date().valueOf();
+                const uptime = os.uptime();
+                const details = await Promise.all([
+                    this.fs.promises.readlink(`/proc/${pid}/exe`, { encoding: 'utf-8' }),
+                    this.fs.promises.readFile(`/proc/${pid}/cmdline`, { encoding: 'utf-8' }),
+                    this.fs.promises.readFile(`/proc/${pid}/stat`, { encoding: 'utf-8' }),
+                    this.fs.promises.readFile(`/proc/${pid}/statm`, { encoding: 'utf-8' }),
+                ]);
+
+                // see https://man7.org/linux/man-pages/man5/proc.5.html
+                const pstat = details[2].split(' ');
+                const pstatm = details[3].split(' ');
+
+                /* eslint-disable @typescript-eslint/naming-convention */
+                return {
+                    entry: {
+                        Name: pid,
+                        ProcessId: pid,
+                        ExecutablePath: details[0],
+                        CommandLine: details[1].split('\0').join(' ').trim(),
+                        PrivatePageCount: String(Number(pstatm[0]) * Processes.pageSize),
+                        CreationDate: String(now - (uptime - Number(pstat[21]) / 100) * 1000),
+                        UserModeTime: String(Number(pstat[13]) * 1000),
+                        KernelModeTime: String(Number(pstat[14]) * 1000),
+                    },
+                    // start time in clock ticks after boot, guards against reused pids
+                    startTime: pstat[21],
+                };
+                /* eslint-enable @typescript-eslint/naming-convention */
+            }
+        } catch {}
+        return null;
+    }
+
+    private trackProcesses(exeName: string | undefined, tracked: TrackedProcess[]): void {
+        if (!exeName) return;
+        if (tracked.length) {
+            this.trackedProcesses.set(exeName, tracked);
+        } else {
+            this.trackedProcesses.delete(exeName);
+        }
+    }
+
+    /**
+     * Cheap liveness probe for the processes found by the last process list fetch of the executable
+     *
+     * @param exeName the executable path used to fetch the process list
+     * @returns undefined if no process is tracked, otherwise whether all tracked processes are still alive
+     */
+    public isTrackedProcessRunning(exeName: string): boolean | undefined {
+        const tracked = this.trackedProcesses.get(exeName);
+        if (!tracked?.length) {
+            return undefined;
+        }
+        return tracked.every((x) => {
+            try {
+                // signal 0 only checks for the existence of the process
+                process.kill(Number(x.pid), 0);
+                return true;
+            } catch (e) {
+                // the process exists but belongs to someone else
+                return e?.code === 'EPERM';
+            }
+        });
     }
 
     public getProcessCPUSpent(proc: ProcessEntry): number {
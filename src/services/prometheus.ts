@@ -0,0 +1,63 @@
+import { injectable, singleton } from 'tsyringe';
+import { IService } from '../types/service';
+import { LoggerFactory } from './loggerfactory';
+import { PromRegistry } from '../util/prometheus';
+
+/**
+ * Holds the in process counters and histograms exposed on the `/metrics` endpoint.
+ *
+ * The values are updated by the services where they occur, so a scrape never has to touch the metrics database.
+ */
+@singleton()
+@injectable()
+export class Prometheus extends IService {
+
+    public readonly registry = new PromRegistry();
+
+    // system reports
+    public readonly systemCpu = this.registry.gauge('dzsm_system_cpu_usage_percent', 'CPU usage of the whole system');
+    public readonly systemMemoryUsed = this.registry.gauge('dzsm_system_memory_used_bytes', 'Used memory of the whole system');
+    public readonly systemMemoryTotal = this.registry.gauge('dzsm_system_memory_total_bytes', 'Total memory of the whole system');
+    public readonly processCpu = this.registry.gauge('dzsm_process_cpu_usage_percent', 'CPU usage of the manager and the server process');
+    public readonly processMemory = this.registry.gauge('dzsm_process_memory_bytes', 'Memory used by the manager (heap) and the server process');
+    public readonly processUptime = this.registry.gauge('dzsm_process_uptime_seconds', 'Uptime of the manager and the server process');
+
+    // server
+    public readonly players = this.registry.gauge('dzsm_players', 'Players online as reported by the source');
+    public readonly vehicles = this.registry.gauge('dzsm_vehicles', 'Vehicles in the last ingame report');
+    public readonly rconCommandDuration = this.registry.histogram(
+        'dzsm_rcon_command_duration_seconds',
+        'Round trip time of RCON commands',
+    );
+    public readonly rconCommandFailures = this.registry.counter('dzsm_rcon_command_failures_total', 'RCON commands without response');
+
+    // manager
+    /** set by the EventLoopMonitor */
+    public readonly eventLoopLag = this.registry.gauge(
+        'dzsm_event_loop_lag_seconds',
+        'Event loop delay of the manager since the previous scrape',
+    );
+    public readonly steamCmdDuration = this.registry.histogram(
+        'dzsm_steamcmd_duration_seconds',
+        'Duration of SteamCMD runs',
+        [1, 5, 15, 30, 60, 120, 300, 600, 1800, 3600],
+    );
+    public readonly logLines = this.registry.counter('dzsm_log_lines_total', 'Lines read from the server logs');
+    public readonly logBytes = this.registry.counter('dzsm_log_bytes_total', 'Bytes read from the server logs');
+    public readonly dbWriteDuration = this.registry.histogram(
+        'dzsm_db_write_duration_seconds',
+        'Duration of metrics database writes',
+        [0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 1],
+    );
+
+    public constructor(
+        loggerFactory: LoggerFactory,
+    ) {
+        super(loggerFactory.createLogger('Prometheus'));
+    }
+
+    public render(): string {
+        return this.registry.render();
+    }
+
+}
@@ -3,13 +3,13 @@ import * as dgram from 'dgram';
 import * as crc32 from 'buffer-crc32';
 import * as path from 'path';
 import { LogLevel } from '../util/logger';
-import { RconBan, RconPlayer } from '../types/rcon';
+import { GuidListType, RconBan, RconPlayer } from '../types/rcon';
 import { IStatefulService } from '../types/service';
 import { ServerState } from '../types/monitor';
 import { matchRegex } from '../util/match-regex';
 import { delay, inject, injectable, registry, singleton } from 'tsyringe';
 import { LoggerFactory } from './loggerfactory';
-import { FSAPI, InjectionTokens, RCONSOCKETFACTORY } from '../util/apis';
+import { CHOKIDAR, FSAPI, InjectionTokens, RCONSOCKETFACTORY } from '../util/apis';
 import { EventBus } from '../control/event-bus';
 import { InternalEventTypes } from '../types/events';
 import { Listener } from 'eventemitter2';
@@ -17,6 +17,10 @@ import { Monitor } from './monitor';
 import * as CryptoJS from 'crypto-js';
 import * as bigInt from 'big-integer';
 import { detectOS } from '../util/detect-os';
+import { GuidList } from '../util/guid-list';
+import { RestartTracer } from './restart-tracer';
+import { Prometheus } from './prometheus';
+import * as chokidarModule from 'chokidar';
 
 // eslint-disable-next-line no-shadow
 export enum PacketType {
@@ -38,18 +42,21 @@ export class IPacketAttributes {
     public sequence?: number;
     public total?: number;
     public index?: number;
-    public data?: string;
     public password?: string;
     public command?: string;
-    public message?: string;
     public login?: boolean;
     public part?: Buffer;
+    /** undecoded response data or message, see Packet.data and Packet.message */
+    public payload?: Buffer;
 }
 
 export class Packet extends IPacketAttributes {
 
     public resolve?: (response: string | null) => any;
 
+    private decoded?: string;
+    private serialized?: Buffer;
+
     public constructor(
         public type: PacketType,
         public direction: PacketDirection,
@@ -60,53 +67,74 @@ export class Packet extends IPacketAttributes {
         Object.assign(this, attributes);
     }
 
+    /**
+     * Serialized packets which never change (acks and keepalives) cached by type and sequence
+     */
+    private static readonly STATIC_PACKETS: Map<number, Buffer> = new Map();
+
+    /**
+     * Checksums of the headers (0xFF, type and sequence) cached by type and sequence,
+     * the checksum of a packet continues from them over the payload
+     */
+    private static readonly HEADER_CRCS: Map<number, number> = new Map();
+
+    private static headerCrc(type: PacketType, sequence?: number): number {
+        const key = (type << 9) | (sequence === undefined ? 0x100 : (sequence & 0xFF));
+        let crc = Packet.HEADER_CRCS.get(key);
+        if (crc === undefined) {
+            const header = sequence === undefined ? [0xFF, type] : [0xFF, type, sequence & 0xFF];
+            crc = crc32.unsigned(Buffer.from(header));
+            Packet.HEADER_CRCS.set(key, crc);
+        }
+        return crc;
+    }
+
     public static fromBuffer(buffer: Buffer): Packet {
         const { length } = buffer
         if (length < 9) {
             throw new Error('Packet must contain at least 9 bytes')
         }
 
-        const header = buffer.toString('utf8', 0, 2)
-        if (header !== 'BE') {
+        if (buffer[0] !== 0x42 || buffer[1] !== 0x45) {
             throw new Error('Invalid header text')
         }
 
-        const payload = buffer.slice(6, length)
-        const checksum = buffer.readInt32BE(2)
-        const crc = crc32(payload).readInt32LE(0)
+        // checksum is transmitted little endian, verify against a view of the payload
+        const checksum = buffer.readInt32LE(2)
+        const crc = crc32.signed(buffer.subarray(6, length))
 
         if (checksum !== crc) {
             throw new Error('Packet checksum verification failed.')
         }
 
-        if (payload.readUInt8(0) !== 0xFF) {
+        if (buffer[6] !== 0xFF) {
             throw new Error('Packet missing 0xFF flag after checksum.')
         }
 
-        const type = payload.readUInt8(1)
+        const type = buffer[7]
         const attributes: IPacketAttributes = {}
         let direction = PacketDirection.RESPONSE
 
         switch (type) {
             case PacketType.LOGIN: {
-                attributes.login = (payload.readUInt8(2) === 1);
+                attributes.login = (buffer[8] === 1);
                 break;
             }
             case PacketType.COMMAND: {
-                attributes.sequence = payload.readUInt8(2);
-                if (payload.length > 4 && payload.readUInt8(3) === 0) {
-                    attributes.total = payload.readUInt8(4);
-                    attributes.index = payload.readUInt8(5);
-                    attributes.part = payload.slice(6, payload.length);
+                attributes.sequence = buffer[8];
+                if (length > 10 && buffer[9] === 0) {
+                    attributes.total = buffer[10];
+                    attributes.index = buffer[11];
+                    attributes.part = buffer.subarray(12, length);
                     direction = PacketDirection.MULTI_PART_RESPONSE;
                 } else {
-                    attributes.data = payload.slice(3, payload.length).toString();
+                    attributes.payload = buffer.subarray(9, length);
                 }
                 break;
             }
             case PacketType.MESSAGE: {
-                attributes.sequence = payload.readUInt8(2);
-                attributes.message = payload.slice(3, payload.length).toString();
+                attributes.sequence = buffer[8];
+                attributes.payload = buffer.subarray(9, length);
                 break;
             }
             default: {
@@ -120,6 +148,29 @@ export class Packet extends IPacketAttributes {
     public get valid(): boolean {
         return (Number.isInteger(this.type) && Number.isInteger(this.direction))
     }
+
+    /**
+     * Response of a command, decoded when it is first read
+     */
+    public get data(): string | undefined {
+        return this.type === PacketType.COMMAND ? this.decodePayload() : undefined;
+    }
+
+    /**
+     * Server message, decoded when it is first read
+     */
+    public get message(): string | undefined {
+        return this.type === PacketType.MESSAGE ? this.decodePayload() : undefined;
+    }
+
+    private decodePayload(): string | undefined {
+        if (this.decoded === undefined && this.payload) {
+            this.decoded = this.payload.toString('utf8');
+            // the view keeps the whole datagram alive
+            this.payload = undefined;
+        }
+        return this.decoded;
+    }
     /**
      * serialize packet to be sent to battleye
      *
@@ -131,47 +182,79 @@ export class Packet extends IPacketAttributes {
             throw new Error('Invalid Packet')
         }
 
-        let payload: Buffer;
+        this.sent = this.sent ? this.sent + 1 : 1
+
+        // acks and keepalives only differ by their sequence, so they are built once and reused
+        const isStatic = this.type === PacketType.MESSAGE
+            || (this.type === PacketType.COMMAND && this.command === '');
+        const cacheKey = (this.type << 8) | (this.sequence & 0xFF);
+        if (isStatic) {
+            const cached = Packet.STATIC_PACKETS.get(cacheKey);
+            if (cached) {
+                return cached;
+            }
+        }
+
+        // resends of a request are sent from the buffer of the first send
+        if (this.serialized && this.serialized[8] === (this.sequence & 0xFF)) {
+            return this.serialized;
+        }
+
+        let buffer: Buffer;
+        let payloadStart: number;
+        let crc: number;
         switch (this.type) {
             case PacketType.LOGIN:
                 if (!this.password) {
                     throw new Error('Missing password');
                 }
-                payload = Buffer.alloc(this.password.length + 2);
-                payload.writeUInt8(0xFF, 0);
-                payload.writeUInt8(this.type, 1);
-                payload.write(this.password, 2);
+                payloadStart = 8;
+                buffer = Buffer.allocUnsafe(payloadStart + Buffer.byteLength(this.password));
+                buffer.write(this.password, payloadStart);
+                crc = Packet.headerCrc(this.type);
                 break;
             case PacketType.COMMAND:
                 if (this.command === undefined || this.command === null) {
                     throw new Error('Missing Command');
                 }
-                payload = Buffer.alloc(this.command.length + 3);
-                payload.writeUInt8(0xFF, 0);
-                payload.writeUInt8(this.type, 1);
-                payload.writeUInt8(this.sequence, 2);
-                payload.write(this.command, 3);
+                payloadStart = 9;
+                buffer = Buffer.allocUnsafe(payloadStart + Buffer.byteLength(this.command));
+                buffer[8] = this.sequence & 0xFF;
+                buffer.write(this.command, payloadStart);
+                crc = Packet.headerCrc(this.type, this.sequence);
                 break;
             case PacketType.MESSAGE:
-                payload = Buffer.alloc(3);
-                payload.writeUInt8(0xFF, 0);
-                payload.writeUInt8(this.type, 1);
-                payload.writeUInt8(this.sequence, 2);
+                payloadStart = 9;
+                buffer = Buffer.allocUnsafe(payloadStart);
+                buffer[8] = this.sequence & 0xFF;
+                crc = Packet.headerCrc(this.type, this.sequence);
                 break;
             default:
                 throw new Error(`Unknown PacketType ${this.type}`);
         }
 
-        const crc = crc32(payload);
-        const header = Buffer.from([0x42, 0x45, 0x00, 0x00, 0x00, 0x00]);
-        header.writeInt32BE(crc.readInt32LE(0), 2);
-
-        this.sent = this.sent ? this.sent + 1 : 1
+        // header and payload share one allocation, the checksum continues from the cached header checksum
+        buffer[0] = 0x42;
+        buffer[1] = 0x45;
+        buffer[6] = 0xFF;
+        buffer[7] = this.type;
+        buffer.writeInt32LE(crc32.signed(buffer.subarray(payloadStart), crc), 2);
+
+        if (isStatic) {
+            Packet.STATIC_PACKETS.set(cacheKey, buffer);
+        } else if (this.type === PacketType.COMMAND) {
+            this.serialized = buffer;
+        }
 
-        return Buffer.concat([header, payload], header.length + payload.length)
+        return buffer;
     }
 }
 
+interface MultipartAssembly {
+    parts: Buffer[];
+    received: number;
+    byteLength: number;
+}
 
 export class BattleyeConf {
 
@@ -185,10 +268,16 @@ export class BattleyeConf {
 }
 
 @singleton()
-@registry([{
-    token: InjectionTokens.rconSocket,
-    useFactory: /* istanbul ignore next */ () => /* istanbul ignore next */ () => dgram.createSocket('udp4'),
-}]) // eslint-disable-line @typescript-eslint/indent
+@registry([
+    {
+        token: InjectionTokens.rconSocket,
+        useFactory: /* istanbul ignore next */ () => /* istanbul ignore next */ () => dgram.createSocket('udp4'),
+    },
+    {
+        token: InjectionTokens.chokidar,
+        useValue: chokidarModule,
+    },
+]) // eslint-disable-line @typescript-eslint/indent
 @injectable()
 export class RCON extends IStatefulService {
 
@@ -206,7 +295,7 @@ export class RCON extends IStatefulService {
     private sequenceNumber: number = -1;
 
     private requests: (Packet | undefined)[] = new Array(255).fill(undefined);
-    private multipart: (Packet[] | undefined)[] = new Array(255).fill(undefined);
+    private multipart: (MultipartAssembly | undefined)[] = new Array(256).fill(undefined);
 
     private lastResponse: number = 0;
     private lastCommand: number = 0
@@ -223,13 +312,19 @@ export class RCON extends IStatefulService {
 
     private stateListener?: Listener;
 
+    private guidLists = new Map<string, GuidList>();
+    private guidListWatchers: chokidarModule.FSWatcher[] = [];
+
     public constructor(
         loggerFactory: LoggerFactory,
         private manager: Manager,
         private eventBus: EventBus,
         @inject(delay(() => Monitor)) private monitor: Monitor,
+        private restartTracer: RestartTracer,
+        private prometheus: Prometheus,
         @inject(InjectionTokens.fs) private fs: FSAPI,
         @inject(InjectionTokens.rconSocket) private socketFactory: RCONSOCKETFACTORY,
+        @inject(InjectionTokens.chokidar) private chokidar: CHOKIDAR,
     ) {
         super(loggerFactory.createLogger('RCON'));
     }
@@ -321,7 +416,7 @@ export class RCON extends IStatefulService {
             x?.resolve?.(undefined);
         })
         this.requests = new Array(255).fill(undefined);
-        this.multipart = new Array(255).fill(undefined);
+        this.multipart = new Array(256).fill(undefined);
         this.duplicateMessageCache = [];
 
         this.lastResponse = 0;
@@ -448,6 +543,8 @@ export class RCON extends IStatefulService {
 
         this.log.log(LogLevel.DEBUG, 'RCON stopping');
         this.reset();
+
+        await this.closeGuidLists();
     }
 
     public async getBansRaw(): Promise<string | null> {
@@ -499,10 +596,11 @@ export class RCON extends IStatefulService {
         const data = await this.getPlayersRaw();
 
         if (!data) {
+            this.prometheus.players.remove({ source: 'rcon' });
             return [];
         }
 
-        return matchRegex(
+        const players = matchRegex(
             /(\d+)\s+(\b\d{1,3}\.\d{1,3}\.\d{1,3}\.\d{1,3}):(\d+\b)\s+(\d+)\s+([0-9a-fA-F]+)\(\w+\)\s([\S ]+)$/gim,
             data,
         )
@@ -517,6 +615,8 @@ export class RCON extends IStatefulService {
                     lobby: !!e[6]?.includes(' (Lobby)'),
                 };
             }) ?? [];
+        this.prometheus.players.set(players.length, { source: 'rcon' });
+        return players;
     }
 
     public async kick(player: string): Promise<void> {
@@ -632,6 +732,7 @@ export class RCON extends IStatefulService {
             this.log.log(LogLevel.DEBUG, `Sending command: ${command}`);
         }
 
+        const timer = this.prometheus.rconCommandDuration.startTimer();
         return new Promise((resolve) => {
             const packet = new Packet(
                 PacketType.COMMAND,
@@ -639,6 +740,11 @@ export class RCON extends IStatefulService {
                 { command },
             );
             packet.resolve = (data) => {
+                if (data === undefined || data === null) {
+                    this.prometheus.rconCommandFailures.inc();
+                } else {
+                    timer();
+                }
                 if (command?.length || this.packetDebug) {
                     if (data === undefined || data === null) {
                         this.log.log(LogLevel.WARN, `Command '${command}' (${packet.sequence}) failed`);
@@ -673,42 +779,55 @@ export class RCON extends IStatefulService {
         }
 
         if (packet.direction === PacketDirection.MULTI_PART_RESPONSE) {
-            if (
-                !this.multipart[packet.sequence]?.length
-                || this.multipart[packet.sequence].length !== packet.total
-            ) {
-                this.multipart[packet.sequence] = new Array(packet.total).fill(undefined);
+            if (packet.index >= packet.total) {
+                this.log.log(LogLevel.ERROR, 'Received multipart RCON packet with invalid index');
+                return;
             }
 
-            this.multipart[packet.sequence][packet.index] = packet;
-
-            if (this.multipart[packet.sequence].every((x) => x !== undefined)) {
-                const parts = this.multipart[packet.sequence];
-                this.multipart[packet.sequence] = [];
-                try {
-                    const buff = Buffer.concat(
-                        parts.map((x) => x.part),
-                        parts.reduce((prev, cur) => prev + cur.part.length, 0),
-                    );
-                    packet = new Packet(
-                        PacketType.COMMAND,
-                        PacketDirection.RESPONSE,
-                        {
-                            data: buff.toString(),
-                            sequence: packet.sequence,
-                        },
-                    );
-                    if (this.packetDebug) {
-                        this.log.log(LogLevel.DEBUG, 'Multipart response completed', packet.data);
-                    }
-                } catch {
-                    this.log.log(LogLevel.ERROR, 'Error joining multipart RCON response');
-                    return;
-                }
+            let assembly = this.multipart[packet.sequence];
+            if (!assembly || assembly.parts.length !== packet.total) {
+                assembly = {
+                    parts: new Array(packet.total).fill(undefined),
+                    received: 0,
+                    byteLength: 0,
+                };
+                this.multipart[packet.sequence] = assembly;
+            }
+
+            if (!assembly.parts[packet.index]) {
+                assembly.received++;
+                assembly.byteLength += packet.part.length;
             } else {
+                // duplicate part, replace it
+                assembly.byteLength += packet.part.length - assembly.parts[packet.index].length;
+            }
+
+            // the part is a view into the received datagram, it is only copied once when joining
+            assembly.parts[packet.index] = packet.part;
+
+            if (assembly.received < assembly.parts.length) {
                 // not all parts received
                 return;
             }
+
+            this.multipart[packet.sequence] = undefined;
+            try {
+                const buff = Buffer.concat(assembly.parts, assembly.byteLength);
+                packet = new Packet(
+                    PacketType.COMMAND,
+                    PacketDirection.RESPONSE,
+                    {
+                        payload: buff,
+                        sequence: packet.sequence,
+                    },
+                );
+                if (this.packetDebug) {
+                    this.log.log(LogLevel.DEBUG, 'Multipart response completed', packet.data);
+                }
+            } catch {
+                this.log.log(LogLevel.ERROR, 'Error joining multipart RCON response');
+                return;
+            }
         }
 
         switch (packet.type) {
@@ -723,6 +842,7 @@ export class RCON extends IStatefulService {
                 } else {
                     this.loggedIn = packet.login;
                     this.log.log(LogLevel.IMPORTANT, 'Log-In Successful. RCON Connected');
+                    this.restartTracer.end('rconLogin');
                     void this.command('say -1 Big Brother Connected.');
                     this.startKeepAlive();
                 }
@@ -804,126 +924,103 @@ export class RCON extends IStatefulService {
         return hash.toString();
     }
 
-    private readGuidFile(file: string): ({ lines: string[]; linefeed: string }) {
-        if (!this.fs.existsSync(file)) {
-            return {
-                linefeed: '\r\n',
-                lines: [],
-            };
+    private getGuidListFile(type: GuidListType): string {
+        if (!['ban', 'whitelist', 'priority'].includes(type)) {
+            throw new Error(`Unknown guid list: ${type}`);
         }
-        const content = this.fs.readFileSync(
-            file,
-            { encoding: 'utf-8' },
-        );
-        const linefeed = content.includes('\r\n') ? '\r\n' : '\n';
-        return {
-            linefeed,
-            lines: content.split(linefeed),
-        };
-    }
-
-    private removeGuidFromFile(steamId: string, file: string): void {
-        if (!steamId || !(steamId.length === 17 || steamId.length === 44)) return;
-        steamId = steamId.length === 17 ? this.steam64ToDayZID(steamId) : steamId;
-        const baseDir = this.manager.getServerPath();
-        const filePath = path.join(baseDir, file);
-        const content = this.readGuidFile(filePath);
-        content.lines = content.lines.filter((x) => !x.trim().startsWith(steamId));
-        this.fs.writeFileSync(
-            filePath,
-            content.lines.join(content.linefeed),
-        );
+        return `${type}.txt`;
     }
 
-    private readGuidsFromFile(file: string): string[] {
-        const baseDir = this.manager.getServerPath();
-        const filePath = path.join(baseDir, file);
-        const content = this.readGuidFile(filePath);
-        return content.lines
-            .map((x) => x.trim())
-            .filter((x) => !!x && !x.startsWith('//'))
-            .map((x) => x.includes('//') ? x.slice(0, x.indexOf('//')).trim() : x);
-    }
-
-    private addGuidToFile(steamId: string, file: string): void {
-        if (!steamId) return;
-        if (steamId.length !== 17 && steamId.length !== 44) return;
-        steamId = steamId.length === 17 ? this.steam64ToDayZID(steamId) : steamId;
-        const baseDir = this.manager.getServerPath();
-        const filePath = path.join(baseDir, file);
-        const content = this.readGuidFile(filePath);
-        if (!content.lines.some((x) => x.trim().startsWith(steamId))) {
-            content.lines.push(steamId);
-            this.fs.writeFileSync(
+    private getGuidList(type: GuidListType): GuidList {
+        const filePath = path.join(this.manager.getServerPath(), this.getGuidListFile(type));
+        let list = this.guidLists.get(filePath);
+        if (!list) {
+            list = new GuidList(
+                this.fs,
                 filePath,
-                content.lines.join(content.linefeed),
+                type === 'priority' ? ';' : undefined,
             );
+            this.guidLists.set(filePath, list);
+
+            const watcher = this.chokidar.watch(filePath, { ignoreInitial: true });
+            watcher.on('all', /* istanbul ignore next */ () => list.invalidate());
+            this.guidListWatchers.push(watcher);
+        }
+        return list;
+    }
+
+    private async closeGuidLists(): Promise<void> {
+        const watchers = this.guidListWatchers;
+        this.guidListWatchers = [];
+        this.guidLists.clear();
+        for (const watcher of watchers) {
+            try {
+                await watcher.close();
+            } catch (e) {
+                this.log.log(LogLevel.DEBUG, 'Failed to close guid list watcher', e);
+            }
         }
     }
 
-    public readBanTxt(): string[] {
-        return this.readGuidsFromFile('ban.txt');
+    private normalizeGuid(type: GuidListType, steamId: string): string {
+        steamId = steamId?.trim();
+        if (type === 'priority') {
+            return steamId?.length === 17 ? steamId : '';
+        }
+        if (!steamId || !(steamId.length === 17 || steamId.length === 44)) return '';
+        return steamId.length === 17 ? this.steam64ToDayZID(steamId) : steamId;
+    }
+
+    /**
+     * Adds many guids or steam64 ids to one of the guid lists with a single write
+     *
+     * @returns the number of newly added entries
+     */
+    public importGuids(type: GuidListType, steamIds: string[]): number {
+        return this.getGuidList(type).add(
+            (steamIds ?? [])
+                .map((x) => this.normalizeGuid(type, x))
+                .filter((x) => !!x),
+        );
+    }
+
+    public exportGuids(type: GuidListType): string {
+        return this.getGuidList(type).export();
+    }
+
+    public readBanTxt(): readonly string[] {
+        return this.getGuidList('ban').values();
     }
 
     public banTxt(steamId: string): void {
-        this.addGuidToFile(steamId, 'ban.txt');
+        this.importGuids('ban', [steamId]);
     }
 
     public unbanTxt(steamId: string): void {
-        this.removeGuidFromFile(steamId, 'ban.txt');
+        this.getGuidList('ban').remove([this.normalizeGuid('ban', steamId)]);
     }
 
-    public readWhitelistTxt(): string[] {
-        return this.readGuidsFromFile('whitelist.txt');
+    public readWhitelistTxt(): readonly string[] {
+        return this.getGuidList('whitelist').values();
     }
 
     public whitelistTxt(steamId: string): void {
-        this.addGuidToFile(steamId, 'whitelist.txt');
+        this.importGuids('whitelist', [steamId]);
     }
 
     public unwhitelistTxt(steamId: string): void {
-        this.removeGuidFromFile(steamId, 'whitelist.txt');
-    }
-
-    public readPriorityTxt(): string[] {
-        const baseDir = this.manager.getServerPath();
-        const filePath = path.join(baseDir, 'priority.txt');
-        const guids = new Set<string>();
-        if (this.fs.existsSync(filePath)) {
-            const content = this.readGuidFile(filePath);
-            for (const line of content.lines) {
-                const lineGuids = line
-                    .split(';')
-                    .map((x) => x.trim())
-                    .filter((x) => !!x);
-                for (const guid of lineGuids) {
-                    guids.add(guid);
-                }
-            }
-        }
-        return [...guids.values()];
+        this.getGuidList('whitelist').remove([this.normalizeGuid('whitelist', steamId)]);
+    }
+
+    public readPriorityTxt(): readonly string[] {
+        return this.getGuidList('priority').values();
     }
 
     public priorityTxt(steamId: string): void {
-        if (!steamId || steamId.length !== 17) return;
-        const baseDir = this.manager.getServerPath();
-        const filePath = path.join(baseDir, 'priority.txt');
-        const guids = this.readPriorityTxt();
-        guids.push(steamId);
-        this.fs.writeFileSync(
-            filePath,
-            guids.join(';'),
-        );
+        this.importGuids('priority', [steamId]);
     }
 
     public unpriorityTxt(steamId: string): void {
-        if (!steamId || steamId.length !== 17) return;
-        const baseDir = this.manager.getServerPath();
-        const filePath = path.join(baseDir, 'priority.txt');
-        const guids = this.readPriorityTxt();
-        this.fs.writeFileSync(
-            filePath,
-            guids.filter((x) => x !== steamId).join(';'),
-        );
+        this.getGuidList('priority').remove([this.normalizeGuid('priority', steamId)]);
     }
 }
@@ -260,7 +260,10 @@ export class Requirements extends IService {
         return true;
     }
 
-    public async check(): Promise<void> {
+    /**
+     * @param exit whether to exit the process if mandatory requirements are missing, throws otherwise
+     */
+    public async check(exit: boolean = true): Promise<void> {
         // check firewall, but let the server boot if its not there (could be manually set to ports)
         await this.checkFirewall();
 
@@ -270,6 +273,9 @@ export class Requirements extends IService {
         // check runtime libs
         if (!await this.checkRuntimeLibs() && this.manager.config?.prerequisitesMandatory !== false) {
             this.log.log(LogLevel.IMPORTANT, 'Install the missing runtime libs and restart the manager');
+            if (!exit) {
+                throw new Error('Missing runtime libs');
+            }
             this.processes.exit(0);
         }
     }
@@ -0,0 +1,156 @@
+import * as os from 'os';
+import { inject, injectable, singleton } from 'tsyringe';
+import { Manager } from '../control/manager';
+import { IService } from '../types/service';
+import { LoggerFactory } from './loggerfactory';
+import { Processes } from './processes';
+import { ServerDetector } from './server-detector';
+import { FSAPI, InjectionTokens } from '../util/apis';
+import { LogLevel } from '../util/logger';
+import { detectOS } from '../util/detect-os';
+import { ProcessResourceProfile, ResourceProfileReport } from '../types/resource-profiles';
+
+export interface SpawnCmd {
+    cmd: string;
+    args: string[];
+    cwd?: string;
+}
+
+@singleton()
+@injectable()
+export class ResourceProfiles extends IService {
+
+    /** the affinity is process wide, so it is shared by all instances */
+    private static managerPinned = false;
+
+    public constructor(
+        loggerFactory: LoggerFactory,
+        private manager: Manager,
+        private processes: Processes,
+        private serverDetector: ServerDetector,
+        @inject(InjectionTokens.fs) private fs: FSAPI,
+    ) {
+        super(loggerFactory.createLogger('ResourceProfiles'));
+    }
+
+    /**
+     * @returns the configured cores, without invalid or unavailable ones
+     */
+    private getCores(cores?: number[]): number[] {
+        const cpuCount = os.cpus().length;
+        const valid = [...new Set(cores ?? [])]
+            .filter((x) => Number.isInteger(x) && x >= 0 && x < cpuCount)
+            .sort((a, b) => a - b);
+        if (valid.length !== (cores?.length ?? 0)) {
+            this.log.log(LogLevel.WARN, `Ignoring invalid cpu cores in ${JSON.stringify(cores)}, this system has ${cpuCount} cores`);
+        }
+        return valid;
+    }
+
+    private toAffinityMask(cores: number[]): string {
+        // no bitwise ops, as they are limited to 32 bits
+        return cores.reduce((mask, core) => mask + (2 ** core), 0).toString(16);
+    }
+
+    /**
+     * pins the manager to the configured cores, all processes started afterwards inherit the affinity
+     */
+    public async applyManagerProfile(): Promise<boolean> {
+        const cores = this.getCores(this.manager.config?.managerCpuAffinity);
+        if (!cores.length) {
+            // a previously applied affinity is kept until the manager is restarted
+            return false;
+        }
+
+        const result = detectOS() === 'windows'
+            ? await this.processes.spawnForOutput(
+                'powershell',
+                [
+                    '-NoProfile',
+                    '-Command',
+                    `(Get-Process -Id ${process.pid}).ProcessorAffinity = 0x${this.toAffinityMask(cores)}`,
+                ],
+                { dontThrow: true },
+            )
+            : await this.processes.spawnForOutput(
+                'taskset',
+                ['--all-tasks', '--pid', '--cpu-list', cores.join(','), String(process.pid)],
+                { dontThrow: true },
+            );
+
+        if (result.status) {
+            this.log.log(LogLevel.WARN, `Failed to pin the manager to cpu cores ${cores.join(',')}`, result.stderr);
+            return false;
+        }
+
+        ResourceProfiles.managerPinned = true;
+        this.log.log(LogLevel.INFO, `Pinned the manager to cpu cores ${cores.join(',')}`);
+        return true;
+    }
+
+    /**
+     * @returns the spawn command wrapped to start the server on the configured cores
+     */
+    public wrapServerSpawnCmd(spawnCmd: SpawnCmd): SpawnCmd {
+        let cores = this.getCores(this.manager.config?.serverCpuAffinity);
+        if (!cores.length) {
+            if (!ResourceProfiles.managerPinned) {
+                return spawnCmd;
+            }
+            // the server would inherit the affinity of the manager
+            cores = os.cpus().map((x, idx) => idx);
+        }
+
+        if (detectOS() === 'windows') {
+            // cmd /c start [/AFFINITY <hexmask>] ...
+            const startIdx = spawnCmd.args.indexOf('start');
+            return {
+                ...spawnCmd,
+                args: [
+                    ...spawnCmd.args.slice(0, startIdx + 1),
+                    '/AFFINITY', this.toAffinityMask(cores),
+                    ...spawnCmd.args.slice(startIdx + 1),
+                ],
+            };
+        }
+
+        return {
+            ...spawnCmd,
+            cmd: 'taskset',
+            args: ['--cpu-list', cores.join(','), spawnCmd.cmd, ...spawnCmd.args],
+        };
+    }
+
+    private async getProcessProfile(pid: string): Promise<ProcessResourceProfile> {
+        const profile: ProcessResourceProfile = { pid };
+        try {
+            profile.priority = os.getPriority(Number(pid));
+        } catch {
+            // process gone or not accessible
+        }
+        if (detectOS() !== 'windows') {
+            try {
+                const status = await this.fs.promises.readFile(`/proc/${pid}/status`, { encoding: 'utf-8' });
+                profile.cpuAffinity = status.match(/^Cpus_allowed_list:\s*(\S+)/m)?.[1];
+            } catch {
+                // process gone or not accessible
+            }
+        }
+        return profile;
+    }
+
+    /**
+     * @returns the effective affinity and priority of the manager and the server
+     */
+    public async getEffectiveSettings(): Promise<ResourceProfileReport> {
+        const serverPid = (await this.serverDetector.getDayZProcesses())?.[0]?.ProcessId;
+        return {
+            manager: await this.getProcessProfile(String(process.pid)),
+            server: serverPid ? await this.getProcessProfile(serverPid) : undefined,
+            serverCpuAffinity: this.getCores(this.manager.config?.serverCpuAffinity),
+            managerCpuAffinity: this.getCores(this.manager.config?.managerCpuAffinity),
+            maintenanceLowPriority: !!this.manager.config?.maintenanceLowPriority,
+        };
+    }
+
+}
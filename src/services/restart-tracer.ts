@@ -0,0 +1,234 @@
+import { injectable, singleton } from 'tsyringe';
+import { Listener } from 'eventemitter2';
+import { Manager } from '../control/manager';
+import { EventBus } from '../control/event-bus';
+import { IStatefulService } from '../types/service';
+import { InternalEventTypes } from '../types/events';
+import { MetricTypeEnum } from '../types/metrics';
+import { ServerState } from '../types/monitor';
+import { RestartCycle, RestartCycleReason, RestartPhase, RestartRegression, RestartSpan, RestartTrace } from '../types/restart-tracer';
+import { LogLevel } from '../util/logger';
+import { LoggerFactory } from './loggerfactory';
+import { Metrics } from './metrics';
+
+/**
+ * Traces the phases of each restart cycle (shutdown, start preparation, boot, rcon login, first ingame report).
+ *
+ * A cycle starts when the server is killed (or found stopped) and ends once all phases after the server start are done.
+ * Finished cycles are stored as metric and compared with the previous cycles to flag phases which got slower.
+ */
+@singleton()
+@injectable()
+export class RestartTracer extends IStatefulService {
+
+    /** max time of a cycle until the server is running again */
+    public static readonly CYCLE_TIMEOUT = 60 * 60 * 1000;
+    /** max time of the phases after the server is running (rcon login, first report) */
+    public static readonly READY_TIMEOUT = 10 * 60 * 1000;
+
+    /** amount of previous cycles used as baseline */
+    public static readonly BASELINE_CYCLES = 10;
+    /** a phase is flagged if it took this much longer than the baseline... */
+    public static readonly REGRESSION_FACTOR = 1.5;
+    /** ...and at least this many ms */
+    public static readonly REGRESSION_MIN_DIFF = 5000;
+
+    private active?: RestartCycle;
+    private stateListener?: Listener;
+
+    public constructor(
+        loggerFactory: LoggerFactory,
+        private manager: Manager,
+        private metrics: Metrics,
+        private eventBus: EventBus,
+    ) {
+        super(loggerFactory.createLogger('RestartTracer'));
+    }
+
+    public async start(): Promise<void> {
+        this.stateListener?.off();
+        this.stateListener = this.eventBus.on(
+            InternalEventTypes.MONITOR_STATE_CHANGE,
+            /* istanbul ignore next */ (state: ServerState, previousState: ServerState) => this.onStateChange(state, previousState),
+        );
+    }
+
+    public async stop(): Promise<void> {
+        this.stateListener?.off();
+        this.stateListener = undefined;
+        this.timers.removeAllTimers();
+        this.active = undefined;
+    }
+
+    public get activeCycle(): RestartCycle | undefined {
+        return this.active;
+    }
+
+    /**
+     * starts a new cycle if none is active (and the tracer is running)
+     */
+    public beginCycle(reason: RestartCycleReason): void {
+        if (this.active || !this.stateListener) {
+            return;
+        }
+        this.active = {
+            reason,
+            start: Date.now(),
+            complete: false,
+            spans: [],
+            regressions: [],
+        };
+        this.log.log(LogLevel.DEBUG, `Restart cycle started (${reason})`);
+        this.timers.addTimeout('cycleTimeout', /* istanbul ignore next */ () => void this.endCycle(), RestartTracer.CYCLE_TIMEOUT);
+    }
+
+    /**
+     * begins a phase of the active cycle, phases are only traced once per cycle
+     */
+    public begin(phase: RestartPhase): void {
+        if (!this.active || this.active.spans.some((x) => x.phase === phase)) {
+            return;
+        }
+        this.active.spans.push({ phase, start: Date.now() });
+    }
+
+    public end(phase: RestartPhase): void {
+        const span = this.active?.spans.find((x) => x.phase === phase);
+        if (!span || span.end !== undefined) {
+            return;
+        }
+        span.end = Date.now();
+        span.duration = span.end - span.start;
+        this.checkDone();
+    }
+
+    public async span<T>(phase: RestartPhase, fnc: () => Promise<T>): Promise<T> {
+        this.begin(phase);
+        try {
+            return await fnc();
+        } finally {
+            this.end(phase);
+        }
+    }
+
+    public async getTrace(since?: number): Promise<RestartTrace> {
+        const cycles = await this.metrics.fetchMetrics(MetricTypeEnum.RESTART_CYCLE, since);
+        return {
+            active: this.active,
+            cycles: cycles.map((x) => x.value as RestartCycle),
+        };
+    }
+
+    private async onStateChange(state: ServerState, previousState: ServerState): Promise<void> {
+        if (state === ServerState.STOPPED) {
+            if (!this.active && previousState === ServerState.STARTED) {
+                this.beginCycle('crash');
+            }
+            this.end('stopDetection');
+        } else if (state === ServerState.STARTED && this.active && !this.active.started) {
+            const cycle = this.active;
+            this.end('startupGrace');
+            this.end('boot');
+
+            if (this.manager.config.ingameReportEnabled !== false) {
+                this.begin('firstReport');
+            }
+            this.begin('rconLogin');
+            cycle.started = Date.now();
+            cycle.downtime = cycle.started - cycle.start;
+            this.timers.removeTimer('cycleTimeout');
+            this.timers.addTimeout('cycleTimeout', /* istanbul ignore next */ () => void this.endCycle(), RestartTracer.READY_TIMEOUT);
+
+            // rcon is not used without battleye
+            const serverCfg = await this.manager.getServerCfg().catch(/* istanbul ignore next */ () => undefined);
+            if (serverCfg?.BattlEye === 0) {
+                cycle.spans = cycle.spans.filter((x) => x.phase !== 'rconLogin');
+            }
+            this.checkDone();
+        }
+    }
+
+    private checkDone(): void {
+        if (this.active?.started && this.active.spans.every((x) => x.end !== undefined)) {
+            this.active.complete = true;
+            void this.endCycle();
+        }
+    }
+
+    private async endCycle(): Promise<void> {
+        const cycle = this.active;
+        if (!cycle) {
+            return;
+        }
+        this.active = undefined;
+        this.timers.removeTimer('cycleTimeout');
+
+        cycle.end = Date.now();
+        cycle.duration = cycle.end - cycle.start;
+
+        try {
+            cycle.regressions = await this.findRegressions(cycle);
+        } catch (e) {
+            this.log.log(LogLevel.WARN, 'Failed to compare restart cycle with previous cycles', e);
+        }
+
+        this.log.log(
+            cycle.complete ? LogLevel.INFO : LogLevel.WARN,
+            `Restart cycle (${cycle.reason}) ${cycle.complete ? 'done' : 'timed out'} after ${Math.round(cycle.duration / 1000)}s, `
+                + `downtime: ${cycle.downtime === undefined ? '-' : `${Math.round(cycle.downtime / 1000)}s`}, phases: `
+                + cycle.spans.map((x) => `${x.phase} ${x.duration === undefined ? '-' : `${(x.duration / 1000).toFixed(1)}s`}`).join(', '),
+        );
+
+        if (cycle.regressions.length) {
+            const msg = `Restart phases got slower: ${cycle.regressions.map(
+                (x) => `${x.phase} took ${(x.duration / 1000).toFixed(1)}s (usually ${(x.baseline / 1000).toFixed(1)}s)`,
+            ).join(', ')}`;
+            this.log.log(LogLevel.WARN, msg);
+            this.eventBus.emit(
+                InternalEventTypes.DISCORD_MESSAGE,
+                {
+                    type: 'admin',
+                    message: msg,
+                },
+            );
+        }
+
+        await this.metrics.pushMetricValue(MetricTypeEnum.RESTART_CYCLE, {
+            timestamp: cycle.start,
+            value: cycle,
+        });
+    }
+
+    private async findRegressions(cycle: RestartCycle): Promise<RestartRegression[]> {
+        const previous = (await this.metrics.fetchMetrics(MetricTypeEnum.RESTART_CYCLE))
+            .map((x) => x.value as RestartCycle)
+            .filter((x) => x.complete && x.reason === cycle.reason)
+            .slice(-RestartTracer.BASELINE_CYCLES);
+        if (!previous.length) {
+            return [];
+        }
+
+        const regressions: RestartRegression[] = [];
+        for (const span of cycle.spans) {
+            if (span.duration === undefined) {
+                continue;
+            }
+            const durations = previous
+                .map((x) => x.spans.find((y: RestartSpan) => y.phase === span.phase)?.duration)
+                .filter((x) => x !== undefined)
+                .sort((a, b) => a - b);
+            if (!durations.length) {
+                continue;
+            }
+            const baseline = durations[Math.floor(durations.length / 2)];
+            if (
+                span.duration > baseline * RestartTracer.REGRESSION_FACTOR
+                && span.duration - baseline >= RestartTracer.REGRESSION_MIN_DIFF
+            ) {
+                regressions.push({ phase: span.phase, duration: span.duration, baseline });
+            }
+        }
+        return regressions;
+    }
+
+}
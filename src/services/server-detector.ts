@@ -61,6 +61,17 @@ export class ServerDetector extends IService {
             });
     }
 
+    /**
+     * Checks whether a previously detected server process has exited without fetching the process list
+     */
+    public hasServerExited(): boolean {
+        if (this.processes.isTrackedProcessRunning(this.manager.getServerExePath()) !== false) {
+            return false;
+        }
+        this.lastServerCheckResult = undefined;
+        return true;
+    }
+
     public async isServerRunning(): Promise<boolean> {
         const processes = await this.getDayZProcesses();
         return processes.length > 0;
@@ -17,6 +17,8 @@ import { FSAPI, InjectionTokens } from '../util/apis';
 import { ServerDetector } from './server-detector';
 import { EventBus } from '../control/event-bus';
 import { InternalEventTypes } from '../types/events';
+import { ResourceProfiles } from './resource-profiles';
+import { RestartTracer } from './restart-tracer';
 
 @singleton()
 @injectable()
@@ -31,6 +33,8 @@ export class ServerStarter extends IService {
         private steamCmd: SteamCMD,
         private eventBus: EventBus,
         private hooks: Hooks,
+        private resourceProfiles: ResourceProfiles,
+        private restartTracer: RestartTracer,
         @inject(InjectionTokens.fs) private fs: FSAPI,
     ) {
         super(loggerFactory.createLogger('ServerStarter'));
@@ -105,40 +109,59 @@ export class ServerStarter extends IService {
 
     private async prepareServerStart(skipPrep?: boolean): Promise<void> {
 
+        // swap in staged updates (or roll them back) while the server is down
+        await this.restartTracer.span('preStart', async () => Promise.all(
+            await this.eventBus.request(InternalEventTypes.SERVER_PRE_START),
+        ));
+
         if (!skipPrep) {
+            // updates are installed by swapping in the staged server
+            const stagedUpdates = !!this.manager.config.stagedUpdates;
+
             // Server
-            if (!await this.steamCmd.checkServer() || this.manager.config.updateServerBeforeServerStart) {
-                await this.steamCmd.updateServer();
-            }
-            if (!await this.steamCmd.checkServer()) {
-                throw new Error('Server installation failed. Server executable not found. Check the steam cmd logs and your settings for wrong paths or wrong executable names');
-            }
+            await this.restartTracer.span('serverCheck', async () => {
+                if (
+                    !await this.steamCmd.checkServer()
+                    || (!stagedUpdates && this.manager.config.updateServerBeforeServerStart)
+                ) {
+                    await this.steamCmd.updateServer();
+                }
+                if (!await this.steamCmd.checkServer()) {
+                    throw new Error('Server installation failed. Server executable not found. Check the steam cmd logs and your settings for wrong paths or wrong executable names');
+                }
+            });
 
             // Mods
-            if (!await this.steamCmd.checkMods() || this.manager.config.updateModsBeforeServerStart) {
-                if (!await this.steamCmd.updateAllMods()) {
-                    throw new Error('Mod update failed');
+            await this.restartTracer.span('modCheck', async () => {
+                const modsInstalled = await this.steamCmd.checkMods();
+                if (!modsInstalled || (!stagedUpdates && this.manager.config.updateModsBeforeServerStart)) {
+                    // install the updated mods while the rest is downloading
+                    if (!await this.steamCmd.updateAllMods({ install: true })) {
+                        throw new Error('Mod update failed');
+                    }
                 }
-            }
-            if (!await this.steamCmd.installMods()) {
-                throw new Error('Mod installation failed');
-            }
-            if (!await this.steamCmd.checkMods()) {
-                throw new Error('Mod installation failed');
-            }
+                if ((!modsInstalled || !stagedUpdates) && !await this.steamCmd.installMods()) {
+                    throw new Error('Mod installation failed');
+                }
+                if (!await this.steamCmd.checkMods()) {
+                    throw new Error('Mod installation failed');
+                }
+            });
         }
 
-        // install internal mods
-        await Promise.all(
-            await this.eventBus.request(InternalEventTypes.INTERNAL_MOD_INSTALL),
-        );
+        await this.restartTracer.span('prepare', async () => {
+            // install internal mods
+            await Promise.all(
+                await this.eventBus.request(InternalEventTypes.INTERNAL_MOD_INSTALL),
+            );
 
-        // battleye / rcon
-        await this.rcon?.createBattleyeConf();
+            // battleye / rcon
+            await this.rcon?.createBattleyeConf();
 
-        await this.writeServerCfg();
+            await this.writeServerCfg();
 
-        await this.adjustDayzSettingXml();
+            await this.adjustDayzSettingXml();
+        });
 
     }
 
@@ -233,12 +256,12 @@ export class ServerStarter extends IService {
         await this.prepareServerStart(skipPrep);
         this.log.log(LogLevel.DEBUG, 'Server start prep done');
 
-        await this.hooks.executeHooks(HookTypeEnum.beforeStart);
+        await this.restartTracer.span('hooks', () => this.hooks.executeHooks(HookTypeEnum.beforeStart));
         this.log.log(LogLevel.DEBUG, 'Server start hooks done');
 
-        const spawnCmd = this.buildServerSpawnCmd();
+        const spawnCmd = this.resourceProfiles.wrapServerSpawnCmd(this.buildServerSpawnCmd());
         const args = await this.buildStartServerArgs();
-        return new Promise<boolean>((res, rej) => {
+        return this.restartTracer.span('spawn', () => new Promise<boolean>((res, rej) => {
             try {
                 let usedArgs = [
                     ...spawnCmd.args,
@@ -279,7 +302,7 @@ export class ServerStarter extends IService {
             } catch (e) {
                 rej(e);
             }
-        });
+        }));
     }
 
 }
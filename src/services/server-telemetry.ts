@@ -0,0 +1,313 @@
+import { inject, injectable, singleton } from 'tsyringe';
+import { Manager } from '../control/manager';
+import { IStatefulService } from '../types/service';
+import { LoggerFactory } from './loggerfactory';
+import { ServerDetector } from './server-detector';
+import { Monitor } from './monitor';
+import { Metrics } from './metrics';
+import { FSAPI, InjectionTokens } from '../util/apis';
+import { LogLevel } from '../util/logger';
+import { detectOS } from '../util/detect-os';
+import { ServerState } from '../types/monitor';
+import { MetricTypeEnum } from '../types/metrics';
+import { RingBuffer } from '../util/ring-buffer';
+import {
+    ServerTelemetryRollup,
+    ServerTelemetrySample,
+    ThreadTelemetry,
+} from '../types/server-telemetry';
+
+// see https://man7.org/linux/man-pages/man5/proc.5.html
+// cpu times are reported in clock ticks, which are 100 per second on basically all linux systems
+const CLOCK_TICKS = 100;
+
+interface RawThreadStats {
+    name: string;
+    ticks: number;
+    ctxSwitches: number;
+    ctxSwitchesInvoluntary: number;
+}
+
+interface RawProcessStats {
+    timestamp: number;
+    pid: string;
+    ticks: number;
+    threads: Map<string, RawThreadStats>;
+    rss: number;
+    swap: number;
+    ioRead: number;
+    ioWrite: number;
+    openFds: number;
+}
+
+@singleton()
+@injectable()
+export class ServerTelemetry extends IStatefulService {
+
+    public sampleIntervall = 1000;
+
+    // amount of threads stored per sample
+    public maxThreadsPerSample = 10;
+
+    private samples: RingBuffer<ServerTelemetrySample> = new RingBuffer(300);
+    private prevStats?: RawProcessStats;
+    private sampleRunning = false;
+    private lastRollup = 0;
+
+    public constructor(
+        loggerFactory: LoggerFactory,
+        private manager: Manager,
+        private monitor: Monitor,
+        private serverDetector: ServerDetector,
+        private metrics: Metrics,
+        @inject(InjectionTokens.fs) private fs: FSAPI,
+    ) {
+        super(loggerFactory.createLogger('ServerTelemetry'));
+    }
+
+    public async start(): Promise<void> {
+        await this.stop();
+
+        if (!this.manager.config.serverTelemetry) {
+            return;
+        }
+
+        if (detectOS() === 'windows') {
+            this.log.log(LogLevel.WARN, 'Server telemetry is only supported on linux');
+            return;
+        }
+
+        this.samples = new RingBuffer(this.manager.config.serverTelemetryBufferSize || 300);
+        this.lastRollup = new Date().valueOf();
+
+        this.timers.addInterval(
+            'sample',
+            /* istanbul ignore next */ () => {
+                if (this.sampleRunning) return;
+                this.sampleRunning = true;
+                const cb = (): void => {
+                    this.sampleRunning = false;
+                };
+                this.sample().then(cb, cb);
+            },
+            this.sampleIntervall,
+        );
+        this.timers.addInterval(
+            'rollup',
+            /* istanbul ignore next */ () => void this.rollup(),
+            this.manager.config.metricPollIntervall,
+        );
+    }
+
+    public async stop(): Promise<void> {
+        this.timers.removeAllTimers();
+        this.prevStats = undefined;
+        this.sampleRunning = false;
+    }
+
+    /**
+     * @param since only return samples newer than this timestamp
+     * @returns the samples kept in memory ordered from oldest to newest
+     */
+    public getSamples(since?: number): ServerTelemetrySample[] {
+        return this.samples.toArray(since ? (x) => x.timestamp > since : undefined);
+    }
+
+    public async sample(): Promise<ServerTelemetrySample | undefined> {
+        if (this.monitor.serverState !== ServerState.STARTED) {
+            this.prevStats = undefined;
+            return undefined;
+        }
+
+        const pid = (await this.serverDetector.getDayZProcesses())?.[0]?.ProcessId;
+        if (!pid) {
+            this.prevStats = undefined;
+            return undefined;
+        }
+
+        let stats: RawProcessStats;
+        try {
+            stats = await this.readProcessStats(pid);
+        } catch (e) {
+            this.log.log(LogLevel.DEBUG, `Failed to read telemetry of process ${pid}`, e);
+            this.prevStats = undefined;
+            return undefined;
+        }
+
+        const prev = this.prevStats;
+        this.prevStats = stats;
+        if (prev?.pid !== pid || stats.timestamp <= prev.timestamp) {
+            return undefined;
+        }
+
+        const seconds = (stats.timestamp - prev.timestamp) / 1000;
+        const rate = (cur: number, before: number): number => Math.max(0, cur - before) / seconds;
+        const cpu = (cur: number, before: number): number => Math.round(rate(cur, before) / CLOCK_TICKS * 1000) / 10;
+
+        const threads: ThreadTelemetry[] = [];
+        let ctxSwitches = 0;
+        let ctxSwitchesInvoluntary = 0;
+        for (const [tid, thread] of stats.threads) {
+            const prevThread = prev.threads.get(tid);
+            if (!prevThread) continue;
+            threads.push({
+                tid,
+                name: thread.name,
+                cpu: cpu(thread.ticks, prevThread.ticks),
+            });
+            ctxSwitches += rate(thread.ctxSwitches, prevThread.ctxSwitches);
+            ctxSwitchesInvoluntary += rate(thread.ctxSwitchesInvoluntary, prevThread.ctxSwitchesInvoluntary);
+        }
+        threads.sort((a, b) => b.cpu - a.cpu);
+
+        const sample: ServerTelemetrySample = {
+            timestamp: stats.timestamp,
+            pid,
+            cpu: cpu(stats.ticks, prev.ticks),
+            threads: threads.slice(0, this.maxThreadsPerSample),
+            threadCount: stats.threads.size,
+            rss: stats.rss,
+            swap: stats.swap,
+            ioRead: Math.round(rate(stats.ioRead, prev.ioRead)),
+            ioWrite: Math.round(rate(stats.ioWrite, prev.ioWrite)),
+            ctxSwitches: Math.round(ctxSwitches),
+            ctxSwitchesInvoluntary: Math.round(ctxSwitchesInvoluntary),
+            openFds: stats.openFds,
+        };
+        this.samples.push(sample);
+        return sample;
+    }
+
+    public async rollup(): Promise<ServerTelemetryRollup | undefined> {
+        const samples = this.getSamples(this.lastRollup);
+        if (!samples.length) {
+            return undefined;
+        }
+        this.lastRollup = samples[samples.length - 1].timestamp;
+
+        const avg = (fnc: (x: ServerTelemetrySample) => number): number => {
+            return Math.round(samples.reduce((sum, x) => sum + fnc(x), 0) / samples.length * 10) / 10;
+        };
+        const max = (fnc: (x: ServerTelemetrySample) => number): number => {
+            return samples.reduce((prev, x) => Math.max(prev, fnc(x)), 0);
+        };
+
+        const threadSums = new Map<string, ThreadTelemetry>();
+        for (const sample of samples) {
+            for (const thread of sample.threads) {
+                const sum = threadSums.get(thread.tid);
+                if (sum) {
+                    sum.cpu += thread.cpu;
+                } else {
+                    threadSums.set(thread.tid, { ...thread });
+                }
+            }
+        }
+        const threads = [...threadSums.values()]
+            .map((x) => ({ ...x, cpu: Math.round(x.cpu / samples.length * 10) / 10 }))
+            .sort((a, b) => b.cpu - a.cpu)
+            .slice(0, this.maxThreadsPerSample);
+
+        const rollup: ServerTelemetryRollup = {
+            samples: samples.length,
+            cpuAvg: avg((x) => x.cpu),
+            cpuMax: max((x) => x.cpu),
+            rssMax: max((x) => x.rss),
+            swapMax: max((x) => x.swap),
+            ioReadAvg: avg((x) => x.ioRead),
+            ioWriteAvg: avg((x) => x.ioWrite),
+            ctxSwitchesAvg: avg((x) => x.ctxSwitches),
+            ctxSwitchesInvoluntaryAvg: avg((x) => x.ctxSwitchesInvoluntary),
+            openFdsMax: max((x) => x.openFds),
+            threads,
+        };
+
+        try {
+            await this.metrics.pushMetricValue(MetricTypeEnum.SERVER_TELEMETRY, {
+                timestamp: this.lastRollup,
+                value: rollup,
+            });
+        } catch (e) {
+            this.log.log(LogLevel.WARN, 'Failed to push server telemetry', e);
+        }
+
+        return rollup;
+    }
+
+    private parseStatTicks(stat: string): { name: string; ticks: number } {
+        // the name is wrapped in parentheses and may contain spaces
+        const nameEnd = stat.lastIndexOf(')');
+        const fields = stat.slice(nameEnd + 2).split(' ');
+        return {
+            name: stat.slice(stat.indexOf('(') + 1, nameEnd),
+            // utime and stime are fields 14 and 15, the remaining fields start at field 3
+            ticks: Number(fields[11]) + Number(fields[12]),
+        };
+    }
+
+    private parseStatus(status: string): Record<string, number> {
+        const values: Record<string, number> = {};
+        for (const line of status.split('\n')) {
+            const sep = line.indexOf(':');
+            if (sep > 0) {
+                // values are either plain numbers or in kB
+                const value = line.slice(sep + 1).trim();
+                values[line.slice(0, sep)] = parseInt(value, 10) * (value.endsWith('kB') ? 1024 : 1);
+            }
+        }
+        return values;
+    }
+
+    private async readThreadStats(pid: string, tid: string): Promise<RawThreadStats | undefined> {
+        try {
+            const [stat, status] = await Promise.all([
+                this.fs.promises.readFile(`/proc/${pid}/task/${tid}/stat`, { encoding: 'utf-8' }),
+                this.fs.promises.readFile(`/proc/${pid}/task/${tid}/status`, { encoding: 'utf-8' }),
+            ]);
+            const statusValues = this.parseStatus(status);
+            return {
+                ...this.parseStatTicks(stat),
+                ctxSwitches: statusValues['voluntary_ctxt_switches'] || 0,
+                ctxSwitchesInvoluntary: statusValues['nonvoluntary_ctxt_switches'] || 0,
+            };
+        } catch {
+            // thread exited in between
+            return undefined;
+        }
+    }
+
+    private async readProcessStats(pid: string): Promise<RawProcessStats> {
+        const timestamp = new Date().valueOf();
+        const [stat, status, io, fds, tids] = await Promise.all([
+            this.fs.promises.readFile(`/proc/${pid}/stat`, { encoding: 'utf-8' }),
+            this.fs.promises.readFile(`/proc/${pid}/status`, { encoding: 'utf-8' }),
+            // io is only readable with the same permissions as ptrace
+            this.fs.promises.readFile(`/proc/${pid}/io`, { encoding: 'utf-8' }).catch(/* istanbul ignore next */ () => ''),
+            this.fs.promises.readdir(`/proc/${pid}/fd`).catch(/* istanbul ignore next */ () => []),
+            this.fs.promises.readdir(`/proc/${pid}/task`),
+        ]);
+
+        const threads = new Map<string, RawThreadStats>();
+        const threadStats = await Promise.all(tids.map((tid) => this.readThreadStats(pid, tid)));
+        threadStats.forEach((x, i) => {
+            if (x) {
+                threads.set(tids[i], x);
+            }
+        });
+
+        const statusValues = this.parseStatus(status);
+        const ioValues = this.parseStatus(io);
+        return {
+            timestamp,
+            pid,
+            ticks: this.parseStatTicks(stat).ticks,
+            threads,
+            rss: statusValues['VmRSS'] || 0,
+            swap: statusValues['VmSwap'] || 0,
+            ioRead: ioValues['read_bytes'] || 0,
+            ioWrite: ioValues['write_bytes'] || 0,
+            openFds: fds.length,
+        };
+    }
+
+}
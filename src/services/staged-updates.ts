@@ -0,0 +1,410 @@
+import { inject, injectable, singleton } from 'tsyringe';
+import * as path from 'path';
+import { Manager } from '../control/manager';
+import { IStatefulService } from '../types/service';
+import { LoggerFactory } from './loggerfactory';
+import { Paths } from './paths';
+import { SteamCMD, SteamMetaData } from './steamcmd';
+import { Monitor } from './monitor';
+import { EventBus } from '../control/event-bus';
+import { FSAPI, InjectionTokens } from '../util/apis';
+import { LogLevel } from '../util/logger';
+import { ServerState } from '../types/monitor';
+import { InternalEventTypes } from '../types/events';
+import { StagedUpdateState, StagedUpdateStatus } from '../types/staged-updates';
+
+/**
+ * Prepares server and mod updates in a shadow copy of the server dir while the server is running.
+ *
+ * The shadow dir is swapped in by renaming the dirs when the server is started the next time.
+ * The state of the server (missions, profiles etc.) is moved over instead of being copied.
+ * If the new server does not stay started for the verification time, the previous server dir is restored at the next start.
+ */
+@singleton()
+@injectable()
+export class StagedUpdates extends IStatefulService {
+
+    public readonly STATUS_FILE = 'staged-update.json';
+    public readonly SEED_MANIFEST = 'staged-seed.sync.json';
+
+    public checkIntervall = 1000;
+
+    /** how long the swapped in server may take to reach STARTED */
+    public startTimeout = 10 * 60 * 1000;
+
+    private status?: StagedUpdateStatus;
+    private preparing = false;
+    private startedSince = 0;
+
+    public constructor(
+        loggerFactory: LoggerFactory,
+        private manager: Manager,
+        private paths: Paths,
+        private steamCmd: SteamCMD,
+        private steamMetaData: SteamMetaData,
+        private monitor: Monitor,
+        private eventBus: EventBus,
+        @inject(InjectionTokens.fs) private fs: FSAPI,
+    ) {
+        super(loggerFactory.createLogger('StagedUpdates'));
+
+        this.eventBus.on(
+            InternalEventTypes.SERVER_PRE_START,
+            /* istanbul ignore next */ () => this.applyPending(),
+        );
+    }
+
+    public async start(): Promise<void> {
+        await this.stop();
+
+        if (this.getStatus().state === 'verifying') {
+            this.startVerification();
+        }
+
+        const prepareIntervall = this.manager.config.stagedUpdatesPrepareIntervall;
+        if (this.manager.config.stagedUpdates && prepareIntervall > 0) {
+            this.timers.addInterval(
+                'prepare',
+                /* istanbul ignore next */ () => {
+                    if (this.monitor.serverState !== ServerState.STARTED) return;
+                    void this.prepare();
+                },
+                prepareIntervall * 60 * 1000,
+            );
+        }
+    }
+
+    public async stop(): Promise<void> {
+        this.timers.removeAllTimers();
+    }
+
+    public getStagedPath(): string {
+        return `${this.manager.getServerPath()}-staged`;
+    }
+
+    public getPreviousPath(): string {
+        return `${this.manager.getServerPath()}-previous`;
+    }
+
+    private getStatusPath(): string {
+        return path.join(this.steamMetaData.getMetaDataPath(), this.STATUS_FILE);
+    }
+
+    public getStatus(): StagedUpdateStatus {
+        if (!this.status) {
+            try {
+                this.status = JSON.parse(this.fs.readFileSync(this.getStatusPath(), { encoding: 'utf-8' }));
+            } catch {
+                // nothing staged yet
+            }
+            this.status = this.status ?? { state: 'none', since: 0 };
+        }
+        return this.status;
+    }
+
+    private setStatus(state: StagedUpdateState, patch?: Partial<StagedUpdateStatus>): void {
+        this.status = {
+            ...this.getStatus(),
+            ...patch,
+            state,
+            since: new Date().valueOf(),
+        };
+        try {
+            this.fs.mkdirSync(path.dirname(this.getStatusPath()), { recursive: true });
+            this.fs.writeFileSync(this.getStatusPath(), JSON.stringify(this.status));
+        } catch (e) {
+            this.log.log(LogLevel.ERROR, 'Failed to write the staged update status', e);
+        }
+    }
+
+    /**
+     * @returns the relative paths in the server dir, which belong to the running server and are moved instead of updated
+     */
+    public getStatePaths(): string[] {
+        const statePaths = [...(this.manager.config.stagedUpdatesStatePaths ?? [])];
+        for (const configured of [this.manager.config.profilesPath, this.manager.config.serverCfgPath]) {
+            if (configured && !this.paths.isAbsolute(configured)) {
+                statePaths.push(configured);
+            }
+        }
+        return [...new Set(
+            statePaths
+                .map((x) => path.normalize(x))
+                .filter((x) => !!x && x !== '.' && !x.startsWith('..')),
+        )];
+    }
+
+    /**
+     * Updates the shadow server dir, so it can be swapped in at the next server start
+     */
+    public async prepare(): Promise<boolean> {
+        if (this.preparing) {
+            this.log.log(LogLevel.WARN, 'Staged update is already being prepared');
+            return false;
+        }
+        const state = this.getStatus().state;
+        if (state === 'verifying' || state === 'rollback') {
+            this.log.log(LogLevel.WARN, `Cannot prepare a staged update while the last one is in state ${state}`);
+            return false;
+        }
+        if ((this.manager.config.linkModFiles ?? 'off') !== 'off' || this.manager.config.linkModDirs) {
+            // the mods are updated in the workshop, which would change the files of the running server through the links
+            const msg = 'Cannot prepare a staged update while linkModFiles or linkModDirs is enabled, the mods must be copied';
+            this.log.log(LogLevel.WARN, msg);
+            this.setStatus('none', { lastError: msg });
+            return false;
+        }
+
+        this.preparing = true;
+        this.setStatus('preparing');
+        try {
+            const serverPath = this.manager.getServerPath();
+            const stagedPath = this.getStagedPath();
+
+            this.log.log(LogLevel.IMPORTANT, `Preparing staged update in ${stagedPath}`);
+            if (this.fs.existsSync(serverPath)) {
+                const modNames = this.manager.getCombinedModIdList()
+                    .map((modId) => this.steamCmd.getWsModName(modId))
+                    .filter((x) => !!x);
+                if (!await this.paths.syncDirFromTo(
+                    serverPath,
+                    stagedPath,
+                    {
+                        manifestPath: path.join(this.steamMetaData.getMetaDataPath(), this.SEED_MANIFEST),
+                        // state is moved over at the swap and mods are installed from the workshop
+                        exclude: [...this.getStatePaths(), ...modNames],
+                    },
+                )) {
+                    throw new Error('Failed to copy the server to the staged dir');
+                }
+            }
+
+            if (!await this.steamCmd.updateServer({ serverPath: stagedPath })) {
+                throw new Error('Failed to update the staged server');
+            }
+            if (!await this.steamCmd.updateAllMods()) {
+                throw new Error('Failed to update the mods');
+            }
+            if (!await this.steamCmd.installMods(stagedPath)) {
+                throw new Error('Failed to install the mods to the staged server');
+            }
+
+            this.setStatus('ready', { lastError: undefined });
+            this.log.log(LogLevel.IMPORTANT, 'Staged update is ready and will be applied at the next server start');
+            return true;
+        } catch (e) {
+            this.log.log(LogLevel.ERROR, 'Preparing the staged update failed', e);
+            this.setStatus('none', { lastError: e?.message ?? String(e) });
+            return false;
+        } finally {
+            this.preparing = false;
+        }
+    }
+
+    /**
+     * Called before the server is started.
+     * Swaps in a ready staged update or restores the previous server, if the last swapped in server failed.
+     *
+     * @returns true if the server dir was changed
+     */
+    public async applyPending(): Promise<boolean> {
+        if (this.preparing) {
+            this.log.log(LogLevel.WARN, 'Staged update is still being prepared, it will be applied at the next start');
+            return false;
+        }
+
+        switch (this.getStatus().state) {
+            case 'ready': {
+                if (!this.manager.config.stagedUpdates) {
+                    return false;
+                }
+                return this.swap();
+            }
+            case 'verifying': {
+                // the server is started again before it was verified, so it crashed or was stopped
+                this.log.log(LogLevel.ERROR, 'The staged update did not start successfully');
+                return this.rollback();
+            }
+            case 'rollback': {
+                return this.rollback();
+            }
+            default: {
+                return false;
+            }
+        }
+    }
+
+    private moveStatePaths(from: string, to: string, undo: (() => void)[]): void {
+        for (const statePath of this.getStatePaths()) {
+            const source = path.join(from, statePath);
+            const target = path.join(to, statePath);
+            if (!this.fs.existsSync(source)) {
+                continue;
+            }
+            if (this.fs.existsSync(target)) {
+                this.fs.rmSync(target, { recursive: true, force: true });
+            }
+            this.fs.mkdirSync(path.dirname(target), { recursive: true });
+            this.fs.renameSync(source, target);
+            undo.push(() => this.fs.renameSync(target, source));
+        }
+    }
+
+    private runUndo(undo: (() => void)[]): void {
+        for (const step of undo.reverse()) {
+            try {
+                step();
+            } catch (e) {
+                this.log.log(LogLevel.ERROR, 'Failed to revert a step of the server dir swap', e);
+            }
+        }
+    }
+
+    /**
+     * Removes the sync manifests of the staged dir, because the synced trees were swapped
+     */
+    private clearStagedManifests(): void {
+        const metaPath = this.steamMetaData.getMetaDataPath();
+        if (!this.fs.existsSync(metaPath)) {
+            return;
+        }
+        for (const file of this.fs.readdirSync(metaPath)) {
+            if (file === this.SEED_MANIFEST || file.endsWith('.staged.sync.json')) {
+                this.fs.unlinkSync(path.join(metaPath, file));
+            }
+        }
+    }
+
+    private async swap(): Promise<boolean> {
+        const serverPath = this.manager.getServerPath();
+        const stagedPath = this.getStagedPath();
+        const previousPath = this.getPreviousPath();
+
+        if (!this.fs.existsSync(stagedPath)) {
+            this.setStatus('none', { lastError: 'Staged server dir not found' });
+            return false;
+        }
+
+        this.log.log(LogLevel.IMPORTANT, 'Swapping in the staged update');
+        const undo: (() => void)[] = [];
+        try {
+            if (this.fs.existsSync(previousPath)) {
+                this.fs.rmSync(previousPath, { recursive: true, force: true });
+            }
+            this.moveStatePaths(serverPath, stagedPath, undo);
+            if (this.fs.existsSync(serverPath)) {
+                this.fs.renameSync(serverPath, previousPath);
+                undo.push(() => this.fs.renameSync(previousPath, serverPath));
+            }
+            this.fs.renameSync(stagedPath, serverPath);
+        } catch (e) {
+            this.log.log(LogLevel.ERROR, 'Swapping in the staged update failed', e);
+            this.runUndo(undo);
+            this.setStatus('none', { lastError: e?.message ?? String(e) });
+            return false;
+        }
+
+        this.clearStagedManifests();
+        this.setStatus('verifying', { lastSwap: new Date().valueOf(), lastError: undefined });
+        this.startVerification();
+        return true;
+    }
+
+    private async rollback(): Promise<boolean> {
+        const serverPath = this.manager.getServerPath();
+        const stagedPath = this.getStagedPath();
+        const previousPath = this.getPreviousPath();
+        this.timers.removeTimer('verify');
+
+        if (!this.fs.existsSync(previousPath)) {
+            this.log.log(LogLevel.ERROR, 'Cannot roll back the staged update, the previous server dir is missing');
+            this.setStatus('none', { lastError: 'Previous server dir not found' });
+            return false;
+        }
+
+        this.log.log(LogLevel.IMPORTANT, 'Rolling back to the previous server');
+        const undo: (() => void)[] = [];
+        try {
+            if (this.fs.existsSync(stagedPath)) {
+                this.fs.rmSync(stagedPath, { recursive: true, force: true });
+            }
+            this.moveStatePaths(serverPath, previousPath, undo);
+            // the failed server is kept as base for the next staged update
+            this.fs.renameSync(serverPath, stagedPath);
+            undo.push(() => this.fs.renameSync(stagedPath, serverPath));
+            this.fs.renameSync(previousPath, serverPath);
+        } catch (e) {
+            this.log.log(LogLevel.ERROR, 'Rolling back the staged update failed', e);
+            this.runUndo(undo);
+            this.setStatus('rollback', { lastError: e?.message ?? String(e) });
+            return false;
+        }
+
+        this.clearStagedManifests();
+        this.setStatus('none', { lastRollback: new Date().valueOf() });
+        return true;
+    }
+
+    private commit(): void {
+        const stagedPath = this.getStagedPath();
+        const previousPath = this.getPreviousPath();
+        this.timers.removeTimer('verify');
+
+        this.log.log(LogLevel.IMPORTANT, 'Staged update started successfully');
+        try {
+            // the previous server is kept as base for the next staged update
+            if (this.fs.existsSync(previousPath)) {
+                if (this.fs.existsSync(stagedPath)) {
+                    this.fs.rmSync(previousPath, { recursive: true, force: true });
+                } else {
+                    this.fs.renameSync(previousPath, stagedPath);
+                }
+            }
+        } catch (e) {
+            this.log.log(LogLevel.WARN, 'Failed to clean up the previous server dir', e);
+        }
+        this.setStatus('none', { lastCommit: new Date().valueOf() });
+    }
+
+    private startVerification(): void {
+        this.startedSince = 0;
+        this.timers.removeTimer('verify');
+        this.timers.addInterval(
+            'verify',
+            /* istanbul ignore next */ () => {
+                void this.checkVerification();
+            },
+            this.checkIntervall,
+        );
+    }
+
+    /**
+     * Commits the swapped in server once it stayed started for the verification time.
+     * Servers that do not start in time are killed and rolled back at the next start.
+     */
+    public async checkVerification(): Promise<void> {
+        const status = this.getStatus();
+        if (status.state !== 'verifying') {
+            this.timers.removeTimer('verify');
+            return;
+        }
+
+        const now = new Date().valueOf();
+        if (this.monitor.serverState === ServerState.STARTED) {
+            this.startedSince = this.startedSince || now;
+            if ((now - this.startedSince) >= (this.manager.config.stagedUpdatesVerifyTime ?? 0) * 1000) {
+                this.commit();
+            }
+            return;
+        }
+
+        this.startedSince = 0;
+        if ((now - status.since) > this.startTimeout) {
+            this.log.log(LogLevel.ERROR, 'The staged update did not start in time');
+            this.timers.removeTimer('verify');
+            this.setStatus('rollback');
+            await this.monitor.killServer(true);
+        }
+    }
+
+}
@@ -3,7 +3,6 @@ import { Manager } from '../control/manager';
 import { Paths } from '../services/paths';
 import { Processes, SpawnOutput } from '../services/processes';
 import { LogLevel } from '../util/logger';
-import { sameDirHash } from '../util/compare-folders';
 import { IService } from '../types/service';
 import { detectOS } from '../util/detect-os';
 import { inject, injectable, singleton } from 'tsyringe';
@@ -12,9 +11,12 @@ import { FSAPI, HTTPSAPI, InjectionTokens } from '../util/apis';
 import { Downloader } from './download';
 import { merge } from '../util/merge';
 import { request } from '../util/request';
-import { DAYZ_APP_ID, DAYZ_EXPERIMENTAL_SERVER_APP_ID, DAYZ_SERVER_APP_ID, LocalMetaData, PublishedFileDetail, SteamApiWorkshopItemDetailsResponse, SteamCmdAppUpdateProgressEvent, SteamCmdEvent, SteamCmdEventListener, SteamCmdExitEvent, SteamCmdModUpdateProgressEvent, SteamCmdOutputEvent, SteamCmdRetryEvent, SteamExitCodes } from '../types/steamcmd';
+import { DAYZ_APP_ID, DAYZ_EXPERIMENTAL_SERVER_APP_ID, DAYZ_SERVER_APP_ID, LocalMetaData, ModUpdateTimeline, ModUpdateTimelineBatch, PublishedFileDetail, SteamApiWorkshopItemDetailsResponse, SteamCmdAppUpdateProgressEvent, SteamCmdEvent, SteamCmdEventListener, SteamCmdExitEvent, SteamCmdModUpdateProgressEvent, SteamCmdModUpdateTimelineEvent, SteamCmdOutputEvent, SteamCmdRetryEvent, SteamExitCodes, WorkshopMetaDataCacheEntry } from '../types/steamcmd';
 import { EventBus } from '../control/event-bus';
 import { InternalEventTypes } from '../types/events';
+import { Prometheus } from './prometheus';
+import { KeyedMutex } from '../util/keyed-mutex';
+import { WorkerPool } from './worker-pool';
 
 @singleton()
 @injectable()
@@ -23,7 +25,12 @@ export class SteamMetaData extends IService {
     private gameLastCheck: number;
     private gameMetaData: PublishedFileDetail[];
 
-    private workshopMetaData: Map<string, { lastCheck: number; data: PublishedFileDetail }> = new Map();
+    private readonly WORKSHOP_CACHE_FILE = 'workshop-cache.json';
+    // maximum number of items per workshop details request
+    private readonly WORKSHOP_BATCH_SIZE = 100;
+
+    // lazy loaded from the persisted cache
+    private workshopMetaData?: Map<string, WorkshopMetaDataCacheEntry>;
 
     public constructor(
         loggerFactory: LoggerFactory,
@@ -35,7 +42,7 @@ export class SteamMetaData extends IService {
         super(loggerFactory.createLogger('SteamAPI'));
     }
 
-    private getMetaDataPath(): string {
+    public getMetaDataPath(): string {
         let metaFolder = this.manager.config?.steamMetaPath ?? '';
         if (!this.paths.isAbsolute(metaFolder)) {
             metaFolder = path.join(this.paths.cwd(), metaFolder);
@@ -86,38 +93,107 @@ export class SteamMetaData extends IService {
         });
     }
 
-    public async getModsMetaData(modIds: string[]): Promise<PublishedFileDetail[]> {
+    private getWorkshopCache(): Map<string, WorkshopMetaDataCacheEntry> {
+        if (!this.workshopMetaData) {
+            this.workshopMetaData = new Map();
+            const cachePath = path.join(this.getMetaDataPath(), this.WORKSHOP_CACHE_FILE);
+            try {
+                if (this.fs.existsSync(cachePath)) {
+                    const cache: Record<string, WorkshopMetaDataCacheEntry> = JSON.parse(
+                        this.fs.readFileSync(cachePath, { encoding: 'utf-8' }),
+                    );
+                    for (const modId of Object.keys(cache)) {
+                        this.workshopMetaData.set(modId, cache[modId]);
+                    }
+                }
+            } catch (e) {
+                this.log.log(LogLevel.WARN, 'Failed to read the workshop metadata cache', e);
+            }
+        }
+        return this.workshopMetaData;
+    }
+
+    private writeWorkshopCache(): void {
+        const cache: Record<string, WorkshopMetaDataCacheEntry> = {};
+        for (const [modId, entry] of this.getWorkshopCache()) {
+            cache[modId] = entry;
+        }
+        try {
+            this.fs.mkdirSync(this.getMetaDataPath(), { recursive: true });
+            this.fs.writeFileSync(
+                path.join(this.getMetaDataPath(), this.WORKSHOP_CACHE_FILE),
+                JSON.stringify(cache),
+            );
+        } catch (e) {
+            this.log.log(LogLevel.WARN, 'Failed to write the workshop metadata cache', e);
+        }
+    }
+
+    /**
+     * @param opts.cachedOnly only returns what is cached, without requesting outdated entries
+     */
+    public async getModsMetaData(
+        modIds: string[],
+        opts?: {
+            cachedOnly?: boolean;
+        },
+    ): Promise<PublishedFileDetail[]> {
         if (!modIds?.length) {
             return [];
         }
 
-        const modInfos: PublishedFileDetail[] = [];
-        const requireUpdate: string[] = [];
+        const cache = this.getWorkshopCache();
+        const maxAge = (this.manager.config?.steamWorkshopMetaCacheTime ?? 300) * 1000;
+        const now = new Date().valueOf();
+        const requireUpdate = opts?.cachedOnly
+            ? []
+            : modIds.filter((modId) => {
+                const entry = cache.get(modId);
+                return !entry?.lastCheck || (now - entry.lastCheck) >= maxAge;
+            });
 
-        for (const modId of modIds) {
-            const cache = this.workshopMetaData.get(modId);
-            if (cache?.lastCheck && (new Date().valueOf() - cache.lastCheck) < 60000) {
-                modInfos.push(cache.data);
-            } else {
-                requireUpdate.push(modId);
+        if (requireUpdate.length) {
+            let updated = false;
+            for (let i = 0; i < requireUpdate.length; i += this.WORKSHOP_BATCH_SIZE) {
+                const batch = requireUpdate.slice(i, i + this.WORKSHOP_BATCH_SIZE);
+                const response = (await this.requestWorkshopItemDetails(batch))?.response?.publishedfiledetails || [];
+                for (const responseItem of response) {
+                    cache.set(
+                        responseItem.publishedfileid,
+                        {
+                            lastCheck: now,
+                            data: this.toCachedMetaData(responseItem),
+                        },
+                    );
+                    updated = true;
+                }
             }
-        }
-
-        if (requireUpdate?.length) {
-            const response = (await this.requestWorkshopItemDetails(requireUpdate))?.response?.publishedfiledetails || [];
-            for (const responseItem of response) {
-                this.workshopMetaData.set(
-                    responseItem.publishedfileid,
-                    {
-                        lastCheck: new Date().valueOf(),
-                        data: responseItem,
-                    },
-                );
-                modInfos.push(responseItem);
+            if (updated) {
+                this.writeWorkshopCache();
             }
         }
 
-        return [...modInfos];
+        // if a request failed, the outdated entries are still better than nothing
+        return modIds
+            .map((modId) => cache.get(modId)?.data as PublishedFileDetail)
+            .filter((x) => !!x);
+    }
+
+    /**
+     * only keeps what is needed for update checks and notifications, as the descriptions can be huge
+     */
+    private toCachedMetaData(data: PublishedFileDetail): Partial<PublishedFileDetail> {
+        /* eslint-disable @typescript-eslint/naming-convention */
+        return {
+            publishedfileid: data.publishedfileid,
+            result: data.result,
+            title: data.title,
+            file_size: data.file_size,
+            preview_url: data.preview_url,
+            time_created: data.time_created,
+            time_updated: data.time_updated,
+        };
+        /* eslint-enable @typescript-eslint/naming-convention */
     }
 
     public async requestWorkshopItemDetails(ids: string[]): Promise<SteamApiWorkshopItemDetailsResponse | null> {
@@ -164,6 +240,12 @@ export class SteamMetaData extends IService {
 @injectable()
 export class SteamCMD extends IService {
 
+    /**
+     * SteamCMD can not run twice in the same folder, the lock is process wide as instances share the folder.
+     * Workshop mod dirs are locked as well, so mods are not installed while they are downloaded.
+     */
+    private static readonly CMD_LOCK = new KeyedMutex();
+
     // time to wait after the zip has been extracted (to avoid errors)
     private extractDelay = 5000;
 
@@ -174,6 +256,10 @@ export class SteamCMD extends IService {
     private progressRegex = /Update state \(0x\d+\) (?<step>.*), progress: (?<progress>\d+.\d+) \((?<current>\d+) \/ (?<total>\d+)\)$/;
     private dlItemRegex = /Downloading item (?<item>\d+) \.\.\./;
 
+    public lastModUpdateTimeline?: ModUpdateTimeline;
+
+    private wsModTsCache = new Map<string, { mtime: number; ts: string }>();
+
     public constructor(
         loggerFactory: LoggerFactory,
         private manager: Manager,
@@ -182,18 +268,29 @@ export class SteamCMD extends IService {
         private downloader: Downloader,
         private metaData: SteamMetaData,
         private eventBus: EventBus,
+        private prometheus: Prometheus,
+        private workerPool: WorkerPool,
         @inject(InjectionTokens.fs) private fs: FSAPI,
     ) {
         super(loggerFactory.createLogger('SteamCMD'));
     }
 
-    private getCmdPath(): string {
+    private getWorkspaceDir(dir: string, workspace: number): string {
+        // additional workspaces are placed next to the configured folder
+        return workspace ? `${dir.replace(/[\\/]+$/, '')}-${workspace}` : dir;
+    }
+
+    private getCmdDir(workspace: number = 0): string {
         let cmdFolder = this.manager.config?.steamCmdPath ?? '';
         if (!this.paths.isAbsolute(cmdFolder)) {
-            cmdFolder = path.join(this.paths.cwd(), cmdFolder);
+            cmdFolder = path.join(this.paths.sharedCwd(), cmdFolder);
         }
+        return this.getWorkspaceDir(cmdFolder, workspace);
+    }
+
+    private getCmdPath(workspace: number = 0): string {
         return path.join(
-            cmdFolder,
+            this.getCmdDir(workspace),
             detectOS() === 'windows' ? 'steamcmd.exe' : 'steamcmd.sh',
         );
     }
@@ -302,7 +399,7 @@ export class SteamCMD extends IService {
         let guardCode: string = this.manager.config.steamGuardCode;
 
         if (!guardCode) {
-            const guardCodePath = path.join(this.paths.cwd(), 'STEAM_GUARD_CODE');
+            const guardCodePath = path.join(this.paths.sharedCwd(), 'STEAM_GUARD_CODE');
             if (this.fs.existsSync(guardCodePath)) {
                 guardCode = this.fs.readFileSync(guardCodePath, { encoding: 'utf-8' });
                 this.fs.rmSync(guardCodePath);
@@ -323,6 +420,7 @@ export class SteamCMD extends IService {
         args: string[],
         opts?: {
             listener: (data: string) => any,
+            workspace?: number,
         },
     ): Promise<SpawnOutput> {
         const defaultCommands = [
@@ -330,7 +428,7 @@ export class SteamCMD extends IService {
             // '@NoPromptForPassword 1',
         ];
         return this.processes.spawnForOutput(
-            this.getCmdPath(),
+            this.getCmdPath(opts?.workspace),
             [...defaultCommands, ...args],
             {
                 verbose: this.progressLog,
@@ -339,7 +437,7 @@ export class SteamCMD extends IService {
                     7, // no command
                 ],
                 spawnOpts: {
-                    cwd: this.manager.config?.steamCmdPath,
+                    cwd: opts?.workspace ? this.getCmdDir(opts.workspace) : this.manager.config?.steamCmdPath,
                     stdio: [
                         'inherit', // inherit stdin to enable input of password / steam guard code
                         'inherit',
@@ -347,15 +445,57 @@ export class SteamCMD extends IService {
                     ],
                 },
                 pty: this.execMode === 'pty',
+                lowPriority: !!this.manager.config?.maintenanceLowPriority,
                 stdOutHandler: opts?.listener ? opts.listener : undefined,
             },
         );
     }
 
+    private getOperation(args: string[]): string {
+        if (args.indexOf('+app_update') !== -1) {
+            return 'server_update';
+        }
+        if (args.indexOf('+workshop_download_item') !== -1) {
+            return 'mod_update';
+        }
+        return 'steamcmd_update';
+    }
+
     private async execute(
         args: string[],
         opts?: {
             listener: SteamCmdEventListener,
+            workspace?: number,
+        },
+    ): Promise<boolean> {
+        const cmdDir = this.getCmdDir(opts?.workspace);
+        if (SteamCMD.CMD_LOCK.isLocked(cmdDir)) {
+            this.log.log(LogLevel.INFO, `Waiting for another SteamCMD run in ${cmdDir} to finish`);
+        }
+        return SteamCMD.CMD_LOCK.runExclusive(cmdDir, async () => {
+            const timer = this.prometheus.steamCmdDuration.startTimer({ operation: this.getOperation(args) });
+            const success = await this.executeWithRetries(args, opts);
+            timer({ result: success ? 'success' : 'failure' });
+            return success;
+        });
+    }
+
+    /**
+     * Locks the dirs one after another in a fixed order, so tasks with overlapping dirs do not deadlock
+     */
+    private async runWithDirLocks<T>(dirs: string[], task: () => Promise<T>): Promise<T> {
+        const [dir, ...rest] = [...new Set(dirs)].sort();
+        if (!dir) {
+            return task();
+        }
+        return SteamCMD.CMD_LOCK.runExclusive(dir, () => this.runWithDirLocks(rest, task));
+    }
+
+    private async executeWithRetries(
+        args: string[],
+        opts?: {
+            listener: SteamCmdEventListener,
+            workspace?: number,
         },
     ): Promise<boolean> {
         let steamGuardDetected = false;
@@ -393,6 +533,7 @@ export class SteamCMD extends IService {
                                 text: data,
                             } as SteamCmdOutputEvent);
                         },
+                        workspace: opts?.workspace,
                     },
                 );
                 opts?.listener?.({
@@ -440,9 +581,9 @@ export class SteamCMD extends IService {
         return false;
     }
 
-    public async checkServer(): Promise<boolean> {
+    public async checkServer(serverPath?: string): Promise<boolean> {
 
-        const serverFolder = this.manager.getServerPath();
+        const serverFolder = serverPath ?? this.manager.getServerPath();
         const serverExe = this.manager.config?.serverExe;
 
         return !!serverFolder && !!serverExe
@@ -454,10 +595,12 @@ export class SteamCMD extends IService {
         opts?: {
             listener?: SteamCmdEventListener,
             validate?: boolean,
+            /** install into a different dir than the live server (i.e. staged updates) */
+            serverPath?: string,
         },
     ): Promise<boolean> {
 
-        const serverPath = this.manager.getServerPath();
+        const serverPath = opts?.serverPath ?? this.manager.getServerPath();
         this.fs.mkdirSync(serverPath, { recursive: true });
 
         const steamAppId = this.manager.config?.experimentalServer
@@ -528,25 +671,32 @@ export class SteamCMD extends IService {
             return false;
         }
 
-        return this.checkServer();
+        return this.checkServer(serverPath);
 
     }
 
-    private getWsBasePath(): string {
+    private getWsBasePath(workspace: number = 0): string {
         let wsPath = this.manager.config.steamWorkshopPath;
         if (!path.isAbsolute(wsPath)) {
-            wsPath = path.join(this.paths.cwd(), wsPath);
+            wsPath = path.join(this.paths.sharedCwd(), wsPath);
         }
-        return wsPath;
+        return this.getWorkspaceDir(wsPath, workspace);
+    }
+
+    private getWsPath(workspace: number = 0): string {
+        return path.join(this.getWsBasePath(workspace), 'steamapps/workshop/content', DAYZ_APP_ID);
+    }
+
+    private getModWorkspace(modId: string): number {
+        return this.metaData.readLocalMeta(modId)?.workspace || 0;
     }
 
-    private getWsPath(): string {
-        return path.join(this.getWsBasePath(), 'steamapps/workshop/content', DAYZ_APP_ID);
+    public getWsModDir(modId: string): string {
+        return path.join(this.getWsPath(this.getModWorkspace(modId)), modId);
     }
 
     public getWsModName(modId: string): string {
-        const wsPath = this.getWsPath();
-        const modMeta = path.join(wsPath, modId, 'meta.cpp');
+        const modMeta = path.join(this.getWsModDir(modId), 'meta.cpp');
         if (!this.fs.existsSync(modMeta)) {
             return '';
         }
@@ -570,18 +720,27 @@ export class SteamCMD extends IService {
     }
 
     public async getWsModUpdatedTs(modId: string): Promise<string> {
-        const wsPath = this.getWsPath();
-        const modMeta = path.join(wsPath, modId, 'meta.cpp');
+        const modMeta = path.join(this.getWsModDir(modId), 'meta.cpp');
         if (!this.fs.existsSync(modMeta)) {
             return '';
         }
+
+        // only parse the meta again if steam touched it
+        const mtime = (await this.fs.promises.stat(modMeta)).mtime.getTime();
+        const cached = this.wsModTsCache.get(modMeta);
+        if (cached?.mtime === mtime) {
+            return cached.ts;
+        }
+
         const metaContent = await this.fs.promises.readFile(modMeta, { encoding: 'utf-8' });
         // timestamp = 5250075451128136767;
-        return (metaContent.match(/timestamp\s*=.*/g) ?? [])
+        const ts = (metaContent.match(/timestamp\s*=.*/g) ?? [])
             .pop()
             ?.split('=')[1]
             ?.trim()
             ?.replace(';', '') || '';
+        this.wsModTsCache.set(modMeta, { mtime, ts });
+        return ts;
     }
 
     public buildWsModParams(): string[] {
@@ -599,6 +758,7 @@ export class SteamCMD extends IService {
         opts?: {
             validate?: boolean,
             listener?: SteamCmdEventListener,
+            workspace?: number,
         },
     ): Promise<boolean> {
 
@@ -606,7 +766,7 @@ export class SteamCMD extends IService {
             return true;
         }
 
-        const wsBasePath = this.getWsBasePath();
+        const wsBasePath = this.getWsBasePath(opts?.workspace);
         this.fs.mkdirSync(wsBasePath, { recursive: true });
 
         const prevModTs = new Map(
@@ -619,8 +779,10 @@ export class SteamCMD extends IService {
 
         let lastDetectedMod: string;
 
-        this.log.log(LogLevel.IMPORTANT, `Updating Mods with ids: ${modIds.join(', ')}, validating: ${validate}`);
-        let success = await this.execute([
+        this.log.log(LogLevel.IMPORTANT, `Updating Mods with ids: ${modIds.join(', ')}, validating: ${validate}${opts?.workspace ? `, workspace: ${opts.workspace}` : ''}`);
+        // other instances must not install the mods while they are downloaded
+        const modDirs = modIds.map((modId) => path.join(this.getWsPath(opts?.workspace), modId));
+        let success = await this.runWithDirLocks(modDirs, () => this.execute([
             '+force_install_dir',
             wsBasePath,
             ...this.getLoginArgs(),
@@ -710,7 +872,8 @@ export class SteamCMD extends IService {
                 }
                 opts?.listener?.(event);
             },
-        });
+            workspace: opts?.workspace,
+        }));
 
         success = success && modIds.every((modId) => !!this.getWsModName(modId));
         if (!success) {
@@ -742,6 +905,7 @@ export class SteamCMD extends IService {
     public async updateAllMods(opts?: {
         force?: boolean,
         validate?: boolean,
+        install?: boolean,
         listener?: SteamCmdEventListener,
     }): Promise<boolean> {
         const modIds: string[] = [];
@@ -753,7 +917,7 @@ export class SteamCMD extends IService {
                     this.manager.getCombinedModIdList(),
                 )),
                 ...this.manager.getCombinedModIdList().filter((modId) => {
-                    const modDir = path.join(this.getWsPath(), modId);
+                    const modDir = this.getWsModDir(modId);
                     if (!this.fs.existsSync(modDir)) {
                         return true;
                     }
@@ -788,19 +952,98 @@ export class SteamCMD extends IService {
                 file_size: '0',
             }) as Partial<PublishedFileDetail>));
 
+        const workers = Math.max(1, this.manager.config.updateModsWorkers || 1);
+        const batches = new Map<number, string[][]>();
+        for (const [workspace, mods] of this.assignWorkspaces(bySize, workers)) {
+            batches.set(workspace, this.buildUpdateBatches(mods));
+        }
+
+        const timeline: ModUpdateTimeline = {
+            start: new Date().valueOf(),
+            workers: batches.size,
+            mods: bySize.length,
+            batches: [],
+        };
+        this.lastModUpdateTimeline = timeline;
+
+        const success = await this.runModUpdatePipeline(batches, timeline, opts);
+
+        timeline.end = new Date().valueOf();
+        this.reportModUpdateTimeline(timeline, opts?.listener);
+        if (bySize.length) {
+            this.log.log(
+                LogLevel.INFO,
+                `Mod update of ${bySize.length} mods finished in ${Math.round((timeline.end - timeline.start) / 1000)}s using ${timeline.workers} workspace(s)`,
+            );
+        }
+
+        return success;
+    }
+
+    /**
+     * Keeps mods in the workspace they were downloaded with, so updates stay incremental.
+     * Mods which were not downloaded yet are distributed to the workspace with the least download size.
+     */
+    private assignWorkspaces(
+        mods: Partial<PublishedFileDetail>[],
+        workers: number,
+    ): Map<number, Partial<PublishedFileDetail>[]> {
+        const assigned = new Map<string, number>();
+        const load = new Map<number, number>();
+        const assign = (workspace: number, mod: Partial<PublishedFileDetail>): void => {
+            assigned.set(mod.publishedfileid!, workspace);
+            // mods without size still count, so they are distributed as well
+            load.set(workspace, (load.get(workspace) ?? 0) + Number(mod.file_size || 0) + 1);
+        };
+
+        const unassigned: Partial<PublishedFileDetail>[] = [];
+        for (const mod of mods) {
+            if (this.fs.existsSync(this.getWsModDir(mod.publishedfileid!))) {
+                assign(this.getModWorkspace(mod.publishedfileid!), mod);
+            } else {
+                unassigned.push(mod);
+            }
+        }
+
+        // mods are sorted by size, so the large ones are spread first
+        for (const mod of unassigned) {
+            let workspace = 0;
+            for (let i = 1; i < workers; i++) {
+                if ((load.get(i) ?? 0) < (load.get(workspace) ?? 0)) {
+                    workspace = i;
+                }
+            }
+            if (this.getModWorkspace(mod.publishedfileid!) !== workspace) {
+                this.metaData.updateLocalModMeta(mod.publishedfileid!, { workspace });
+            }
+            assign(workspace, mod);
+        }
+
+        // keep the order by size for batching
+        const byWorkspace = new Map<number, Partial<PublishedFileDetail>[]>();
+        for (const mod of mods) {
+            const workspace = assigned.get(mod.publishedfileid!)!;
+            if (!byWorkspace.has(workspace)) {
+                byWorkspace.set(workspace, []);
+            }
+            byWorkspace.get(workspace)!.push(mod);
+        }
+        return byWorkspace;
+    }
+
+    private buildUpdateBatches(mods: Partial<PublishedFileDetail>[]): string[][] {
         const maxBatchSize = this.manager.config.updateModsMaxBatchSize || 5;
         const maxDownloadSize = this.manager.config.updateModsMaxBatchFileSize || 1_000_000_000; // ~1 GB
+        const batches: string[][] = [];
         let curBatch: Partial<PublishedFileDetail>[] = [];
-        for (const mod of bySize) {
+        for (const mod of mods) {
             let curBatchFileSize = curBatch.reduce((acc, x) => acc + Number(x.file_size || 0), 0);
 
             // if this mod would exceed the download limit, then execute the batch first
             if (curBatch.length && (curBatchFileSize + Number(mod.file_size || 0)) >= maxDownloadSize) {
-                const curBatchIds = curBatch.map(/* istanbul ignore next */ (x) => x.publishedfileid);
+                const curBatchIds = curBatch.map(/* istanbul ignore next */ (x) => x.publishedfileid!);
                 this.log.log(LogLevel.INFO, `Batching mod update for ids: ${curBatchIds.join(', ')}, because the maximum download size per batch (${maxDownloadSize}) would be exceed with the next mod. Current download size: ${curBatchFileSize}`);
-                if (!await this.updateMod(curBatchIds)) {
-                    return false;
-                }
+                batches.push(curBatchIds);
                 curBatch = [];
             }
 
@@ -809,32 +1052,141 @@ export class SteamCMD extends IService {
             // check if batch is full or exceeds size limit
             curBatchFileSize = curBatch.reduce((acc, x) => acc + Number(x.file_size || 0), 0);
             if (curBatchFileSize >= maxDownloadSize || curBatch.length >= maxBatchSize) {
-                const curBatchIds = curBatch.map((x) => x.publishedfileid);
+                const curBatchIds = curBatch.map((x) => x.publishedfileid!);
                 if (curBatchFileSize >= maxDownloadSize) {
                     this.log.log(LogLevel.INFO, `Batching mod update for ids: ${curBatchIds.join(', ')}, because the maximum download size per batch (${maxDownloadSize}) was reached. Current download size: ${curBatchFileSize}`);
                 } else if (curBatch.length >= maxBatchSize) {
                     this.log.log(LogLevel.INFO, `Batching mod update for ids: ${curBatchIds.join(', ')}, because the maximum number items per batch (${maxBatchSize}) was reached. Current batch size: ${curBatch.length}`);
                 }
-
-                if (!await this.updateMod(
-                    curBatchIds,
-                    {
-                        validate: opts?.validate,
-                        listener: opts?.listener,
-                    },
-                )) {
-                    return false;
-                }
+                batches.push(curBatchIds);
                 curBatch = [];
             }
         }
         // update the rest
         if (curBatch.length) {
-            if (!await this.updateMod(curBatch.map((x) => x.publishedfileid))) {
+            batches.push(curBatch.map((x) => x.publishedfileid!));
+        }
+        return batches;
+    }
+
+    /**
+     * Additional workspaces use their own copy of SteamCMD, which is synced from the main one to share the login.
+     */
+    private async prepareWorkspace(workspace: number): Promise<boolean> {
+        if (!workspace) {
+            return true;
+        }
+        if (!this.fs.existsSync(this.getCmdPath())) {
+            this.log.log(LogLevel.ERROR, 'SteamCMD needs to be installed before using additional workspaces');
+            return false;
+        }
+        this.fs.mkdirSync(this.getWsBasePath(workspace), { recursive: true });
+        return this.paths.syncDirFromTo(
+            this.getCmdDir(),
+            this.getCmdDir(workspace),
+            {
+                manifestPath: path.join(this.metaData.getMetaDataPath(), `steamcmd-${workspace}.sync.json`),
+            },
+        );
+    }
+
+    /**
+     * Downloads the batches of all workspaces in parallel, while the batches of one workspace run one after another.
+     * If enabled, finished batches are installed while the next ones are still downloading.
+     */
+    private async runModUpdatePipeline(
+        batchesByWorkspace: Map<number, string[][]>,
+        timeline: ModUpdateTimeline,
+        opts?: {
+            validate?: boolean,
+            install?: boolean,
+            listener?: SteamCmdEventListener,
+        },
+    ): Promise<boolean> {
+        // prepare before any download runs, so SteamCMD is not copied while its in use
+        for (const workspace of batchesByWorkspace.keys()) {
+            if (!await this.prepareWorkspace(workspace)) {
                 return false;
             }
         }
-        return true;
+
+        if (opts?.install) {
+            this.fs.mkdirSync(
+                path.join(this.manager.getServerPath(), 'keys'),
+                { recursive: true },
+            );
+        }
+
+        // installs run one after another to not compete for the disk
+        const installs: Promise<boolean>[] = [];
+        let lastInstall: Promise<boolean> = Promise.resolve(true);
+        const queueInstall = (batch: ModUpdateTimelineBatch): void => {
+            const prevInstall = lastInstall;
+            lastInstall = (async () => {
+                await prevInstall;
+                let success = true;
+                for (const modId of batch.modIds) {
+                    success = success && await this.installMod(modId) && await this.copyModKeys(modId);
+                }
+                batch.installEnd = new Date().valueOf();
+                batch.success = success;
+                this.reportModUpdateTimeline(timeline, opts?.listener);
+                return success;
+            })();
+            installs.push(lastInstall);
+        };
+
+        const downloads = [...batchesByWorkspace.entries()].map(async ([workspace, batches]) => {
+            for (const modIds of batches) {
+                const batch: ModUpdateTimelineBatch = {
+                    modIds,
+                    workspace,
+                    downloadStart: new Date().valueOf(),
+                };
+                timeline.batches.push(batch);
+
+                batch.success = await this.updateMod(
+                    modIds,
+                    {
+                        validate: opts?.validate,
+                        listener: opts?.listener,
+                        workspace,
+                    },
+                );
+                batch.downloadEnd = new Date().valueOf();
+                this.reportModUpdateTimeline(timeline, opts?.listener);
+                if (!batch.success) {
+                    return false;
+                }
+
+                if (opts?.install) {
+                    queueInstall(batch);
+                }
+            }
+            return true;
+        });
+
+        const downloaded = (await Promise.all(downloads)).every((x) => x);
+        const installed = (await Promise.all(installs)).every((x) => x);
+        return downloaded && installed;
+    }
+
+    private reportModUpdateTimeline(timeline: ModUpdateTimeline, listener?: SteamCmdEventListener): void {
+        const downloaded = timeline.batches
+            .filter((x) => x.downloadEnd && x.success !== false)
+            .reduce((acc, x) => acc + x.modIds.length, 0);
+        const installed = timeline.batches
+            .filter((x) => x.installEnd && x.success)
+            .reduce((acc, x) => acc + x.modIds.length, 0);
+        const elapsed = Math.round(((timeline.end ?? new Date().valueOf()) - timeline.start) / 1000);
+        this.log.log(
+            LogLevel.DEBUG,
+            `Mod update timeline: ${downloaded}/${timeline.mods} downloaded, ${installed} installed, ${elapsed}s elapsed`,
+        );
+        listener?.({
+            type: 'mod-timeline',
+            timeline,
+        } as SteamCmdModUpdateTimelineEvent);
     }
 
     private async sameModMeta(modDir: string, serverDir: string): Promise<boolean> {
@@ -850,15 +1202,47 @@ export class SteamCMD extends IService {
         return `${this.fs.readFileSync(modMeta)}` === `${this.fs.readFileSync(serverMeta)}`;
     }
 
-    public async installMod(modId: string): Promise<boolean> {
+    public async installMod(modId: string, serverPath?: string): Promise<boolean> {
+        // the workshop is shared by all instances, so the mod must not be updated while its installed
+        const modDir = this.getWsModDir(modId);
+        if (SteamCMD.CMD_LOCK.isLocked(modDir)) {
+            this.log.log(LogLevel.INFO, `Waiting for the update of mod (${modId}) to finish`);
+        }
+        return SteamCMD.CMD_LOCK.runExclusive(modDir, () => this.installModDir(modId, modDir, serverPath));
+    }
+
+    private async installModDir(modId: string, modDir: string, serverPath?: string): Promise<boolean> {
         const modName = this.getWsModName(modId);
         if (!modName) {
             return false;
         }
 
-        const modDir = path.join(this.getWsPath(), modId);
-        const serverDir = path.join(this.manager.getServerPath(), modName);
-        if (this.manager.config.linkModDirs) {
+        const serverDir = path.join(serverPath ?? this.manager.getServerPath(), modName);
+        // staged server dirs need their own sync state
+        const syncManifest = path.join(
+            this.metaData.getMetaDataPath(),
+            serverPath ? `${modId}.staged.sync.json` : `${modId}.sync.json`,
+        );
+        const linkModFiles = this.manager.config.linkModFiles ?? 'off';
+        if (linkModFiles !== 'off') {
+            this.log.log(LogLevel.INFO, `Linking mod (${modId}) files`);
+            if (!await this.paths.syncDirFromTo(
+                modDir,
+                serverDir,
+                {
+                    manifestPath: syncManifest,
+                    // on linux, all folders and files need to be lowercase
+                    lowerCaseTarget: detectOS() !== 'windows',
+                    mode: linkModFiles,
+                },
+            )) {
+                this.log.log(LogLevel.ERROR, `Linking mod (${modId}) files failed`);
+                return false;
+            }
+
+            // already linked with lower case names
+            return true;
+        } else if (this.manager.config.linkModDirs) {
             this.log.log(LogLevel.INFO, `Linking mod (${modId}) dir`);
             if (!this.paths.linkDirsFromTo(
                 modDir,
@@ -867,6 +1251,23 @@ export class SteamCMD extends IService {
                 this.log.log(LogLevel.ERROR, `Linking mod (${modId}) dir failed`);
                 return false;
             }
+        } else if (this.manager.config.copyModIncremental) {
+            this.log.log(LogLevel.INFO, `Syncing mod (${modId}) dir`);
+            if (!await this.paths.syncDirFromTo(
+                modDir,
+                serverDir,
+                {
+                    manifestPath: syncManifest,
+                    // on linux, all folders and files need to be lowercase
+                    lowerCaseTarget: detectOS() !== 'windows',
+                },
+            )) {
+                this.log.log(LogLevel.ERROR, `Syncing mod (${modId}) dir failed`);
+                return false;
+            }
+
+            // already synced with lower case names
+            return true;
         } else {
 
             let isUp2Date = false;
@@ -874,7 +1275,7 @@ export class SteamCMD extends IService {
             if (
                 !isUp2Date
                 && this.manager.config.copyModDeepCompare
-                && await sameDirHash(this.fs, modDir, serverDir)
+                && await this.workerPool.run('sameDirHash', modDir, serverDir)
             ) {
                 isUp2Date = true;
             }
@@ -934,29 +1335,29 @@ export class SteamCMD extends IService {
         }
     }
 
-    public async installMods(): Promise<boolean> {
+    public async installMods(serverPath?: string): Promise<boolean> {
         const modIds = this.manager.getCombinedModIdList();
 
-        const installed = Promise.all(modIds.map((modId) => this.installMod(modId)));
-        if (!await installed) {
+        const installed = await Promise.all(modIds.map((modId) => this.installMod(modId, serverPath)));
+        if (!installed.every((x) => x)) {
             return false;
         }
 
         this.fs.mkdirSync(
-            path.join(this.manager.getServerPath(), 'keys'),
+            path.join(serverPath ?? this.manager.getServerPath(), 'keys'),
             { recursive: true },
         );
         let success = true;
         for (const modId of modIds) {
-            success = success && (await this.copyModKeys(modId));
+            success = success && (await this.copyModKeys(modId, serverPath));
         }
         return success;
     }
 
-    private async copyModKeys(modId: string): Promise<boolean> {
-        const keysFolder = path.join(this.manager.getServerPath(), 'keys');
+    private async copyModKeys(modId: string, serverPath?: string): Promise<boolean> {
+        const keysFolder = path.join(serverPath ?? this.manager.getServerPath(), 'keys');
         const modName = this.getWsModName(modId);
-        const modDir = path.join(this.getWsPath(), modId);
+        const modDir = this.getWsModDir(modId);
         this.log.log(LogLevel.DEBUG, `Searching keys for ${modName}`);
         const keys = await this.paths.findFilesInDir(modDir, /.*\.bikey/);
         for (const key of keys) {
@@ -972,10 +1373,9 @@ export class SteamCMD extends IService {
     }
 
     public async checkMods(): Promise<boolean> {
-        const wsPath = this.getWsPath();
         return this.manager.getCombinedModIdList()
             .every((modId) => {
-                const modDir = path.join(wsPath, modId);
+                const modDir = this.getWsModDir(modId);
                 if (!this.fs.existsSync(modDir)) {
                     this.log.log(LogLevel.ERROR, `Mod ${modId} was not found`);
                     return false;
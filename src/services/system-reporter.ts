@@ -1,11 +1,12 @@
 import { Processes } from '../services/processes';
 import { LogLevel } from '../util/logger';
-import { ServerState, SystemReport } from '../types/monitor';
+import { ServerState, SystemReport, UsageItem } from '../types/monitor';
 import { IService } from '../types/service';
 import { injectable, singleton } from 'tsyringe';
 import { LoggerFactory } from './loggerfactory';
 import { ServerDetector } from './server-detector';
 import { Monitor } from './monitor';
+import { Prometheus } from './prometheus';
 
 @singleton()
 @injectable()
@@ -19,6 +20,7 @@ export class SystemReporter extends IService {
         private processes: Processes,
         private monitor: Monitor,
         private serverDetector: ServerDetector,
+        private prometheus: Prometheus,
     ) {
         super(loggerFactory.createLogger('SystemReport'));
     }
@@ -95,6 +97,7 @@ export class SystemReporter extends IService {
 
             this.prevReport = report;
             this.prevReportTS = new Date().valueOf();
+            this.updatePrometheus(report);
 
             return report;
 
@@ -104,4 +107,29 @@ export class SystemReporter extends IService {
         }
     }
 
+    private updatePrometheus(report: SystemReport): void {
+        const mb = 1024 * 1024;
+        this.prometheus.systemCpu.set(report.system.cpuTotal);
+        this.prometheus.systemMemoryUsed.set(report.system.mem * mb);
+        this.prometheus.systemMemoryTotal.set(report.system.memTotal * mb);
+
+        const processes: { name: string; usage?: UsageItem; uptimeFactor: number }[] = [
+            // manager uptime is in seconds, server uptime in ms
+            { name: 'manager', usage: report.manager, uptimeFactor: 1 },
+            { name: 'server', usage: report.server, uptimeFactor: 1 / 1000 },
+        ];
+        for (const { name, usage, uptimeFactor } of processes) {
+            const labels = { process: name };
+            if (usage) {
+                this.prometheus.processCpu.set(usage.cpuTotal, labels);
+                this.prometheus.processMemory.set(usage.mem * mb, labels);
+                this.prometheus.processUptime.set(usage.uptime * uptimeFactor, labels);
+            } else {
+                this.prometheus.processCpu.remove(labels);
+                this.prometheus.processMemory.remove(labels);
+                this.prometheus.processUptime.remove(labels);
+            }
+        }
+    }
+
 }
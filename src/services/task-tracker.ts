@@ -0,0 +1,85 @@
+import { injectable, singleton } from 'tsyringe';
+import { RingBuffer } from '../util/ring-buffer';
+
+export interface TrackedTask {
+    id: number;
+    name: string;
+    /** worker tasks do not block the manager, but show what else was going on */
+    worker: boolean;
+    start: number;
+    end?: number;
+}
+
+/**
+ * Remembers which tasks are running and which finished recently,
+ * so a blocked event loop can be attributed to the tasks running at that time.
+ */
+@singleton()
+@injectable()
+export class TaskTracker {
+
+    public static readonly HISTORY = 100;
+
+    private idx = 0;
+    private running = new Map<number, TrackedTask>();
+    private finished = new RingBuffer<TrackedTask>(TaskTracker.HISTORY);
+
+    /* istanbul ignore next function for easier tests */
+    public now(): number {
+        return Date.now();
+    }
+
+    /**
+     * @returns the id of the task, which must be passed to end()
+     */
+    public begin(name: string, worker: boolean = false): number {
+        const id = ++this.idx;
+        this.running.set(id, { id, name, worker, start: this.now() });
+        return id;
+    }
+
+    public end(id: number): void {
+        const task = this.running.get(id);
+        if (task) {
+            this.running.delete(id);
+            task.end = this.now();
+            this.finished.push(task);
+        }
+    }
+
+    public async track<T>(name: string, task: () => T | Promise<T>): Promise<T> {
+        const id = this.begin(name);
+        try {
+            return await task();
+        } finally {
+            this.end(id);
+        }
+    }
+
+    /**
+     * Tracks synchronous work, which blocks the event loop until it returns
+     */
+    public trackSync<T>(name: string, task: () => T): T {
+        const id = this.begin(name);
+        try {
+            return task();
+        } finally {
+            this.end(id);
+        }
+    }
+
+    public getRunning(): TrackedTask[] {
+        return [...this.running.values()];
+    }
+
+    /**
+     * @returns the tasks which were running at some point between from and to, the longest first
+     */
+    public getTasksBetween(from: number, to: number): TrackedTask[] {
+        return [
+            ...this.finished.toArray((x) => x.end >= from && x.start <= to),
+            ...this.getRunning().filter((x) => x.start <= to),
+        ].sort((a, b) => ((b.end ?? to) - b.start) - ((a.end ?? to) - a.start));
+    }
+
+}
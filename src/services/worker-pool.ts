@@ -0,0 +1,182 @@
+import * as fsModule from 'fs';
+import * as path from 'path';
+import { Worker } from 'worker_threads';
+import { inject, injectable, singleton } from 'tsyringe';
+import { IStatefulService } from '../types/service';
+import { LoggerFactory } from './loggerfactory';
+import { TaskTracker } from './task-tracker';
+import { FSAPI, InjectionTokens } from '../util/apis';
+import { LogLevel } from '../util/logger';
+import {
+    WORKER_JOBS,
+    WORKER_MARKER,
+    WorkerJobArgs,
+    WorkerJobName,
+    WorkerJobResult,
+    WorkerRequest,
+    WorkerResponse,
+} from '../util/worker-jobs';
+
+interface PendingJob {
+    request: WorkerRequest;
+    task: number;
+    resolve: (result: any) => void;
+    reject: (error: Error) => void;
+}
+
+interface PoolWorker {
+    worker: Worker;
+    job?: PendingJob;
+}
+
+/**
+ * Runs cpu and disk heavy jobs in worker threads, so the event loop of the manager stays responsive.
+ *
+ * The jobs are defined in util/worker-jobs. Workers are spawned on demand up to the configured size.
+ * If no workers are configured (or the fs is not the real one, i.e. in tests), the jobs are executed in the manager thread.
+ */
+@singleton()
+@injectable()
+export class WorkerPool extends IStatefulService {
+
+    public static readonly DEFAULT_SIZE = 2;
+
+    private size = 0;
+    private workers: PoolWorker[] = [];
+    private queue: PendingJob[] = [];
+    private jobIdx = 0;
+
+    public constructor(
+        loggerFactory: LoggerFactory,
+        private taskTracker: TaskTracker,
+        @inject(InjectionTokens.fs) private fs: FSAPI,
+    ) {
+        super(loggerFactory.createLogger('WorkerPool'));
+    }
+
+    public async start(): Promise<void> {
+        // sized by the manager controller as soon as the config is loaded, so the initial setup uses the workers as well
+    }
+
+    /**
+     * @param size the number of worker threads, 0 runs the jobs in the manager thread
+     */
+    public setSize(size?: number): void {
+        // workers use the real fs
+        this.size = (this.fs === fsModule) ? Math.max(0, size ?? WorkerPool.DEFAULT_SIZE) : 0;
+        this.dispatch();
+    }
+
+    /**
+     * New jobs run in the manager thread after stopping.
+     * Running and queued jobs are not aborted (the services are stopped on every config reload),
+     * the workers are terminated as soon as they are done, unless the pool is sized again.
+     */
+    public async stop(): Promise<void> {
+        this.size = 0;
+        this.dispatch();
+    }
+
+    public getSize(): number {
+        return this.size;
+    }
+
+    /* istanbul ignore next function for easier tests */
+    public createWorker(): Worker {
+        const ext = path.extname(__filename);
+        const file = path.join(__dirname, '..', 'util', `worker-jobs${ext}`);
+        const workerData = { [WORKER_MARKER]: true };
+        if (ext === '.ts') {
+            // running from source (i.e. tests)
+            return new Worker(
+                `require('ts-node').register({ transpileOnly: true }); require(${JSON.stringify(file)});`,
+                { eval: true, workerData },
+            );
+        }
+        return new Worker(file, { workerData });
+    }
+
+    /**
+     * Executes a job of util/worker-jobs
+     * @returns the result of the job, which is copied from the worker
+     */
+    public run<K extends WorkerJobName>(job: K, ...args: WorkerJobArgs<K>): Promise<WorkerJobResult<K>> {
+        if (!this.size) {
+            return this.taskTracker.track(
+                `${job} ${args[0]}`,
+                () => (WORKER_JOBS[job] as (fsApi: FSAPI, ...args: any[]) => any)(this.fs, ...args),
+            );
+        }
+
+        return new Promise((resolve, reject) => {
+            this.queue.push({
+                request: { id: ++this.jobIdx, job, args },
+                task: this.taskTracker.begin(`${job} ${args[0]}`, true),
+                resolve,
+                reject,
+            });
+            this.dispatch();
+        });
+    }
+
+    private dispatch(): void {
+        while (this.queue.length) {
+            let poolWorker = this.workers.find((x) => !x.job);
+            if (!poolWorker) {
+                // a stopped pool keeps one worker for the queued jobs
+                if (this.workers.length >= Math.max(this.size, 1)) {
+                    return;
+                }
+                poolWorker = this.spawn();
+            }
+            poolWorker.job = this.queue.shift();
+            poolWorker.worker.postMessage(poolWorker.job.request);
+        }
+
+        // idle workers above the size are not needed anymore
+        const idle = this.workers.filter((x) => !x.job).slice(0, Math.max(0, this.workers.length - this.size));
+        this.workers = this.workers.filter((x) => idle.indexOf(x) === -1);
+        idle.forEach((x) => void x.worker.terminate());
+    }
+
+    private spawn(): PoolWorker {
+        const poolWorker: PoolWorker = { worker: this.createWorker() };
+        this.workers.push(poolWorker);
+
+        poolWorker.worker.on('message', (response: WorkerResponse) => {
+            const job = poolWorker.job;
+            if (job?.request.id !== response?.id) {
+                return;
+            }
+            poolWorker.job = undefined;
+            this.finishJob(job, response.result, response.error ? new Error(response.error) : undefined);
+            this.dispatch();
+        });
+        poolWorker.worker.on('error', (e) => {
+            this.log.log(LogLevel.ERROR, 'Worker failed', e);
+        });
+        poolWorker.worker.on('exit', () => {
+            const idx = this.workers.indexOf(poolWorker);
+            if (idx === -1) {
+                return;
+            }
+            // replaced on demand by the next job
+            this.workers.splice(idx, 1);
+            if (poolWorker.job) {
+                this.finishJob(poolWorker.job, undefined, new Error(`Worker exited while running ${poolWorker.job.request.job}`));
+            }
+            this.dispatch();
+        });
+        return poolWorker;
+    }
+
+    private finishJob(job: PendingJob, result: any, error?: Error): void {
+        this.taskTracker.end(job.task);
+        if (error) {
+            job.reject(error);
+        } else {
+            job.resolve(result);
+        }
+    }
+
+}
@@ -0,0 +1,70 @@
+export interface ClassDatabasePbo {
+    /** absolute path of the pbo */
+    file: string;
+    /** mod name or "vanilla" */
+    source: string;
+    mtime: number;
+    size: number;
+    /** name of the file in the database dir holding the parsed config */
+    configFile?: string;
+    /** CfgPatches classes defined by the pbo */
+    patches: string[];
+    /** CfgPatches requiredAddons of the pbo */
+    requiredAddons: string[];
+    /** error while reading the pbo */
+    error?: string;
+}
+
+export interface ClassDatabaseIndex {
+    version: number;
+    pbos: Record<string, ClassDatabasePbo>;
+}
+
+export interface ClassDatabaseUpdateResult {
+    pbos: number;
+    /** pbos which were parsed again */
+    parsed: number;
+    /** pbos which were removed from the database */
+    removed: number;
+    failed: number;
+    classes: number;
+    duration: number;
+}
+
+export interface ClassDatabaseStatus {
+    pbos: number;
+    classes: number;
+    updating: boolean;
+    lastUpdate?: number;
+    lastResult?: ClassDatabaseUpdateResult;
+}
+
+export interface ResolvedClass {
+    classname: string;
+    /** the top level config class, i.e. CfgVehicles */
+    root: string;
+    /** mod name or "vanilla" of the last definition */
+    source: string;
+    /** direct parent first */
+    parents: string[];
+    /** own and inherited properties, with nested classes resolved */
+    properties: Record<string, any>;
+}
+
+export interface ClassQuery {
+    /** top level config class, defaults to CfgVehicles */
+    root?: string;
+    /** only classes inheriting from this class (case insensitive) */
+    baseClass?: string;
+    /** part of the classname (case insensitive) */
+    name?: string;
+    /** only classes with this scope (i.e. 2 for public classes) */
+    scope?: number;
+    offset?: number;
+    limit?: number;
+}
+
+export interface ClassQueryResult {
+    total: number;
+    items: ResolvedClass[];
+}
@@ -0,0 +1,58 @@
+import { ServerState } from './monitor';
+import { LogEntryEvent } from './log-reader';
+import { MetricEntryEvent } from './metrics';
+
+export type ClusterMode = 'off' | 'controller' | 'agent';
+
+/** first message of an agent after connecting */
+export interface AgentHello {
+    name: string;
+    version: string;
+    instanceId: string;
+}
+
+/** compact state of an agent, only changed values are sent */
+export interface AgentState {
+    serverState?: ServerState;
+    restartLock?: boolean;
+    players?: number;
+    /** system cpu usage in percent */
+    cpu?: number;
+    /** used system memory in MB */
+    mem?: number;
+    memTotal?: number;
+}
+
+/** logs and metrics batched by the agent */
+export interface AgentEvents {
+    logs: LogEntryEvent[];
+    metrics: MetricEntryEvent[];
+}
+
+export interface AgentInfo extends AgentHello {
+    address: string;
+    connectedSince: number;
+    lastSeen: number;
+    state: AgentState;
+}
+
+export type RolloutStepStatus = 'pending' | 'running' | 'done' | 'failed' | 'skipped';
+
+export interface RolloutStep {
+    agent: string;
+    status: RolloutStepStatus;
+    start?: number;
+    end?: number;
+    responseStatus?: number;
+}
+
+/** a command which is executed on all agents, one after another */
+export interface Rollout {
+    id: number;
+    command: string;
+    /** time in ms between two agents */
+    stagger: number;
+    created: number;
+    done?: number;
+    steps: RolloutStep[];
+}
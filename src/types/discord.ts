@@ -5,6 +5,8 @@ export interface DiscordMessage {
     type: DiscordChannelType,
     message: string,
     embeds?: MessageEmbed[],
+    /** low priority messages may be dropped if the channel is overloaded, defaults to true for rcon relay messages */
+    lowPriority?: boolean,
 }
 
 export const isDiscordChannelType = (test: DiscordChannelType | DiscordChannelType[], wanted: DiscordChannelType): boolean => {
@@ -14,4 +14,11 @@ export enum InternalEventTypes {
 
     INTERNAL_MOD_INSTALL = 'INTERNAL_MOD_INSTALL',
     GET_INTERNAL_MODS = 'GET_INTERNAL_MODS',
+
+    SERVER_PRE_START = 'SERVER_PRE_START',
+
+    CONFIG_RELOADED = 'CONFIG_RELOADED',
+    MISSION_FILE_WRITTEN = 'MISSION_FILE_WRITTEN',
+    BACKUP_CREATED = 'BACKUP_CREATED',
+    BACKUP_REMOVED = 'BACKUP_REMOVED',
 }
@@ -11,7 +11,39 @@ export interface IngameReportEntry {
     category: 'GROUND' | 'AIR' | 'SEA' | 'MAN';
 }
 
+/**
+ * frame time aggregates of one report interval, all times are in ms
+ */
+export interface IngameReportFrameTimes {
+    frames: number;
+    avg: number;
+    p50: number;
+    p95: number;
+    p99: number;
+    max: number;
+    // upper bounds of the histogram buckets, the last bucket has no upper bound
+    bucketBounds: number[];
+    buckets: number[];
+}
+
+export interface IngameFrameTimesMetric extends IngameReportFrameTimes {
+    players: number;
+    vehicles: number;
+}
+
+/**
+ * aggregates of a script profiler zone of one report interval, all times are in ms
+ */
+export interface IngameReportProfilerZone {
+    name: string;
+    count: number;
+    total: number;
+    max: number;
+}
+
 export interface IngameReportContainer {
     players: IngameReportContainer[];
     vehicles: IngameReportContainer[];
+    frameTimes?: IngameReportFrameTimes;
+    profilerZones?: IngameReportProfilerZone[];
 }
@@ -1,4 +1,5 @@
 import { UserLevel } from '../config/config';
+import { InternalEventTypes } from './events';
 import { merge } from '../util/merge';
 import { constants as HTTP } from 'http2';
 
@@ -12,6 +13,10 @@ export class Request {
     public channel?: string;
     public canStream?: boolean;
     public uuid?: string;
+    /** executed on behalf of the cluster controller, which already checked the permissions of the user */
+    public forwarded?: boolean;
+    /** level of the user on the cluster controller, checked again by the agent for forwarded requests */
+    public userLevel?: UserLevel;
 
 }
 
@@ -23,6 +28,9 @@ export class Response {
         public uuid?: string,
     ) {}
 
+    /** JSON of the body, set for cached responses so it is serialized only once */
+    public serializedBody?: string;
+
 }
 
 export type ResponsePart = Omit<Response, 'status'>;
@@ -32,6 +40,27 @@ export interface RequestOptions {
     partialResponseCallback: ResponsePartHandler,
 }
 
+export interface ResponseCacheOptions {
+    /** time in ms a response is served from the cache */
+    ttl: number;
+    /** events that drop the cached responses of the command, all of them unless invalidates is set */
+    invalidateOn?: InternalEventTypes[];
+    /** limits the invalidation to the responses whose params match the event data */
+    invalidates?: (params: Record<string, any>, ...eventData: any[]) => boolean;
+}
+
+export interface ResponseCacheCommandStats {
+    hits: number;
+    misses: number;
+    invalidations: number;
+    entries: number;
+}
+
+export interface ResponseCacheStats {
+    enabled: boolean;
+    commands: Record<string, ResponseCacheCommandStats>;
+}
+
 export type RequestHandler = (request: Request, params: Record<string, any>, options: RequestOptions) => any;
 export type RequestMethods = 'get' | 'post' | 'put' | 'delete';
 
@@ -54,6 +83,9 @@ export class RequestTemplate {
     public discordPublic?: boolean = false;
     public disableRest?: boolean = false;
 
+    /** cache successful responses of read only commands */
+    public cache?: ResponseCacheOptions;
+
     public static build(optionals: {
         [Property in keyof RequestTemplate]?: RequestTemplate[Property];
     }): RequestTemplate {
@@ -9,6 +9,11 @@ export enum MetricTypeEnum {
     AUDIT = 'AUDIT',
     INGAME_PLAYERS = 'INGAME_PLAYERS',
     INGAME_VEHICLES = 'INGAME_VEHICLES',
+    SERVER_TELEMETRY = 'SERVER_TELEMETRY',
+    INGAME_FRAMETIMES = 'INGAME_FRAMETIMES',
+    INGAME_PROFILER = 'INGAME_PROFILER',
+    DISCORD_QUEUE = 'DISCORD_QUEUE',
+    RESTART_CYCLE = 'RESTART_CYCLE',
 }
 /* eslint-enable no-shadow */
 
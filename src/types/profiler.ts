@@ -0,0 +1,39 @@
+export type ProfileType = 'cpu' | 'continuous' | 'heap' | 'heapsnapshot' | 'handles';
+
+export const PROFILE_EXTENSIONS: Record<ProfileType, string> = {
+    cpu: '.cpuprofile',
+    continuous: '.cpuprofile',
+    heap: '.heapprofile',
+    heapsnapshot: '.heapsnapshot',
+    handles: '.json',
+};
+
+export interface ProfileFile {
+    /** file name in the profiles folder of the manager */
+    file: string;
+    type: ProfileType;
+    size: number;
+    created: number;
+}
+
+export interface ActiveHandle {
+    type: string;
+    /** i.e. the address of sockets and servers or the pid of child processes */
+    details?: string;
+    refed?: boolean;
+}
+
+export interface ActiveHandlesDump {
+    timestamp: number;
+    /** node's count of the active resources by type (includes timers and pending requests) */
+    resources: Record<string, number>;
+    handles: ActiveHandle[];
+    /** named timers of the manager services */
+    timers: {
+        owner?: string;
+        name: string;
+        type: 'timeout' | 'interval';
+        delay?: number;
+    }[];
+    memory: NodeJS.MemoryUsage;
+}
@@ -15,3 +15,5 @@ export interface RconBan {
     time: string;
     reason: string;
 }
+
+export type GuidListType = 'ban' | 'whitelist' | 'priority';
@@ -0,0 +1,15 @@
+export interface ProcessResourceProfile {
+    pid: string;
+    /** cpu list the process is allowed to run on (i.e. 0-3,6), undefined if not readable */
+    cpuAffinity?: string;
+    /** scheduling priority (nice value), undefined if not readable */
+    priority?: number;
+}
+
+export interface ResourceProfileReport {
+    manager: ProcessResourceProfile;
+    server?: ProcessResourceProfile;
+    serverCpuAffinity: number[];
+    managerCpuAffinity: number[];
+    maintenanceLowPriority: boolean;
+}
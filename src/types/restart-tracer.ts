@@ -0,0 +1,53 @@
+export const RESTART_PHASES = [
+    'shutdown', // the server is killed / shut down via rcon
+    'stopDetection', // until the monitor detected the stop
+    'preStart', // pre start handlers (i.e. staged updates)
+    'serverCheck', // server installation check / update
+    'modCheck', // mod check / update / install
+    'prepare', // internal mods, battleye, server cfg, dayzsettings
+    'hooks', // before start hooks
+    'spawn', // spawning the server process
+    'startupGrace', // time the monitor waits after spawning the server
+    'boot', // until the monitor detected the running server
+    'rconLogin', // until rcon is logged in after the server started
+    'firstReport', // until the first ingame report after the server started
+] as const;
+
+export type RestartPhase = typeof RESTART_PHASES[number];
+
+export type RestartCycleReason = 'start' | 'restart' | 'crash';
+
+export interface RestartSpan {
+    phase: RestartPhase;
+    start: number;
+    end?: number;
+    duration?: number;
+}
+
+export interface RestartRegression {
+    phase: RestartPhase;
+    duration: number;
+    /** median duration of the phase in the previous cycles */
+    baseline: number;
+}
+
+export interface RestartCycle {
+    reason: RestartCycleReason;
+    start: number;
+    /** when the monitor detected the running server */
+    started?: number;
+    end?: number;
+    /** time until the server was running again */
+    downtime?: number;
+    /** time until all phases were done */
+    duration?: number;
+    /** false if the cycle timed out before all phases were done */
+    complete: boolean;
+    spans: RestartSpan[];
+    regressions: RestartRegression[];
+}
+
+export interface RestartTrace {
+    active?: RestartCycle;
+    cycles: RestartCycle[];
+}
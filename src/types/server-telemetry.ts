@@ -0,0 +1,44 @@
+export interface ThreadTelemetry {
+    tid: string;
+    name: string;
+    /** cpu usage in percent of a single core */
+    cpu: number;
+}
+
+export interface ServerTelemetrySample {
+    timestamp: number;
+    pid: string;
+    /** cpu usage in percent of a single core */
+    cpu: number;
+    /** busiest threads, sorted by cpu usage */
+    threads: ThreadTelemetry[];
+    threadCount: number;
+    /** resident memory in bytes */
+    rss: number;
+    /** swapped memory in bytes */
+    swap: number;
+    /** bytes per second read from storage */
+    ioRead: number;
+    /** bytes per second written to storage */
+    ioWrite: number;
+    /** voluntary context switches per second */
+    ctxSwitches: number;
+    /** involuntary context switches per second */
+    ctxSwitchesInvoluntary: number;
+    openFds: number;
+}
+
+export interface ServerTelemetryRollup {
+    samples: number;
+    cpuAvg: number;
+    cpuMax: number;
+    rssMax: number;
+    swapMax: number;
+    ioReadAvg: number;
+    ioWriteAvg: number;
+    ctxSwitchesAvg: number;
+    ctxSwitchesInvoluntaryAvg: number;
+    openFdsMax: number;
+    /** busiest threads of the rollup period, cpu is the average over the period */
+    threads: ThreadTelemetry[];
+}
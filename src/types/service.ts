@@ -11,27 +11,63 @@ export class IService {
 export interface Timer {
     type: 'timeout' | 'interval';
     handle: any;
+    delay?: number;
+}
+
+export interface ActiveTimer {
+    owner?: string;
+    name: string;
+    type: Timer['type'];
+    delay?: number;
 }
 
 export class TimerHandler {
+
+    /** handlers which (possibly) have pending timers, for diagnostics */
+    private static handlers = new Set<TimerHandler>();
+
     protected timers = new Map<string, Timer>();
 
+    public constructor(
+        public readonly owner?: string,
+    ) {}
+
+    /**
+     * @returns the timers of all handlers which did not fire or were not removed yet
+     */
+    public static getActiveTimers(): ActiveTimer[] {
+        const active: ActiveTimer[] = [];
+        for (const handler of TimerHandler.handlers) {
+            for (const [name, timer] of handler.timers) {
+                // fired timeouts stay in the map until they are removed
+                if (!timer.handle?._destroyed) {
+                    active.push({ owner: handler.owner, name, type: timer.type, delay: timer.delay });
+                }
+            }
+        }
+        return active;
+    }
+
     public addInterval(name: string, cb: () => any, delay: number): void {
+        TimerHandler.handlers.add(this);
         this.timers.set(
             name,
             {
                 type: 'interval',
                 handle: setInterval(cb, delay),
+                delay,
             },
         );
     }
 
     public addTimeout(name: string, cb: () => any, delay: number): void {
+        TimerHandler.handlers.add(this);
         this.timers.set(
             name,
             {
                 type: 'timeout',
                 handle: setTimeout(cb, delay),
+                delay,
             },
         );
     }
@@ -46,6 +82,9 @@ export class TimerHandler {
             }
             this.timers.delete(name);
         }
+        if (!this.timers.size) {
+            TimerHandler.handlers.delete(this);
+        }
     }
 
     public getTimer(name: string): Timer {
@@ -62,7 +101,7 @@ export class TimerHandler {
 
 export abstract class IStatefulService extends IService {
 
-    protected timers = new TimerHandler();
+    protected timers = new TimerHandler(this.constructor.name);
 
     abstract start(): Promise<void>;
     abstract stop(): Promise<void>;
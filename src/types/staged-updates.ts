@@ -0,0 +1,22 @@
+/**
+ * none: nothing staged
+ * preparing: the shadow server dir is being updated
+ * ready: the shadow server dir is complete and will be swapped in at the next server start
+ * verifying: the shadow server dir was swapped in and the server has to reach STARTED
+ * rollback: the swapped in server failed and the previous one is restored at the next server start
+ */
+export type StagedUpdateState = 'none' | 'preparing' | 'ready' | 'verifying' | 'rollback';
+
+export interface StagedUpdateStatus {
+    state: StagedUpdateState;
+    /** when the current state was entered */
+    since: number;
+    /** when the last staged update was swapped in */
+    lastSwap?: number;
+    /** when the last swapped update was confirmed by a successful server start */
+    lastCommit?: number;
+    /** when the last rollback was done */
+    lastRollback?: number;
+    /** error of the last prepare, swap or rollback */
+    lastError?: string;
+}
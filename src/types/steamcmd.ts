@@ -59,6 +59,11 @@ export interface PublishedFileDetail {
 }
 /* eslint-enable @typescript-eslint/naming-convention */
 
+export interface WorkshopMetaDataCacheEntry {
+    lastCheck: number;
+    data: Partial<PublishedFileDetail>;
+}
+
 export interface SteamApiWorkshopItemDetailsResponse {
     response: {
         result: number;
@@ -105,10 +110,34 @@ export interface SteamCmdExitEvent extends SteamCmdEvent {
     status: number;
 }
 
+export interface SteamCmdModUpdateTimelineEvent extends SteamCmdEvent {
+    type: 'mod-timeline';
+    timeline: ModUpdateTimeline;
+}
+
 export type SteamCmdEventListener = (event: SteamCmdEvent) => any;
 
 export interface LocalMetaData {
     lastDownloaded?: number;
+    // the workspace the mod is downloaded with, 0 / missing is the main steamWorkshopPath
+    workspace?: number;
+}
+
+export interface ModUpdateTimelineBatch {
+    modIds: string[];
+    workspace: number;
+    downloadStart: number;
+    downloadEnd?: number;
+    installEnd?: number;
+    success?: boolean;
+}
+
+export interface ModUpdateTimeline {
+    start: number;
+    end?: number;
+    workers: number;
+    mods: number;
+    batches: ModUpdateTimelineBatch[];
 }
 
 export interface ModUpdatedStatus {
@@ -6,6 +6,11 @@ export enum WebsocketCommand {
 
     REQUEST = 'REQUEST',
     RESPONSE = 'RESPONSE',
+
+    // cluster agents
+    AGENT_HELLO = 'AGENT_HELLO',
+    AGENT_STATE = 'AGENT_STATE',
+    AGENT_EVENTS = 'AGENT_EVENTS',
 }
 
 // eslint-disable-next-line no-shadow
@@ -0,0 +1,303 @@
+import * as path from 'path';
+import * as crypto from 'crypto';
+import * as zlib from 'zlib';
+import { promisify } from 'util';
+import { FSAPI } from './apis';
+
+const gzip = promisify(zlib.gzip);
+const gunzip = promisify(zlib.gunzip);
+
+export interface BackupFileEntry {
+    size: number;
+    mtime: number;
+    // hashes of the chunks the file consists of, in order
+    chunks: string[];
+}
+
+export interface BackupManifest {
+    name: string;
+    created: number;
+    source: string;
+    dirs: string[];
+    // relative path -> entry
+    files: Record<string, BackupFileEntry>;
+}
+
+export interface BackupStoreResult {
+    files: number;
+    // files which were unchanged since the last backup and were not read again
+    reused: number;
+    chunks: number;
+    newChunks: number;
+    // uncompressed size of the new chunks
+    newBytes: number;
+}
+
+/**
+ * Content addressed store for deduplicated backups of a directory.
+ *
+ * Files are split into chunks at content defined boundaries (gear rolling hash),
+ * so changes in the middle of a file only produce new chunks around the change.
+ * Each unique chunk is stored once, gzip compressed, named by the sha256 of its content.
+ * A backup is a manifest listing the chunks of each file.
+ * Files with the same size and mtime as in the last backup are not read again.
+ */
+export class BackupStore {
+
+    public static readonly MIN_CHUNK = 64 * 1024;
+    public static readonly MAX_CHUNK = 1024 * 1024;
+    // cut when the lowest 18 bits are zero, which results in ~256KB chunks on average
+    public static readonly CHUNK_MASK = (1 << 18) - 1;
+
+    private static gearTable?: Uint32Array;
+
+    public constructor(
+        private fs: FSAPI,
+        public dir: string,
+    ) {}
+
+    private static get gear(): Uint32Array {
+        if (!BackupStore.gearTable) {
+            // must be stable, otherwise the chunk boundaries change between versions
+            BackupStore.gearTable = new Uint32Array(256);
+            for (let i = 0; i < 256; i++) {
+                BackupStore.gearTable[i] = crypto.createHash('sha256').update(`gear${i}`).digest().readUInt32LE(0);
+            }
+        }
+        return BackupStore.gearTable;
+    }
+
+    private get chunkDir(): string {
+        return path.join(this.dir, 'chunks');
+    }
+
+    private getChunkPath(hash: string): string {
+        return path.join(this.chunkDir, hash.slice(0, 2), hash);
+    }
+
+    public getManifestPath(name: string): string {
+        return path.join(this.dir, `${name}.json`);
+    }
+
+    /**
+     * @returns the length of the next chunk in buf[0..len]
+     */
+    private findCut(buf: Buffer, len: number): number {
+        if (len <= BackupStore.MIN_CHUNK) {
+            return len;
+        }
+        const gear = BackupStore.gear;
+        let hash = 0;
+        for (let i = BackupStore.MIN_CHUNK; i < len; i++) {
+            hash = ((hash << 1) + gear[buf[i]]) >>> 0;
+            if ((hash & BackupStore.CHUNK_MASK) === 0) {
+                return i + 1;
+            }
+        }
+        return len;
+    }
+
+    private async chunkFile(file: string, onChunk: (chunk: Buffer) => Promise<void>): Promise<void> {
+        const handle = await this.fs.promises.open(file, 'r');
+        try {
+            const buf = Buffer.alloc(BackupStore.MAX_CHUNK * 2);
+            let filled = 0;
+            let eof = false;
+            do {
+                while (!eof && filled < BackupStore.MAX_CHUNK) {
+                    const { bytesRead } = await handle.read(buf, filled, buf.length - filled, null);
+                    eof = bytesRead === 0;
+                    filled += bytesRead;
+                }
+                if (!filled) {
+                    break;
+                }
+                const cut = this.findCut(buf, Math.min(filled, BackupStore.MAX_CHUNK));
+                await onChunk(Buffer.from(buf.subarray(0, cut)));
+                buf.copy(buf, 0, cut, filled);
+                filled -= cut;
+            } while (filled || !eof);
+        } finally {
+            await handle.close();
+        }
+    }
+
+    /**
+     * @returns true if the chunk was new
+     */
+    private async writeChunk(hash: string, chunk: Buffer): Promise<boolean> {
+        const chunkPath = this.getChunkPath(hash);
+        if (this.fs.existsSync(chunkPath)) {
+            return false;
+        }
+        await this.fs.promises.mkdir(path.dirname(chunkPath), { recursive: true });
+        // write to a temp file first, so an interrupted backup never leaves a broken chunk
+        const tmpPath = `${chunkPath}.tmp`;
+        await this.fs.promises.writeFile(tmpPath, await gzip(chunk));
+        await this.fs.promises.rename(tmpPath, chunkPath);
+        return true;
+    }
+
+    private async walk(dir: string, files: string[], dirs: string[], rel: string = ''): Promise<void> {
+        const entries = await this.fs.promises.readdir(path.join(dir, rel));
+        for (const entry of entries) {
+            const entryRel = path.join(rel, entry);
+            const stat = await this.fs.promises.stat(path.join(dir, entryRel));
+            if (stat.isDirectory()) {
+                dirs.push(entryRel);
+                await this.walk(dir, files, dirs, entryRel);
+            } else {
+                files.push(entryRel);
+            }
+        }
+    }
+
+    public listBackups(): string[] {
+        if (!this.fs.existsSync(this.dir)) {
+            return [];
+        }
+        return this.fs.readdirSync(this.dir)
+            .filter((x) => x.endsWith('.json'))
+            .map((x) => x.slice(0, -'.json'.length));
+    }
+
+    public readManifest(name: string): BackupManifest | undefined {
+        try {
+            return JSON.parse(this.fs.readFileSync(this.getManifestPath(name), { encoding: 'utf-8' }));
+        } catch {
+            return undefined;
+        }
+    }
+
+    private getLatestManifest(): BackupManifest | undefined {
+        let latest: BackupManifest | undefined;
+        for (const name of this.listBackups()) {
+            const manifest = this.readManifest(name);
+            if (manifest && (!latest || manifest.created > latest.created)) {
+                latest = manifest;
+            }
+        }
+        return latest;
+    }
+
+    public async createBackup(source: string, name: string): Promise<BackupStoreResult> {
+        const result: BackupStoreResult = { files: 0, reused: 0, chunks: 0, newChunks: 0, newBytes: 0 };
+        const base = this.getLatestManifest();
+
+        const files: string[] = [];
+        const manifest: BackupManifest = {
+            name,
+            created: new Date().valueOf(),
+            source,
+            dirs: [],
+            files: {},
+        };
+        await this.walk(source, files, manifest.dirs);
+
+        for (const rel of files) {
+            const file = path.join(source, rel);
+            const stat = await this.fs.promises.stat(file);
+            const known = base?.files[rel];
+            result.files++;
+
+            if (known && known.size === stat.size && known.mtime === stat.mtime.getTime()) {
+                manifest.files[rel] = known;
+                result.reused++;
+                result.chunks += known.chunks.length;
+                continue;
+            }
+
+            const entry: BackupFileEntry = {
+                size: stat.size,
+                mtime: stat.mtime.getTime(),
+                chunks: [],
+            };
+            await this.chunkFile(file, async (chunk) => {
+                const hash = crypto.createHash('sha256').update(chunk).digest('hex');
+                entry.chunks.push(hash);
+                result.chunks++;
+                if (await this.writeChunk(hash, chunk)) {
+                    result.newChunks++;
+                    result.newBytes += chunk.length;
+                }
+            });
+            manifest.files[rel] = entry;
+        }
+
+        // the manifest is written last, so incomplete backups are not listed and their chunks are collected
+        const manifestPath = this.getManifestPath(name);
+        await this.fs.promises.writeFile(`${manifestPath}.tmp`, JSON.stringify(manifest));
+        await this.fs.promises.rename(`${manifestPath}.tmp`, manifestPath);
+
+        return result;
+    }
+
+    public async restore(name: string, target: string): Promise<void> {
+        const manifest = this.readManifest(name);
+        if (!manifest) {
+            throw new Error(`Backup ${name} not found`);
+        }
+
+        await this.fs.promises.mkdir(target, { recursive: true });
+        for (const dir of manifest.dirs) {
+            await this.fs.promises.mkdir(path.join(target, dir), { recursive: true });
+        }
+        for (const rel of Object.keys(manifest.files)) {
+            const entry = manifest.files[rel];
+            const file = path.join(target, rel);
+            const handle = await this.fs.promises.open(file, 'w');
+            try {
+                for (const hash of entry.chunks) {
+                    const chunk = await gunzip(await this.fs.promises.readFile(this.getChunkPath(hash)));
+                    await handle.write(chunk, 0, chunk.length);
+                }
+            } finally {
+                await handle.close();
+            }
+            const mtime = new Date(entry.mtime);
+            await this.fs.promises.utimes(file, mtime, mtime);
+        }
+    }
+
+    public async remove(name: string): Promise<void> {
+        await this.fs.promises.unlink(this.getManifestPath(name));
+    }
+
+    /**
+     * Removes chunks which are not referenced by any backup anymore
+     *
+     * @returns the number of removed chunks
+     */
+    public async gc(): Promise<number> {
+        if (!this.fs.existsSync(this.chunkDir)) {
+            return 0;
+        }
+
+        const referenced = new Set<string>();
+        for (const name of this.listBackups()) {
+            const manifest = this.readManifest(name);
+            if (!manifest) {
+                // do not collect anything if a backup is unreadable
+                return 0;
+            }
+            for (const rel of Object.keys(manifest.files)) {
+                for (const hash of manifest.files[rel].chunks) {
+                    referenced.add(hash);
+                }
+            }
+        }
+
+        let removed = 0;
+        for (const prefix of await this.fs.promises.readdir(this.chunkDir)) {
+            const prefixDir = path.join(this.chunkDir, prefix);
+            for (const chunk of await this.fs.promises.readdir(prefixDir)) {
+                if (!referenced.has(chunk)) {
+                    await this.fs.promises.unlink(path.join(prefixDir, chunk));
+                    removed++;
+                }
+            }
+        }
+        return removed;
+    }
+
+}
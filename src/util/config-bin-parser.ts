@@ -0,0 +1,159 @@
+import { extendConfigArray } from './config-parser';
+
+const RAP_SIGNATURE = Buffer.from([0, 0x72, 0x61, 0x50]); // \0raP
+
+const MAX_CLASS_DEPTH = 64;
+
+const set = (target: Record<string, any>, name: string, value: any): void => {
+    // mods are untrusted input
+    if (name !== '__proto__') {
+        target[name] = value;
+    }
+};
+
+export const isConfigBin = (buf: Buffer): boolean => buf.length >= 16 && buf.subarray(0, 4).equals(RAP_SIGNATURE);
+
+/**
+ * Parser for binarized configs (config.bin, "rapified")
+ *
+ * Produces the same structure as ConfigParser.cfg2json, so binarized and plain configs are interchangeable.
+ */
+class ConfigBinReader {
+
+    public constructor(
+        private buf: Buffer,
+    ) {}
+
+    private asciiz(pos: { offset: number }): string {
+        const end = this.buf.indexOf(0, pos.offset);
+        if (end === -1) {
+            throw new Error(`Unterminated string at ${pos.offset}`);
+        }
+        const str = this.buf.toString('utf-8', pos.offset, end);
+        pos.offset = end + 1;
+        return str;
+    }
+
+    private compressedInt(pos: { offset: number }): number {
+        let value = 0;
+        let shift = 0;
+        let byte: number;
+        do {
+            byte = this.buf[pos.offset++];
+            if (byte === undefined) {
+                throw new Error('Unexpected end of config');
+            }
+            value += (byte & 0x7f) * (2 ** shift);
+            shift += 7;
+        } while (byte & 0x80);
+        return value;
+    }
+
+    private float(pos: { offset: number }): number {
+        const value = this.buf.readFloatLE(pos.offset);
+        pos.offset += 4;
+        // float32 -> the value as written in the source (0.1 instead of 0.10000000149011612)
+        return Number(value.toPrecision(7));
+    }
+
+    private int(pos: { offset: number }): number {
+        const value = this.buf.readInt32LE(pos.offset);
+        pos.offset += 4;
+        return value;
+    }
+
+    private value(type: number, pos: { offset: number }): any {
+        switch (type) {
+            case 0: // string
+            case 4: // variable / expression
+                return this.asciiz(pos);
+            case 1:
+                return this.float(pos);
+            case 2:
+                return this.int(pos);
+            case 3:
+                return this.array(pos);
+            case 6: {
+                // int64, precise up to 2^53
+                const value = this.buf.readInt32LE(pos.offset + 4) * 0x100000000 + this.buf.readUInt32LE(pos.offset);
+                pos.offset += 8;
+                return value;
+            }
+            default:
+                throw new Error(`Unknown value type ${type} at ${pos.offset}`);
+        }
+    }
+
+    private array(pos: { offset: number }): any[] {
+        const count = this.compressedInt(pos);
+        const result: any[] = [];
+        for (let i = 0; i < count; i++) {
+            const type = this.buf[pos.offset++];
+            result.push(this.value(type, pos));
+        }
+        return result;
+    }
+
+    public classBody(offset: number, depth: number = 0): Record<string, any> {
+        if (depth > MAX_CLASS_DEPTH || offset >= this.buf.length) {
+            throw new Error(`Invalid class offset ${offset}`);
+        }
+        const pos = { offset };
+        const result: Record<string, any> = {};
+        const inherited = this.asciiz(pos);
+        const count = this.compressedInt(pos);
+
+        for (let i = 0; i < count; i++) {
+            const type = this.buf[pos.offset++];
+            switch (type) {
+                case 0: { // class
+                    const name = this.asciiz(pos);
+                    const bodyOffset = this.buf.readUInt32LE(pos.offset);
+                    pos.offset += 4;
+                    set(result, name, this.classBody(bodyOffset, depth + 1));
+                    break;
+                }
+                case 1: { // value
+                    const subType = this.buf[pos.offset++];
+                    const name = this.asciiz(pos);
+                    set(result, name, this.value(subType, pos));
+                    break;
+                }
+                case 2: { // array
+                    const name = this.asciiz(pos);
+                    set(result, name, this.array(pos));
+                    break;
+                }
+                case 3: // extern class
+                    this.asciiz(pos);
+                    break;
+                case 4: // delete class
+                    delete result[this.asciiz(pos)];
+                    break;
+                case 5: { // array with flags: 1 = +=, 2 = -=
+                    const flags = this.buf.readUInt32LE(pos.offset);
+                    pos.offset += 4;
+                    const name = this.asciiz(pos);
+                    set(result, name, extendConfigArray(result[name], this.array(pos), flags === 2));
+                    break;
+                }
+                default:
+                    throw new Error(`Unknown entry type ${type} at ${pos.offset - 1}`);
+            }
+        }
+
+        if (inherited) {
+            result.__inherited = inherited;
+        }
+        return result;
+    }
+
+}
+
+export const parseConfigBin = (buf: Buffer): any => {
+    if (!isConfigBin(buf)) {
+        throw new Error('Not a binarized config');
+    }
+    // header: signature, 0, 8, enum offset - the root class starts after it
+    return new ConfigBinReader(buf).classBody(16);
+};
@@ -1,4 +1,369 @@
 
+export interface ConfigParseOptions {
+    /**
+     * Resolves the content of #include "file" directives, which is then parsed in place.
+     * Includes are ignored without a resolver.
+     * Returning the resolved file name alongside the content makes it the "from" of nested includes.
+     *
+     * @param file the included file as written in the directive
+     * @param from the file that contains the directive (opts.file for the root input)
+     */
+    include?: (file: string, from?: string) => string | { file: string; content: string } | undefined;
+    /** name of the root input, passed to the include resolver */
+    file?: string;
+}
+
+const CHAR_TAB = 9;
+const CHAR_LF = 10;
+const CHAR_CR = 13;
+const CHAR_SPACE = 32;
+const CHAR_QUOTE = 34;
+const CHAR_HASH = 35;
+const CHAR_SINGLE_QUOTE = 39;
+const CHAR_SLASH = 47;
+const CHAR_STAR = 42;
+const CHAR_COMMA = 44;
+const CHAR_COLON = 58;
+const CHAR_SEMICOLON = 59;
+const CHAR_EQUALS = 61;
+const CHAR_BRACKET_OPEN = 91;
+const CHAR_BRACKET_CLOSE = 93;
+const CHAR_BACKSLASH = 92;
+const CHAR_BRACE_OPEN = 123;
+const CHAR_BRACE_CLOSE = 125;
+const CHAR_PLUS = 43;
+const CHAR_MINUS = 45;
+
+const MAX_INCLUDE_DEPTH = 32;
+
+/**
+ * Applies an array extension (name[] += {...} or name[] -= {...}) to the values already known in the same class.
+ * Values are removed by equality, nested arrays by their content.
+ */
+export const extendConfigArray = (existing: any, values: any[], remove: boolean): any[] => {
+    const current: any[] = Array.isArray(existing) ? existing : [];
+    if (!remove) {
+        return [...current, ...values];
+    }
+    const key = (x: any): string => JSON.stringify(x);
+    const removed = new Set(values.map(key));
+    return current.filter((x) => !removed.has(key(x)));
+};
+
+const isIdentChar = (c: number): boolean =>
+    (c >= 48 && c <= 57) // 0-9
+    || (c >= 65 && c <= 90) // A-Z
+    || (c >= 97 && c <= 122) // a-z
+    || c === 95; // _
+
+/**
+ * Single pass recursive descent parser for the arma / dayz config format (server cfg, config.cpp).
+ *
+ * Works on the original input with an index instead of slicing and re-parsing class bodies,
+ * so the runtime is linear to the input size. Only identifiers and values are sliced out.
+ */
+class ConfigReader {
+
+    private pos = 0;
+    private readonly len: number;
+
+    public constructor(
+        private input: string,
+        private opts: ConfigParseOptions,
+        private file: string | undefined,
+        private includeDepth: number,
+    ) {
+        this.len = input.length;
+    }
+
+    private error(message: string): Error {
+        // only compute the line if needed
+        let line = 1;
+        for (let i = 0; i < this.pos && i < this.len; i++) {
+            if (this.input.charCodeAt(i) === CHAR_LF) line++;
+        }
+        return new Error(`${message} at ${this.file ?? 'input'}:${line}`);
+    }
+
+    private skipToEol(): void {
+        while (this.pos < this.len) {
+            const c = this.input.charCodeAt(this.pos);
+            if (c === CHAR_LF) {
+                // a backslash continues the line, also with crlf line endings
+                const prev = this.input.charCodeAt(this.pos - 1) === CHAR_CR ? this.pos - 2 : this.pos - 1;
+                if (this.input.charCodeAt(prev) !== CHAR_BACKSLASH) {
+                    return;
+                }
+            }
+            this.pos++;
+        }
+    }
+
+    private directive(target: Record<string, any>): void {
+        const start = this.pos;
+        this.skipToEol();
+        const line = this.input.slice(start, this.pos);
+        const include = /^#include\s*["<]([^">]+)[">]/.exec(line);
+        if (!include || !this.opts.include) {
+            // other preprocessor directives (#define, #ifdef, ...) are not supported and skipped
+            return;
+        }
+        if (this.includeDepth >= MAX_INCLUDE_DEPTH) {
+            throw this.error(`Include depth exceeded for ${include[1]}`);
+        }
+        const included = this.opts.include(include[1], this.file);
+        if (included === undefined || included === null) {
+            return;
+        }
+        const [file, content] = typeof included === 'string'
+            ? [include[1], included]
+            : [included.file, included.content];
+        new ConfigReader(content, this.opts, file, this.includeDepth + 1).parseBody(target, false);
+    }
+
+    /**
+     * skips whitespace and comments
+     */
+    private skip(): void {
+        while (this.pos < this.len) {
+            const c = this.input.charCodeAt(this.pos);
+            if (c === CHAR_SPACE || c === CHAR_TAB || c === CHAR_LF || c === CHAR_CR) {
+                this.pos++;
+            } else if (c === CHAR_SLASH && this.input.charCodeAt(this.pos + 1) === CHAR_SLASH) {
+                this.skipToEol();
+            } else if (c === CHAR_SLASH && this.input.charCodeAt(this.pos + 1) === CHAR_STAR) {
+                const end = this.input.indexOf('*/', this.pos + 2);
+                this.pos = end === -1 ? this.len : end + 2;
+            } else {
+                return;
+            }
+        }
+    }
+
+    private peek(): number {
+        return this.input.charCodeAt(this.pos);
+    }
+
+    private expect(c: number): void {
+        this.skip();
+        if (this.peek() !== c) {
+            throw this.error(`Expected "${String.fromCharCode(c)}"`);
+        }
+        this.pos++;
+    }
+
+    /**
+     * semicolons after values and classes are optional in some configs
+     */
+    private optional(c: number): void {
+        this.skip();
+        if (this.peek() === c) {
+            this.pos++;
+        }
+    }
+
+    private ident(): string {
+        this.skip();
+        const start = this.pos;
+        while (this.pos < this.len && isIdentChar(this.input.charCodeAt(this.pos))) {
+            this.pos++;
+        }
+        const ident = this.input.slice(start, this.pos);
+        // also parses untrusted mod configs
+        if (!ident || ident === '__proto__') {
+            throw this.error('Expected identifier');
+        }
+        return ident;
+    }
+
+    private string(): string {
+        const quote = this.input.charCodeAt(this.pos);
+        const quoteChar = String.fromCharCode(quote);
+        let start = ++this.pos;
+        let result = '';
+        while (this.pos < this.len) {
+            const end = this.input.indexOf(quoteChar, this.pos);
+            if (end === -1) {
+                break;
+            }
+            // doubled quotes are escaped quotes
+            if (this.input.charCodeAt(end + 1) === quote) {
+                result += this.input.slice(start, end + 1);
+                start = this.pos = end + 2;
+                continue;
+            }
+            this.pos = end + 1;
+            return result + this.input.slice(start, end);
+        }
+        throw this.error('Unterminated string');
+    }
+
+    private scalar(inArray: boolean): any {
+        this.skip();
+        const c = this.peek();
+        if (c === CHAR_QUOTE || c === CHAR_SINGLE_QUOTE) {
+            return this.string();
+        }
+        const start = this.pos;
+        while (this.pos < this.len) {
+            const next = this.input.charCodeAt(this.pos);
+            if (
+                next === CHAR_LF
+                || next === CHAR_BRACE_CLOSE
+                || next === (inArray ? CHAR_COMMA : CHAR_SEMICOLON)
+                || (next === CHAR_SLASH && this.input.charCodeAt(this.pos + 1) === CHAR_SLASH)
+            ) {
+                break;
+            }
+            this.pos++;
+        }
+        const raw = this.input.slice(start, this.pos).trim();
+        const lower = raw.toLowerCase();
+        if (lower === 'true' || lower === 'false') {
+            return lower === 'true';
+        }
+        if (raw !== '' && !isNaN(Number(raw))) {
+            return Number(raw);
+        }
+        // unquoted strings and macros
+        return raw;
+    }
+
+    private array(): any[] {
+        this.expect(CHAR_BRACE_OPEN);
+        const result: any[] = [];
+        this.skip();
+        if (this.peek() === CHAR_BRACE_CLOSE) {
+            this.pos++;
+            return result;
+        }
+        while (this.pos < this.len) {
+            this.skip();
+            if (this.peek() === CHAR_BRACE_OPEN) {
+                result.push(this.array());
+            } else {
+                result.push(this.scalar(true));
+            }
+            this.skip();
+            const c = this.peek();
+            this.pos++;
+            if (c === CHAR_BRACE_CLOSE) {
+                return result;
+            }
+            if (c !== CHAR_COMMA) {
+                this.pos--;
+                throw this.error('Expected "," or "}" in array');
+            }
+        }
+        throw this.error('Unexpected end of array');
+    }
+
+    private skipBlock(): void {
+        this.expect(CHAR_BRACE_OPEN);
+        let depth = 1;
+        while (this.pos < this.len && depth > 0) {
+            const c = this.peek();
+            if (c === CHAR_QUOTE || c === CHAR_SINGLE_QUOTE) {
+                this.string();
+                continue;
+            }
+            if (c === CHAR_BRACE_OPEN) depth++;
+            if (c === CHAR_BRACE_CLOSE) depth--;
+            this.pos++;
+        }
+    }
+
+    public parseBody(target: Record<string, any>, nested: boolean): Record<string, any> {
+        for (;;) {
+            this.skip();
+            if (this.pos >= this.len) {
+                if (nested) {
+                    throw this.error('Unexpected end of file in class');
+                }
+                return target;
+            }
+
+            const c = this.peek();
+            if (c === CHAR_BRACE_CLOSE) {
+                if (!nested) {
+                    throw this.error('Unexpected "}"');
+                }
+                this.pos++;
+                return target;
+            }
+            if (c === CHAR_HASH) {
+                this.directive(target);
+                continue;
+            }
+            if (c === CHAR_SEMICOLON) {
+                this.pos++;
+                continue;
+            }
+
+            const name = this.ident();
+            if (name === 'class') {
+                const className = this.ident();
+                this.skip();
+                let base: string | undefined;
+                if (this.peek() === CHAR_COLON) {
+                    this.pos++;
+                    base = this.ident();
+                    this.skip();
+                }
+                if (this.peek() === CHAR_BRACE_OPEN) {
+                    this.pos++;
+                    // reopening a class (i.e. via includes) extends it
+                    const existing = target[className];
+                    const cls = this.parseBody(
+                        (existing && typeof existing === 'object' && !Array.isArray(existing)) ? existing : {},
+                        true,
+                    );
+                    if (base) {
+                        cls.__inherited = base;
+                    }
+                    target[className] = cls;
+                }
+                // forward declarations (class X;) are skipped
+                this.optional(CHAR_SEMICOLON);
+                continue;
+            }
+            if (name === 'delete') {
+                delete target[this.ident()];
+                this.optional(CHAR_SEMICOLON);
+                continue;
+            }
+            if (name === 'enum') {
+                this.skipBlock();
+                this.optional(CHAR_SEMICOLON);
+                continue;
+            }
+
+            this.skip();
+            if (this.peek() === CHAR_BRACKET_OPEN) {
+                this.pos++;
+                this.expect(CHAR_BRACKET_CLOSE);
+                this.skip();
+                const op = this.peek();
+                if (op === CHAR_PLUS || op === CHAR_MINUS) {
+                    this.pos++;
+                }
+                this.expect(CHAR_EQUALS);
+                const values = this.array();
+                target[name] = (op === CHAR_PLUS || op === CHAR_MINUS)
+                    ? extendConfigArray(target[name], values, op === CHAR_MINUS)
+                    : values;
+                this.optional(CHAR_SEMICOLON);
+                continue;
+            }
+
+            this.expect(CHAR_EQUALS);
+            target[name] = this.scalar(false);
+            this.optional(CHAR_SEMICOLON);
+        }
+    }
+
+}
+
 /**
  * Config parser ported from arma-config-parser
  */
@@ -14,7 +379,20 @@ export class ConfigParser {
         return -1;
     }
 
-    public cfg2json(input: string, level?: number): any {
+    /**
+     * Parses a config in a single pass.
+     * Supports classes with inheritance (stored as __inherited), arrays (also nested, += and -=), #include and comments.
+     */
+    public cfg2json(input: string, opts?: ConfigParseOptions): any {
+        return new ConfigReader(input, opts ?? {}, opts?.file, 0).parseBody({}, false);
+    }
+
+    /**
+     * The previous line based parser, kept for comparison (see scripts/bench-config-parser.ts)
+     *
+     * @deprecated use cfg2json
+     */
+    public cfg2jsonLegacy(input: string, level?: number): any {
         level = (level || 0) + 1;
 
         input = input
@@ -63,7 +441,7 @@ export class ConfigParser {
                         }
                         ptr += 1;
                     }
-                    output[classMatch[1]] = this.cfg2json(
+                    output[classMatch[1]] = this.cfg2jsonLegacy(
                         `${input.slice(innerStart, ptr - 1).trim()}\n`,
                         level,
                     );
@@ -126,6 +504,13 @@ export class ConfigParser {
     }
 
 
+    /**
+     * quotes in strings are escaped by doubling them
+     */
+    private escapeString(val: string): string {
+        return String(val).replace(/"/g, '""');
+    }
+
     public json2cfg(input: any, indent? : number): string {
         indent = indent || 0;
         const tabs = '\t'.repeat(indent);
@@ -143,7 +528,7 @@ export class ConfigParser {
                     break;
                 }
                 case 'string': {
-                    output.push(`${tabs}${key}="${val}";`);
+                    output.push(`${tabs}${key}="${this.escapeString(val)}";`);
                     break;
                 }
                 case 'array': {
@@ -154,7 +539,7 @@ export class ConfigParser {
                         );
                         val.forEach((v, i, a) => {
                             if (isNaN(v)) {
-                                output.push(`${tabs}\t"${v}"${(i === (a.length - 1)) ? '' : ','}`);
+                                output.push(`${tabs}\t"${this.escapeString(v)}"${(i === (a.length - 1)) ? '' : ','}`);
                             } else {
                                 output.push(`${tabs}\t${v}${(i === (a.length - 1)) ? '' : ','}`);
                             }
@@ -0,0 +1,26 @@
+import * as path from 'path';
+import { FSAPI } from './apis';
+
+export const copySync = (fs: FSAPI, source: string, target: string): void => {
+
+    // src=somedir/test target=tmp -> tmp/test
+    if (fs.lstatSync(source).isDirectory()) {
+        if (!fs.existsSync(target)) {
+            fs.mkdirSync(target, { recursive: true });
+        }
+        fs.readdirSync(source).forEach((file) => {
+            const curSource = path.join(source, file);
+            const curTarget = path.join(target, file);
+            if (fs.lstatSync(curSource).isDirectory()) {
+                copySync(fs, curSource, curTarget);
+            } else {
+                fs.copyFileSync(curSource, curTarget);
+            }
+        });
+    } else {
+        if (!fs.existsSync(target)) {
+            fs.mkdirSync(target, { recursive: true });
+        }
+        fs.copyFileSync(source, path.join(target, path.basename(source)));
+    }
+};
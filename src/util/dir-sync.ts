@@ -0,0 +1,400 @@
+import * as path from 'path';
+import * as crypto from 'crypto';
+import { constants } from 'fs';
+import { FSAPI } from './apis';
+
+/**
+ * copy: copies the files
+ * hardlink: links the files, requires source and target to be on the same filesystem
+ * symlink: creates symlinks to the source files
+ */
+export type DirSyncMode = 'copy' | 'hardlink' | 'symlink';
+
+export interface DirSyncManifestEntry {
+    // stats of the source file when it was last synced
+    size: number;
+    mtime: number;
+    hash: string;
+    // mtime of the target file after it was last synced, to detect changes in the target dir
+    targetMtime: number;
+}
+
+export interface DirSyncManifest {
+    source: string;
+    target: string;
+    lowerCaseTarget: boolean;
+    mode: DirSyncMode;
+    // relative source path -> entry
+    files: Record<string, DirSyncManifestEntry>;
+}
+
+export interface DirSyncOptions {
+    /** where to persist the manifest between syncs */
+    manifestPath: string;
+    /** use lower case file and dir names in the target dir */
+    lowerCaseTarget?: boolean;
+    /** how the target files are created, defaults to copy */
+    mode?: DirSyncMode;
+    /** how many files to compare and copy at the same time */
+    concurrency?: number;
+    /** relative paths which are neither synced nor removed from the target */
+    exclude?: string[];
+}
+
+export interface DirSyncResult {
+    copied: number;
+    removed: number;
+    unchanged: number;
+    /** source files which were skipped, because their lower case target is already used by another file */
+    collisions?: string[];
+}
+
+interface FileStats {
+    size: number;
+    mtime: number;
+    ino: number;
+    dev: number;
+    symlink: boolean;
+}
+
+/**
+ * Incrementally syncs a source dir to a target dir, similar to rsync.
+ *
+ * Files are only copied if they changed since the last sync, which is detected via a persisted manifest of size, mtime and content hash.
+ * Contents are only hashed if the stats changed, so unchanged trees are synced with just a walk over both dirs.
+ * Copies use copy-on-write clones (reflinks) where the filesystem supports them.
+ * Changed files are copied to a temporary file and renamed over the target, so the file a running server has open is never truncated.
+ * Files in the target dir, which do not exist in the source dir, are removed.
+ *
+ * Instead of copying, the target can also be built as a tree of hard- or symlinks to the source files,
+ * which leaves the source dir untouched, even if the target names are lowercased.
+ */
+export class DirSync {
+
+    public static readonly DEFAULT_CONCURRENCY = 8;
+
+    public constructor(
+        private fs: FSAPI,
+        public source: string,
+        public target: string,
+        private opts: DirSyncOptions,
+    ) {}
+
+    private toTargetRel(rel: string): string {
+        return this.opts.lowerCaseTarget ? rel.toLowerCase() : rel;
+    }
+
+    private isExcluded(rel: string, lowerCase?: boolean): boolean {
+        return !!this.opts.exclude?.some((x) => {
+            const excluded = path.normalize(lowerCase ? this.toTargetRel(x) : x);
+            return rel === excluded || rel.startsWith(excluded + path.sep);
+        });
+    }
+
+    private async walk(dir: string, files: Map<string, FileStats>, dirs?: string[], rel: string = ''): Promise<void> {
+        const entries = await this.fs.promises.readdir(path.join(dir, rel));
+        for (const entry of entries) {
+            const entryRel = path.join(rel, entry);
+            if (this.isExcluded(entryRel, dir === this.target)) {
+                continue;
+            }
+            const stat = await this.fs.promises.lstat(path.join(dir, entryRel));
+            if (stat.isDirectory()) {
+                dirs?.push(entryRel);
+                await this.walk(dir, files, dirs, entryRel);
+            } else {
+                files.set(entryRel, {
+                    size: stat.size,
+                    mtime: stat.mtime.getTime(),
+                    ino: stat.ino,
+                    dev: stat.dev,
+                    symlink: stat.isSymbolicLink(),
+                });
+            }
+        }
+    }
+
+    private hashFile(file: string): Promise<string> {
+        return new Promise((res, rej) => {
+            const hash = crypto.createHash('sha1');
+            const stream = this.fs.createReadStream(file);
+            stream.on('error', rej);
+            stream.on('data', (chunk) => hash.update(chunk));
+            stream.on('end', () => res(hash.digest('hex')));
+        });
+    }
+
+    private get mode(): DirSyncMode {
+        return this.opts.mode ?? 'copy';
+    }
+
+    private readManifest(): DirSyncManifest['files'] {
+        try {
+            const manifest: DirSyncManifest = JSON.parse(
+                this.fs.readFileSync(this.opts.manifestPath, { encoding: 'utf-8' }),
+            );
+            if (
+                manifest.source === this.source
+                && manifest.target === this.target
+                && manifest.lowerCaseTarget === !!this.opts.lowerCaseTarget
+                && (manifest.mode ?? 'copy') === this.mode
+            ) {
+                return manifest.files ?? {};
+            }
+        } catch {
+            // no or broken manifest, which just means a full compare
+        }
+        return {};
+    }
+
+    private writeManifest(files: DirSyncManifest['files']): void {
+        this.fs.mkdirSync(path.dirname(this.opts.manifestPath), { recursive: true });
+        this.fs.writeFileSync(
+            this.opts.manifestPath,
+            JSON.stringify({
+                source: this.source,
+                target: this.target,
+                lowerCaseTarget: !!this.opts.lowerCaseTarget,
+                mode: this.mode,
+                files,
+            } as DirSyncManifest),
+        );
+    }
+
+    private async runParallel(jobs: (() => Promise<void>)[]): Promise<void> {
+        const queue = [...jobs];
+        const workers = Math.max(1, Math.min(this.opts.concurrency || DirSync.DEFAULT_CONCURRENCY, queue.length));
+        await Promise.all(
+            Array.from({ length: workers }, async () => {
+                while (queue.length) {
+                    await queue.shift()!();
+                }
+            }),
+        );
+    }
+
+    /**
+     * @returns whether writing to the target file would write to the source file
+     */
+    private isLinkedToSource(sourceStats: FileStats, targetStats: FileStats): boolean {
+        return targetStats.symlink || (targetStats.ino === sourceStats.ino && targetStats.dev === sourceStats.dev);
+    }
+
+    /**
+     * @returns whether the target file is a link to the source file
+     */
+    private async isLinked(
+        rel: string,
+        sourceStats: FileStats,
+        targetStats: FileStats,
+        entry: DirSyncManifestEntry | undefined,
+    ): Promise<boolean> {
+        if (this.mode === 'hardlink') {
+            return !targetStats.symlink && targetStats.ino === sourceStats.ino && targetStats.dev === sourceStats.dev;
+        }
+
+        if (!targetStats.symlink) {
+            return false;
+        }
+        if (
+            entry
+            && entry.size === sourceStats.size
+            && entry.mtime === sourceStats.mtime
+            && entry.targetMtime === targetStats.mtime
+        ) {
+            return true;
+        }
+        return (
+            await this.fs.promises.readlink(path.join(this.target, this.toTargetRel(rel)))
+        ) === path.join(this.source, rel);
+    }
+
+    /**
+     * @returns whether the target file is known to have the same content as the source file
+     */
+    private async isUpToDate(
+        rel: string,
+        sourceStats: FileStats,
+        targetStats: FileStats | undefined,
+        entry: DirSyncManifestEntry | undefined,
+        newEntry: DirSyncManifestEntry,
+    ): Promise<boolean> {
+        if (!targetStats) {
+            return false;
+        }
+
+        if (this.mode !== 'copy') {
+            return this.isLinked(rel, sourceStats, targetStats, entry);
+        }
+
+        // links in the source are synced as links
+        if (sourceStats.symlink) {
+            return targetStats.symlink && (
+                await this.fs.promises.readlink(path.join(this.target, this.toTargetRel(rel)))
+            ) === (
+                await this.fs.promises.readlink(path.join(this.source, rel))
+            );
+        }
+
+        if (this.isLinkedToSource(sourceStats, targetStats) || targetStats.size !== sourceStats.size) {
+            return false;
+        }
+
+        let knownTargetHash: string | undefined;
+        if (entry && entry.targetMtime === targetStats.mtime && entry.size === targetStats.size) {
+            if (entry.mtime === sourceStats.mtime) {
+                newEntry.hash = entry.hash;
+                return true;
+            }
+            knownTargetHash = entry.hash;
+        }
+
+        // stats changed (i.e. the mod was downloaded again), so compare the contents
+        newEntry.hash = await this.hashFile(path.join(this.source, rel));
+        const targetHash = knownTargetHash ?? await this.hashFile(path.join(this.target, this.toTargetRel(rel)));
+        return newEntry.hash === targetHash;
+    }
+
+    public async sync(): Promise<DirSyncResult> {
+        const result: DirSyncResult = { copied: 0, removed: 0, unchanged: 0 };
+
+        // never sync into a link to the source (i.e. mods that were linked before)
+        if (this.fs.existsSync(this.target) && this.fs.lstatSync(this.target).isSymbolicLink()) {
+            this.fs.unlinkSync(this.target);
+        }
+        this.fs.mkdirSync(this.target, { recursive: true });
+
+        const sourceFiles = new Map<string, FileStats>();
+        const sourceDirs: string[] = [];
+        const targetFiles = new Map<string, FileStats>();
+        let targetDirs: string[] = [];
+        await Promise.all([
+            this.walk(this.source, sourceFiles, sourceDirs),
+            this.walk(this.target, targetFiles, targetDirs),
+        ]);
+
+        const manifest = this.readManifest();
+        const newManifest: DirSyncManifest['files'] = {};
+        const expectedTargets = new Set<string>();
+        const jobs: (() => Promise<void>)[] = [];
+
+        // replace target dirs which are files in the source (i.e. linked mod dirs) and the other way around
+        const targetDirSet = new Set(targetDirs);
+        for (const rel of sourceFiles.keys()) {
+            const targetRel = this.toTargetRel(rel);
+            if (targetDirSet.has(targetRel)) {
+                this.fs.rmSync(path.join(this.target, targetRel), { recursive: true });
+                targetDirs = targetDirs.filter((x) => x !== targetRel && !x.startsWith(targetRel + path.sep));
+                for (const targetFile of [...targetFiles.keys()]) {
+                    if (targetFile.startsWith(targetRel + path.sep)) {
+                        targetFiles.delete(targetFile);
+                    }
+                }
+            }
+        }
+        for (const dir of sourceDirs) {
+            const targetDir = this.toTargetRel(dir);
+            if (targetFiles.has(targetDir)) {
+                this.fs.unlinkSync(path.join(this.target, targetDir));
+                targetFiles.delete(targetDir);
+            }
+            this.fs.mkdirSync(path.join(this.target, targetDir), { recursive: true });
+        }
+
+        const collisions: string[] = [];
+        for (const [rel, sourceStats] of sourceFiles) {
+            const targetRel = this.toTargetRel(rel);
+            const targetStats = targetFiles.get(targetRel);
+            if (expectedTargets.has(targetRel)) {
+                // names which only differ by case, the first one wins
+                collisions.push(rel);
+                continue;
+            }
+            expectedTargets.add(targetRel);
+
+            const newEntry: DirSyncManifestEntry = {
+                size: sourceStats.size,
+                mtime: sourceStats.mtime,
+                hash: '',
+                targetMtime: targetStats?.mtime ?? 0,
+            };
+            newManifest[rel] = newEntry;
+
+            jobs.push(async () => {
+                if (await this.isUpToDate(rel, sourceStats, targetStats, manifest[rel], newEntry)) {
+                    result.unchanged++;
+                    return;
+                }
+
+                const sourceFile = path.join(this.source, rel);
+                const targetFile = path.join(this.target, targetRel);
+                if (this.mode === 'copy' && sourceStats.symlink) {
+                    if (targetStats) {
+                        await this.fs.promises.unlink(targetFile);
+                    }
+                    await this.fs.promises.symlink(await this.fs.promises.readlink(sourceFile), targetFile);
+                } else if (this.mode === 'copy') {
+                    await this.replaceWithCopy(sourceFile, targetFile);
+                    newEntry.hash = newEntry.hash || await this.hashFile(sourceFile);
+                } else {
+                    if (targetStats) {
+                        await this.fs.promises.unlink(targetFile);
+                    }
+                    if (this.mode === 'hardlink') {
+                        await this.fs.promises.link(sourceFile, targetFile);
+                    } else {
+                        await this.fs.promises.symlink(sourceFile, targetFile);
+                    }
+                }
+                newEntry.targetMtime = (await this.fs.promises.lstat(targetFile)).mtime.getTime();
+                result.copied++;
+            });
+        }
+
+        await this.runParallel(jobs);
+
+        for (const targetRel of targetFiles.keys()) {
+            if (!expectedTargets.has(targetRel)) {
+                await this.fs.promises.unlink(path.join(this.target, targetRel));
+                result.removed++;
+            }
+        }
+
+        // remove dirs which are not part of the source anymore, deepest first
+        const expectedDirs = new Set(sourceDirs.map((x) => this.toTargetRel(x)));
+        for (const dir of targetDirs.filter((x) => !expectedDirs.has(x)).reverse()) {
+            try {
+                await this.fs.promises.rmdir(path.join(this.target, dir));
+            } catch (e) {
+                // the remaining entries are excluded, so the dir is kept
+                if (e?.code !== 'ENOTEMPTY' && e?.code !== 'EEXIST') {
+                    throw e;
+                }
+            }
+        }
+
+        this.writeManifest(newManifest);
+
+        if (collisions.length) {
+            result.collisions = collisions;
+        }
+        return result;
+    }
+
+    /**
+     * Copies the file next to the target and renames it over the target.
+     * Replacing the dir entry leaves the old file intact for anyone who has it open and never writes through links into the source.
+     */
+    private async replaceWithCopy(sourceFile: string, targetFile: string): Promise<void> {
+        const tmpFile = path.join(path.dirname(targetFile), `.${path.basename(targetFile)}.${crypto.randomBytes(4).toString('hex')}.tmp`);
+        try {
+            // uses a copy-on-write clone if supported and falls back to a regular copy
+            await this.fs.promises.copyFile(sourceFile, tmpFile, constants.COPYFILE_FICLONE);
+            await this.fs.promises.rename(tmpFile, targetFile);
+        } catch (e) {
+            await this.fs.promises.unlink(tmpFile).catch(() => { /* not created */ });
+            throw e;
+        }
+    }
+
+}
@@ -0,0 +1,272 @@
+import { MessageEmbed } from 'discord.js';
+import { RingBuffer } from './ring-buffer';
+
+export interface DiscordPayload {
+    content?: string;
+    embeds?: MessageEmbed[];
+}
+
+export type DiscordSendFnc = (payload: DiscordPayload) => Promise<any>;
+
+export interface DiscordQueueOptions {
+    /** time in ms messages are collected before they are sent as one message, 0 sends them on the next tick */
+    coalesceWindow: number;
+    /** max amount of queued messages, if exceeded the oldest low priority messages are dropped */
+    maxQueueSize: number;
+    /** messages allowed per rate limit window */
+    rateLimit: number;
+    /** rate limit window in ms */
+    rateLimitWindow: number;
+}
+
+export interface DiscordQueueStats {
+    /** queued messages */
+    depth: number;
+    sent: number;
+    /** discord messages actually sent (coalesced) */
+    requests: number;
+    dropped: number;
+    failed: number;
+    /** average time in ms from queueing to delivery of the last delivered messages */
+    avgLatency: number;
+    maxLatency: number;
+}
+
+interface QueuedMessage {
+    message?: string;
+    embeds?: MessageEmbed[];
+    lowPriority: boolean;
+    enqueued: number;
+    done: () => void;
+}
+
+/**
+ * Outbound queue of a single discord channel.
+ *
+ * Bursts of messages are coalesced into multi line messages (and up to 10 embeds per message),
+ * sends stay within the channel rate limit instead of piling up in discord.js,
+ * and under sustained overload the oldest low priority messages are dropped and summarized.
+ */
+export class DiscordChannelQueue {
+
+    public static readonly MAX_CONTENT_LENGTH = 2000;
+    public static readonly MAX_EMBEDS = 10;
+
+    private items: QueuedMessage[] = [];
+    private timer?: any;
+    private flushing = false;
+
+    // send timestamps within the current rate limit window
+    private sendTimes: number[] = [];
+    private droppedSinceSend = 0;
+
+    private latencies = new RingBuffer<number>(100);
+    private stats = { sent: 0, requests: 0, dropped: 0, failed: 0 };
+
+    public constructor(
+        private send: DiscordSendFnc,
+        private options: () => DiscordQueueOptions,
+        private onError: (e: any) => void,
+    ) {}
+
+    /**
+     * @returns a promise which resolves once the message was sent (or dropped)
+     */
+    public push(message: string | undefined, embeds: MessageEmbed[] | undefined, lowPriority: boolean): Promise<void> {
+        return new Promise((resolve) => {
+            // messages over the discord limit are sent in parts, the embeds with the last one
+            const parts = message ? this.split(message) : [message];
+            let pending = parts.length;
+            const enqueued = Date.now();
+            parts.forEach((part, i) => this.items.push({
+                message: part,
+                embeds: i === parts.length - 1 ? embeds : undefined,
+                lowPriority,
+                enqueued,
+                done: () => {
+                    if (--pending === 0) {
+                        resolve();
+                    }
+                },
+            }));
+            this.enforceLimit();
+            this.schedule(Math.max(0, this.options().coalesceWindow || 0));
+        });
+    }
+
+    public getStats(): DiscordQueueStats {
+        const latencies = this.latencies.toArray();
+        return {
+            depth: this.items.length,
+            ...this.stats,
+            avgLatency: latencies.length ? Math.round(latencies.reduce((a, b) => a + b, 0) / latencies.length) : 0,
+            maxLatency: latencies.length ? Math.max(...latencies) : 0,
+        };
+    }
+
+    /**
+     * sends all queued messages without waiting for the coalescing window or the rate limit budget
+     */
+    public async drain(): Promise<void> {
+        this.clearTimer();
+        while (this.items.length) {
+            await this.sendBatch();
+        }
+    }
+
+    public dispose(): void {
+        this.clearTimer();
+        for (const item of this.items.splice(0)) {
+            item.done();
+        }
+    }
+
+    private clearTimer(): void {
+        if (this.timer) {
+            clearTimeout(this.timer);
+            this.timer = undefined;
+        }
+    }
+
+    private schedule(delay: number): void {
+        if (this.timer || this.flushing) {
+            return;
+        }
+        this.timer = setTimeout(() => {
+            this.timer = undefined;
+            void this.flush();
+        }, delay);
+    }
+
+    private enforceLimit(): void {
+        const max = Math.max(1, this.options().maxQueueSize || 1);
+        for (let i = 0; i < this.items.length && this.items.length > max;) {
+            if (this.items[i].lowPriority) {
+                this.items.splice(i, 1)[0].done();
+                this.droppedSinceSend++;
+                this.stats.dropped++;
+            } else {
+                i++;
+            }
+        }
+    }
+
+    /**
+     * @returns the time in ms until the next message may be sent
+     */
+    private budgetWait(now: number): number {
+        const { rateLimit, rateLimitWindow } = this.options();
+        this.sendTimes = this.sendTimes.filter((x) => x > now - rateLimitWindow);
+        if (this.sendTimes.length < Math.max(1, rateLimit)) {
+            return 0;
+        }
+        return this.sendTimes[0] + rateLimitWindow - now;
+    }
+
+    private async flush(): Promise<void> {
+        this.flushing = true;
+        let wait = 0;
+        try {
+            while (this.items.length) {
+                wait = this.budgetWait(Date.now());
+                if (wait > 0) {
+                    break;
+                }
+                await this.sendBatch();
+            }
+        } finally {
+            this.flushing = false;
+        }
+        if (this.items.length) {
+            // new messages arrived while sending or the budget is used up
+            this.schedule(Math.max(wait, this.options().coalesceWindow || 0));
+        }
+    }
+
+    private takeBatch(): QueuedMessage[] {
+        const batch: QueuedMessage[] = [];
+        let contentLength = this.droppedSinceSend ? this.dropSummary().length : 0;
+        let embedCount = 0;
+        for (const item of this.items) {
+            const length = item.message ? item.message.length + (contentLength ? 1 : 0) : 0;
+            const embeds = item.embeds?.length ?? 0;
+            if (
+                // the drop summary is sent alone, if the first message does not fit next to it
+                (batch.length || contentLength)
+                && (
+                    contentLength + length > DiscordChannelQueue.MAX_CONTENT_LENGTH
+                    || embedCount + embeds > DiscordChannelQueue.MAX_EMBEDS
+                )
+            ) {
+                break;
+            }
+            batch.push(item);
+            contentLength += length;
+            embedCount += embeds;
+        }
+        this.items.splice(0, batch.length);
+        return batch;
+    }
+
+    private split(message: string): string[] {
+        const max = DiscordChannelQueue.MAX_CONTENT_LENGTH;
+        const parts: string[] = [];
+        let rest = message;
+        while (rest.length > max) {
+            // prefer splitting at line breaks
+            const lineBreak = rest.lastIndexOf('\n', max);
+            const end = lineBreak > 0 ? lineBreak : max;
+            parts.push(rest.slice(0, end));
+            rest = rest.slice(lineBreak > 0 ? end + 1 : end);
+        }
+        parts.push(rest);
+        return parts;
+    }
+
+    private dropSummary(): string {
+        return `(${this.droppedSinceSend} message${this.droppedSinceSend === 1 ? ' was' : 's were'} dropped because of rate limits)`;
+    }
+
+    private async sendBatch(): Promise<void> {
+        const summary = this.droppedSinceSend ? this.dropSummary() : undefined;
+        const batch = this.takeBatch();
+        const lines = batch.filter((x) => !!x.message).map((x) => x.message);
+        if (summary) {
+            lines.unshift(summary);
+        }
+        const embeds: MessageEmbed[] = [];
+        for (const item of batch) {
+            embeds.push(...(item.embeds ?? []));
+        }
+
+        const payload: DiscordPayload = {};
+        if (lines.length) {
+            payload.content = lines.join('\n');
+        }
+        if (embeds.length) {
+            payload.embeds = embeds;
+        }
+
+        this.droppedSinceSend = 0;
+        this.sendTimes.push(Date.now());
+        try {
+            if (payload.content || payload.embeds) {
+                await this.send(payload);
+                this.stats.requests++;
+            }
+            const now = Date.now();
+            for (const item of batch) {
+                this.latencies.push(now - item.enqueued);
+            }
+            this.stats.sent += batch.length;
+        } catch (e) {
+            this.stats.failed += batch.length;
+            this.onError(e);
+        } finally {
+            for (const item of batch) {
+                item.done();
+            }
+        }
+    }
+
+}
@@ -0,0 +1,219 @@
+/**
+ * types: types.xml and other type files registered in the cfgeconomycore.xml
+ * spawnabletypes: cfgspawnabletypes.xml
+ * eventspawns: cfgeventspawns.xml
+ * mapgrouppos: mapgrouppos.xml
+ * other: any other xml, which is only cached but not indexed
+ */
+export type EconomyFileType = 'types' | 'spawnabletypes' | 'eventspawns' | 'mapgrouppos' | 'other';
+
+export interface EconomyQuery {
+    /** class name / event name / group name (case insensitive) */
+    name?: string;
+    category?: string;
+    tag?: string;
+    usage?: string;
+    value?: string;
+    /** minX, minZ, maxX, maxZ in world coordinates */
+    bbox?: number[];
+    offset?: number;
+    limit?: number;
+}
+
+export interface EconomyQueryResult {
+    type: EconomyFileType;
+    total: number;
+    items: any[];
+}
+
+interface EconomyPos {
+    x: number;
+    z: number;
+}
+
+/**
+ * In memory index over a parsed (xml2js structured) economy file
+ */
+export class EconomyIndex {
+
+    /** size (in meters) of the map cells positions are indexed by */
+    public static readonly CELL_SIZE = 500;
+
+    public readonly type: EconomyFileType;
+    public readonly entries: any[];
+
+    private byName = new Map<string, number[]>();
+    private byCategory = new Map<string, number[]>();
+    private byTag = new Map<string, number[]>();
+    private byUsage = new Map<string, number[]>();
+    private byValue = new Map<string, number[]>();
+    private byCell = new Map<string, number[]>();
+    /** min and max cell coordinates of all indexed positions */
+    private cellBounds = { minX: Infinity, minZ: Infinity, maxX: -Infinity, maxZ: -Infinity };
+    private positions: EconomyPos[][] = [];
+
+    public constructor(
+        public readonly content: any,
+    ) {
+        if (content?.types) {
+            this.type = 'types';
+            this.entries = content.types.type ?? [];
+        } else if (content?.spawnabletypes) {
+            this.type = 'spawnabletypes';
+            this.entries = content.spawnabletypes.type ?? [];
+        } else if (content?.eventposdef) {
+            this.type = 'eventspawns';
+            this.entries = content.eventposdef.event ?? [];
+        } else if (content?.map) {
+            this.type = 'mapgrouppos';
+            this.entries = content.map.group ?? [];
+        } else {
+            this.type = 'other';
+            this.entries = [];
+        }
+
+        this.entries.forEach((entry, idx) => this.indexEntry(entry, idx));
+    }
+
+    private static add(index: Map<string, number[]>, key: string | undefined, idx: number): void {
+        if (!key) {
+            return;
+        }
+        const lowerKey = key.toLowerCase();
+        const list = index.get(lowerKey);
+        if (!list) {
+            index.set(lowerKey, [idx]);
+        } else if (list[list.length - 1] !== idx) {
+            list.push(idx);
+        }
+    }
+
+    private static getCellCoord(coord: number): number {
+        return Math.floor(coord / EconomyIndex.CELL_SIZE);
+    }
+
+    private getPositions(entry: any): EconomyPos[] {
+        if (this.type === 'eventspawns') {
+            return (entry.pos ?? [])
+                .map((pos: any) => ({ x: Number(pos.$?.x), z: Number(pos.$?.z) }))
+                .filter((pos: EconomyPos) => !isNaN(pos.x) && !isNaN(pos.z));
+        }
+        if (this.type === 'mapgrouppos' && entry.$?.pos) {
+            const [x, , z] = String(entry.$.pos).split(' ').map((pos) => Number(pos));
+            if (!isNaN(x) && !isNaN(z)) {
+                return [{ x, z }];
+            }
+        }
+        return [];
+    }
+
+    private indexEntry(entry: any, idx: number): void {
+        EconomyIndex.add(this.byName, entry?.$?.name, idx);
+        for (const category of entry?.category ?? []) {
+            EconomyIndex.add(this.byCategory, category?.$?.name, idx);
+        }
+        for (const tag of entry?.tag ?? []) {
+            EconomyIndex.add(this.byTag, tag?.$?.name, idx);
+        }
+        for (const usage of entry?.usage ?? []) {
+            EconomyIndex.add(this.byUsage, usage?.$?.name, idx);
+        }
+        for (const value of entry?.value ?? []) {
+            EconomyIndex.add(this.byValue, value?.$?.name, idx);
+        }
+
+        const positions = this.getPositions(entry);
+        this.positions[idx] = positions;
+        for (const pos of positions) {
+            const cx = EconomyIndex.getCellCoord(pos.x);
+            const cz = EconomyIndex.getCellCoord(pos.z);
+            EconomyIndex.add(this.byCell, `${cx}_${cz}`, idx);
+            this.cellBounds.minX = Math.min(this.cellBounds.minX, cx);
+            this.cellBounds.minZ = Math.min(this.cellBounds.minZ, cz);
+            this.cellBounds.maxX = Math.max(this.cellBounds.maxX, cx);
+            this.cellBounds.maxZ = Math.max(this.cellBounds.maxZ, cz);
+        }
+    }
+
+    private getCellCandidates(bbox: number[]): number[] {
+        // only visit cells which can contain positions, the bbox is user input
+        const minX = Math.max(EconomyIndex.getCellCoord(bbox[0]), this.cellBounds.minX);
+        const minZ = Math.max(EconomyIndex.getCellCoord(bbox[1]), this.cellBounds.minZ);
+        const maxX = Math.min(EconomyIndex.getCellCoord(bbox[2]), this.cellBounds.maxX);
+        const maxZ = Math.min(EconomyIndex.getCellCoord(bbox[3]), this.cellBounds.maxZ);
+        if (minX > maxX || minZ > maxZ) {
+            return [];
+        }
+        const candidates = new Set<number>();
+        if ((maxX - minX + 1) * (maxZ - minZ + 1) > this.byCell.size) {
+            // sparse index, checking the indexed cells is cheaper
+            for (const [cell, indices] of this.byCell) {
+                const [cx, cz] = cell.split('_').map((x) => Number(x));
+                if (cx >= minX && cx <= maxX && cz >= minZ && cz <= maxZ) {
+                    indices.forEach((idx) => candidates.add(idx));
+                }
+            }
+        } else {
+            for (let cx = minX; cx <= maxX; cx++) {
+                for (let cz = minZ; cz <= maxZ; cz++) {
+                    for (const idx of this.byCell.get(`${cx}_${cz}`) ?? []) {
+                        candidates.add(idx);
+                    }
+                }
+            }
+        }
+        return [...candidates].sort((a, b) => a - b);
+    }
+
+    private isInBBox(idx: number, bbox: number[]): boolean {
+        const [minX, minZ, maxX, maxZ] = bbox;
+        return this.positions[idx]?.some((pos) => pos.x >= minX && pos.x <= maxX && pos.z >= minZ && pos.z <= maxZ);
+    }
+
+    public query(query: EconomyQuery): EconomyQueryResult {
+        const filters: [Map<string, number[]>, string | undefined][] = [
+            [this.byName, query.name],
+            [this.byCategory, query.category],
+            [this.byTag, query.tag],
+            [this.byUsage, query.usage],
+            [this.byValue, query.value],
+        ];
+        const bbox = query.bbox?.length === 4 && query.bbox.every((x) => !isNaN(x)) ? query.bbox : undefined;
+
+        // start with the smallest candidate list and check the other filters on it
+        let candidates: number[] | undefined;
+        const checks: ((idx: number) => boolean)[] = [];
+        for (const [index, key] of filters) {
+            if (!key) continue;
+            const matches = index.get(key.toLowerCase()) ?? [];
+            if (!candidates || matches.length < candidates.length) {
+                if (candidates) {
+                    const set = new Set(candidates);
+                    checks.push((idx) => set.has(idx));
+                }
+                candidates = matches;
+            } else {
+                const set = new Set(matches);
+                checks.push((idx) => set.has(idx));
+            }
+        }
+        if (bbox) {
+            if (!candidates) {
+                candidates = this.getCellCandidates(bbox);
+            }
+            checks.push((idx) => this.isInBBox(idx, bbox));
+        }
+
+        const matching = (candidates ?? this.entries.map((x, idx) => idx))
+            .filter((idx) => checks.every((check) => check(idx)));
+
+        const offset = Math.max(0, query.offset ?? 0);
+        const limit = query.limit ? Math.max(0, query.limit) : matching.length;
+        return {
+            type: this.type,
+            total: matching.length,
+            items: matching.slice(offset, offset + limit).map((idx) => this.entries[idx]),
+        };
+    }
+
+}
@@ -0,0 +1,211 @@
+import { FSAPI } from './apis';
+
+/**
+ * In-memory index of a guid list file (ban.txt, whitelist.txt, priority.txt).
+ *
+ * Entries are kept in file order in a map, so lookups, adds and removes do not need to rescan the file.
+ * Adds are appended to the file, removes rewrite it from memory.
+ * The file is only parsed again after it was invalidated and its stats differ from the last own write.
+ */
+export class GuidList {
+
+    // entry -> raw line, comments and blank lines are kept under placeholder keys to survive rewrites
+    private entries = new Map<string, string>();
+    private placeholderCount = 0;
+    private valuesCache: readonly string[] | undefined;
+
+    private loaded = false;
+    private stale = false;
+    private fileMtime = 0;
+    private fileSize = -1;
+
+    private linefeed = '\r\n';
+    private endsWithSeparator = true;
+
+    public constructor(
+        private fs: FSAPI,
+        public filePath: string,
+        private separator?: string,
+    ) {}
+
+    /**
+     * marks the list to be verified against the file on the next access
+     */
+    public invalidate(): void {
+        this.stale = true;
+    }
+
+    private isPlaceholder(key: string): boolean {
+        return key.startsWith('\0');
+    }
+
+    private updateFileStats(): void {
+        try {
+            const stats = this.fs.statSync(this.filePath);
+            this.fileMtime = stats.mtime.getTime();
+            this.fileSize = stats.size;
+        } catch {
+            this.fileMtime = 0;
+            this.fileSize = -1;
+        }
+    }
+
+    private fileChanged(): boolean {
+        const prevMtime = this.fileMtime;
+        const prevSize = this.fileSize;
+        this.updateFileStats();
+        return prevMtime !== this.fileMtime || prevSize !== this.fileSize;
+    }
+
+    private ensureLoaded(): void {
+        if (this.loaded && (!this.stale || !this.fileChanged())) {
+            this.stale = false;
+            return;
+        }
+        this.load();
+    }
+
+    private load(): void {
+        this.entries.clear();
+        this.placeholderCount = 0;
+        this.valuesCache = undefined;
+        this.loaded = true;
+        this.stale = false;
+        this.linefeed = '\r\n';
+        this.endsWithSeparator = true;
+
+        if (!this.fs.existsSync(this.filePath)) {
+            this.updateFileStats();
+            return;
+        }
+
+        const content = this.fs.readFileSync(this.filePath, { encoding: 'utf-8' });
+        this.updateFileStats();
+
+        this.linefeed = content.includes('\r\n') ? '\r\n' : '\n';
+        if (this.separator) {
+            this.endsWithSeparator = !content.trim() || content.trimEnd().endsWith(this.separator);
+            for (const part of content.split(/[\r\n]+/).join(this.separator).split(this.separator)) {
+                const entry = part.trim();
+                if (entry && !this.entries.has(entry)) {
+                    this.entries.set(entry, entry);
+                }
+            }
+            return;
+        }
+
+        this.endsWithSeparator = !content || content.endsWith('\n');
+        const lines = content.split(this.linefeed);
+        if (this.endsWithSeparator) {
+            lines.pop();
+        }
+        for (const line of lines) {
+            const entry = this.parseLine(line);
+            if (!entry) {
+                this.entries.set(`\0${this.placeholderCount++}`, line);
+            } else if (!this.entries.has(entry)) {
+                this.entries.set(entry, line);
+            }
+        }
+    }
+
+    private parseLine(line: string): string {
+        const trimmed = line.trim();
+        if (!trimmed || trimmed.startsWith('//')) {
+            return '';
+        }
+        return trimmed.includes('//') ? trimmed.slice(0, trimmed.indexOf('//')).trim() : trimmed;
+    }
+
+    public has(entry: string): boolean {
+        this.ensureLoaded();
+        return this.entries.has(entry);
+    }
+
+    /**
+     * @returns the entries without comments, the array is shared with other callers and frozen
+     */
+    public values(): readonly string[] {
+        this.ensureLoaded();
+        if (!this.valuesCache) {
+            this.valuesCache = Object.freeze([...this.entries.keys()].filter((x) => !this.isPlaceholder(x)));
+        }
+        return this.valuesCache;
+    }
+
+    /**
+     * adds the given entries and appends the new ones to the file
+     *
+     * @returns the number of entries which were not yet part of the list
+     */
+    public add(entries: string[]): number {
+        this.ensureLoaded();
+        const added = [...new Set(entries.map((x) => x?.trim()))]
+            .filter((x) => !!x && !this.isPlaceholder(x) && !this.entries.has(x));
+        if (!added.length) {
+            return 0;
+        }
+
+        for (const entry of added) {
+            this.entries.set(entry, entry);
+        }
+        this.valuesCache = undefined;
+
+        const separator = this.separator ?? this.linefeed;
+        let content = added.join(separator);
+        if (!this.endsWithSeparator) {
+            content = `${separator}${content}`;
+        }
+        if (!this.separator) {
+            content = `${content}${separator}`;
+        }
+        this.fs.appendFileSync(this.filePath, content);
+        this.endsWithSeparator = !this.separator;
+        this.updateFileStats();
+
+        return added.length;
+    }
+
+    /**
+     * removes the given entries and rewrites the file from memory
+     *
+     * @returns the number of entries which were removed
+     */
+    public remove(entries: string[]): number {
+        this.ensureLoaded();
+        let removed = 0;
+        for (const entry of entries) {
+            if (entry && !this.isPlaceholder(entry) && this.entries.delete(entry)) {
+                removed++;
+            }
+        }
+        if (removed) {
+            this.valuesCache = undefined;
+            this.compact();
+        }
+        return removed;
+    }
+
+    /**
+     * rewrites the file from the in-memory list, dropping duplicates
+     */
+    public compact(): void {
+        this.ensureLoaded();
+        this.fs.writeFileSync(this.filePath, this.export(true));
+        this.endsWithSeparator = !this.entries.size;
+        this.updateFileStats();
+    }
+
+    /**
+     * @param withComments keep comment and blank lines of the file
+     * @returns the list in its file format
+     */
+    public export(withComments?: boolean): string {
+        if (this.separator) {
+            return this.values().join(this.separator);
+        }
+        this.ensureLoaded();
+        return (withComments ? [...this.entries.values()] : this.values()).join(this.linefeed);
+    }
+
+}
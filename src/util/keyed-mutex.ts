@@ -0,0 +1,30 @@
+/**
+ * Runs tasks with the same key one after another, while tasks with different keys run in parallel.
+ */
+export class KeyedMutex {
+
+    private locks = new Map<string, Promise<void>>();
+
+    public isLocked(key: string): boolean {
+        return this.locks.has(key);
+    }
+
+    public async runExclusive<T>(key: string, task: () => Promise<T>): Promise<T> {
+        const previous = this.locks.get(key) ?? Promise.resolve();
+        let release: () => void;
+        const current = previous.then(() => new Promise<void>((r) => release = r));
+        this.locks.set(key, current);
+
+        await previous;
+        try {
+            return await task();
+        } finally {
+            release();
+            // the last waiter cleans up
+            if (this.locks.get(key) === current) {
+                this.locks.delete(key);
+            }
+        }
+    }
+
+}
@@ -23,6 +23,8 @@ export class Logger {
     public static readonly LOG_LEVELS: { [context: string]: LogLevel } = {};
 
     public static defaultLogLevel: LogLevel = LogLevel.INFO;
+    /** log levels of the instances, when running multiple instances in one process */
+    public static readonly INSTANCE_LOG_LEVELS: { [instance: string]: LogLevel } = {};
     public static defaultLogFile: string = Logger.getDefaultLogFileName();
 
     private static lastWrite: Promise<any> = Promise.resolve();
@@ -73,6 +75,7 @@ export class Logger {
 
     public constructor(
         private context: string,
+        private instance?: string,
     ) {}
 
     private formatContext(context: string): string {
@@ -88,12 +91,15 @@ export class Logger {
         ...data: any[]
     ): void {
 
-        const allowedLevel = Logger.LOG_LEVELS[this.context] ?? Logger.defaultLogLevel;
+        const allowedLevel = Logger.LOG_LEVELS[this.context]
+            ?? (this.instance ? Logger.INSTANCE_LOG_LEVELS[this.instance] : undefined)
+            ?? Logger.defaultLogLevel;
         if (level >= allowedLevel) {
             const date = false
                 ? new Date().toLocaleString()
                 : new Date().toISOString();
-            const fmt = `@${date} | ${LogLevelNames[level]} | ${this.formatContext(this.context)} | ${msg}`;
+            const instance = this.instance ? `${this.instance} | ` : '';
+            const fmt = `@${date} | ${LogLevelNames[level]} | ${instance}${this.formatContext(this.context)} | ${msg}`;
 
             Logger.LogLevelFncs[level](fmt, data);
         }
@@ -0,0 +1,214 @@
+import { FSAPI } from './apis';
+
+type FileHandle = Awaited<ReturnType<FSAPI['promises']['open']>>;
+
+// packing methods ("mime types") stored as little endian uint32
+export const PBO_PACKING_VERSION = 0x56657273; // 'Vers'
+export const PBO_PACKING_COMPRESSED = 0x43707273; // 'Cprs'
+
+export interface PboEntry {
+    /** path inside the pbo (as stored, usually with backslashes) */
+    name: string;
+    packingMethod: number;
+    originalSize: number;
+    timestamp: number;
+    dataSize: number;
+    /** offset of the data in the pbo file */
+    offset: number;
+}
+
+/**
+ * Decompresses the LZSS variant used by pbos and config.bin files
+ *
+ * @param input the compressed data (the trailing checksum is ignored)
+ * @param outputSize the size of the decompressed data
+ */
+export const lzssDecompress = (input: Buffer, outputSize: number): Buffer => {
+    const out = Buffer.alloc(outputSize);
+    let inPos = 0;
+    let outPos = 0;
+    while (outPos < outputSize && inPos < input.length) {
+        let flags = input[inPos++];
+        for (let bit = 0; bit < 8 && outPos < outputSize && inPos < input.length; bit++, flags >>= 1) {
+            if (flags & 1) {
+                out[outPos++] = input[inPos++];
+                continue;
+            }
+            const b1 = input[inPos++];
+            const b2 = input[inPos++];
+            const start = outPos - (b1 | ((b2 & 0xf0) << 4));
+            const length = (b2 & 0x0f) + 3;
+            for (let i = 0; i < length && outPos < outputSize; i++) {
+                // references before the start of the output are spaces
+                out[outPos++] = start + i < 0 ? 0x20 : out[start + i];
+            }
+        }
+    }
+    if (outPos < outputSize) {
+        throw new Error('Unexpected end of compressed data');
+    }
+    return out;
+};
+
+class HeaderCursor {
+
+    public pos = 0;
+
+    public constructor(
+        private buf: Buffer,
+        private len: number,
+    ) {}
+
+    public asciiz(): string {
+        const end = this.buf.indexOf(0, this.pos);
+        if (end === -1 || end >= this.len) {
+            throw new RangeError('Header exceeds buffer');
+        }
+        const str = this.buf.toString('utf-8', this.pos, end);
+        this.pos = end + 1;
+        return str;
+    }
+
+    public uint32(): number {
+        if (this.pos + 4 > this.len) {
+            throw new RangeError('Header exceeds buffer');
+        }
+        const value = this.buf.readUInt32LE(this.pos);
+        this.pos += 4;
+        return value;
+    }
+
+}
+
+/**
+ * Reads the entry table of a pbo archive and single entries on demand without extracting the archive.
+ *
+ * Only the header is read on open, entry data is read with positioned reads,
+ * so even large pbos only cost the size of their header and the requested entries.
+ */
+export class PboReader {
+
+    /** initial amount of bytes read for the header, grown if the header is larger */
+    public static readonly HEADER_READ_SIZE = 64 * 1024;
+
+    /** header extension properties, i.e. prefix */
+    public readonly properties: Record<string, string> = {};
+    public readonly entries: PboEntry[] = [];
+
+    private byName = new Map<string, PboEntry>();
+
+    private constructor(
+        public readonly file: string,
+        public readonly size: number,
+        private handle: FileHandle,
+    ) {}
+
+    public static async open(fs: FSAPI, file: string): Promise<PboReader> {
+        const handle = await fs.promises.open(file, 'r');
+        try {
+            const { size } = await handle.stat();
+            const reader = new PboReader(file, size, handle);
+            await reader.readHeader();
+            return reader;
+        } catch (e) {
+            await handle.close();
+            throw e;
+        }
+    }
+
+    /**
+     * normalizes entry names for lookups (case insensitive, backslashes)
+     */
+    public static normalizeName(name: string): string {
+        return name.replace(/\//g, '\\').replace(/^\\+/, '').toLowerCase();
+    }
+
+    /** the virtual path of the pbo content (i.e. "dz\weapons") */
+    public get prefix(): string {
+        return this.properties.prefix ?? '';
+    }
+
+    private async readHeader(): Promise<void> {
+        let readSize = Math.min(PboReader.HEADER_READ_SIZE, this.size);
+        for (;;) {
+            const buf = Buffer.alloc(readSize);
+            const { bytesRead } = await this.handle.read(buf, 0, readSize, 0);
+            try {
+                this.parseHeader(buf, bytesRead);
+                return;
+            } catch (e) {
+                if (!(e instanceof RangeError) || readSize >= this.size) {
+                    throw new Error(`Invalid pbo header in ${this.file}`);
+                }
+                readSize = Math.min(readSize * 4, this.size);
+            }
+        }
+    }
+
+    private parseHeader(buf: Buffer, len: number): void {
+        const cursor = new HeaderCursor(buf, len);
+        const entries: PboEntry[] = [];
+        const properties: Record<string, string> = {};
+
+        for (;;) {
+            const name = cursor.asciiz();
+            const packingMethod = cursor.uint32();
+            const originalSize = cursor.uint32();
+            cursor.uint32(); // reserved
+            const timestamp = cursor.uint32();
+            const dataSize = cursor.uint32();
+
+            if (!name) {
+                if (packingMethod !== PBO_PACKING_VERSION) {
+                    // end of the entry table
+                    break;
+                }
+                // header extension: key value pairs until an empty key
+                for (let key = cursor.asciiz(); key; key = cursor.asciiz()) {
+                    properties[key.toLowerCase()] = cursor.asciiz();
+                }
+                continue;
+            }
+
+            entries.push({ name, packingMethod, originalSize, timestamp, dataSize, offset: 0 });
+        }
+
+        let offset = cursor.pos;
+        for (const entry of entries) {
+            entry.offset = offset;
+            offset += entry.dataSize;
+        }
+        if (offset > this.size) {
+            throw new Error(`Truncated pbo ${this.file}`);
+        }
+
+        this.entries.push(...entries);
+        Object.assign(this.properties, properties);
+        for (const entry of entries) {
+            this.byName.set(PboReader.normalizeName(entry.name), entry);
+        }
+    }
+
+    public getEntry(name: string): PboEntry | undefined {
+        return this.byName.get(PboReader.normalizeName(name));
+    }
+
+    public async readEntry(entry: PboEntry | string): Promise<Buffer | undefined> {
+        const found = typeof entry === 'string' ? this.getEntry(entry) : entry;
+        if (!found) {
+            return undefined;
+        }
+        const data = Buffer.alloc(found.dataSize);
+        if (found.dataSize) {
+            await this.handle.read(data, 0, found.dataSize, found.offset);
+        }
+        const compressed = found.packingMethod === PBO_PACKING_COMPRESSED
+            || (found.originalSize && found.originalSize !== found.dataSize);
+        return compressed ? lzssDecompress(data, found.originalSize) : data;
+    }
+
+    public async close(): Promise<void> {
+        await this.handle.close();
+    }
+
+}
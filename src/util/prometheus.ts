@@ -0,0 +1,243 @@
+export type PromLabels = Record<string, string | number>;
+
+export type PromMetricType = 'counter' | 'gauge' | 'histogram';
+
+/** default buckets in seconds, from 5ms to 10s */
+export const DEFAULT_BUCKETS = [0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1, 2.5, 5, 10];
+
+const escapeLabelValue = (value: string): string => value
+    .replace(/\\/g, '\\\\')
+    .replace(/\n/g, '\\n')
+    .replace(/"/g, '\\"');
+
+const escapeHelp = (help: string): string => help
+    .replace(/\\/g, '\\\\')
+    .replace(/\n/g, '\\n');
+
+const formatValue = (value: number): string => {
+    if (Number.isNaN(value)) {
+        return 'NaN';
+    }
+    if (!Number.isFinite(value)) {
+        return value > 0 ? '+Inf' : '-Inf';
+    }
+    return String(value);
+};
+
+/**
+ * @returns the labels in exposition format (sorted by name, without braces)
+ */
+const serializeLabels = (labels?: PromLabels): string => Object.keys(labels ?? {})
+    .sort()
+    .map((x) => `${x}="${escapeLabelValue(String(labels[x]))}"`)
+    .join(',');
+
+const withLabels = (name: string, labels: string, extra?: string): string => {
+    const all = [labels, extra].filter((x) => !!x).join(',');
+    return all ? `${name}{${all}}` : name;
+};
+
+export abstract class PromMetric<T> {
+
+    protected series = new Map<string, T>();
+
+    public constructor(
+        public readonly name: string,
+        public readonly help: string,
+        public readonly type: PromMetricType,
+    ) {}
+
+    public remove(labels?: PromLabels): void {
+        this.series.delete(serializeLabels(labels));
+    }
+
+    public reset(): void {
+        this.series.clear();
+    }
+
+    public render(): string[] {
+        if (!this.series.size) {
+            return [];
+        }
+        const lines = [
+            `# HELP ${this.name} ${escapeHelp(this.help)}`,
+            `# TYPE ${this.name} ${this.type}`,
+        ];
+        for (const [labels, value] of this.series) {
+            lines.push(...this.renderSeries(labels, value));
+        }
+        return lines;
+    }
+
+    protected getSeries(labels: PromLabels | undefined, init: () => T): T {
+        const key = serializeLabels(labels);
+        let series = this.series.get(key);
+        if (series === undefined) {
+            series = init();
+            this.series.set(key, series);
+        }
+        return series;
+    }
+
+    protected abstract renderSeries(labels: string, value: T): string[];
+
+}
+
+export class Counter extends PromMetric<{ value: number }> {
+
+    public constructor(name: string, help: string) {
+        super(name, help, 'counter');
+    }
+
+    public inc(labels?: PromLabels, value: number = 1): void {
+        if (value < 0) {
+            throw new Error(`Counter ${this.name} can only be increased`);
+        }
+        this.getSeries(labels, () => ({ value: 0 })).value += value;
+    }
+
+    public get(labels?: PromLabels): number {
+        return this.series.get(serializeLabels(labels))?.value ?? 0;
+    }
+
+    protected renderSeries(labels: string, series: { value: number }): string[] {
+        return [`${withLabels(this.name, labels)} ${formatValue(series.value)}`];
+    }
+
+}
+
+export class Gauge extends PromMetric<{ value: number }> {
+
+    public constructor(name: string, help: string) {
+        super(name, help, 'gauge');
+    }
+
+    public set(value: number, labels?: PromLabels): void {
+        this.getSeries(labels, () => ({ value: 0 })).value = value;
+    }
+
+    public inc(labels?: PromLabels, value: number = 1): void {
+        this.getSeries(labels, () => ({ value: 0 })).value += value;
+    }
+
+    public get(labels?: PromLabels): number | undefined {
+        return this.series.get(serializeLabels(labels))?.value;
+    }
+
+    protected renderSeries(labels: string, series: { value: number }): string[] {
+        return [`${withLabels(this.name, labels)} ${formatValue(series.value)}`];
+    }
+
+}
+
+interface HistogramSeries {
+    counts: number[];
+    sum: number;
+    count: number;
+}
+
+export class Histogram extends PromMetric<HistogramSeries> {
+
+    public readonly buckets: number[];
+
+    public constructor(name: string, help: string, buckets: number[] = DEFAULT_BUCKETS) {
+        super(name, help, 'histogram');
+        this.buckets = [...buckets].sort((a, b) => a - b);
+    }
+
+    public observe(value: number, labels?: PromLabels): void {
+        const series = this.getSeries(labels, () => ({
+            counts: new Array(this.buckets.length).fill(0),
+            sum: 0,
+            count: 0,
+        }));
+        // counts are stored per bucket and accumulated when rendered
+        const idx = this.buckets.findIndex((x) => value <= x);
+        if (idx !== -1) {
+            series.counts[idx]++;
+        }
+        series.sum += value;
+        series.count++;
+    }
+
+    /**
+     * @returns a function which observes the seconds passed since it was created
+     */
+    public startTimer(labels?: PromLabels): (endLabels?: PromLabels) => number {
+        const start = process.hrtime();
+        return (endLabels?: PromLabels) => {
+            const [sec, nano] = process.hrtime(start);
+            const duration = sec + (nano / 1e9);
+            this.observe(duration, { ...labels, ...endLabels });
+            return duration;
+        };
+    }
+
+    public getCount(labels?: PromLabels): number {
+        return this.series.get(serializeLabels(labels))?.count ?? 0;
+    }
+
+    protected renderSeries(labels: string, series: HistogramSeries): string[] {
+        const lines: string[] = [];
+        let cumulative = 0;
+        for (let i = 0; i < this.buckets.length; i++) {
+            cumulative += series.counts[i];
+            lines.push(`${withLabels(`${this.name}_bucket`, labels, `le="${formatValue(this.buckets[i])}"`)} ${cumulative}`);
+        }
+        lines.push(`${withLabels(`${this.name}_bucket`, labels, 'le="+Inf"')} ${series.count}`);
+        lines.push(`${withLabels(`${this.name}_sum`, labels)} ${formatValue(series.sum)}`);
+        lines.push(`${withLabels(`${this.name}_count`, labels)} ${series.count}`);
+        return lines;
+    }
+
+}
+
+/**
+ * In process registry of metrics in the prometheus text exposition format.
+ *
+ * Values are kept in memory and only formatted when rendered,
+ * collectors can be used to refresh values which are cheap to read right before rendering.
+ */
+export class PromRegistry {
+
+    public static readonly CONTENT_TYPE = 'text/plain; version=0.0.4; charset=utf-8';
+
+    private metrics = new Map<string, PromMetric<any>>();
+    private collectors: (() => void)[] = [];
+
+    public counter(name: string, help: string): Counter {
+        return this.register(new Counter(name, help));
+    }
+
+    public gauge(name: string, help: string): Gauge {
+        return this.register(new Gauge(name, help));
+    }
+
+    public histogram(name: string, help: string, buckets?: number[]): Histogram {
+        return this.register(new Histogram(name, help, buckets));
+    }
+
+    public addCollector(collector: () => void): void {
+        this.collectors.push(collector);
+    }
+
+    public render(): string {
+        for (const collector of this.collectors) {
+            collector();
+        }
+        const lines: string[] = [];
+        for (const metric of this.metrics.values()) {
+            lines.push(...metric.render());
+        }
+        return lines.length ? `${lines.join('\n')}\n` : '';
+    }
+
+    private register<T extends PromMetric<any>>(metric: T): T {
+        if (this.metrics.has(metric.name)) {
+            throw new Error(`Metric ${metric.name} is already registered`);
+        }
+        this.metrics.set(metric.name, metric);
+        return metric;
+    }
+
+}
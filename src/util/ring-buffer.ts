@@ -0,0 +1,59 @@
+/**
+ * Fixed size buffer which overwrites the oldest entry once it is full
+ */
+export class RingBuffer<T> {
+
+    private items: T[];
+    private head = 0;
+    private count = 0;
+
+    public constructor(
+        public capacity: number,
+    ) {
+        this.capacity = Math.max(1, Math.floor(capacity) || 1);
+        this.items = new Array(this.capacity);
+    }
+
+    public get size(): number {
+        return this.count;
+    }
+
+    public push(item: T): void {
+        this.items[this.head] = item;
+        this.head = (this.head + 1) % this.capacity;
+        this.count = Math.min(this.count + 1, this.capacity);
+    }
+
+    /**
+     * @returns the latest entry or undefined if empty
+     */
+    public last(): T | undefined {
+        if (!this.count) {
+            return undefined;
+        }
+        return this.items[(this.head - 1 + this.capacity) % this.capacity];
+    }
+
+    /**
+     * @param filter optional filter applied while copying
+     * @returns the entries ordered from oldest to newest
+     */
+    public toArray(filter?: (item: T) => boolean): T[] {
+        const result: T[] = [];
+        const start = (this.head - this.count + this.capacity) % this.capacity;
+        for (let i = 0; i < this.count; i++) {
+            const item = this.items[(start + i) % this.capacity];
+            if (!filter || filter(item)) {
+                result.push(item);
+            }
+        }
+        return result;
+    }
+
+    public clear(): void {
+        this.items = new Array(this.capacity);
+        this.head = 0;
+        this.count = 0;
+    }
+
+}
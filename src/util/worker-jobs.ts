@@ -0,0 +1,63 @@
+import * as fs from 'fs';
+import { isMainThread, parentPort, workerData } from 'worker_threads';
+import { FSAPI } from './apis';
+import { sameDirHash } from './compare-folders';
+import { copySync } from './copy-dir';
+import { DirSync, DirSyncOptions, DirSyncResult } from './dir-sync';
+import { BackupStore, BackupStoreResult } from './backup-store';
+
+/**
+ * Jobs which can be executed by the worker pool.
+ *
+ * This module is the entry point of the worker threads, so it must not import any services.
+ * Arguments and results are copied between the threads, so they must be plain data.
+ */
+export const WORKER_JOBS = {
+    sameDirHash: (fsApi: FSAPI, dir1: string, dir2: string): Promise<boolean> => sameDirHash(fsApi, dir1, dir2),
+    copyDir: (fsApi: FSAPI, source: string, target: string): void => copySync(fsApi, source, target),
+    readJson: (fsApi: FSAPI, file: string): any => JSON.parse(fsApi.readFileSync(file, { encoding: 'utf-8' })),
+    syncDir: (fsApi: FSAPI, source: string, target: string, opts: DirSyncOptions): Promise<DirSyncResult> => (
+        new DirSync(fsApi, source, target, opts).sync()
+    ),
+    // the first argument names the tracked task
+    createBackup: (fsApi: FSAPI, source: string, backupDir: string, name: string): Promise<BackupStoreResult> => (
+        new BackupStore(fsApi, backupDir).createBackup(source, name)
+    ),
+    restoreBackup: (fsApi: FSAPI, name: string, backupDir: string, target: string): Promise<void> => (
+        new BackupStore(fsApi, backupDir).restore(name, target)
+    ),
+    collectBackupChunks: (fsApi: FSAPI, backupDir: string): Promise<number> => new BackupStore(fsApi, backupDir).gc(),
+};
+
+export type WorkerJobs = typeof WORKER_JOBS;
+export type WorkerJobName = keyof WorkerJobs;
+export type WorkerJobArgs<K extends WorkerJobName> = WorkerJobs[K] extends (fsApi: FSAPI, ...args: infer A) => any ? A : never;
+export type WorkerJobResult<K extends WorkerJobName> = Awaited<ReturnType<WorkerJobs[K]>>;
+
+export const WORKER_MARKER = 'dzsmWorker';
+
+export interface WorkerRequest {
+    id: number;
+    job: WorkerJobName;
+    args: any[];
+}
+
+export interface WorkerResponse {
+    id: number;
+    result?: any;
+    error?: string;
+}
+
+/* istanbul ignore next runs inside of the worker threads */
+if (!isMainThread && parentPort && workerData?.[WORKER_MARKER]) {
+    const port = parentPort;
+    port.on('message', async (request: WorkerRequest) => {
+        try {
+            const job = WORKER_JOBS[request.job] as (fsApi: FSAPI, ...args: any[]) => any;
+            const result = await job(fs, ...request.args);
+            port.postMessage({ id: request.id, result } as WorkerResponse);
+        } catch (e) {
+            port.postMessage({ id: request.id, error: e?.message ?? String(e) } as WorkerResponse);
+        }
+    });
+}
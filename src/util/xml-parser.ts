@@ -0,0 +1,179 @@
+const ENTITIES: Record<string, string> = {
+    amp: '&',
+    lt: '<',
+    gt: '>',
+    quot: '"',
+    apos: '\'',
+};
+
+const decodeEntities = (text: string): string => {
+    if (!text.includes('&')) {
+        return text;
+    }
+    return text.replace(/&(#x[0-9a-fA-F]+|#[0-9]+|[a-zA-Z]+);/g, (match, entity: string) => {
+        if (entity.startsWith('#x')) {
+            return String.fromCodePoint(parseInt(entity.slice(2), 16));
+        }
+        if (entity.startsWith('#')) {
+            return String.fromCodePoint(parseInt(entity.slice(1), 10));
+        }
+        return ENTITIES[entity] ?? match;
+    });
+};
+
+interface OpenElement {
+    name: string;
+    obj: Record<string, any>;
+    text: string;
+}
+
+const hasOwn = (obj: any, key: string): boolean => Object.prototype.hasOwnProperty.call(obj, key);
+
+const ATTRIBUTE_REGEX = /([^\s=]+)\s*=\s*(?:"([^"]*)"|'([^']*)')/g;
+
+/**
+ * Single pass XML parser, which produces the same structure as xml2js with its default options
+ * (attributes in "$", text in "_" or as plain string, child elements as arrays),
+ * so the results are interchangeable with the xml2js results of the web ui.
+ *
+ * Only supports what the mission files use: elements, attributes, text, comments, CDATA and the basic entities.
+ */
+export const parseXml = (xml: string): Record<string, any> => {
+    const root: Record<string, any> = {};
+    const stack: OpenElement[] = [];
+
+    const finish = (element: OpenElement): any => {
+        const hasChildren = Object.keys(element.obj).length > 0;
+        if (/^\s*$/.test(element.text)) {
+            return hasChildren ? element.obj : '';
+        }
+        if (!hasChildren) {
+            return element.text;
+        }
+        element.obj._ = element.text;
+        return element.obj;
+    };
+
+    const append = (name: string, value: any): void => {
+        if (name === '__proto__') {
+            return;
+        }
+        const parent = stack[stack.length - 1];
+        if (!parent) {
+            root[name] = value;
+            return;
+        }
+        if (!hasOwn(parent.obj, name)) {
+            parent.obj[name] = [];
+        }
+        parent.obj[name].push(value);
+    };
+
+    const len = xml.length;
+    let i = 0;
+    while (i < len) {
+        const lt = xml.indexOf('<', i);
+        const textEnd = lt === -1 ? len : lt;
+        if (textEnd > i && stack.length) {
+            stack[stack.length - 1].text += decodeEntities(xml.slice(i, textEnd));
+        }
+        if (lt === -1) {
+            break;
+        }
+
+        if (xml.startsWith('<!--', lt)) {
+            const end = xml.indexOf('-->', lt + 4);
+            if (end === -1) {
+                throw new Error(`Unclosed comment at ${lt}`);
+            }
+            i = end + 3;
+            continue;
+        }
+
+        if (xml.startsWith('<![CDATA[', lt)) {
+            const end = xml.indexOf(']]>', lt + 9);
+            if (end === -1) {
+                throw new Error(`Unclosed CDATA at ${lt}`);
+            }
+            if (stack.length) {
+                stack[stack.length - 1].text += xml.slice(lt + 9, end);
+            }
+            i = end + 3;
+            continue;
+        }
+
+        if (xml[lt + 1] === '?' || xml[lt + 1] === '!') {
+            const end = xml.indexOf('>', lt);
+            i = end === -1 ? len : end + 1;
+            continue;
+        }
+
+        if (xml[lt + 1] === '/') {
+            const end = xml.indexOf('>', lt);
+            if (end === -1) {
+                throw new Error(`Unclosed tag at ${lt}`);
+            }
+            const name = xml.slice(lt + 2, end).trim();
+            const element = stack.pop();
+            if (!element || element.name !== name) {
+                throw new Error(`Unexpected closing tag "${name}" at ${lt}`);
+            }
+            append(name, finish(element));
+            i = end + 1;
+            continue;
+        }
+
+        // find the end of the tag, while ignoring ">" in attribute values
+        let end = lt + 1;
+        let quote = '';
+        for (; end < len; end++) {
+            const char = xml[end];
+            if (quote) {
+                if (char === quote) {
+                    quote = '';
+                }
+            } else if (char === '"' || char === '\'') {
+                quote = char;
+            } else if (char === '>') {
+                break;
+            }
+        }
+        if (end >= len) {
+            throw new Error(`Unclosed tag at ${lt}`);
+        }
+
+        const selfClosing = xml[end - 1] === '/';
+        const tag = xml.slice(lt + 1, selfClosing ? end - 1 : end);
+        const name = /^[^\s/>]+/.exec(tag)?.[0];
+        if (!name) {
+            throw new Error(`Invalid tag at ${lt}`);
+        }
+
+        const element: OpenElement = { name, obj: {}, text: '' };
+        const attrString = tag.slice(name.length);
+        if (attrString.trim()) {
+            const attrs: Record<string, string> = {};
+            ATTRIBUTE_REGEX.lastIndex = 0;
+            let match: RegExpExecArray | null;
+            while ((match = ATTRIBUTE_REGEX.exec(attrString))) {
+                if (match[1] !== '__proto__') {
+                    attrs[match[1]] = decodeEntities(match[2] ?? match[3]);
+                }
+            }
+            element.obj.$ = attrs;
+        }
+
+        if (selfClosing) {
+            append(name, finish(element));
+        } else {
+            stack.push(element);
+        }
+        i = end + 1;
+    }
+
+    if (stack.length) {
+        throw new Error(`Unclosed element "${stack[stack.length - 1].name}"`);
+    }
+
+    return root;
+};
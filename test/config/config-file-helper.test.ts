@@ -176,4 +176,23 @@ describe('Test class ConfigFileHelper', () => {
         expect(config?.admins[0].password).not.to.equal('admin');
     });
 
+    it('ConfigFileHelper-createDefaultConfig-instance', () => {
+        const paths = injector.resolve(Paths);
+        (paths.getInstanceName as sinon.SinonStub).returns('s1');
+        (paths.sharedCwd as sinon.SinonStub).returns('/');
+        const helper = injector.resolve(ConfigFileHelper);
+
+        // the workshop is on another filesystem
+        expect(helper.createDefaultConfig(false)).to.be.true;
+        expect(helper.createDefaultConfig(false)).to.be.false;
+        expect(helper.readConfig()?.linkModFiles).to.equal('off');
+
+        // the instances share the workshop files
+        files.unlinkSync(helper.getConfigFilePath());
+        (paths.sameFilesystem as sinon.SinonStub).returns(true);
+        expect(helper.createDefaultConfig(false)).to.be.true;
+        expect(helper.readConfig()?.linkModFiles).to.equal('hardlink');
+        expect((paths.sameFilesystem as sinon.SinonStub).calledWith('/', '/')).to.be.true;
+    });
+
 });
@@ -0,0 +1,125 @@
+import 'reflect-metadata';
+
+import * as path from 'path';
+import * as sinon from 'sinon';
+import { expect } from '../expect';
+import { disableConsole, enableConsole, fakeChildProcess, memfs, stubClass } from '../util';
+import { Lifecycle, container, injectable } from 'tsyringe';
+import { InstanceSupervisor } from '../../src/control/instance-supervisor';
+import { ManagerController } from '../../src/control/manager-controller';
+import { ConfigFileHelper } from '../../src/config/config-file-helper';
+import { LoggerFactory } from '../../src/services/loggerfactory';
+import { Paths } from '../../src/services/paths';
+import { Processes, ProcessSpawner, WindowsProcessFetcher } from '../../src/services/processes';
+import { FSAPI } from '../../src/util/apis';
+import { WorkerPool } from '../../src/services/worker-pool';
+
+@injectable()
+class TestService {
+    public constructor(
+        public paths: Paths,
+        public processes: Processes,
+        public workerPool: WorkerPool,
+    ) {}
+}
+
+describe('Test class InstanceSupervisor', () => {
+
+    let fs: FSAPI;
+
+    before(() => {
+        disableConsole();
+    });
+
+    after(() => {
+        enableConsole();
+    });
+
+    beforeEach(() => {
+        container.reset();
+        fs = memfs({}, '/', container);
+        fakeChildProcess(container);
+
+        container.register(LoggerFactory, LoggerFactory, { lifecycle: Lifecycle.Singleton });
+        container.register(Paths, Paths, { lifecycle: Lifecycle.Singleton });
+        container.register(ProcessSpawner, stubClass(ProcessSpawner), { lifecycle: Lifecycle.Singleton });
+        container.register(WindowsProcessFetcher, stubClass(WindowsProcessFetcher), { lifecycle: Lifecycle.Singleton });
+        container.register(Processes, stubClass(Processes), { lifecycle: Lifecycle.Singleton });
+        container.register(WorkerPool, stubClass(WorkerPool), { lifecycle: Lifecycle.Singleton });
+        container.register(ConfigFileHelper, stubClass(ConfigFileHelper), { lifecycle: Lifecycle.Singleton });
+        container.register(ManagerController, stubClass(ManagerController), { lifecycle: Lifecycle.Singleton });
+        container.register(TestService, TestService, { lifecycle: Lifecycle.Singleton });
+    });
+
+    it('InstanceSupervisor-getInstanceDirs', () => {
+        expect(InstanceSupervisor.getInstanceDirs(['node', 'index.js'])).to.be.undefined;
+        expect(InstanceSupervisor.getInstanceDirs(['--instances', 's1, s2,'])).to.deep.equal(['s1', 's2']);
+        expect(InstanceSupervisor.getInstanceDirs(['--instances=/srv/s1'])).to.deep.equal(['/srv/s1']);
+    });
+
+    it('InstanceSupervisor', async () => {
+        const supervisor = container.resolve(InstanceSupervisor);
+        const sharedDir = container.resolve(Paths).cwd();
+
+        expect(await supervisor.start(['s1', '/other/s2'])).to.be.true;
+
+        const [s1, s2] = supervisor.instances;
+        expect(s1.name).to.equal('s1');
+        expect(s2.name).to.equal('s2');
+        expect(fs.existsSync('/other/s2')).to.be.true;
+
+        // own services per instance
+        const service1 = s1.injector.resolve(TestService);
+        const service2 = s2.injector.resolve(TestService);
+        expect(service1).to.not.equal(service2);
+        expect(s1.injector.resolve(TestService)).to.equal(service1);
+        expect(service1.paths.cwd()).to.equal(path.join(sharedDir, 's1'));
+        expect(service2.paths.cwd()).to.equal(path.resolve('/other/s2'));
+        expect(service1.paths.getInstanceName()).to.equal('s1');
+        expect(service2.paths.sharedCwd()).to.equal(sharedDir);
+        expect(s2.injector.resolve(LoggerFactory).instance).to.equal('s2');
+
+        // shared services
+        expect(service1.processes).to.equal(service2.processes);
+        expect(service1.processes).to.equal(container.resolve(Processes));
+        expect((service1.processes.setScanSharing as sinon.SinonStub).calledOnceWith(true)).to.be.true;
+        expect(service1.workerPool).to.equal(service2.workerPool);
+        expect(service1.workerPool).to.equal(container.resolve(WorkerPool));
+
+        expect(s1.controller).to.not.equal(s2.controller);
+        expect(s1.controller.injector).to.equal(s1.injector);
+        expect(s1.controller.instance).to.equal('s1');
+        expect(s1.controller.processOwner).to.be.true;
+        expect(s2.controller.processOwner).to.be.false;
+        expect((s1.controller.start as sinon.SinonStub).callCount).to.equal(2);
+
+        await supervisor.stop();
+        expect((s1.controller.stop as sinon.SinonStub).callCount).to.equal(2);
+    });
+
+    it('InstanceSupervisor-startFailed', async () => {
+        (container.resolve(ManagerController).start as sinon.SinonStub)
+            .onFirstCall().rejects(new Error('test'))
+            .onSecondCall().resolves();
+        (container.resolve(ManagerController).stop as sinon.SinonStub).rejects(new Error('test'));
+        const supervisor = container.resolve(InstanceSupervisor);
+
+        // one failing instance does not stop the others
+        expect(await supervisor.start(['/s1', '/s2'])).to.be.true;
+        expect((supervisor.instances[1].controller.start as sinon.SinonStub).callCount).to.equal(2);
+
+        await supervisor.stop();
+    });
+
+    it('InstanceSupervisor-createConfigs', async () => {
+        (container.resolve(ConfigFileHelper).createDefaultConfig as sinon.SinonStub).returns(true);
+        const supervisor = container.resolve(InstanceSupervisor);
+
+        expect(await supervisor.start(['/s1', '/s2'])).to.be.false;
+        expect((supervisor.instances[0].controller.start as sinon.SinonStub).called).to.be.false;
+
+        // instance names must be unique
+        expect(() => supervisor['createInstance']('/other/s1', '/')).to.throw();
+    });
+
+});
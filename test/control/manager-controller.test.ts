@@ -18,6 +18,11 @@ import { Config } from '../../src/config/config';
 import { DiscordBot } from '../../src/services/discord';
 import { DiscordEventConverter } from '../../src/services/discord-event-converter';
 import { ConfigFileHelper } from '../../src/config/config-file-helper';
+import { ResourceProfiles } from '../../src/services/resource-profiles';
+import { EventBus } from '../../src/control/event-bus';
+import { InternalEventTypes } from '../../src/types/events';
+import { WorkerPool } from '../../src/services/worker-pool';
+import { LogLevel, Logger } from '../../src/util/logger';
 
 class TestMonitor {
     public startCalled = false;
@@ -88,6 +93,8 @@ export class TestStateful extends IStatefulService {
     }
 }
 
+export class TestInstanceStateful extends TestStateful {}
+
 
 describe('Test class ManagerController', () => {
 
@@ -125,6 +132,9 @@ describe('Test class ManagerController', () => {
         injector.register(Requirements, stubClass(Requirements), { lifecycle: Lifecycle.Singleton });
         injector.register(DiscordBot, stubClass(DiscordBot), { lifecycle: Lifecycle.Singleton });
         injector.register(DiscordEventConverter, stubClass(DiscordEventConverter), { lifecycle: Lifecycle.Singleton });
+        injector.register(ResourceProfiles, stubClass(ResourceProfiles), { lifecycle: Lifecycle.Singleton });
+        injector.register(EventBus, stubClass(EventBus), { lifecycle: Lifecycle.Singleton });
+        injector.register(WorkerPool, stubClass(WorkerPool), { lifecycle: Lifecycle.Singleton });
         
         configWatcher = injector.resolve(ConfigWatcher) as any;
         configHelper = injector.resolve(ConfigFileHelper) as any;
@@ -152,11 +162,15 @@ describe('Test class ManagerController', () => {
         
         expect(testStateful.start.called).to.be.true;
         expect(manager.initDone).to.be.true;
+        expect((injector.resolve(EventBus) as any).emit.calledWith(InternalEventTypes.CONFIG_RELOADED)).to.be.true;
 
         expect(steamCmd.checkSteamCmd.called).to.be.true;
         expect(steamCmd.checkServer.called).to.be.true;
         expect(steamCmd.checkMods.called).to.be.true;
         expect(steamCmd.installMods.called).to.be.true;
+        expect(requirements.check.calledOnceWith(true)).to.be.true;
+        expect((injector.resolve(ResourceProfiles) as any).applyManagerProfile.called).to.be.true;
+        expect((injector.resolve(WorkerPool) as any).setSize.called).to.be.true;
         
         await controller.stop();
 
@@ -164,4 +178,66 @@ describe('Test class ManagerController', () => {
         expect(manager.initDone).to.be.false;
         
     });
+
+    it('ManagerController-instance-setupFailed', async () => {
+
+        container.register(TestStateful, TestStateful, { lifecycle: Lifecycle.Singleton });
+        const testStateful = container.resolve(TestStateful);
+        testStateful.start.rejects(new Error('test'));
+
+        configWatcher.watch.resolves(new Config());
+        steamCmd.checkSteamCmd.resolves(true);
+        steamCmd.checkServer.resolves(true);
+        steamCmd.checkMods.resolves(true);
+        steamCmd.installMods.resolves(true);
+
+        const controller = injector.resolve(ManagerController);
+        controller.injector = injector;
+        controller.instance = 's1';
+
+        // only the instance fails, the process keeps running
+        await expect(controller.start()).to.be.rejectedWith('test');
+        expect(manager.initDone).to.not.be.true;
+    });
+
+    it('ManagerController-instance-processSettings', async () => {
+
+        // shared services are resolved from the root, instance services are registered per instance
+        container.register(TestStateful, TestStateful, { lifecycle: Lifecycle.Singleton });
+        container.register(TestInstanceStateful, TestInstanceStateful, { lifecycle: Lifecycle.Singleton });
+        injector.register(TestInstanceStateful, TestInstanceStateful, { lifecycle: Lifecycle.Singleton });
+        const sharedStateful = injector.resolve(TestStateful);
+        const instanceStateful = injector.resolve(TestInstanceStateful);
+
+        const config = new Config();
+        config.loglevel = LogLevel.WARN;
+        config.managerCpuAffinity = [0];
+        configWatcher.watch.resolves(config);
+        steamCmd.checkSteamCmd.resolves(true);
+        steamCmd.checkServer.resolves(true);
+        steamCmd.checkMods.resolves(true);
+        steamCmd.installMods.resolves(true);
+
+        const controller = injector.resolve(ManagerController);
+        controller.injector = injector;
+        controller.instance = 's2';
+        controller.processOwner = false;
+        const defaultLogLevel = Logger.defaultLogLevel;
+
+        await controller.start();
+
+        // the settings of the process are left to the first instance
+        expect(Logger.INSTANCE_LOG_LEVELS['s2']).to.equal(LogLevel.WARN);
+        expect(Logger.defaultLogLevel).to.equal(defaultLogLevel);
+        expect((injector.resolve(ResourceProfiles) as any).applyManagerProfile.called).to.be.false;
+        expect(requirements.check.calledOnceWith(false)).to.be.true;
+        expect((injector.resolve(WorkerPool) as any).setSize.called).to.be.false;
+        expect(instanceStateful.start.called).to.be.true;
+        expect(sharedStateful.start.called).to.be.false;
+
+        await controller.stop();
+        expect(instanceStateful.stop.called).to.be.true;
+        expect(sharedStateful.stop.called).to.be.false;
+        delete Logger.INSTANCE_LOG_LEVELS['s2'];
+    });
 });
\ No newline at end of file
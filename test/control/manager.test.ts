@@ -174,6 +174,15 @@ describe('Test class Manager', () => {
         expect(result).to.be.true;
     });
 
+    it('Manager-isLevelAllowed', () => {
+        const manager = getConfiguredManager();
+
+        expect(manager.isLevelAllowed('admin', 'manage')).to.be.true;
+        expect(manager.isLevelAllowed('view', 'manage')).to.be.false;
+        expect(manager.isLevelAllowed(undefined!, 'view')).to.be.false;
+        expect(manager.isLevelAllowed(undefined!, null!)).to.be.true;
+    });
+
     it('Manager-getWebPort-default', () => {
         const manager = getConfiguredManager();
         const result = manager.getWebPort();
@@ -1,20 +1,29 @@
 import { expect } from '../expect';
 import { ImportMock } from 'ts-mock-imports'
 import { Interface } from '../../src/interface/interface';
-import { Request } from '../../src/types/interface';
+import { Request, Response } from '../../src/types/interface';
 import { StubInstance, disableConsole, enableConsole, stubClass } from '../util';
 import { DependencyContainer, Lifecycle, container } from 'tsyringe';
 import { Manager } from '../../src/control/manager';
 import { RCON } from '../../src/services/rcon';
 import { Monitor } from '../../src/services/monitor';
 import { Metrics } from '../../src/services/metrics';
-import { SteamCMD } from '../../src/services/steamcmd';
+import { SteamCMD, SteamMetaData } from '../../src/services/steamcmd';
 import { LogReader } from '../../src/services/log-reader';
 import { Backups } from '../../src/services/backups';
 import { MissionFiles } from '../../src/services/mission-files';
 import { ConfigFileHelper } from '../../src/config/config-file-helper';
 import { ServerDetector } from '../../src/services/server-detector';
 import { SystemReporter } from '../../src/services/system-reporter';
+import { ServerTelemetry } from '../../src/services/server-telemetry';
+import { ResourceProfiles } from '../../src/services/resource-profiles';
+import { StagedUpdates } from '../../src/services/staged-updates';
+import { ClassDatabase } from '../../src/services/class-database';
+import { RestartTracer } from '../../src/services/restart-tracer';
+import { ClusterController } from '../../src/services/cluster-controller';
+import { ManagerProfiler } from '../../src/services/manager-profiler';
+import { EventBus } from '../../src/control/event-bus';
+import { InternalEventTypes } from '../../src/types/events';
 
 
 describe('Test Interface', () => {
@@ -32,6 +41,8 @@ describe('Test Interface', () => {
     let backups: StubInstance<Backups>;
     let missionFiles: StubInstance<MissionFiles>;
     let configFileHelper: StubInstance<ConfigFileHelper>;
+    let clusterController: StubInstance<ClusterController>;
+    let managerProfiler: StubInstance<ManagerProfiler>;
 
     before(() => {
         disableConsole();
@@ -55,10 +66,18 @@ describe('Test Interface', () => {
         injector.register(ServerDetector, stubClass(ServerDetector), { lifecycle: Lifecycle.Singleton });
         injector.register(Metrics, stubClass(Metrics), { lifecycle: Lifecycle.Singleton });
         injector.register(SteamCMD, stubClass(SteamCMD), { lifecycle: Lifecycle.Singleton });
+        injector.register(SteamMetaData, stubClass(SteamMetaData), { lifecycle: Lifecycle.Singleton });
         injector.register(LogReader, stubClass(LogReader), { lifecycle: Lifecycle.Singleton });
         injector.register(Backups, stubClass(Backups), { lifecycle: Lifecycle.Singleton });
         injector.register(MissionFiles, stubClass(MissionFiles), { lifecycle: Lifecycle.Singleton });
         injector.register(ConfigFileHelper, stubClass(ConfigFileHelper), { lifecycle: Lifecycle.Singleton });
+        injector.register(ServerTelemetry, stubClass(ServerTelemetry), { lifecycle: Lifecycle.Singleton });
+        injector.register(ResourceProfiles, stubClass(ResourceProfiles), { lifecycle: Lifecycle.Singleton });
+        injector.register(StagedUpdates, stubClass(StagedUpdates), { lifecycle: Lifecycle.Singleton });
+        injector.register(ClassDatabase, stubClass(ClassDatabase), { lifecycle: Lifecycle.Singleton });
+        injector.register(RestartTracer, stubClass(RestartTracer), { lifecycle: Lifecycle.Singleton });
+        injector.register(ClusterController, stubClass(ClusterController), { lifecycle: Lifecycle.Singleton });
+        injector.register(ManagerProfiler, stubClass(ManagerProfiler), { lifecycle: Lifecycle.Singleton });
         
         manager = injector.resolve(Manager) as any;
         manager.config = {
@@ -105,6 +124,8 @@ describe('Test Interface', () => {
         backups = injector.resolve(Backups) as any;
         missionFiles = injector.resolve(MissionFiles) as any;
         configFileHelper = injector.resolve(ConfigFileHelper) as any;
+        clusterController = injector.resolve(ClusterController) as any;
+        managerProfiler = injector.resolve(ManagerProfiler) as any;
     });
 
     it('execute-non existing', async () => {
@@ -150,6 +171,29 @@ describe('Test Interface', () => {
         expect(response.status).to.be.greaterThanOrEqual(400);
     });
 
+    it('execute-forwarded', async () => {
+        manager.isUserOfLevel.returns(false);
+        manager.isLevelAllowed.callsFake(Manager.prototype.isLevelAllowed);
+        const handler = injector.resolve(Interface);
+        const request = {
+            resource: 'ping',
+            user: 'controllerUser',
+            userLevel: 'view',
+            forwarded: true,
+        } as any as Request;
+        const response = await handler.execute(request);
+
+        // the user is only known to the cluster controller, which asserts the level
+        expect(response.status).to.equal(200);
+        expect(manager.isLevelAllowed.calledWith('view', 'view')).to.be.true;
+
+        const noLevel = await handler.execute({ ...request, userLevel: undefined } as Request);
+        expect(noLevel.status).to.equal(401);
+
+        const lowLevel = await handler.execute({ ...request, resource: 'lockrestart' } as Request);
+        expect(lowLevel.status).to.equal(401);
+    });
+
     it('execute-auth level', async () => {
         manager.isUserOfLevel.returns(false);
         const handler = injector.resolve(Interface);
@@ -455,6 +499,26 @@ describe('Test Interface', () => {
         expect(metrics.fetchMetrics.firstCall.firstArg).to.equal('test');
     });
 
+    it('execute-metrics-cached', async () => {
+        injector.register(EventBus, EventBus, { lifecycle: Lifecycle.Singleton });
+        metrics.fetchMetrics.resolves([]);
+        const handler = injector.resolve(Interface);
+        const eventBus = injector.resolve(EventBus);
+        const players = { resource: 'metrics', user: 'admin', query: { type: 'PLAYERS' } } as any as Request;
+        const system = { resource: 'metrics', user: 'admin', query: { type: 'SYSTEM' } } as any as Request;
+        await handler.execute(players);
+        await handler.execute(system);
+
+        // only the metrics of the pushed type are outdated
+        eventBus.emit(InternalEventTypes.METRIC_ENTRY, { type: 'SYSTEM', entry: {} as any });
+        await new Promise((r) => setImmediate(r));
+        await handler.execute(players);
+        await handler.execute(system);
+
+        expect(metrics.fetchMetrics.callCount).to.equal(3);
+        expect(metrics.fetchMetrics.lastCall.firstArg).to.equal('SYSTEM');
+    });
+
     it('execute-metrics-missing type', async () => {
         const handler = injector.resolve(Interface);
         const request = {
@@ -643,6 +707,18 @@ describe('Test Interface', () => {
         expect(missionFiles.readMissionFile.callCount).to.equal(3);
     });
 
+    it('execute-readmissionfiles-invalid', async () => {
+        const handler = injector.resolve(Interface);
+        for (const resource of ['readmissionfiles', 'readmissioneconomyfiles']) {
+            for (const files of ['test1', { 0: 'test1' }, [1]]) {
+                const response = await handler.execute({ resource, user: 'admin', body: { files } });
+                expect(response.status).to.equal(400);
+            }
+        }
+        expect(missionFiles.readMissionFile.called).to.be.false;
+        expect(missionFiles.readMissionEconomy.called).to.be.false;
+    });
+
     it('execute-readmissiondir', async () => {
         missionFiles.readMissionDir.resolves([]);
         const handler = injector.resolve(Interface);
@@ -732,4 +808,170 @@ describe('Test Interface', () => {
         expect(manager.getServerInfo.called).to.be.true;
     });
 
+    it('execute-cached', async () => {
+        manager.getServerInfo.resolves({ name: 'hello' } as any);
+        const handler = injector.resolve(Interface);
+        const request = {
+            resource: 'serverinfo',
+            user: 'admin',
+        } as any as Request;
+        await handler.execute(request);
+        const response = await handler.execute(request);
+
+        expect(response.status).to.equal(200);
+        expect(response.body).to.deep.equal({ name: 'hello' });
+        expect(response.serializedBody).to.equal('{"name":"hello"}');
+        expect(manager.getServerInfo.callCount).to.equal(1);
+
+        const stats = await handler.execute({
+            resource: 'cachestats',
+            user: 'admin',
+        } as any as Request);
+        expect(stats.body).to.deep.include({ enabled: true });
+        expect((stats.body as any).commands.serverinfo).to.include({ hits: 1, misses: 1 });
+    });
+
+    it('execute-agents', async () => {
+        clusterController.getAgents.returns([{
+            name: 'host1',
+            version: '1.0.0',
+            address: '127.0.0.1',
+            state: { serverState: 'STARTED', players: 3, cpu: 10, mem: 1000, memTotal: 2000 },
+        }] as any);
+        const handler = injector.resolve(Interface);
+        const response = await handler.execute({
+            resource: 'agents',
+            user: 'admin',
+            accept: 'text/plain',
+        } as any as Request);
+
+        expect(response.status).to.equal(200);
+        expect(response.body).to.include('host1');
+        expect(response.body).to.include('1000 / 2000 MB');
+
+        clusterController.getAgents.returns([]);
+        const empty = await handler.execute({
+            resource: 'agents',
+            user: 'admin',
+            accept: 'text/plain',
+        } as any as Request);
+        expect(empty.body).to.equal('No agents connected');
+
+        const json = await handler.execute({
+            resource: 'agents',
+            user: 'admin',
+        } as any as Request);
+        expect(json.body).to.deep.equal([]);
+    });
+
+    it('execute-agentlogs', async () => {
+        clusterController.getAgentLogs.returns([]);
+        clusterController.getAgentMetrics.returns([]);
+        const handler = injector.resolve(Interface);
+        await handler.execute({
+            resource: 'agentlogs',
+            user: 'admin',
+            query: { agent: 'host1', type: 'ADM', since: 1 },
+        } as any as Request);
+        await handler.execute({
+            resource: 'agentmetrics',
+            user: 'admin',
+            query: { agent: 'host1', type: 'SYSTEM' },
+        } as any as Request);
+
+        expect(clusterController.getAgentLogs.firstCall.args).to.deep.equal(['host1', 'ADM', 1]);
+        expect(clusterController.getAgentMetrics.firstCall.args).to.deep.equal(['host1', 'SYSTEM', undefined]);
+    });
+
+    it('execute-agentrequest', async () => {
+        clusterController.request.resolves(new Response(200, 'remote'));
+        const handler = injector.resolve(Interface);
+        const response = await handler.execute({
+            resource: 'agentrequest',
+            user: 'admin',
+            body: { agent: 'host1', command: 'lockrestart' },
+        } as any as Request);
+
+        expect(response.status).to.equal(200);
+        expect(response.body).to.equal('remote');
+        const [agent, forwarded] = clusterController.request.firstCall.args;
+        expect(agent).to.equal('host1');
+        expect(forwarded.resource).to.equal('lockrestart');
+        expect(forwarded.user).to.equal('admin');
+
+        clusterController.request.resolves(new Response(404, 'Agent host1 is not connected'));
+        const failed = await handler.execute({
+            resource: 'agentrequest',
+            user: 'admin',
+            body: { agent: 'host1', command: 'lockrestart' },
+        } as any as Request);
+        expect(failed.status).to.equal(404);
+    });
+
+    it('execute-agentrequest-not allowed', async () => {
+        manager.isUserOfLevel.callsFake((user, level) => level === 'view');
+        const handler = injector.resolve(Interface);
+        const unknown = await handler.execute({
+            resource: 'agentrequest',
+            user: 'whatever',
+            body: { agent: 'host1', command: 'whatever' },
+        } as any as Request);
+        const notAllowed = await handler.execute({
+            resource: 'agentrequest',
+            user: 'whatever',
+            body: { agent: 'host1', command: 'lockrestart' },
+        } as any as Request);
+
+        expect(unknown.status).to.equal(400);
+        expect(notAllowed.status).to.equal(401);
+        expect(clusterController.request.called).to.be.false;
+    });
+
+    it('execute-rollout', async () => {
+        clusterController.rollout.returns({ id: 1 } as any);
+        clusterController.getRollouts.returns([{ id: 1 }] as any);
+        const handler = injector.resolve(Interface);
+        const response = await handler.execute({
+            resource: 'rollout',
+            user: 'admin',
+            body: { command: 'restart', stagger: 60 },
+        } as any as Request);
+        const rollouts = await handler.execute({
+            resource: 'rollouts',
+            user: 'admin',
+        } as any as Request);
+
+        expect(response.status).to.equal(200);
+        expect(clusterController.rollout.firstCall.args).to.deep.equal(['restart', 'admin', undefined, 60000]);
+        expect(rollouts.body).to.deep.equal([{ id: 1 }]);
+    });
+
+    it('execute-profiler', async () => {
+        const file = { file: 'cpu-test.cpuprofile', type: 'cpu', size: 1, created: 1 } as any;
+        managerProfiler.captureCpuProfile.resolves(file);
+        managerProfiler.captureHeapProfile.resolves(file);
+        managerProfiler.takeHeapSnapshot.resolves(file);
+        managerProfiler.dumpActiveHandles.resolves({ handles: [] } as any);
+        managerProfiler.getProfiles.resolves([file]);
+        const handler = injector.resolve(Interface);
+
+        const execute = (resource: string, params?: any) => handler.execute({
+            resource,
+            user: 'admin',
+            body: params,
+            query: params,
+        } as any as Request);
+
+        expect((await execute('cpuprofile', { seconds: '5' })).body).to.equal(file);
+        expect((await execute('heapprofile')).body).to.equal(file);
+        expect((await execute('heapsnapshot')).body).to.equal(file);
+        expect((await execute('activehandles')).body).to.deep.equal({ handles: [] });
+        expect((await execute('profiles')).body).to.deep.equal([file]);
+        // profiles are downloaded via REST, so they are streamed
+        expect(handler.commandMap.has('profile')).to.be.false;
+
+        expect(managerProfiler.captureCpuProfile.firstCall.args).to.deep.equal([5]);
+        expect(managerProfiler.captureHeapProfile.firstCall.args).to.deep.equal([10]);
+    });
+
 });
@@ -0,0 +1,138 @@
+import { expect } from '../expect';
+import * as sinon from 'sinon';
+import { StubInstance, disableConsole, enableConsole, stubClass } from '../util';
+import { DependencyContainer, Lifecycle, container } from 'tsyringe';
+import { Manager } from '../../src/control/manager';
+import { EventBus } from '../../src/control/event-bus';
+import { InternalEventTypes } from '../../src/types/events';
+import { Response } from '../../src/types/interface';
+import { ResponseCache } from '../../src/interface/response-cache';
+
+describe('Test class ResponseCache', () => {
+
+    let injector: DependencyContainer;
+
+    let manager: StubInstance<Manager>;
+    let eventBus: EventBus;
+
+    const options = { ttl: 1000, invalidateOn: [InternalEventTypes.BACKUP_CREATED] };
+
+    before(() => {
+        disableConsole();
+    });
+
+    after(() => {
+        enableConsole();
+    });
+
+    beforeEach(() => {
+        container.reset();
+        injector = container.createChildContainer();
+
+        injector.register(Manager, stubClass(Manager), { lifecycle: Lifecycle.Singleton });
+        injector.register(EventBus, EventBus, { lifecycle: Lifecycle.Singleton });
+
+        manager = injector.resolve(Manager) as any;
+        manager.config = {} as any;
+        eventBus = injector.resolve(EventBus);
+    });
+
+    it('ResponseCache-hit', async () => {
+        const cache = injector.resolve(ResponseCache);
+        const execute = sinon.stub().callsFake(async () => new Response(200, [{ file: 'a' }]));
+
+        // concurrent requests share one execution
+        const [first, second] = await Promise.all([
+            cache.fetch('getbackups', options, 'key', execute),
+            cache.fetch('getbackups', options, 'key', execute),
+        ]);
+        const third = await cache.fetch('getbackups', options, 'key', execute);
+        await cache.fetch('getbackups', options, 'other', execute);
+
+        expect(execute.callCount).to.equal(2);
+        expect(first.body).to.deep.equal([{ file: 'a' }]);
+        expect(third.serializedBody).to.equal('[{"file":"a"}]');
+        expect(second).to.not.equal(third);
+
+        expect(cache.getStats()).to.deep.equal({
+            enabled: true,
+            commands: {
+                getbackups: { hits: 2, misses: 2, invalidations: 0, entries: 2 },
+            },
+        });
+    });
+
+    it('ResponseCache-invalidate', async () => {
+        const cache = injector.resolve(ResponseCache);
+        const execute = sinon.stub().callsFake(async () => new Response(200, { ok: true }));
+
+        await cache.fetch('getbackups', options, 'key', execute);
+        eventBus.emit(InternalEventTypes.BACKUP_CREATED, 'mpmissions_1');
+        await cache.fetch('getbackups', options, 'key', execute);
+        expect(execute.callCount).to.equal(2);
+        expect(cache.getStats().commands.getbackups.invalidations).to.equal(1);
+
+        // invalidated while executing, the stale result is not stored
+        let resolve: (r: Response) => void;
+        execute.callsFake(() => new Promise((r) => resolve = r));
+        cache.invalidate();
+        const pending = cache.fetch('getbackups', options, 'key', execute);
+        cache.invalidate('getbackups');
+        resolve!(new Response(200, { ok: false }));
+        expect((await pending).body).to.deep.equal({ ok: false });
+        expect(cache.getStats().commands.getbackups.entries).to.equal(0);
+    });
+
+    it('ResponseCache-invalidate matching', async () => {
+        const cache = injector.resolve(ResponseCache);
+        const execute = sinon.stub().callsFake(async () => new Response(200, { ok: true }));
+        const matching = {
+            ttl: 1000,
+            invalidateOn: [InternalEventTypes.BACKUP_REMOVED],
+            invalidates: (params, removed: string[]) => removed.includes(params.backup),
+        };
+
+        await cache.fetch('backup', matching, 'a', execute, { backup: 'a' });
+        await cache.fetch('backup', matching, 'b', execute, { backup: 'b' });
+        eventBus.emit(InternalEventTypes.BACKUP_REMOVED, ['a']);
+        await cache.fetch('backup', matching, 'a', execute, { backup: 'a' });
+        await cache.fetch('backup', matching, 'b', execute, { backup: 'b' });
+
+        expect(execute.callCount).to.equal(3);
+        expect(cache.getStats().commands.backup).to.include({ invalidations: 1, entries: 2 });
+
+        // nothing matched
+        eventBus.emit(InternalEventTypes.BACKUP_REMOVED, ['c']);
+        expect(cache.getStats().commands.backup.invalidations).to.equal(1);
+    });
+
+    it('ResponseCache-not cached', async () => {
+        const cache = injector.resolve(ResponseCache);
+        const execute = sinon.stub().callsFake(async () => new Response(404, 'Action had no results'));
+
+        await cache.fetch('getbackups', options, 'key', execute);
+        await cache.fetch('getbackups', options, 'key', execute);
+        expect(execute.callCount).to.equal(2);
+
+        // string bodies are not serialized
+        execute.callsFake(async () => new Response(200, 'config'));
+        await cache.fetch('config', { ttl: 1000 }, 'key', execute);
+        expect((await cache.fetch('config', { ttl: 1000 }, 'key', execute)).serializedBody).to.be.undefined;
+
+        manager.config.webResponseCache = false;
+        await cache.fetch('config', { ttl: 1000 }, 'key', execute);
+        expect(execute.callCount).to.equal(4);
+        expect(cache.getStats().enabled).to.be.false;
+    });
+
+    it('ResponseCache-evict', async () => {
+        const cache = injector.resolve(ResponseCache);
+        const execute = async () => new Response(200, {});
+
+        for (let i = 0; i <= ResponseCache.MAX_ENTRIES; i++) {
+            await cache.fetch('metrics', { ttl: 1000 }, `${i}`, execute);
+        }
+        expect(cache.getStats().commands.metrics.entries).to.equal(ResponseCache.MAX_ENTRIES);
+    });
+
+});
@@ -11,7 +11,11 @@ import * as websocket from 'websocket';
 import { EventBus } from '../../src/control/event-bus';
 import { InternalEventTypes } from '../../src/types/events';
 import { WebsocketCommand, WebsocketListenerEvent, WebsocketListenerType, WebsocketMessage } from '../../src/types/websocket';
-import { Request } from '../../src/types/interface';
+import { Request, Response } from '../../src/types/interface';
+import { Prometheus } from '../../src/services/prometheus';
+import { PromRegistry } from '../../src/util/prometheus';
+import { ManagerProfiler } from '../../src/services/manager-profiler';
+import { PassThrough, Readable } from 'stream';
 
 
 describe('Test REST', () => {
@@ -32,6 +36,8 @@ describe('Test REST', () => {
         injector.register(Manager, stubClass(Manager), { lifecycle: Lifecycle.Singleton });
         injector.register(EventBus, EventBus, { lifecycle: Lifecycle.Singleton });
         injector.register(Interface, stubClass(Interface), { lifecycle: Lifecycle.Singleton });
+        injector.register(Prometheus, Prometheus, { lifecycle: Lifecycle.Singleton });
+        injector.register(ManagerProfiler, stubClass(ManagerProfiler), { lifecycle: Lifecycle.Singleton });
         
         manager = injector.resolve(Manager) as any;
         manager.initDone = true;
@@ -130,6 +136,8 @@ describe('Test REST', () => {
         expect(registeredPaths.get('all')).to.include(`*`);
         expect(registeredPaths.get('get')).to.include(`/login`);
         expect(registeredPaths.get('get')).to.include(`/dashboard`);
+        expect(registeredPaths.get('get')).to.include(`/metrics`);
+        expect(registeredRouterPaths.get('get')).to.include(`/profile`);
 
         interfaceService.commandMap.forEach(
             (template, key) => {
@@ -143,6 +151,17 @@ describe('Test REST', () => {
         
     });
 
+    it('REST-clusterAgent', async () => {
+        (manager as any).config = { clusterMode: 'agent' };
+        const rest = injector.resolve(REST);
+        const createExpress = sinon.stub(rest, 'createExpress');
+
+        await rest.start();
+        await rest.stop();
+
+        expect(createExpress.called).to.be.false;
+    });
+
     it('REST-ws', async () => {
         manager.isUserOfLevel.returns(true);
         manager.getWebPort.returns(12564);
@@ -314,9 +333,131 @@ describe('Test REST', () => {
         expect(interfaceService.execute.firstCall.lastArg.body).to.equal(req.body);
         expect(interfaceService.execute.firstCall.lastArg.resource).to.equal('testResource');
         expect(interfaceService.execute.firstCall.lastArg.user).to.equal('admin');
+
+        // cached responses are sent as they are
+        const cached = new Response(200, { ok: true });
+        cached.serializedBody = '{"ok":true}';
+        interfaceService.execute.resolves(cached);
+        let resType;
+        res.type = (type) => {
+            resType = type;
+            return res;
+        };
+        await rest['handleCommand'](req, res, 'testResource');
+        expect(resType).to.equal('json');
+        expect(resBody).to.equal('{"ok":true}');
+        expect(JSON.parse(rest['serializeWsResponse'](cached))).to.deep.equal({
+            cmd: WebsocketCommand.RESPONSE,
+            data: { status: 200, body: { ok: true } },
+        });
         
     });
 
+    it('REST-handleMetrics', async () => {
+        const rest = injector.resolve(REST);
+        injector.resolve(Prometheus).players.set(3, { source: 'rcon' });
+
+        let resResponseCode;
+        let resType;
+        let resBody;
+        const res = {
+            status: (code) => {
+                resResponseCode = code;
+                return res;
+            },
+            type: (type) => {
+                resType = type;
+                return res;
+            },
+            send: (body) => resBody = body,
+        } as any;
+
+        rest['handleMetrics']({} as any, res);
+        expect(resResponseCode).to.equal(200);
+        expect(resType).to.equal(PromRegistry.CONTENT_TYPE);
+        expect(resBody).to.include('dzsm_players{source="rcon"} 3\n');
+    });
+
+    it('REST-metricsAuth', async () => {
+        (manager as any).config = {
+            admins: [{ userId: 'admin', password: 'admin', userLevel: 'admin' }],
+            prometheusMetricsToken: 'scrape',
+        };
+        const rest = injector.resolve(REST);
+
+        const authorize = (auth: any, authorization?: string): boolean => {
+            let allowed = false;
+            const res = {
+                status: () => res,
+                set: () => res,
+                send: () => res,
+                json: () => res,
+            } as any;
+            auth({ headers: { authorization } } as any, res, () => allowed = true);
+            return allowed;
+        };
+
+        const auth = rest['createMetricsAuth']();
+        expect(authorize(auth, 'Bearer scrape')).to.be.true;
+        expect(authorize(auth, `Basic ${Buffer.from('admin:admin').toString('base64')}`)).to.be.true;
+        expect(authorize(auth, 'Bearer wrong')).to.be.false;
+        expect(authorize(auth)).to.be.false;
+
+        // without a token only basic auth is accepted
+        (manager as any).config.prometheusMetricsToken = '';
+        expect(authorize(rest['createMetricsAuth'](), 'Bearer ')).to.be.false;
+    });
+
+    it('REST-handleProfileDownload', async () => {
+        const rest = injector.resolve(REST);
+        const profiler = injector.resolve(ManagerProfiler) as any as StubInstance<ManagerProfiler>;
+        const req = {
+            headers: {
+                authorization: 'Basic ' + Buffer.from('admin:admin').toString('base64'),
+            },
+            query: { file: 'cpu-1.cpuprofile' },
+        } as any;
+        const createRes = (): any => {
+            const res = new PassThrough() as any;
+            res.status = sinon.stub().returns(res);
+            res.attachment = sinon.stub().returns(res);
+            res.set = sinon.stub().returns(res);
+            res.send = sinon.stub().returns(res);
+            res.sendStatus = sinon.stub().returns(res);
+            return res;
+        };
+
+        manager.isUserOfLevel.returns(false);
+        const unauthorized = createRes();
+        await rest['handleProfileDownload'](req, unauthorized);
+        expect(unauthorized.sendStatus.calledWith(401)).to.be.true;
+        expect(profiler.openProfile.called).to.be.false;
+
+        manager.isUserOfLevel.returns(true);
+        profiler.openProfile.resolves({
+            profile: { file: 'cpu-1.cpuprofile', type: 'cpu', size: 7, created: 1 },
+            stream: Readable.from(['{"a":1}']),
+        });
+        const res = createRes();
+        const chunks: Buffer[] = [];
+        res.on('data', (chunk) => chunks.push(chunk));
+        const ended = new Promise((r) => res.on('end', r));
+        await rest['handleProfileDownload'](req, res);
+        await ended;
+
+        expect(profiler.openProfile.calledWith('cpu-1.cpuprofile')).to.be.true;
+        expect(res.status.calledWith(200)).to.be.true;
+        expect(res.attachment.calledWith('cpu-1.cpuprofile')).to.be.true;
+        expect(res.set.calledWith('Content-Length', '7')).to.be.true;
+        expect(Buffer.concat(chunks).toString()).to.equal('{"a":1}');
+
+        profiler.openProfile.rejects(new Response(404, 'Profile ../secret.json not found'));
+        const notFound = createRes();
+        await rest['handleProfileDownload']({ ...req, query: { file: '../secret.json' } }, notFound);
+        expect(notFound.status.calledWith(404)).to.be.true;
+        expect(notFound.send.calledWith('Profile ../secret.json not found')).to.be.true;
+    });
+
     it('REST-handleCommand-cors', async () => {
 
         const rest = injector.resolve(REST);
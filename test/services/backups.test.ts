@@ -6,12 +6,15 @@ import { DependencyContainer, Lifecycle, container } from 'tsyringe';
 import { Paths } from '../../src/services/paths';
 import { FSAPI, InjectionTokens } from '../../src/util/apis';
 import { Manager } from '../../src/control/manager';
+import { EventBus } from '../../src/control/event-bus';
+import { InternalEventTypes } from '../../src/types/events';
 
 describe('Test class Backups', () => {
 
     let injector: DependencyContainer;
 
     let manager: StubInstance<Manager>;
+    let eventBus: StubInstance<EventBus>;
     let paths: Paths;
     let fs: FSAPI;
 
@@ -31,9 +34,11 @@ describe('Test class Backups', () => {
         injector.register(InjectionTokens.childProcess, { useValue: {} });
         injector.register(Paths, Paths, { lifecycle: Lifecycle.Singleton });
         injector.register(Manager, stubClass(Manager), { lifecycle: Lifecycle.Singleton });
+        injector.register(EventBus, stubClass(EventBus), { lifecycle: Lifecycle.Singleton });
 
         paths = injector.resolve(Paths);
         manager = injector.resolve(Manager) as any;
+        eventBus = injector.resolve(EventBus) as any;
     });
 
     it('Backups', async () => {
@@ -56,6 +61,35 @@ describe('Test class Backups', () => {
         expect(fs.existsSync('/test/backups')).to.be.true;
         const backups = fs.readdirSync('/test/backups', { withFileTypes: true });
         expect(backups.length).to.equal(1);
+        expect(eventBus.emit.calledWith(InternalEventTypes.BACKUP_CREATED, backups[0].name)).to.be.true;
+
+    });
+
+    it('Backups-deduplicate', async () => {
+
+        fs.mkdirSync('/test/testserver/mpmissions', { recursive: true });
+        fs.writeFileSync('/test/testserver/mpmissions/test.txt', 'test');
+
+        paths.setCwd('/test');
+        manager.config = {
+            backupPath: '/test/backups',
+            backupMaxAge: 1,
+            backupDeduplicate: true,
+        } as any;
+        manager.getServerPath.returns('/test/testserver');
+
+        const backup = injector.resolve(Backups);
+
+        await backup.createBackup();
+
+        const backups = await backup.getBackups();
+        expect(backups.length).to.equal(1);
+        expect(fs.existsSync(`/test/backups/${backups[0].file}.json`)).to.be.true;
+
+        const restored = await backup.restoreBackup(backups[0].file);
+        expect(fs.readFileSync(`${restored}/test.txt`) + '').to.equal('test');
+
+        await expect(backup.restoreBackup('../../etc')).to.be.rejected;
 
     });
 
@@ -81,6 +115,7 @@ describe('Test class Backups', () => {
         await backup.cleanup();
 
         expect(unlinkStub.callCount).to.equal(1);
+        expect(eventBus.emit.calledWith(InternalEventTypes.BACKUP_REMOVED, ['mpmissions_at_some_time'])).to.be.true;
 
     });
 
@@ -0,0 +1,206 @@
+import { expect } from '../expect';
+import { ImportMock } from 'ts-mock-imports';
+import { StubInstance, buildPbo, disableConsole, enableConsole, memfs, rapify, stubClass } from '../util';
+import { DependencyContainer, Lifecycle, container } from 'tsyringe';
+import { Manager } from '../../src/control/manager';
+import { Paths } from '../../src/services/paths';
+import { SteamCMD, SteamMetaData } from '../../src/services/steamcmd';
+import { EventBus } from '../../src/control/event-bus';
+import { ClassDatabase } from '../../src/services/class-database';
+import { WorkerPool } from '../../src/services/worker-pool';
+import { TaskTracker } from '../../src/services/task-tracker';
+import { LoggerFactory } from '../../src/services/loggerfactory';
+import { FSAPI } from '../../src/util/apis';
+
+describe('Test class ClassDatabase', () => {
+
+    let injector: DependencyContainer;
+
+    let manager: StubInstance<Manager>;
+    let steamCmd: StubInstance<SteamCMD>;
+    let steamMeta: StubInstance<SteamMetaData>;
+    let fs: FSAPI;
+
+    const MOD_CONFIG = `
+        #include "items.hpp"
+        class CfgPatches
+        {
+            class TestMod
+            {
+                requiredAddons[] = {"DZ_Data", "OtherMod"};
+            };
+        };
+        class CfgVehicles
+        {
+            class Clothing_Base;
+            class TestJacket: Clothing_Base
+            {
+                scope = 2;
+                weight = 5;
+                class DamageSystem
+                {
+                    armor = 1;
+                };
+            };
+            class Apple
+            {
+                weight = 2;
+            };
+        };
+    `;
+
+    before(() => {
+        disableConsole();
+    });
+
+    after(() => {
+        enableConsole();
+    });
+
+    beforeEach(() => {
+        // restore mocks
+        ImportMock.restore();
+
+        container.reset();
+        injector = container.createChildContainer();
+
+        injector.register(Manager, stubClass(Manager), { lifecycle: Lifecycle.Singleton });
+        injector.register(Paths, stubClass(Paths), { lifecycle: Lifecycle.Singleton });
+        injector.register(SteamCMD, stubClass(SteamCMD), { lifecycle: Lifecycle.Singleton });
+        injector.register(SteamMetaData, stubClass(SteamMetaData), { lifecycle: Lifecycle.Singleton });
+        injector.register(EventBus, stubClass(EventBus), { lifecycle: Lifecycle.Singleton });
+        fs = memfs(
+            {
+                '/server': { 'dta': { 'core.pbo': '' }, 'addons': {} },
+                '/ws': { '1234': { 'addons': {} }, '5678': { 'Addons': {} } },
+                '/meta': {},
+            },
+            '/',
+            injector,
+        );
+        fs.writeFileSync('/server/dta/core.pbo', buildPbo([{ name: 'readme.txt', data: 'no config' }]));
+        fs.writeFileSync('/server/addons/data.pbo', buildPbo([{
+            name: 'config.bin',
+            data: rapify({
+                CfgPatches: { DZ_Data: { requiredAddons: [] } },
+                CfgVehicles: {
+                    Inventory_Base: { scope: 0, weight: 10, DamageSystem: { hp: 100 } },
+                    Clothing_Base: { __inherited: 'Inventory_Base' },
+                    Apple: { __inherited: 'Inventory_Base', scope: 2, weight: 0 },
+                },
+            }),
+        }]));
+        fs.writeFileSync('/ws/1234/addons/mod.pbo', buildPbo(
+            [
+                { name: 'config.cpp', data: MOD_CONFIG },
+                { name: 'items.hpp', data: 'class CfgVehicles { class Inventory_Base; class TestApple: Inventory_Base { scope = 2; }; };' },
+            ],
+            { prefix: 'testmod' },
+        ));
+        fs.writeFileSync('/ws/5678/Addons/other.pbo', buildPbo([{
+            name: 'data\\config.cpp',
+            data: 'class CfgPatches { class OtherMod {}; }; class CfgVehicles { class Apple { weight = 1; }; };',
+        }]));
+        fs.writeFileSync('/ws/5678/Addons/broken.pbo', 'broken');
+
+        manager = injector.resolve(Manager) as any;
+        steamCmd = injector.resolve(SteamCMD) as any;
+        steamMeta = injector.resolve(SteamMetaData) as any;
+
+        manager.config = {
+            classDatabase: true,
+            localMods: [],
+        } as any;
+        manager.getServerPath.returns('/server');
+        manager.getCombinedModIdList.returns(['1234', '5678']);
+        steamMeta.getMetaDataPath.returns('/meta');
+        steamCmd.getWsModDir.callsFake((modId) => `/ws/${modId}`);
+        steamCmd.getWsModName.callsFake((modId) => `@Mod${modId}`);
+    });
+
+    it('ClassDatabase-update', async () => {
+        const classDb = injector.resolve(ClassDatabase);
+
+        const result = await classDb.update();
+        // 5 vehicles and 3 patches
+        expect(result).to.include({ pbos: 5, parsed: 5, removed: 0, failed: 1, classes: 8 });
+
+        const jacket = classDb.getClass('testjacket');
+        expect(jacket).to.deep.include({
+            classname: 'TestJacket',
+            root: 'CfgVehicles',
+            source: '@Mod1234',
+            parents: ['Clothing_Base', 'Inventory_Base'],
+        });
+        expect(jacket.properties).to.deep.equal({
+            scope: 2,
+            weight: 5,
+            DamageSystem: { hp: 100, armor: 1 },
+        });
+
+        // included from the hpp
+        expect(classDb.isKindOf('TestApple', 'inventory_base')).to.be.true;
+        expect(classDb.isKindOf('TestApple', 'Clothing_Base')).to.be.false;
+        expect(classDb.getClass('Missing')).to.be.undefined;
+        expect(classDb.getClass('Apple', 'CfgWeapons')).to.be.undefined;
+
+        // merged after OtherMod, as it is required, although it is loaded before
+        expect(classDb.getClass('Apple').properties.weight).to.equal(2);
+        expect(classDb.getClass('Apple').properties.scope).to.equal(2);
+
+        const query = classDb.query({ baseClass: 'Inventory_Base', scope: 2, limit: 2 });
+        expect(query.total).to.equal(3);
+        expect(query.items.map((x) => x.classname)).to.deep.equal(['Apple', 'TestApple']);
+        expect(classDb.query({ name: 'jack' }).items.map((x) => x.classname)).to.deep.equal(['TestJacket']);
+
+        expect(classDb.getStatus()).to.include({ pbos: 5, classes: 8, updating: false });
+    });
+
+    it('ClassDatabase-incremental', async () => {
+        const classDb = injector.resolve(ClassDatabase);
+        await classDb.update();
+
+        expect(await classDb.update()).to.include({ parsed: 0, removed: 0 });
+
+        fs.writeFileSync('/ws/1234/addons/mod.pbo', buildPbo([{
+            name: 'config.cpp',
+            data: 'class CfgVehicles { class Inventory_Base; class TestJacket: Inventory_Base { scope = 1; weight = 7; }; };',
+        }]));
+        fs.unlinkSync('/ws/5678/Addons/other.pbo');
+        const result = await classDb.update();
+        expect(result).to.include({ parsed: 1, removed: 1 });
+        expect(classDb.getClass('TestJacket').properties.weight).to.equal(7);
+        expect(classDb.getClass('TestApple')).to.be.undefined;
+        expect(fs.readdirSync('/meta/classdb').length).to.equal(3);
+
+        // persisted
+        const restarted = new ClassDatabase(
+            injector.resolve(LoggerFactory),
+            manager,
+            injector.resolve(Paths),
+            steamCmd,
+            steamMeta,
+            injector.resolve(EventBus),
+            injector.resolve(WorkerPool),
+            injector.resolve(TaskTracker),
+            fs,
+        );
+        expect(await restarted.update()).to.include({ parsed: 0, removed: 0 });
+        expect(restarted.getClass('TestJacket').properties.weight).to.equal(7);
+    });
+
+    it('ClassDatabase-start', async () => {
+        const classDb = injector.resolve(ClassDatabase);
+
+        manager.config.classDatabase = false;
+        await classDb.start();
+        await classDb.stop();
+        expect(classDb.getStatus().lastUpdate).to.be.undefined;
+
+        manager.config.classDatabase = true;
+        await classDb.start();
+        await classDb.stop();
+        expect(classDb.getStatus().lastResult).to.include({ parsed: 5 });
+    });
+
+});
@@ -0,0 +1,387 @@
+import 'reflect-metadata';
+
+import { expect } from '../expect';
+import * as sinon from 'sinon';
+import { StubInstance, disableConsole, enableConsole, sleep, stubClass } from '../util';
+import { DependencyContainer, Lifecycle, container } from 'tsyringe';
+import { Manager } from '../../src/control/manager';
+import { Monitor } from '../../src/services/monitor';
+import { EventBus } from '../../src/control/event-bus';
+import { Interface } from '../../src/interface/interface';
+import { ClusterController } from '../../src/services/cluster-controller';
+import { ClusterAgent } from '../../src/services/cluster-agent';
+import { InternalEventTypes } from '../../src/types/events';
+import { Request, Response } from '../../src/types/interface';
+import { ServerState } from '../../src/types/monitor';
+import { Events } from '../../src/services/events';
+import { RCON } from '../../src/services/rcon';
+import { Backups } from '../../src/services/backups';
+import { ImportMock } from 'ts-mock-imports';
+import * as cron from 'node-schedule';
+
+const PORT = 23200;
+
+const waitFor = async (condition: () => boolean, timeout: number = 2000): Promise<void> => {
+    const start = Date.now();
+    while (!condition()) {
+        if ((Date.now() - start) > timeout) {
+            throw new Error('Timed out waiting for condition');
+        }
+        await sleep(5);
+    }
+};
+
+interface TestAgent {
+    agent: ClusterAgent;
+    eventBus: EventBus;
+    monitor: StubInstance<Monitor>;
+    eventInterface: StubInstance<Interface>;
+}
+
+describe('Test class ClusterController and ClusterAgent', () => {
+
+    let injector: DependencyContainer;
+    let controller: ClusterController;
+    let agents: TestAgent[];
+
+    const createAgent = (name: string, key: string = 'secret'): TestAgent => {
+        const agentInjector = container.createChildContainer();
+        agentInjector.register(Manager, stubClass(Manager), { lifecycle: Lifecycle.Singleton });
+        agentInjector.register(Monitor, stubClass(Monitor), { lifecycle: Lifecycle.Singleton });
+        agentInjector.register(EventBus, EventBus, { lifecycle: Lifecycle.Singleton });
+        agentInjector.register(Interface, stubClass(Interface), { lifecycle: Lifecycle.Singleton });
+        agentInjector.register(ClusterAgent, ClusterAgent, { lifecycle: Lifecycle.Singleton });
+
+        const manager = agentInjector.resolve(Manager) as StubInstance<Manager>;
+        (manager as any).APP_VERSION = '1.0.0';
+        manager.config = {
+            clusterMode: 'agent',
+            clusterController: `ws://127.0.0.1:${PORT}`,
+            clusterKey: key,
+            clusterAgentName: name,
+            instanceId: name,
+        } as any;
+        const monitor = agentInjector.resolve(Monitor) as StubInstance<Monitor>;
+        (monitor as any).serverState = ServerState.STARTED;
+        monitor.restartLock = false;
+
+        const agent = agentInjector.resolve(ClusterAgent);
+        agent.flushDelay = 10;
+        agent.reconnectDelay = 10;
+
+        const testAgent = {
+            agent,
+            eventBus: agentInjector.resolve(EventBus),
+            monitor,
+            eventInterface: agentInjector.resolve(Interface) as StubInstance<Interface>,
+        };
+        agents.push(testAgent);
+        return testAgent;
+    };
+
+    before(() => {
+        disableConsole();
+    });
+
+    after(() => {
+        enableConsole();
+    });
+
+    beforeEach(async () => {
+        container.reset();
+        injector = container.createChildContainer();
+        injector.register(Manager, stubClass(Manager), { lifecycle: Lifecycle.Singleton });
+
+        const manager = injector.resolve(Manager) as StubInstance<Manager>;
+        manager.config = {
+            clusterMode: 'controller',
+            clusterPort: PORT,
+            clusterKey: 'secret',
+            clusterStagger: 0,
+        } as any;
+
+        agents = [];
+        injector.register(ClusterController, ClusterController, { lifecycle: Lifecycle.Singleton });
+        controller = injector.resolve(ClusterController);
+        await controller.start();
+    });
+
+    afterEach(async () => {
+        ImportMock.restore();
+        for (const agent of agents) {
+            await agent.agent.stop();
+        }
+        await controller.stop();
+    });
+
+    it('ClusterController-disabled', async () => {
+        await controller.stop();
+        const manager = injector.resolve(Manager) as StubInstance<Manager>;
+
+        manager.config = { clusterMode: 'controller' } as any;
+        await controller.start();
+        expect(controller.isActive()).to.be.false;
+
+        manager.config = { clusterMode: 'off', clusterKey: 'secret' } as any;
+        await controller.start();
+        expect(controller.isActive()).to.be.false;
+    });
+
+    it('ClusterAgent-disabled', async () => {
+        const { agent, eventInterface } = createAgent('host1');
+        (agent as any).manager.config.clusterKey = '';
+        await agent.start();
+
+        (agent as any).manager.config.clusterMode = 'off';
+        await agent.start();
+
+        await sleep(20);
+        expect(agent.isConnected()).to.be.false;
+        expect(controller.getAgents()).to.be.empty;
+        expect(eventInterface.execute.called).to.be.false;
+    });
+
+    it('ClusterController-insecure', async () => {
+        await controller.stop();
+        const manager = injector.resolve(Manager) as StubInstance<Manager>;
+
+        // other hosts would connect unencrypted
+        manager.config.publishClusterPort = true;
+        await controller.start();
+        expect(controller.isActive()).to.be.false;
+    });
+
+    it('ClusterAgent-insecure', async () => {
+        const { agent } = createAgent('host1');
+        const createSocket = sinon.spy(agent, 'createSocket');
+        (agent as any).manager.config.clusterController = 'ws://10.0.0.1:2320';
+        await agent.start();
+        expect(createSocket.called).to.be.false;
+
+        expect(agent['isSecureAddress']('wss://10.0.0.1:2320')).to.be.true;
+        expect(agent['isSecureAddress']('ws://localhost:2320')).to.be.true;
+        expect(agent['isSecureAddress']('ws://[::1]:2320')).to.be.true;
+        expect(agent['isSecureAddress']('invalid')).to.be.false;
+    });
+
+    it('Cluster-register', async () => {
+        const host2 = createAgent('host2');
+        const host1 = createAgent('host1');
+        host1.monitor.restartLock = true;
+
+        await host2.agent.start();
+        await host1.agent.start();
+        await waitFor(() => controller.getAgents().length === 2);
+        await waitFor(() => controller.getAgents()[0].state.serverState !== undefined);
+
+        const [agent1, agent2] = controller.getAgents();
+        expect(agent1.name).to.equal('host1');
+        expect(agent2.name).to.equal('host2');
+        expect(agent1.version).to.equal('1.0.0');
+        expect(agent1.address).to.include('127.0.0.1');
+        expect(agent1.state).to.include({ serverState: ServerState.STARTED, restartLock: true });
+
+        // a disconnected agent is removed
+        await host2.agent.stop();
+        await waitFor(() => controller.getAgents().length === 1);
+    });
+
+    it('Cluster-reconnect', async () => {
+        const wrongKey = createAgent('host1', 'wrong');
+        await wrongKey.agent.start();
+        await sleep(50);
+        expect(wrongKey.agent.isConnected()).to.be.false;
+        expect(controller.getAgents()).to.be.empty;
+
+        // the agent retries until the controller accepts it
+        (wrongKey.agent as any).manager.config.clusterKey = 'secret';
+        await waitFor(() => controller.getAgents().length === 1);
+
+        // an agent with the same name replaces the old connection, which does not reconnect
+        const duplicate = createAgent('host1');
+        await duplicate.agent.start();
+        await waitFor(() => duplicate.agent.isConnected() && !wrongKey.agent.isConnected());
+        await sleep(50);
+        expect(wrongKey.agent.isConnected()).to.be.false;
+        expect(duplicate.agent.isConnected()).to.be.true;
+        expect(controller.getAgents().length).to.equal(1);
+    });
+
+    it('Cluster-state and events', async () => {
+        const { agent, eventBus } = createAgent('host1');
+        await agent.start();
+        await waitFor(() => agent.isConnected() && controller.getAgents().length === 1);
+
+        eventBus.emit(InternalEventTypes.MONITOR_STATE_CHANGE, ServerState.STOPPED, ServerState.STARTED);
+        eventBus.emit(InternalEventTypes.METRIC_ENTRY, {
+            type: 'SYSTEM',
+            entry: {
+                timestamp: 1,
+                value: {
+                    serverState: ServerState.STOPPED,
+                    system: { cpuTotal: 10, mem: 1000, memTotal: 2000 },
+                },
+            },
+        } as any);
+        eventBus.emit(InternalEventTypes.METRIC_ENTRY, {
+            type: 'PLAYERS',
+            entry: { timestamp: 2, value: [{ name: 'player1' }, { name: 'player2' }] },
+        } as any);
+        eventBus.emit(InternalEventTypes.METRIC_ENTRY, {
+            type: 'INGAME_VEHICLES',
+            entry: { timestamp: 3, value: [] },
+        } as any);
+        eventBus.emit(InternalEventTypes.LOG_ENTRY, {
+            type: 'ADM',
+            entry: { timestamp: 4, message: 'test' },
+        } as any);
+
+        await waitFor(() => controller.getAgentLogs('host1')?.length === 1);
+        await waitFor(() => controller.getAgentMetrics('host1', 'PLAYERS')?.length === 1);
+
+        const [info] = controller.getAgents();
+        expect(info.state).to.include({
+            serverState: ServerState.STOPPED,
+            cpu: 10,
+            mem: 1000,
+            memTotal: 2000,
+            players: 2,
+        });
+        expect(controller.getAgentLogs('host1', 'ADM')[0].entry.message).to.equal('test');
+        expect(controller.getAgentLogs('host1', 'RPT')).to.be.empty;
+        expect(controller.getAgentLogs('host1', undefined, 4)).to.be.empty;
+        expect(controller.getAgentMetrics('host1', 'SYSTEM').length).to.equal(1);
+        // only the compact metrics are streamed
+        expect(controller.getAgentMetrics('host1', 'INGAME_VEHICLES')).to.be.empty;
+        expect(controller.getAgentLogs('unknown')).to.be.undefined;
+    });
+
+    it('Cluster-request', async () => {
+        const { agent, eventInterface } = createAgent('host1');
+        eventInterface.execute.resolves(new Response(200, 'done'));
+        await agent.start();
+        await waitFor(() => controller.getAgents().length === 1);
+
+        (injector.resolve(Manager).getUserLevel as sinon.SinonStub).returns('admin');
+        const request = new Request();
+        request.resource = 'lockrestart';
+        request.user = 'admin';
+        request.body = { test: 1 };
+
+        const response = await controller.request('host1', request);
+        expect(response.status).to.equal(200);
+        expect(response.body).to.equal('done');
+
+        const executed = eventInterface.execute.firstCall.args[0];
+        expect(executed.resource).to.equal('lockrestart');
+        expect(executed.user).to.equal('admin');
+        expect(executed.body).to.deep.equal({ test: 1 });
+        expect(executed.forwarded).to.be.true;
+        // the agent checks the level asserted by the controller
+        expect(executed.userLevel).to.equal('admin');
+
+        expect((await controller.request('unknown', request)).status).to.equal(404);
+
+        // agents which do not respond
+        eventInterface.execute.returns(new Promise(() => {}));
+        controller.requestTimeout = 20;
+        expect((await controller.request('host1', request)).status).to.equal(504);
+
+        controller.requestTimeout = 10000;
+        const pending = controller.request('host1', request);
+        await sleep(20);
+        await agent.stop();
+        expect((await pending).status).to.equal(503);
+    });
+
+    it('Cluster-rollout', async () => {
+        const host1 = createAgent('host1');
+        const host2 = createAgent('host2');
+        const host3 = createAgent('host3');
+        const order: string[] = [];
+        for (const host of [host1, host2, host3]) {
+            host.eventInterface.execute.callsFake(async () => {
+                if (host === host1) {
+                    // disconnects while the rollout is running
+                    void host3.agent.stop();
+                }
+                order.push(`${host.agent.getName()}-start`);
+                await sleep(10);
+                order.push(`${host.agent.getName()}-end`);
+                return new Response(host === host2 ? 500 : 200, 'Done');
+            });
+            await host.agent.start();
+        }
+        await waitFor(() => controller.getAgents().length === 3);
+
+        const rollout = controller.rollout('restart', 'admin', undefined, 20);
+        expect(rollout.steps.map((x) => x.agent)).to.deep.equal(['host1', 'host2', 'host3']);
+        expect(controller.getRollouts()).to.deep.equal([rollout]);
+
+        await waitFor(() => !!rollout.done);
+
+        // one agent after another
+        expect(order).to.deep.equal(['host1-start', 'host1-end', 'host2-start', 'host2-end']);
+        expect(rollout.steps[0]).to.include({ status: 'done', responseStatus: 200 });
+        expect(rollout.steps[1]).to.include({ status: 'failed', responseStatus: 500 });
+        expect(rollout.steps[2].status).to.equal('skipped');
+        expect(rollout.steps[1].start - rollout.steps[0].end).to.be.greaterThanOrEqual(15);
+        expect(host1.eventInterface.execute.firstCall.args[0].user).to.equal('admin');
+    });
+
+    it('Cluster-rollout-stopped', async () => {
+        const host1 = createAgent('host1');
+        const host2 = createAgent('host2');
+        host1.eventInterface.execute.resolves(new Response(200, 'Done'));
+        host2.eventInterface.execute.resolves(new Response(200, 'Done'));
+        await host1.agent.start();
+        await host2.agent.start();
+        await waitFor(() => controller.getAgents().length === 2);
+
+        const rollout = controller.rollout('restart', 'admin', undefined, 60000);
+        await waitFor(() => rollout.steps[0].status === 'done');
+
+        await controller.stop();
+        await waitFor(() => !!rollout.done);
+        expect(rollout.steps[1].status).to.equal('skipped');
+        expect(host2.eventInterface.execute.called).to.be.false;
+    });
+
+    it('Cluster-rollout-event', async () => {
+        const host1 = createAgent('host1');
+        // the agent checks the forwarded level like the interface does
+        host1.eventInterface.execute.callsFake(async (req: Request) => (
+            Manager.prototype.isLevelAllowed(req.userLevel, 'manage')
+                ? new Response(200, 'Done')
+                : new Response(401, 'Unauthorized')
+        ));
+        await host1.agent.start();
+        await waitFor(() => controller.getAgents().length === 1);
+
+        injector.register(Monitor, stubClass(Monitor), { lifecycle: Lifecycle.Singleton });
+        injector.register(RCON, stubClass(RCON), { lifecycle: Lifecycle.Singleton });
+        injector.register(Backups, stubClass(Backups), { lifecycle: Lifecycle.Singleton });
+        const manager = injector.resolve(Manager) as StubInstance<Manager>;
+        // the events user is unknown to the manager
+        manager.getUserLevel.returns(null);
+        manager.config.events = [{ name: 'rollout', type: 'rollout', cron: '* * * * *', params: ['restart'] } as any];
+
+        const actions: (() => void)[] = [];
+        ImportMock.mockFunction(cron, 'scheduleJob').callsFake((_name, _cron, action) => {
+            actions.push(action);
+            return { cancel: sinon.stub(), nextInvocation: () => new Date() };
+        });
+        const events = injector.resolve(Events);
+        await events.start();
+        actions[0]();
+
+        await waitFor(() => !!controller.getRollouts()[0]?.done);
+        const rollout = controller.getRollouts()[0];
+        expect(rollout.steps[0]).to.include({ status: 'done', responseStatus: 200 });
+        const executed = host1.eventInterface.execute.firstCall.args[0];
+        expect(executed.user).to.equal('events');
+        expect(executed.userLevel).to.equal('admin');
+        await events.stop();
+    });
+
+});
@@ -1,14 +1,18 @@
 import { expect } from '../expect';
 import { StubInstance, disableConsole, enableConsole, stubClass } from '../util';
 import * as sinon from 'sinon';
+import * as path from 'path';
 import { Database, DatabaseTypes, Sqlite3Wrapper } from '../../src/services/database';
 import { DependencyContainer, Lifecycle, container } from 'tsyringe';
 import { Manager } from '../../src/control/manager';
+import { Paths } from '../../src/services/paths';
+import { TaskTracker } from '../../src/services/task-tracker';
 
 describe('Test class Database', () => {
 
     let origCreate;
     let createCalled = 0;
+    let createdFile: string;
 
     let injector: DependencyContainer;
     let manager: StubInstance<Manager>
@@ -16,8 +20,9 @@ describe('Test class Database', () => {
     before(() => {
         disableConsole();
         origCreate = Sqlite3Wrapper['createDb'];
-        Sqlite3Wrapper['createDb'] = () => {
+        Sqlite3Wrapper['createDb'] = (file: string) => {
             createCalled++;
+            createdFile = file;
             return {
                 prepare: (sql) => ({
                     all: sinon.stub(),
@@ -40,8 +45,11 @@ describe('Test class Database', () => {
         container.reset();
         injector = container.createChildContainer();
         injector.register(Manager, stubClass(Manager), { lifecycle: Lifecycle.Singleton });
+        injector.register(Paths, stubClass(Paths), { lifecycle: Lifecycle.Singleton });
+        injector.register(TaskTracker, TaskTracker, { lifecycle: Lifecycle.Singleton });
 
         manager = injector.resolve(Manager) as any;
+        (injector.resolve(Paths).cwd as sinon.SinonStub).returns('/test');
     });
 
     it('Database', async () => {
@@ -54,6 +62,12 @@ describe('Test class Database', () => {
         const metricsdb = db.getDatabase(DatabaseTypes.METRICS);
         expect(createCalled).to.be.greaterThan(0);
         expect(metricsdb).to.be.not.undefined;
+        expect(createdFile).to.equal(path.join('/test', 'metrics.db'));
+
+        // queries block the event loop, so they are tracked
+        metricsdb.all('SELECT * FROM metrics\n WHERE timestamp > ?', 0);
+        const tasks = injector.resolve(TaskTracker).getTasksBetween(0, Date.now());
+        expect(tasks.map((x) => x.name)).to.deep.equal(['sqlite metrics.db SELECT * FROM']);
 
         await db.stop();
         expect(db['databases']).to.be.empty;
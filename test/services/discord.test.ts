@@ -49,6 +49,7 @@ describe('Test class Discord', () => {
         await discord.start();
 
         expect(discord.client).to.be.undefined;
+        expect(discord.getQueueStats()).to.be.undefined;
     });
 
     it('Discord', async () => {
@@ -154,6 +155,7 @@ describe('Test class Discord', () => {
 
         manager.config = {
             discordBotToken: '1234',
+            discordMessageCoalescing: 10,
             discordChannels: [{
                 mode: 'rcon',
                 channel: 'channel1',
@@ -170,10 +172,15 @@ describe('Test class Discord', () => {
         await discord.sendMessage({ type: 'rcon', message: 'test' });
         
         discord.client = discordClientMock.getMockInstance();
-        await discord.sendMessage({ type: 'rcon', message: 'test' });
+        await Promise.all([
+            discord.sendMessage({ type: 'rcon', message: 'test' }),
+            discord.sendMessage({ type: 'rcon', message: 'test2' }),
+        ]);
 
         expect(channel1.send.callCount).to.equal(1);
+        expect(channel1.send.firstCall.args[0]).to.deep.equal({ content: 'test\ntest2' });
         expect(channel2.send.callCount).to.equal(0);
+        expect(discord.getQueueStats()).to.include({ depth: 1, sent: 2, requests: 1 });
 
 
     });
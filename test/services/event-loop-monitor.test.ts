@@ -0,0 +1,131 @@
+import { expect } from '../expect';
+import * as sinon from 'sinon';
+import { StubInstance, disableConsole, enableConsole, sleep, stubClass } from '../util';
+import { DependencyContainer, Lifecycle, container } from 'tsyringe';
+import { Manager } from '../../src/control/manager';
+import { EventLoopMonitor } from '../../src/services/event-loop-monitor';
+import { Prometheus } from '../../src/services/prometheus';
+import { TaskTracker } from '../../src/services/task-tracker';
+import { LoggerFactory } from '../../src/services/loggerfactory';
+
+describe('Test class EventLoopMonitor', () => {
+
+    let injector: DependencyContainer;
+
+    let manager: StubInstance<Manager>;
+    let tracker: TaskTracker;
+    let prometheus: Prometheus;
+    let now: number;
+
+    before(() => {
+        disableConsole();
+    });
+
+    after(() => {
+        enableConsole();
+    });
+
+    beforeEach(() => {
+        container.reset();
+        injector = container.createChildContainer();
+
+        injector.register(Manager, stubClass(Manager), { lifecycle: Lifecycle.Singleton });
+        injector.register(TaskTracker, TaskTracker, { lifecycle: Lifecycle.Singleton });
+        injector.register(Prometheus, Prometheus, { lifecycle: Lifecycle.Singleton });
+        manager = injector.resolve(Manager) as any;
+        manager.config = {} as any;
+
+        tracker = injector.resolve(TaskTracker);
+        prometheus = injector.resolve(Prometheus);
+        now = 10000;
+        sinon.stub(tracker, 'now').callsFake(() => now);
+    });
+
+    it('EventLoopMonitor-spikes', async () => {
+        const monitor = injector.resolve(EventLoopMonitor);
+        await monitor.start();
+
+        // not blocked
+        now += EventLoopMonitor.INTERVAL;
+        (monitor as any).tick();
+        expect(monitor.getSpikes().length).to.equal(0);
+
+        const task = tracker.begin('copyDir /mods', true);
+        now += 100;
+        await tracker.track('readJson /tick.json', () => {
+            now += 700;
+        });
+        now += EventLoopMonitor.INTERVAL;
+        (monitor as any).tick();
+
+        const spikes = monitor.getSpikes();
+        expect(spikes.length).to.equal(1);
+        expect(spikes[0].lag).to.equal(800);
+        expect(spikes[0].tasks.map((x) => x.name)).to.deep.equal(['copyDir /mods', 'readJson /tick.json']);
+        tracker.end(task);
+
+        // disabled warnings
+        manager.config.eventLoopLagWarning = 0;
+        now += 2000;
+        (monitor as any).tick();
+        expect(monitor.getSpikes().length).to.equal(1);
+
+        await monitor.stop();
+    });
+
+    it('EventLoopMonitor-lag', async () => {
+        const monitor = injector.resolve(EventLoopMonitor);
+        expect(prometheus.render()).to.not.include('dzsm_event_loop_lag_seconds');
+
+        await monitor.start();
+        await sleep(50);
+        // block the event loop
+        const start = Date.now();
+        while (Date.now() - start < 100) {
+            // busy
+        }
+        await sleep(50);
+
+        const rendered = prometheus.render();
+        expect(rendered).to.include('# TYPE dzsm_event_loop_lag_seconds gauge');
+        expect(prometheus.eventLoopLag.get({ stat: 'max' })).to.be.greaterThan(0.05);
+
+        await monitor.stop();
+        expect(prometheus.render()).to.not.include('dzsm_event_loop_lag_seconds');
+    });
+
+    it('EventLoopMonitor-interval', async () => {
+        const monitor = injector.resolve(EventLoopMonitor);
+        const tickSpy = sinon.spy(monitor as any, 'tick');
+        await monitor.start();
+        await sleep(EventLoopMonitor.INTERVAL * 2.5);
+        await monitor.stop();
+        expect(tickSpy.callCount).to.be.greaterThan(0);
+    });
+
+    it('EventLoopMonitor-instances', async () => {
+        const createMonitor = (): EventLoopMonitor => new EventLoopMonitor(
+            injector.resolve(LoggerFactory),
+            manager as any,
+            prometheus,
+            tracker,
+        );
+        const monitor1 = createMonitor();
+        const monitor2 = createMonitor();
+
+        // the event loop is shared, so only one instance checks it for spikes
+        await monitor1.start();
+        await monitor2.start();
+        expect(monitor1['timers'].getTimer('lag')).to.not.be.undefined;
+        expect(monitor2['timers'].getTimer('lag')).to.be.undefined;
+
+        // another instance takes over once the first one stopped
+        await monitor1.stop();
+        await monitor2.stop();
+        await monitor2.start();
+        expect(monitor2['timers'].getTimer('lag')).to.not.be.undefined;
+
+        await monitor2.stop();
+    });
+
+});
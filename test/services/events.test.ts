@@ -12,6 +12,7 @@ import { Manager } from '../../src/control/manager';
 import { RCON } from '../../src/services/rcon';
 import { Backups } from '../../src/services/backups';
 import { EventBus } from '../../src/control/event-bus';
+import { ClusterController } from '../../src/services/cluster-controller';
 
 describe('Test class Events', () => {
 
@@ -21,6 +22,7 @@ describe('Test class Events', () => {
     let monitor: StubInstance<Monitor>;
     let rcon: StubInstance<RCON>;
     let backup: StubInstance<Backups>;
+    let clusterController: StubInstance<ClusterController>;
 
     before(() => {
         disableConsole();
@@ -41,11 +43,13 @@ describe('Test class Events', () => {
         injector.register(Monitor, stubClass(Monitor), { lifecycle: Lifecycle.Singleton });
         injector.register(RCON, stubClass(RCON), { lifecycle: Lifecycle.Singleton });
         injector.register(Backups, stubClass(Backups), { lifecycle: Lifecycle.Singleton });
+        injector.register(ClusterController, stubClass(ClusterController), { lifecycle: Lifecycle.Singleton });
 
         manager = injector.resolve(Manager) as any;
         monitor = injector.resolve(Monitor) as any;
         rcon = injector.resolve(RCON) as any;
         backup = injector.resolve(Backups) as any;
+        clusterController = injector.resolve(ClusterController) as any;
     });
 
     it('Events', async () => {
@@ -79,6 +83,7 @@ describe('Test class Events', () => {
             }))
         } as any;
         (monitor as any).serverState = ServerState.STOPPED;
+        clusterController.isActive.returns(true);
 
         const events = injector.resolve(Events);
 
@@ -106,6 +111,8 @@ describe('Test class Events', () => {
         expect(rcon.unlock.callCount).to.equal(1);
 
         expect(backup.createBackup.callCount).to.equal(2);
+        expect(clusterController.rollout.callCount).to.equal(2);
+        expect(clusterController.rollout.firstCall.args).to.deep.equal(['test', 'events', undefined, undefined, 'admin']);
 
     });
 
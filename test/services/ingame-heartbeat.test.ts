@@ -0,0 +1,120 @@
+import { expect } from '../expect';
+import { StubInstance, disableConsole, enableConsole, memfs, stubClass } from '../util';
+import { DependencyContainer, Lifecycle, container } from 'tsyringe';
+import * as sinon from 'sinon';
+import { Manager } from '../../src/control/manager';
+import { Monitor } from '../../src/services/monitor';
+import { EventBus } from '../../src/control/event-bus';
+import { IngameHeartbeat } from '../../src/services/ingame-heartbeat';
+import { ServerState } from '../../src/types/monitor';
+import { InternalEventTypes } from '../../src/types/events';
+import { FSAPI } from '../../src/util/apis';
+
+describe('Test class IngameHeartbeat', () => {
+
+    let injector: DependencyContainer;
+
+    let manager: StubInstance<Manager>;
+    let monitor: StubInstance<Monitor>;
+    let eventBus: EventBus;
+    let fs: FSAPI;
+
+    const writeHeartbeat = (counter: number): void => {
+        fs.writeFileSync('/profiles/DZSM-HEARTBEAT.txt', `${counter}`);
+    };
+
+    before(() => {
+        disableConsole();
+    });
+
+    after(() => {
+        enableConsole();
+    });
+
+    beforeEach(() => {
+        container.reset();
+        injector = container.createChildContainer();
+
+        injector.register(Manager, stubClass(Manager), { lifecycle: Lifecycle.Singleton });
+        injector.register(Monitor, stubClass(Monitor), { lifecycle: Lifecycle.Singleton });
+        injector.register(EventBus, EventBus, { lifecycle: Lifecycle.Singleton });
+        fs = memfs({ profiles: {} }, '/', injector);
+
+        manager = injector.resolve(Manager) as any;
+        monitor = injector.resolve(Monitor) as any;
+        eventBus = injector.resolve(EventBus);
+
+        manager.config = {
+            ingameHeartbeatIntervall: 1.0,
+            ingameHeartbeatDeadline: 30,
+            ingameHeartbeatRestart: true,
+        } as any;
+        manager.getProfilesPath.returns('/profiles');
+        (monitor as any).serverState = ServerState.STARTED;
+        monitor.killServer.resolves(true);
+    });
+
+    it('IngameHeartbeat-disabled', async () => {
+        manager.config.ingameHeartbeatDeadline = 0;
+        const heartbeat = injector.resolve(IngameHeartbeat);
+        await heartbeat.start();
+        expect(heartbeat['timers'].getTimer('check')).to.be.undefined;
+
+        manager.config.ingameHeartbeatDeadline = 30;
+        await heartbeat.start();
+        expect(heartbeat['timers'].getTimer('check')).to.be.not.undefined;
+        await heartbeat.stop();
+    });
+
+    it('IngameHeartbeat-missed', async () => {
+        const discordMessage = sinon.stub().resolves();
+        eventBus.on(InternalEventTypes.DISCORD_MESSAGE, discordMessage);
+        const heartbeat = injector.resolve(IngameHeartbeat);
+
+        // leftover from the previous server is only the baseline
+        writeHeartbeat(500);
+        expect(await heartbeat.check()).to.be.false;
+        expect(heartbeat.lastHeartbeat).to.be.undefined;
+
+        // not armed yet, so no deadline
+        heartbeat['lastBeat'] -= 60000;
+        expect(await heartbeat.check()).to.be.false;
+
+        writeHeartbeat(1);
+        expect(await heartbeat.check()).to.be.false;
+        expect(heartbeat.lastHeartbeat).to.be.not.undefined;
+
+        // within deadline
+        expect(await heartbeat.check()).to.be.false;
+
+        heartbeat['lastBeat'] -= 31000;
+        expect(await heartbeat.check()).to.be.true;
+        expect(monitor.killServer).to.be.calledOnceWith(true);
+        expect(discordMessage).to.be.calledOnce;
+
+        // only reported once
+        expect(await heartbeat.check()).to.be.false;
+        expect(monitor.killServer).to.be.calledOnce;
+
+        writeHeartbeat(2);
+        expect(await heartbeat.check()).to.be.false;
+
+        (monitor as any).serverState = ServerState.STOPPED;
+        expect(await heartbeat.check()).to.be.false;
+        expect(heartbeat.lastHeartbeat).to.be.undefined;
+    });
+
+    it('IngameHeartbeat-missed-locked', async () => {
+        (monitor as any).restartLock = true;
+        const heartbeat = injector.resolve(IngameHeartbeat);
+
+        expect(await heartbeat.check()).to.be.false;
+        writeHeartbeat(1);
+        expect(await heartbeat.check()).to.be.false;
+
+        heartbeat['lastBeat'] -= 31000;
+        expect(await heartbeat.check()).to.be.true;
+        expect(monitor.killServer).to.be.not.called;
+    });
+
+});
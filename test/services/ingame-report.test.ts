@@ -11,6 +11,8 @@ import { Paths } from '../../src/services/paths';
 import { FSAPI } from '../../src/util/apis';
 import { IngameReportContainer } from '../../src/types/ingame-report';
 import { Config } from '../../src/config/config';
+import { MetricTypeEnum } from '../../src/types/metrics';
+import { RestartTracer } from '../../src/services/restart-tracer';
 
 describe('Test class IngameReport', () => {
 
@@ -39,6 +41,7 @@ describe('Test class IngameReport', () => {
         injector.register(Manager, stubClass(Manager), { lifecycle: Lifecycle.Singleton });
         injector.register(Metrics, stubClass(Metrics), { lifecycle: Lifecycle.Singleton });
         injector.register(Paths, stubClass(Paths), { lifecycle: Lifecycle.Singleton });
+        injector.register(RestartTracer, stubClass(RestartTracer), { lifecycle: Lifecycle.Singleton });
         fs = memfs({}, '/', injector);
 
         manager = injector.resolve(Manager) as any;
@@ -59,6 +62,55 @@ describe('Test class IngameReport', () => {
 
     });
 
+    it('IngameReport-processReport-frameTimes', async () => {
+
+        const ingameReport = injector.resolve(IngameReport);
+
+        await ingameReport.processIngameReport({
+            players: [{} as any, {} as any],
+            vehicles: [],
+            frameTimes: {
+                frames: 100,
+                avg: 12.5,
+                p50: 10,
+                p95: 20,
+                p99: 33,
+                max: 40.2,
+                bucketBounds: [10, 20, 33],
+                buckets: [50, 45, 4, 1],
+            },
+        });
+
+        expect(metrics.pushMetricValue.callCount).to.equal(3);
+        expect(metrics.pushMetricValue.getCall(2).args[0]).to.equal(MetricTypeEnum.INGAME_FRAMETIMES);
+        expect(metrics.pushMetricValue.getCall(2).args[1].value.p99).to.equal(33);
+        expect(metrics.pushMetricValue.getCall(2).args[1].value.players).to.equal(2);
+        expect(metrics.pushMetricValue.getCall(2).args[1].value.vehicles).to.equal(0);
+
+    });
+
+    it('IngameReport-processReport-profilerZones', async () => {
+
+        const ingameReport = injector.resolve(IngameReport);
+        ingameReport.maxProfilerZones = 2;
+
+        await ingameReport.processIngameReport({
+            players: [],
+            vehicles: [],
+            profilerZones: [
+                { name: 'DZSM.Tick', count: 1, total: 2.5, max: 2.5 },
+                { name: 'SomeMod.Update', count: 900, total: 120.3, max: 4.1 },
+                { name: 'OtherMod.Update', count: 900, total: 12, max: 0.2 },
+            ],
+        });
+
+        expect(metrics.pushMetricValue.callCount).to.equal(3);
+        expect(metrics.pushMetricValue.getCall(2).args[0]).to.equal(MetricTypeEnum.INGAME_PROFILER);
+        expect(metrics.pushMetricValue.getCall(2).args[1].value.map((x) => x.name))
+            .to.deep.equal(['SomeMod.Update', 'OtherMod.Update']);
+
+    });
+
     it('IngameReport-scan', async () => {
 
         fs = memfs(
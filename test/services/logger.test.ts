@@ -49,4 +49,17 @@ describe('Test class Logger', () => {
         expect(msg).to.match(/@\d{4}-\d{2}-\d{2}T\d{2}:\d{2}:\d{2}.\d{3}Z.*/g);
     });
 
+    it('Logger-instance', () => {
+
+        const stub = sinon.stub();
+
+        Logger.LogLevelFncs[LogLevel.ERROR] = stub;
+
+        const loggerFactory = new LoggerFactory();
+        loggerFactory.instance = 's1';
+        loggerFactory.createLogger('TestContext').log(LogLevel.ERROR, 'Test');
+
+        expect(stub.firstCall.args[0]).to.include('| s1 | TestContext');
+    });
+
 });
@@ -0,0 +1,193 @@
+import { expect } from '../expect';
+import * as sinon from 'sinon';
+import { EventEmitter } from 'events';
+import { StubInstance, disableConsole, enableConsole, memfs, sleep, stubClass } from '../util';
+import { DependencyContainer, Lifecycle, container } from 'tsyringe';
+import { Manager } from '../../src/control/manager';
+import { Paths } from '../../src/services/paths';
+import { ManagerProfiler } from '../../src/services/manager-profiler';
+import { FSAPI } from '../../src/util/apis';
+import { TimerHandler } from '../../src/types/service';
+
+describe('Test class ManagerProfiler', () => {
+
+    let injector: DependencyContainer;
+
+    let manager: StubInstance<Manager>;
+    let paths: StubInstance<Paths>;
+    let fs: FSAPI;
+    let profiler: ManagerProfiler;
+
+    const readProfile = async (file: string): Promise<string> => {
+        const { stream } = await profiler.openProfile(file);
+        const chunks: Buffer[] = [];
+        await new Promise((r, e) => stream
+            .on('data', (chunk) => chunks.push(Buffer.from(chunk)))
+            .on('end', r)
+            .on('error', e));
+        return Buffer.concat(chunks).toString('utf-8');
+    };
+
+    before(() => {
+        disableConsole();
+    });
+
+    after(() => {
+        enableConsole();
+    });
+
+    beforeEach(() => {
+        container.reset();
+        injector = container.createChildContainer();
+
+        injector.register(Manager, stubClass(Manager), { lifecycle: Lifecycle.Singleton });
+        injector.register(Paths, stubClass(Paths), { lifecycle: Lifecycle.Singleton });
+        fs = memfs({}, '/', injector);
+
+        manager = injector.resolve(Manager) as any;
+        manager.config = {} as any;
+        paths = injector.resolve(Paths) as any;
+        paths.cwd.returns('/manager');
+
+        profiler = injector.resolve(ManagerProfiler);
+    });
+
+    afterEach(async () => {
+        await profiler.stop();
+    });
+
+    it('ManagerProfiler-cpu', async () => {
+        const capture = profiler.captureCpuProfile(0.05);
+        expect(await profiler.captureCpuProfile(1).catch((e) => e)).to.include({ status: 409 });
+
+        const file = await capture;
+        expect(file.type).to.equal('cpu');
+        expect(file.file).to.match(/^cpu-.*\.cpuprofile$/);
+
+        const profile = JSON.parse(await readProfile(file.file));
+        expect(profile.nodes).to.be.an('array').that.is.not.empty;
+
+        // can be captured again
+        expect((await profiler.captureCpuProfile(0)).type).to.equal('cpu');
+    });
+
+    it('ManagerProfiler-heap', async () => {
+        const file = await profiler.captureHeapProfile(0.05);
+        expect(file.file).to.match(/^heap-.*\.heapprofile$/);
+        expect(JSON.parse(await readProfile(file.file)).head).to.be.an('object');
+    });
+
+    it('ManagerProfiler-heapsnapshot', async () => {
+        // a real snapshot of the test process would take too long
+        const session = new EventEmitter() as any;
+        session.connect = sinon.stub();
+        session.disconnect = sinon.stub();
+        session.post = sinon.stub().callsFake((method, params, cb) => {
+            session.emit('HeapProfiler.addHeapSnapshotChunk', { params: { chunk: '{"snapshot":' } });
+            session.emit('HeapProfiler.addHeapSnapshotChunk', { params: { chunk: '{}}' } });
+            cb(null, {});
+        });
+        sinon.stub(profiler, 'createSession').returns(session);
+
+        const file = await profiler.takeHeapSnapshot();
+        expect(file.type).to.equal('heapsnapshot');
+        expect(session.post.firstCall.args[0]).to.equal('HeapProfiler.takeHeapSnapshot');
+        expect(session.disconnect.called).to.be.true;
+        expect(await readProfile(file.file)).to.equal('{"snapshot":{}}');
+
+        // failed captures release the session as well
+        session.post = sinon.stub().callsFake((method, params, cb) => cb(new Error('test')));
+        await expect(profiler.takeHeapSnapshot()).to.be.rejectedWith('test');
+        expect(session.disconnect.callCount).to.equal(2);
+    });
+
+    it('ManagerProfiler-handles', async () => {
+        const timers = new TimerHandler('TestService');
+        timers.addInterval('poll', () => {}, 10000);
+        timers.addTimeout('fired', () => {}, 0);
+        await sleep(5);
+
+        const dump = await profiler.dumpActiveHandles();
+        timers.removeAllTimers();
+
+        expect(dump.handles).to.be.an('array');
+        expect(dump.memory.heapUsed).to.be.greaterThan(0);
+        expect(dump.timers).to.deep.include({ owner: 'TestService', name: 'poll', type: 'interval', delay: 10000 });
+        expect(dump.timers.find((x) => x.name === 'fired')).to.be.undefined;
+        expect(TimerHandler.getActiveTimers().find((x) => x.owner === 'TestService')).to.be.undefined;
+
+        const profiles = await profiler.getProfiles();
+        expect(profiles.map((x) => x.type)).to.deep.equal(['handles']);
+    });
+
+    it('ManagerProfiler-files', async () => {
+        expect(await profiler.getProfiles()).to.deep.equal([]);
+
+        fs.mkdirSync('/manager/profiles', { recursive: true });
+        fs.writeFileSync('/manager/profiles/cpu-1.cpuprofile', '{}');
+        fs.writeFileSync('/manager/profiles/other.txt', 'test');
+        fs.writeFileSync('/manager/secret.json', 'test');
+
+        expect((await profiler.getProfiles()).map((x) => x.file)).to.deep.equal(['cpu-1.cpuprofile']);
+        expect(await readProfile('cpu-1.cpuprofile')).to.equal('{}');
+        const opened = await profiler.openProfile('cpu-1.cpuprofile');
+        opened.stream.destroy();
+        expect(opened.profile).to.include({ type: 'cpu', size: 2 });
+        fs.writeFileSync('/manager/profiles/cpu-1.txt', 'test');
+        for (const file of ['other.txt', '../secret.json', 'cpu-2.cpuprofile', 'cpu-1.txt', '', undefined!]) {
+            expect(await profiler.openProfile(file).catch((e) => e)).to.include({ status: 404 });
+        }
+    });
+
+    it('ManagerProfiler-continuous', async () => {
+        fs.mkdirSync('/manager/profiles', { recursive: true });
+        for (let i = 0; i < ManagerProfiler.CONTINUOUS_KEPT; i++) {
+            const file = `/manager/profiles/continuous-old${i}.cpuprofile`;
+            fs.writeFileSync(file, '{}');
+            fs.utimesSync(file, new Date(1000 + i), new Date(1000 + i));
+        }
+
+        // 60ms per profile
+        manager.config.continuousProfiling = 0.001;
+        await profiler.start();
+        expect(profiler.isContinuous()).to.be.true;
+        await sleep(100);
+        await profiler.stop();
+        expect(profiler.isContinuous()).to.be.false;
+
+        const profiles = (await profiler.getProfiles()).filter((x) => x.type === 'continuous');
+        expect(profiles.length).to.equal(ManagerProfiler.CONTINUOUS_KEPT);
+        expect(profiles.map((x) => x.file)).to.not.include('continuous-old0.cpuprofile');
+        expect(JSON.parse(await readProfile(profiles[0].file)).nodes).to.be.an('array');
+    });
+
+    it('ManagerProfiler-instances', async () => {
+        const instanceInjector = container.createChildContainer();
+        instanceInjector.register(Manager, stubClass(Manager), { lifecycle: Lifecycle.Singleton });
+        instanceInjector.register(Paths, stubClass(Paths), { lifecycle: Lifecycle.Singleton });
+        memfs({}, '/', instanceInjector);
+        (instanceInjector.resolve(Manager) as StubInstance<Manager>).config = { continuousProfiling: 1 } as any;
+        (instanceInjector.resolve(Paths) as StubInstance<Paths>).cwd.returns('/instance');
+        const other = instanceInjector.resolve(ManagerProfiler);
+        expect(other).to.not.equal(profiler);
+
+        // one continuous profile for the whole process
+        manager.config.continuousProfiling = 1;
+        await profiler.start();
+        await other.start();
+        expect(profiler.isContinuous()).to.be.true;
+        expect(other.isContinuous()).to.be.false;
+
+        // the profiles cover all instances
+        const capture = profiler.captureCpuProfile(0.05);
+        expect(await other.captureCpuProfile(1).catch((e) => e)).to.include({ status: 409 });
+        await capture;
+
+        // taken over after the first instance stopped
+        await profiler.stop();
+        await other.start();
+        expect(other.isContinuous()).to.be.true;
+        await other.stop();
+    });
+
+});
@@ -10,6 +10,10 @@ import { Database } from '../../src/services/database';
 import { RCON } from '../../src/services/rcon';
 import { SystemReporter } from '../../src/services/system-reporter';
 import { MetricsCollector } from '../../src/services/metrics-collector';
+import { EventBus } from '../../src/control/event-bus';
+import { DiscordBot } from '../../src/services/discord';
+import { InternalEventTypes } from '../../src/types/events';
+import { Prometheus } from '../../src/services/prometheus';
 
 describe('Test class Metrics', () => {
 
@@ -19,6 +23,7 @@ describe('Test class Metrics', () => {
     let database: StubInstance<Database>;
     let rcon: StubInstance<RCON>;
     let systemReporter: StubInstance<SystemReporter>;
+    let eventBus: StubInstance<EventBus>;
 
     before(() => {
         disableConsole();
@@ -39,11 +44,15 @@ describe('Test class Metrics', () => {
         injector.register(Database, stubClass(Database), { lifecycle: Lifecycle.Singleton });
         injector.register(RCON, stubClass(RCON), { lifecycle: Lifecycle.Singleton });
         injector.register(SystemReporter, stubClass(SystemReporter), { lifecycle: Lifecycle.Singleton });
+        injector.register(EventBus, stubClass(EventBus), { lifecycle: Lifecycle.Singleton });
+        injector.register(DiscordBot, stubClass(DiscordBot), { lifecycle: Lifecycle.Singleton });
+        injector.register(Prometheus, Prometheus, { lifecycle: Lifecycle.Singleton });
 
         manager = injector.resolve(Manager) as any;
         database = injector.resolve(Database) as any;
         rcon = injector.resolve(RCON) as any;
         systemReporter = injector.resolve(SystemReporter) as any;
+        eventBus = injector.resolve(EventBus) as any;
     });
 
     it('Metrics', async () => {
@@ -93,6 +102,7 @@ describe('Test class Metrics', () => {
         expect(metricsCollector['interval']).to.be.undefined;
 
         expect(db.run.callCount).to.be.greaterThanOrEqual(3);
+        expect(eventBus.emit.calledWith(InternalEventTypes.METRIC_ENTRY)).to.be.true;
 
     });
 
@@ -107,6 +117,7 @@ describe('Test class Metrics', () => {
         
         await metrics.deleteMetrics(5);
         expect(db.run.callCount).to.be.greaterThanOrEqual(1);
+        expect(injector.resolve(Prometheus).dbWriteDuration.getCount({ operation: 'delete', table: 'SYSTEM' })).to.equal(1);
 
     });
 
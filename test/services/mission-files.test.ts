@@ -9,6 +9,8 @@ import { Hooks } from '../../src/services/hooks';
 import { FSAPI, InjectionTokens } from '../../src/util/apis';
 import { HookTypeEnum } from '../../src/config/config';
 import { Paths } from '../../src/services/paths';
+import { EventBus } from '../../src/control/event-bus';
+import { InternalEventTypes } from '../../src/types/events';
 
 describe('Test class MissionFiles', () => {
 
@@ -17,6 +19,7 @@ describe('Test class MissionFiles', () => {
     let manager: StubInstance<Manager>;
     let backups: StubInstance<Backups>;
     let hooks: StubInstance<Hooks>;
+    let eventBus: StubInstance<EventBus>;
     let fs: FSAPI;
 
     before(() => {
@@ -37,6 +40,7 @@ describe('Test class MissionFiles', () => {
         injector.register(Manager, stubClass(Manager), { lifecycle: Lifecycle.Singleton });
         injector.register(Backups, stubClass(Backups), { lifecycle: Lifecycle.Singleton });
         injector.register(Hooks, stubClass(Hooks), { lifecycle: Lifecycle.Singleton });
+        injector.register(EventBus, stubClass(EventBus), { lifecycle: Lifecycle.Singleton });
         injector.register(Paths, Paths, { lifecycle: Lifecycle.Singleton });
         injector.register(InjectionTokens.childProcess, { useValue: {} }); // dependency of Paths
         
@@ -137,6 +141,65 @@ describe('Test class MissionFiles', () => {
 
         expect(hooks.executeHooks.callCount).to.equal(1);
         expect(hooks.executeHooks.firstCall.args[0]).to.equal(HookTypeEnum.missionChanged);
+        expect(eventBus.emit.calledWith(InternalEventTypes.MISSION_FILE_WRITTEN, expectedPath)).to.be.true;
+
+    });
+
+    it('MissionFiles-economy', async () => {
+
+        const typesXml = (nominal: number) => `<?xml version="1.0" encoding="UTF-8" standalone="yes" ?>
+<types>
+    <type name="AKM">
+        <nominal>${nominal}</nominal>
+        <category name="weapons"/>
+        <usage name="Military"/>
+    </type>
+    <type name="Apple">
+        <nominal>20</nominal>
+        <category name="food"/>
+    </type>
+</types>`;
+
+        fs = memfs(
+            {
+                'testserver': {
+                    'mpmissions': {
+                        'dayz.chernarusplus': {
+                            'db': {
+                                'types.xml': typesXml(10),
+                            },
+                        },
+                    },
+                },
+            },
+            '/',
+            injector,
+        );
+
+        manager.getServerPath.returns('/testserver');
+        manager.getServerCfg.resolves({
+                Missions: {
+                    DayZ: {
+                        template: 'dayz.chernarusplus',
+                    },
+                },
+            } as any);
+
+        const files = injector.resolve(MissionFiles);
+
+        const content = await files.readMissionEconomy('db/types.xml');
+        expect(content.types.type[0].nominal).to.deep.equal(['10']);
+        // cached as long as the file is unchanged
+        expect(await files.readMissionEconomy('db/types.xml')).to.equal(content);
+
+        const result = await files.queryMissionEconomy('db/types.xml', { category: 'weapons' });
+        expect(result.total).to.equal(1);
+        expect(result.items[0].$.name).to.equal('AKM');
+
+        await files.writeMissionFile('db/types.xml', typesXml(5));
+        const updated = await files.readMissionEconomy('db/types.xml');
+        expect(updated).to.not.equal(content);
+        expect(updated.types.type[0].nominal).to.deep.equal(['5']);
 
     });
 
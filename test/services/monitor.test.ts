@@ -21,6 +21,8 @@ import { Hooks } from '../../src/services/hooks';
 import { EventBus } from '../../src/control/event-bus';
 import { InternalEventTypes } from '../../src/types/events';
 import { Paths } from '../../src/services/paths';
+import { Metrics } from '../../src/services/metrics';
+import { Prometheus } from '../../src/services/prometheus';
 
 describe('Test class ServerDetector', () => {
 
@@ -88,6 +90,22 @@ describe('Test class ServerDetector', () => {
         expect(isRunning).to.be.false;
     });
 
+    it('ServerDetector-hasServerExited', async () => {
+        manager.getServerExePath.returns('test/DayZServer_x64.exe');
+
+        const detector = injector.resolve(ServerDetector);
+
+        processes.isTrackedProcessRunning.returns(undefined);
+        expect(detector.hasServerExited()).to.be.false;
+
+        processes.isTrackedProcessRunning.returns(true);
+        expect(detector.hasServerExited()).to.be.false;
+
+        processes.isTrackedProcessRunning.returns(false);
+        expect(detector.hasServerExited()).to.be.true;
+        expect(processes.isTrackedProcessRunning).to.be.calledWith('test/DayZServer_x64.exe');
+    });
+
 });
 
 describe('Test class ServerStarter', () => {
@@ -125,6 +143,7 @@ describe('Test class ServerStarter', () => {
         injector.register(SteamCMD, stubClass(SteamCMD), { lifecycle: Lifecycle.Singleton });
         injector.register(IngameReport, stubClass(IngameReport), { lifecycle: Lifecycle.Singleton });
         injector.register(Hooks, stubClass(Hooks), { lifecycle: Lifecycle.Singleton });
+        injector.register(Metrics, stubClass(Metrics), { lifecycle: Lifecycle.Singleton });
         
         fs = memfs({}, '/', injector);
 
@@ -311,6 +330,7 @@ describe('Test class Monitor', () => {
         injector.register(ServerDetector, stubClass(ServerDetector), { lifecycle: Lifecycle.Singleton });
         injector.register(EventBus, EventBus, { lifecycle: Lifecycle.Singleton });
         injector.register(Paths, Paths, { lifecycle: Lifecycle.Singleton });
+        injector.register(Metrics, stubClass(Metrics), { lifecycle: Lifecycle.Singleton });
         fakeChildProcess(injector); // for paths
 
         fs = memfs({}, '/', injector);
@@ -496,6 +516,7 @@ describe('Test class SystemReporter', () => {
         injector.register(Monitor, stubClass(Monitor), { lifecycle: Lifecycle.Singleton });
         injector.register(Processes, stubClass(Processes), { lifecycle: Lifecycle.Singleton });
         injector.register(ServerDetector, stubClass(ServerDetector), { lifecycle: Lifecycle.Singleton });
+        injector.register(Prometheus, Prometheus, { lifecycle: Lifecycle.Singleton });
 
         monitor = injector.resolve(Monitor) as any;
         processes = injector.resolve(Processes) as any;
@@ -543,6 +564,15 @@ describe('Test class SystemReporter', () => {
         expect(res).to.be.not.undefined;
         expect(res?.server).to.be.not.undefined;
 
+        const prometheus = injector.resolve(Prometheus);
+        expect(prometheus.systemMemoryTotal.get()).to.equal(16 * 1024 * 1024);
+        expect(prometheus.processMemory.get({ process: 'server' })).to.be.a('number');
+
+        (monitor as any).serverState = ServerState.STOPPED;
+        await reporter.getSystemReport();
+        expect(prometheus.processMemory.get({ process: 'server' })).to.be.undefined;
+        expect(prometheus.processMemory.get({ process: 'manager' })).to.be.a('number');
+
     });
 
     
@@ -4,7 +4,8 @@ import { expect } from '../expect';
 import * as path from 'path';
 import { Paths } from '../../src/services/paths';
 import { disableConsole, enableConsole, fakeChildProcess, memfs } from '../util';
-import { DependencyContainer, container } from 'tsyringe';
+import { DependencyContainer, Lifecycle, container } from 'tsyringe';
+import { TaskTracker } from '../../src/services/task-tracker';
 
 describe('Test class Paths', () => {
 
@@ -117,6 +118,31 @@ describe('Test class Paths', () => {
         
     });
 
+    it('Paths-setInstance', () => {
+
+        const paths = injector.resolve(Paths);
+        expect(paths.getInstanceName()).to.be.undefined;
+        expect(paths.sharedCwd()).to.equal(paths.cwd());
+
+        paths.setInstance('s1', '/supervisor/s1', '/supervisor');
+
+        expect(paths.getInstanceName()).to.equal('s1');
+        expect(paths.cwd()).to.equal(path.resolve('/supervisor/s1'));
+        expect(paths.sharedCwd()).to.equal(path.resolve('/supervisor'));
+    });
+
+    it('Paths-sameFilesystem', () => {
+        const fs = memfs({ 'supervisor': { 's1': {} } }, '/', injector);
+        const paths = injector.resolve(Paths);
+
+        expect(paths.sameFilesystem('/supervisor', '/supervisor/s1')).to.be.true;
+        expect(paths.sameFilesystem('/supervisor', '/missing')).to.be.false;
+
+        const statSync = fs.statSync.bind(fs);
+        (fs as any).statSync = (p: string) => ({ ...statSync(p), dev: p === '/supervisor' ? 1 : 2 });
+        expect(paths.sameFilesystem('/supervisor', '/supervisor/s1')).to.be.false;
+    });
+
     it('Paths-findFilesInDir', async () => {
         
         memfs(
@@ -349,4 +375,29 @@ describe('Test class Paths', () => {
         // TODO check dest
     });
 
+    it('Paths-syncDirFromTo', async () => {
+
+        const fs = memfs(
+            {
+                'src/dir/path': {
+                    'test1': 'testcontent1',
+                },
+            },
+            '/',
+            injector,
+        );
+        injector.register(TaskTracker, TaskTracker, { lifecycle: Lifecycle.Singleton });
+
+        const paths = injector.resolve(Paths);
+        const result = await paths.syncDirFromTo('/src/dir/path', '/dest/dir/path', { manifestPath: '/manifest.json' });
+
+        expect(result).to.be.true;
+        expect(fs.readFileSync('/dest/dir/path/test1') + '').to.equal('testcontent1');
+        // synced by the worker pool, which tracks the job
+        const tasks = injector.resolve(TaskTracker).getTasksBetween(0, Date.now());
+        expect(tasks.map((x) => x.name)).to.include('syncDir /src/dir/path');
+
+        expect(await paths.syncDirFromTo('/missing', '/dest/dir/path', { manifestPath: '/manifest.json' })).to.be.false;
+    });
+
 });
@@ -10,6 +10,8 @@ import * as childProcess from 'child_process';
 import * as nodePty from 'node-pty';
 import * as os from 'os';
 import * as sinon from 'sinon';
+import { ImportMock } from 'ts-mock-imports';
+import * as detectOSModule from '../../src/util/detect-os';
 import { disableConsole, enableConsole, memfs, stubClass } from '../util';
 import { DependencyContainer, container } from 'tsyringe';
 import { Paths } from '../../src/services/paths';
@@ -287,6 +289,31 @@ describe('Test class ProcessesSpawner', () => {
         expect(handlerStderr).to.equal('');
     });
 
+    it('ProcessesSpawner-spawnForOutput-lowPriority', async () => {
+        if (process.platform === 'win32') {
+            // priority is lowered after the spawn on windows
+            return;
+        }
+        const detectOSMock = ImportMock.mockFunction(detectOSModule, 'detectOS', 'linux');
+        const processes = injector.resolve(ProcessSpawner);
+
+        const result = await processes.spawnForOutput(
+            'node',
+            [
+                '-e',
+                'console.log(require(\'os\').getPriority())'
+            ],
+            {
+                lowPriority: true,
+            }
+        );
+
+        detectOSMock.restore();
+
+        expect(result.status).to.equal(0);
+        expect(Number(result.stdout)).to.equal(Math.min(os.getPriority() + processes.LOW_PRIORITY_NICE, 19));
+    });
+
     it('ProcessesSpawner-spawnForOutputPty', async () => {
         const processes = injector.resolve(ProcessSpawner);
         
@@ -378,6 +405,44 @@ describe('Test class Processes', () => {
         expect(processes.getProcessCPUUsage(result[0], result[0])).to.equal(0);
     });
 
+    it('Processes-getProcessList-sharedScan', async () => {
+        const detectOSMock = ImportMock.mockFunction(detectOSModule, 'detectOS', 'windows');
+        const processes = injector.resolve(Processes);
+        const fetcher = injector.resolve(WindowsProcessFetcher) as any;
+
+        (injector.resolve(Paths).samePath as sinon.SinonStub).callsFake((p1, p2) => p1 === p2);
+        const proc = (exe: string): ProcessEntry => Object.assign(new ProcessEntry(), { ProcessId: exe, ExecutablePath: exe, CreationDate: '1' });
+        fetcher.getAllProcesses.resolves([proc('a'), proc('b')]);
+
+        // both instances share one scan
+        const [a, b] = await Promise.all([
+            processes.getProcessList('a'),
+            processes.getProcessList('b'),
+        ]);
+        expect(a.map((x) => x.ProcessId)).to.deep.equal(['a']);
+        expect(b.map((x) => x.ProcessId)).to.deep.equal(['b']);
+        expect(fetcher.getAllProcesses.callCount).to.equal(1);
+
+        // finished scans are only reused if multiple instances share the list
+        await processes.getProcessList('a');
+        expect(fetcher.getAllProcesses.callCount).to.equal(2);
+        processes.setScanSharing(true);
+        await processes.getProcessList('a');
+        expect(fetcher.getAllProcesses.callCount).to.equal(2);
+
+        // outdated scans are repeated
+        processes['lastScan'].done = Date.now() - Processes.SCAN_TTL - 1;
+        fetcher.getAllProcesses.rejects(new Error('test'));
+        await expect(processes.getProcessList('a')).to.be.rejected;
+
+        // failed scans are not reused
+        fetcher.getAllProcesses.resolves([proc('a')]);
+        expect(await processes.getProcessList('a')).to.have.length(1);
+        expect(fetcher.getAllProcesses.callCount).to.equal(4);
+
+        detectOSMock.restore();
+    });
+
     it('Processes-killProcess', async () => {
         const processes = injector.resolve(Processes);
         
@@ -403,6 +468,18 @@ describe('Test class Processes', () => {
         expect(processes.killProcess(pid)).to.be.rejected;
     });
 
+    it('Processes-isTrackedProcessRunning', () => {
+        const processes = injector.resolve(Processes);
+
+        expect(processes.isTrackedProcessRunning('test')).to.be.undefined;
+
+        processes['trackedProcesses'].set('test', [{ pid: String(process.pid), startTime: '' }]);
+        expect(processes.isTrackedProcessRunning('test')).to.be.true;
+
+        processes['trackedProcesses'].set('test', [{ pid: '99999999', startTime: '' }]);
+        expect(processes.isTrackedProcessRunning('test')).to.be.false;
+    });
+
     it('Processes-getSystemUsage', () => {
         const processes = injector.resolve(Processes);
         const result = processes.getSystemUsage();
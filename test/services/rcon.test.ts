@@ -5,7 +5,7 @@ import { StubInstance, disableConsole, enableConsole, memfs, sleep, stubClass }
 import * as path from 'path';
 import * as sinon from 'sinon';
 import { ServerState } from '../../src/types/monitor';
-import { BattleyeConf, RCON } from '../../src/services/rcon';
+import { BattleyeConf, Packet, PacketDirection, PacketType, RCON } from '../../src/services/rcon';
 import { DependencyContainer, Lifecycle, container } from 'tsyringe';
 import { Manager } from '../../src/control/manager';
 import { DiscordBot } from '../../src/services/discord';
@@ -13,6 +13,7 @@ import { FSAPI, InjectionTokens } from '../../src/util/apis';
 import { EventBus } from '../../src/control/event-bus';
 import { InternalEventTypes } from '../../src/types/events';
 import { Monitor } from '../../src/services/monitor';
+import { RestartTracer } from '../../src/services/restart-tracer';
 import * as crc32 from 'buffer-crc32';
 import { Socket } from 'dgram';
 
@@ -83,10 +84,16 @@ describe('Test class RCON', () => {
         injector.register(EventBus, EventBus, { lifecycle: Lifecycle.Singleton });
         injector.register(DiscordBot, stubClass(DiscordBot), { lifecycle: Lifecycle.Singleton });
         injector.register(Monitor, stubClass(Monitor), { lifecycle: Lifecycle.Singleton });
+        injector.register(RestartTracer, stubClass(RestartTracer), { lifecycle: Lifecycle.Singleton });
         
         socket = new (stubClass(Socket)) as any;
         socket.address.returns({address: 'test', family: 'test', port: 1234});
         injector.register(InjectionTokens.rconSocket, { useValue: () => socket });
+        injector.register(InjectionTokens.chokidar, {
+            useValue: {
+                watch: sinon.stub().returns({ on: sinon.stub(), close: sinon.stub().resolves() }),
+            },
+        });
 
         manager = injector.resolve(Manager) as any;
         eventBus = injector.resolve(EventBus);
@@ -100,6 +107,37 @@ describe('Test class RCON', () => {
         expect(conf.RestrictRCon).to.equal('2');
     });
 
+    it('Packet-codec', () => {
+        const cmd = new Packet(PacketType.COMMAND, PacketDirection.REQUEST, { command: 'say -1 äöü', sequence: 5 });
+        const cmdBuf = cmd.serialize();
+        expect(cmdBuf.equals(createResponse(Buffer.concat([Buffer.from([0xFF, 0x01, 5]), Buffer.from('say -1 äöü')])))).to.be.true;
+
+        // resends reuse the serialized buffer
+        expect(cmd.serialize()).to.equal(cmdBuf);
+        cmd.sequence = 6;
+        expect(cmd.serialize()[8]).to.equal(6);
+
+        const parsed = Packet.fromBuffer(createResponse(createCmdBuffer(5, 'response')));
+        expect(parsed.sequence).to.equal(5);
+        // decoded lazily
+        expect(parsed.payload.toString()).to.equal('response');
+        expect(parsed.data).to.equal('response');
+        expect(parsed.payload).to.be.undefined;
+        expect(parsed.message).to.be.undefined;
+
+        const part = Packet.fromBuffer(createResponse(createCmdBuffers(7, 'multipartresponse')[1]));
+        expect(part.direction).to.equal(PacketDirection.MULTI_PART_RESPONSE);
+        expect(part.total).to.equal(3);
+        expect(part.index).to.equal(1);
+
+        const ack1 = new Packet(PacketType.MESSAGE, PacketDirection.RESPONSE, { sequence: 3 }).serialize();
+        const ack2 = new Packet(PacketType.MESSAGE, PacketDirection.RESPONSE, { sequence: 3 }).serialize();
+        expect(ack1).to.equal(ack2);
+        expect(Packet.fromBuffer(ack1).sequence).to.equal(3);
+
+        expect(() => Packet.fromBuffer(Buffer.from('BE000000000'))).to.throw();
+    });
+
     const startRCON = async () => {
         const rcon = injector.resolve(RCON);
         rcon.keepAlive = false;
@@ -527,6 +565,11 @@ describe('Test class RCON', () => {
         guids = rcon.readWhitelistTxt();
         expect(guids).to.be.empty;
 
+        expect(rcon.importGuids('whitelist', [steamId, steamId.replace(/0$/, '1'), 'invalid'])).to.equal(2);
+        expect(rcon.readWhitelistTxt().length).to.equal(2);
+        expect(rcon.exportGuids('whitelist').split(/\r?\n/).length).to.equal(2);
+        expect(() => rcon.exportGuids('../test' as any)).to.throw();
+
         expect(
             fs.existsSync(
                 path.join(
@@ -190,4 +190,16 @@ describe('Test class Requirements', () => {
         expect(exitMock.called).to.be.true;
     });
 
+    it('Requirements-check-missingLibInstance', async () => {
+        const requirements = injector.resolve(Requirements);
+
+        sinon.stub(requirements, 'checkFirewall').returns(Promise.resolve(true));
+        sinon.stub(requirements, 'checkOptionals').returns(Promise.resolve(true));
+        sinon.stub(requirements, 'checkRuntimeLibs').returns(Promise.resolve(false));
+
+        // instances must not exit the process of the other instances
+        await expect(requirements.check(false)).to.be.rejected;
+        expect(processes.exit.called).to.be.false;
+    });
+
 });
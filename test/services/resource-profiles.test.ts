@@ -0,0 +1,151 @@
+import { expect } from '../expect';
+import { ImportMock } from 'ts-mock-imports';
+import * as os from 'os';
+import { StubInstance, disableConsole, enableConsole, memfs, stubClass } from '../util';
+import { DependencyContainer, Lifecycle, container } from 'tsyringe';
+import { Manager } from '../../src/control/manager';
+import { Processes } from '../../src/services/processes';
+import { ServerDetector } from '../../src/services/server-detector';
+import { ResourceProfiles } from '../../src/services/resource-profiles';
+import { LoggerFactory } from '../../src/services/loggerfactory';
+import { InjectionTokens } from '../../src/util/apis';
+import * as detectOSModule from '../../src/util/detect-os';
+
+describe('Test class ResourceProfiles', () => {
+
+    let injector: DependencyContainer;
+
+    let manager: StubInstance<Manager>;
+    let processes: StubInstance<Processes>;
+    let serverDetector: StubInstance<ServerDetector>;
+
+    before(() => {
+        disableConsole();
+    });
+
+    after(() => {
+        enableConsole();
+    });
+
+    beforeEach(() => {
+        // restore mocks
+        ImportMock.restore();
+
+        container.reset();
+        injector = container.createChildContainer();
+        (ResourceProfiles as any).managerPinned = false;
+
+        injector.register(Manager, stubClass(Manager), { lifecycle: Lifecycle.Singleton });
+        injector.register(Processes, stubClass(Processes), { lifecycle: Lifecycle.Singleton });
+        injector.register(ServerDetector, stubClass(ServerDetector), { lifecycle: Lifecycle.Singleton });
+        memfs({}, '/', injector);
+
+        manager = injector.resolve(Manager) as any;
+        processes = injector.resolve(Processes) as any;
+        serverDetector = injector.resolve(ServerDetector) as any;
+
+        manager.config = {
+            serverCpuAffinity: [1, 0, 1, 9999],
+            managerCpuAffinity: [0],
+            maintenanceLowPriority: true,
+        } as any;
+        processes.spawnForOutput.resolves({ status: 0, stdout: '', stderr: '' });
+    });
+
+    it('ResourceProfiles-wrapServerSpawnCmd-linux', () => {
+        ImportMock.mockFunction(detectOSModule, 'detectOS', 'linux');
+        const profiles = injector.resolve(ResourceProfiles);
+
+        const cores = os.cpus().length > 1 ? '0,1' : '0';
+        expect(profiles.wrapServerSpawnCmd({ cmd: '/server/DayZServer', args: [], cwd: '/server' })).to.deep.equal({
+            cmd: 'taskset',
+            args: ['--cpu-list', cores, '/server/DayZServer'],
+            cwd: '/server',
+        });
+
+        manager.config.serverCpuAffinity = [];
+        expect(profiles.wrapServerSpawnCmd({ cmd: '/server/DayZServer', args: [] }).cmd).to.equal('/server/DayZServer');
+    });
+
+    it('ResourceProfiles-wrapServerSpawnCmd-managerPinned', async () => {
+        ImportMock.mockFunction(detectOSModule, 'detectOS', 'linux');
+        const profiles = injector.resolve(ResourceProfiles);
+        manager.config.serverCpuAffinity = [];
+        expect(await profiles.applyManagerProfile()).to.be.true;
+
+        // the server does not inherit the cores of the manager
+        const allCores = os.cpus().map((x, idx) => idx).join(',');
+        expect(profiles.wrapServerSpawnCmd({ cmd: '/server/DayZServer', args: [] }).args)
+            .to.deep.equal(['--cpu-list', allCores, '/server/DayZServer']);
+
+        // shared with other instances, which did not apply the profile
+        const other = new ResourceProfiles(
+            injector.resolve(LoggerFactory),
+            manager as any,
+            processes as any,
+            serverDetector as any,
+            injector.resolve(InjectionTokens.fs),
+        );
+        expect(other.wrapServerSpawnCmd({ cmd: '/server/DayZServer', args: [] }).cmd).to.equal('taskset');
+    });
+
+    it('ResourceProfiles-wrapServerSpawnCmd-windows', () => {
+        ImportMock.mockFunction(detectOSModule, 'detectOS', 'windows');
+        const profiles = injector.resolve(ResourceProfiles);
+
+        manager.config.serverCpuAffinity = [0];
+        expect(profiles.wrapServerSpawnCmd({ cmd: 'cmd', args: ['/c', 'start', '/D', 'server', 'DayZServer_x64.exe'] }).args)
+            .to.deep.equal(['/c', 'start', '/AFFINITY', '1', '/D', 'server', 'DayZServer_x64.exe']);
+
+        // all cores if only the manager is pinned
+        (ResourceProfiles as any).managerPinned = true;
+        manager.config.serverCpuAffinity = [];
+        const mask = (2 ** os.cpus().length - 1).toString(16);
+        expect(profiles.wrapServerSpawnCmd({ cmd: 'cmd', args: ['/c', 'start', 'DayZServer_x64.exe'] }).args)
+            .to.deep.equal(['/c', 'start', '/AFFINITY', mask, 'DayZServer_x64.exe']);
+    });
+
+    it('ResourceProfiles-applyManagerProfile', async () => {
+        ImportMock.mockFunction(detectOSModule, 'detectOS', 'linux');
+        const profiles = injector.resolve(ResourceProfiles);
+
+        expect(await profiles.applyManagerProfile()).to.be.true;
+        expect(processes.spawnForOutput).to.be.calledOnceWith('taskset');
+        expect(processes.spawnForOutput.firstCall.args[1]).to.include(String(process.pid));
+
+        processes.spawnForOutput.resolves({ status: 1, stdout: '', stderr: 'not permitted' });
+        expect(await profiles.applyManagerProfile()).to.be.false;
+
+        manager.config.managerCpuAffinity = [];
+        expect(await profiles.applyManagerProfile()).to.be.false;
+        expect(processes.spawnForOutput).to.be.calledTwice;
+    });
+
+    it('ResourceProfiles-getEffectiveSettings', async () => {
+        ImportMock.mockFunction(detectOSModule, 'detectOS', 'linux');
+        memfs(
+            {
+                proc: {
+                    [String(process.pid)]: {
+                        status: 'Name:\tnode\nCpus_allowed_list:\t0-3\n',
+                    },
+                },
+            },
+            '/',
+            injector,
+        );
+        serverDetector.getDayZProcesses.resolves([{ ProcessId: '999999999' }] as any);
+        const profiles = injector.resolve(ResourceProfiles);
+
+        const report = await profiles.getEffectiveSettings();
+        expect(report.manager.pid).to.equal(String(process.pid));
+        expect(report.manager.cpuAffinity).to.equal('0-3');
+        expect(report.manager.priority).to.equal(os.getPriority());
+        expect(report.server!.pid).to.equal('999999999');
+        expect(report.server!.cpuAffinity).to.be.undefined;
+        expect(report.server!.priority).to.be.undefined;
+        expect(report.managerCpuAffinity).to.deep.equal([0]);
+        expect(report.maintenanceLowPriority).to.be.true;
+    });
+
+});
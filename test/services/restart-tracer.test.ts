@@ -0,0 +1,139 @@
+import { expect } from '../expect';
+import * as sinon from 'sinon';
+import { StubInstance, disableConsole, enableConsole, sleep, stubClass } from '../util';
+import { DependencyContainer, Lifecycle, container } from 'tsyringe';
+import { Manager } from '../../src/control/manager';
+import { EventBus } from '../../src/control/event-bus';
+import { Metrics } from '../../src/services/metrics';
+import { RestartTracer } from '../../src/services/restart-tracer';
+import { InternalEventTypes } from '../../src/types/events';
+import { MetricTypeEnum } from '../../src/types/metrics';
+import { ServerState } from '../../src/types/monitor';
+import { RestartCycle } from '../../src/types/restart-tracer';
+
+describe('Test class RestartTracer', () => {
+
+    let injector: DependencyContainer;
+
+    let manager: StubInstance<Manager>;
+    let metrics: StubInstance<Metrics>;
+    let eventBus: EventBus;
+    let tracer: RestartTracer;
+
+    before(() => {
+        disableConsole();
+    });
+
+    after(() => {
+        enableConsole();
+    });
+
+    beforeEach(async () => {
+        container.reset();
+        injector = container.createChildContainer();
+
+        injector.register(Manager, stubClass(Manager), { lifecycle: Lifecycle.Singleton });
+        injector.register(Metrics, stubClass(Metrics), { lifecycle: Lifecycle.Singleton });
+        injector.register(EventBus, EventBus, { lifecycle: Lifecycle.Singleton });
+
+        manager = injector.resolve(Manager) as any;
+        metrics = injector.resolve(Metrics) as any;
+        eventBus = injector.resolve(EventBus);
+
+        manager.config = {} as any;
+        manager.getServerCfg.resolves({ BattlEye: 1 } as any);
+        metrics.fetchMetrics.resolves([]);
+
+        tracer = injector.resolve(RestartTracer);
+        await tracer.start();
+    });
+
+    afterEach(async () => {
+        await tracer.stop();
+    });
+
+    it('RestartTracer-cycle', async () => {
+        tracer.beginCycle('restart');
+        expect(await tracer.span('shutdown', async () => true)).to.be.true;
+        tracer.begin('stopDetection');
+        eventBus.emit(InternalEventTypes.MONITOR_STATE_CHANGE, ServerState.STOPPED, ServerState.STOPPING);
+
+        // already active
+        tracer.beginCycle('crash');
+        expect(tracer.activeCycle.reason).to.equal('restart');
+
+        tracer.begin('boot');
+        eventBus.emit(InternalEventTypes.MONITOR_STATE_CHANGE, ServerState.STARTED, ServerState.STARTING);
+        await sleep(10);
+        expect(tracer.activeCycle.downtime).to.be.a('number');
+        expect(tracer.activeCycle.spans.map((x) => x.phase)).to.deep.equal([
+            'shutdown', 'stopDetection', 'boot', 'firstReport', 'rconLogin',
+        ]);
+
+        tracer.end('rconLogin');
+        expect(tracer.activeCycle).to.not.be.undefined;
+        tracer.end('firstReport');
+        await sleep(10);
+
+        expect(tracer.activeCycle).to.be.undefined;
+        expect(metrics.pushMetricValue.callCount).to.equal(1);
+        expect(metrics.pushMetricValue.firstCall.args[0]).to.equal(MetricTypeEnum.RESTART_CYCLE);
+        const cycle = metrics.pushMetricValue.firstCall.args[1].value as RestartCycle;
+        expect(cycle.complete).to.be.true;
+        expect(cycle.regressions).to.be.empty;
+        expect(cycle.spans.every((x) => x.duration >= 0)).to.be.true;
+    });
+
+    it('RestartTracer-regression', async () => {
+        manager.config.ingameReportEnabled = false;
+        manager.getServerCfg.resolves({ BattlEye: 0 } as any);
+        metrics.fetchMetrics.resolves([10000, 12000, 8000].map((duration, i) => ({
+            timestamp: i,
+            value: {
+                reason: 'start',
+                start: i,
+                complete: true,
+                spans: [{ phase: 'boot', start: 0, end: duration, duration }],
+                regressions: [],
+            },
+        })));
+        const discordMessage = sinon.stub();
+        eventBus.on(InternalEventTypes.DISCORD_MESSAGE, discordMessage);
+
+        tracer.beginCycle('start');
+        tracer.begin('boot');
+        tracer.activeCycle.spans[0].start -= 30000;
+        eventBus.emit(InternalEventTypes.MONITOR_STATE_CHANGE, ServerState.STARTED, ServerState.STARTING);
+        await sleep(10);
+
+        // no rcon and ingame report phases, done right away
+        expect(tracer.activeCycle).to.be.undefined;
+        const cycle = metrics.pushMetricValue.firstCall.args[1].value as RestartCycle;
+        expect(cycle.spans.map((x) => x.phase)).to.deep.equal(['boot']);
+        expect(cycle.regressions.length).to.equal(1);
+        expect(cycle.regressions[0]).to.include({ phase: 'boot', baseline: 10000 });
+        expect(discordMessage.callCount).to.equal(1);
+    });
+
+    it('RestartTracer-crash', async () => {
+        metrics.fetchMetrics.resolves([{ timestamp: 0, value: { reason: 'start' } }]);
+
+        eventBus.emit(InternalEventTypes.MONITOR_STATE_CHANGE, ServerState.STOPPED, ServerState.STARTING);
+        expect(tracer.activeCycle).to.be.undefined;
+
+        eventBus.emit(InternalEventTypes.MONITOR_STATE_CHANGE, ServerState.STOPPED, ServerState.STARTED);
+        expect(tracer.activeCycle.reason).to.equal('crash');
+
+        const trace = await tracer.getTrace(100);
+        expect(trace.active).to.equal(tracer.activeCycle);
+        expect(trace.cycles).to.deep.equal([{ reason: 'start' }]);
+        expect(metrics.fetchMetrics.calledWith(MetricTypeEnum.RESTART_CYCLE, 100)).to.be.true;
+
+        // not traced while stopped
+        await tracer.stop();
+        expect(tracer.activeCycle).to.be.undefined;
+        tracer.beginCycle('restart');
+        expect(tracer.activeCycle).to.be.undefined;
+    });
+
+});
@@ -0,0 +1,120 @@
+import { expect } from '../expect';
+import { StubInstance, disableConsole, enableConsole, memfs, stubClass } from '../util';
+import { DependencyContainer, Lifecycle, container } from 'tsyringe';
+import { Manager } from '../../src/control/manager';
+import { Monitor } from '../../src/services/monitor';
+import { Metrics } from '../../src/services/metrics';
+import { ServerDetector } from '../../src/services/server-detector';
+import { ServerTelemetry } from '../../src/services/server-telemetry';
+import { ServerState } from '../../src/types/monitor';
+import { MetricTypeEnum } from '../../src/types/metrics';
+import { FSAPI } from '../../src/util/apis';
+
+describe('Test class ServerTelemetry', () => {
+
+    let injector: DependencyContainer;
+
+    let manager: StubInstance<Manager>;
+    let monitor: StubInstance<Monitor>;
+    let metrics: StubInstance<Metrics>;
+    let serverDetector: StubInstance<ServerDetector>;
+    let fs: FSAPI;
+
+    const writeProc = (ticks: number, ctx: number, ioBytes: number): void => {
+        fs.mkdirSync('/proc/123/task/123', { recursive: true });
+        fs.mkdirSync('/proc/123/task/124', { recursive: true });
+        fs.mkdirSync('/proc/123/fd', { recursive: true });
+        fs.writeFileSync('/proc/123/fd/0', '');
+        fs.writeFileSync('/proc/123/fd/1', '');
+        fs.writeFileSync(
+            '/proc/123/stat',
+            `123 (DayZServer) S 1 1 1 0 -1 0 0 0 0 0 ${ticks * 2} ${ticks} 0 0 20 0 2 0 100`,
+        );
+        fs.writeFileSync('/proc/123/status', 'Name:\tDayZServer\nVmRSS:\t    2048 kB\nVmSwap:\t       1 kB\n');
+        fs.writeFileSync('/proc/123/io', `read_bytes: ${ioBytes}\nwrite_bytes: ${ioBytes * 2}\n`);
+        fs.writeFileSync(
+            '/proc/123/task/123/stat',
+            `123 (DayZServer) S 1 1 1 0 -1 0 0 0 0 0 ${ticks * 2} 0 0 0 20 0 2 0 100`,
+        );
+        fs.writeFileSync('/proc/123/task/123/status', `voluntary_ctxt_switches:\t${ctx}\nnonvoluntary_ctxt_switches:\t${ctx}\n`);
+        fs.writeFileSync(
+            '/proc/123/task/124/stat',
+            `124 (Job Thread 1) S 1 1 1 0 -1 0 0 0 0 0 ${ticks} 0 0 0 20 0 2 0 100`,
+        );
+        fs.writeFileSync('/proc/123/task/124/status', `voluntary_ctxt_switches:\t${ctx}\nnonvoluntary_ctxt_switches:\t0\n`);
+    };
+
+    before(() => {
+        disableConsole();
+    });
+
+    after(() => {
+        enableConsole();
+    });
+
+    beforeEach(() => {
+        container.reset();
+        injector = container.createChildContainer();
+
+        injector.register(Manager, stubClass(Manager), { lifecycle: Lifecycle.Singleton });
+        injector.register(Monitor, stubClass(Monitor), { lifecycle: Lifecycle.Singleton });
+        injector.register(Metrics, stubClass(Metrics), { lifecycle: Lifecycle.Singleton });
+        injector.register(ServerDetector, stubClass(ServerDetector), { lifecycle: Lifecycle.Singleton });
+        fs = memfs({}, '/', injector);
+
+        manager = injector.resolve(Manager) as any;
+        monitor = injector.resolve(Monitor) as any;
+        metrics = injector.resolve(Metrics) as any;
+        serverDetector = injector.resolve(ServerDetector) as any;
+
+        manager.config = {
+            serverTelemetry: false,
+            metricPollIntervall: 10000,
+        } as any;
+        (monitor as any).serverState = ServerState.STARTED;
+        serverDetector.getDayZProcesses.resolves([{ ProcessId: '123' }] as any);
+    });
+
+    it('ServerTelemetry-disabled', async () => {
+        const telemetry = injector.resolve(ServerTelemetry);
+        await telemetry.start();
+        expect(telemetry['timers'].getTimer('sample')).to.be.undefined;
+        await telemetry.stop();
+    });
+
+    it('ServerTelemetry-sample', async () => {
+        const telemetry = injector.resolve(ServerTelemetry);
+
+        writeProc(100, 10, 1000);
+        expect(await telemetry.sample()).to.be.undefined; // first sample is the baseline
+
+        telemetry['prevStats'].timestamp -= 1000;
+        writeProc(150, 20, 2000);
+        const sample = await telemetry.sample();
+
+        expect(sample).to.be.not.undefined;
+        expect(sample!.pid).to.equal('123');
+        expect(sample!.threadCount).to.equal(2);
+        expect(sample!.threads[0].name).to.equal('DayZServer');
+        expect(sample!.threads[1].name).to.equal('Job Thread 1');
+        expect(sample!.rss).to.equal(2048 * 1024);
+        expect(sample!.swap).to.equal(1024);
+        expect(sample!.openFds).to.equal(2);
+        expect(sample!.cpu).to.be.greaterThan(0);
+        expect(sample!.ioRead).to.be.greaterThan(0);
+        expect(sample!.ctxSwitches).to.be.greaterThan(0);
+        expect(telemetry.getSamples().length).to.equal(1);
+
+        const rollup = await telemetry.rollup();
+        expect(rollup!.samples).to.equal(1);
+        expect(rollup!.rssMax).to.equal(2048 * 1024);
+        expect(metrics.pushMetricValue).to.be.calledWith(MetricTypeEnum.SERVER_TELEMETRY);
+
+        // nothing new to roll up
+        expect(await telemetry.rollup()).to.be.undefined;
+
+        (monitor as any).serverState = ServerState.STOPPED;
+        expect(await telemetry.sample()).to.be.undefined;
+    });
+
+});
@@ -0,0 +1,188 @@
+import { expect } from '../expect';
+import { ImportMock } from 'ts-mock-imports';
+import { StubInstance, disableConsole, enableConsole, memfs, stubClass } from '../util';
+import { DependencyContainer, Lifecycle, container } from 'tsyringe';
+import { Manager } from '../../src/control/manager';
+import { Paths } from '../../src/services/paths';
+import { SteamCMD, SteamMetaData } from '../../src/services/steamcmd';
+import { Monitor } from '../../src/services/monitor';
+import { EventBus } from '../../src/control/event-bus';
+import { StagedUpdates } from '../../src/services/staged-updates';
+import { ServerState } from '../../src/types/monitor';
+import { FSAPI } from '../../src/util/apis';
+
+describe('Test class StagedUpdates', () => {
+
+    let injector: DependencyContainer;
+
+    let manager: StubInstance<Manager>;
+    let paths: StubInstance<Paths>;
+    let steamCmd: StubInstance<SteamCMD>;
+    let steamMeta: StubInstance<SteamMetaData>;
+    let monitor: StubInstance<Monitor>;
+    let fs: FSAPI;
+
+    before(() => {
+        disableConsole();
+    });
+
+    after(() => {
+        enableConsole();
+    });
+
+    beforeEach(() => {
+        // restore mocks
+        ImportMock.restore();
+
+        container.reset();
+        injector = container.createChildContainer();
+
+        injector.register(Manager, stubClass(Manager), { lifecycle: Lifecycle.Singleton });
+        injector.register(Paths, stubClass(Paths), { lifecycle: Lifecycle.Singleton });
+        injector.register(SteamCMD, stubClass(SteamCMD), { lifecycle: Lifecycle.Singleton });
+        injector.register(SteamMetaData, stubClass(SteamMetaData), { lifecycle: Lifecycle.Singleton });
+        injector.register(Monitor, stubClass(Monitor), { lifecycle: Lifecycle.Singleton });
+        injector.register(EventBus, stubClass(EventBus), { lifecycle: Lifecycle.Singleton });
+        fs = memfs(
+            {
+                '/server': {
+                    'DayZServer': 'old',
+                    'mpmissions': { 'dayzOffline.chernarusplus': { 'storage_1': 'state' } },
+                    'profiles': { 'server.log': 'log' },
+                    'serverDZ.cfg': 'cfg',
+                },
+                '/server-staged': {
+                    'DayZServer': 'new',
+                    'mpmissions': { 'dayzOffline.chernarusplus': { 'storage_1': 'vanilla' } },
+                },
+                '/meta': {
+                    '1234.staged.sync.json': '{}',
+                    '1234.sync.json': '{}',
+                },
+            },
+            '/',
+            injector,
+        );
+
+        manager = injector.resolve(Manager) as any;
+        paths = injector.resolve(Paths) as any;
+        steamCmd = injector.resolve(SteamCMD) as any;
+        steamMeta = injector.resolve(SteamMetaData) as any;
+        monitor = injector.resolve(Monitor) as any;
+
+        manager.config = {
+            stagedUpdates: true,
+            stagedUpdatesStatePaths: ['mpmissions', 'ban.txt'],
+            stagedUpdatesVerifyTime: 0,
+            stagedUpdatesPrepareIntervall: 0,
+            profilesPath: 'profiles',
+            serverCfgPath: 'serverDZ.cfg',
+        } as any;
+        manager.getServerPath.returns('/server');
+        manager.getCombinedModIdList.returns(['1234']);
+        steamMeta.getMetaDataPath.returns('/meta');
+        steamCmd.getWsModName.returns('@Mod');
+    });
+
+    it('StagedUpdates-prepare', async () => {
+        paths.syncDirFromTo.resolves(true);
+        steamCmd.updateServer.resolves(true);
+        steamCmd.updateAllMods.resolves(true);
+        steamCmd.installMods.resolves(true);
+
+        const staged = injector.resolve(StagedUpdates);
+        expect(await staged.prepare()).to.be.true;
+
+        expect(paths.syncDirFromTo).to.be.calledOnceWith('/server', '/server-staged');
+        expect(paths.syncDirFromTo.firstCall.args[2].exclude)
+            .to.include.members(['mpmissions', 'ban.txt', 'profiles', 'serverDZ.cfg', '@Mod']);
+        expect(steamCmd.updateServer.firstCall.args[0].serverPath).to.equal('/server-staged');
+        expect(steamCmd.installMods).to.be.calledOnceWith('/server-staged');
+        expect(staged.getStatus().state).to.equal('ready');
+        expect(JSON.parse(fs.readFileSync('/meta/staged-update.json') + '').state).to.equal('ready');
+
+        steamCmd.updateAllMods.resolves(false);
+        expect(await staged.prepare()).to.be.false;
+        expect(staged.getStatus().state).to.equal('none');
+        expect(staged.getStatus().lastError).to.be.not.empty;
+    });
+
+    it('StagedUpdates-prepare-linked', async () => {
+        const staged = injector.resolve(StagedUpdates);
+
+        manager.config.linkModFiles = 'hardlink';
+        expect(await staged.prepare()).to.be.false;
+        expect(staged.getStatus().lastError).to.include('linkModFiles');
+
+        manager.config.linkModFiles = 'off';
+        manager.config.linkModDirs = true;
+        expect(await staged.prepare()).to.be.false;
+
+        expect(paths.syncDirFromTo.called).to.be.false;
+        expect(steamCmd.updateAllMods.called).to.be.false;
+    });
+
+    it('StagedUpdates-swap-commit', async () => {
+        fs.writeFileSync('/meta/staged-update.json', JSON.stringify({ state: 'ready', since: 0 }));
+        const staged = injector.resolve(StagedUpdates);
+
+        expect(await staged.applyPending()).to.be.true;
+        await staged.stop();
+
+        expect(fs.readFileSync('/server/DayZServer') + '').to.equal('new');
+        expect(fs.readFileSync('/server/mpmissions/dayzOffline.chernarusplus/storage_1') + '').to.equal('state');
+        expect(fs.readFileSync('/server/profiles/server.log') + '').to.equal('log');
+        expect(fs.readFileSync('/server/serverDZ.cfg') + '').to.equal('cfg');
+        expect(fs.readFileSync('/server-previous/DayZServer') + '').to.equal('old');
+        expect(fs.existsSync('/server-staged')).to.be.false;
+        expect(fs.existsSync('/meta/1234.staged.sync.json')).to.be.false;
+        expect(fs.existsSync('/meta/1234.sync.json')).to.be.true;
+        expect(staged.getStatus().state).to.equal('verifying');
+
+        (monitor as any).serverState = ServerState.STARTED;
+        await staged.checkVerification();
+
+        expect(staged.getStatus().state).to.equal('none');
+        expect(staged.getStatus().lastCommit).to.be.greaterThan(0);
+        expect(fs.existsSync('/server-previous')).to.be.false;
+        expect(fs.readFileSync('/server-staged/DayZServer') + '').to.equal('old');
+    });
+
+    it('StagedUpdates-rollback', async () => {
+        fs.writeFileSync('/meta/staged-update.json', JSON.stringify({ state: 'ready', since: 0 }));
+        const staged = injector.resolve(StagedUpdates);
+
+        expect(await staged.applyPending()).to.be.true;
+        await staged.stop();
+        fs.writeFileSync('/server/profiles/crash.log', 'crash');
+
+        // started again before the update was verified
+        expect(await staged.applyPending()).to.be.true;
+
+        expect(fs.readFileSync('/server/DayZServer') + '').to.equal('old');
+        expect(fs.readFileSync('/server/mpmissions/dayzOffline.chernarusplus/storage_1') + '').to.equal('state');
+        expect(fs.readFileSync('/server/profiles/crash.log') + '').to.equal('crash');
+        expect(fs.readFileSync('/server-staged/DayZServer') + '').to.equal('new');
+        expect(fs.existsSync('/server-previous')).to.be.false;
+        expect(staged.getStatus().state).to.equal('none');
+        expect(staged.getStatus().lastRollback).to.be.greaterThan(0);
+
+        expect(await staged.applyPending()).to.be.false;
+    });
+
+    it('StagedUpdates-startTimeout', async () => {
+        fs.writeFileSync('/meta/staged-update.json', JSON.stringify({ state: 'ready', since: 0 }));
+        const staged = injector.resolve(StagedUpdates);
+        staged.startTimeout = -1;
+
+        expect(await staged.applyPending()).to.be.true;
+        await staged.stop();
+
+        (monitor as any).serverState = ServerState.STARTING;
+        await staged.checkVerification();
+
+        expect(monitor.killServer).to.be.calledOnceWith(true);
+        expect(staged.getStatus().state).to.equal('rollback');
+    });
+
+});
@@ -1,7 +1,7 @@
 import 'reflect-metadata';
 
 import { expect } from '../expect';
-import { StubInstance, disableConsole, enableConsole, fakeChildProcess, fakeHttps, memfs, stubClass } from '../util';
+import { StubInstance, disableConsole, enableConsole, fakeChildProcess, fakeHttps, memfs, sleep, stubClass } from '../util';
 import * as path from 'path';
 import * as requestModule from '../../src/util/request';
 import { SteamCMD, SteamMetaData } from '../../src/services/steamcmd';
@@ -181,6 +181,58 @@ describe('Test class SteamMetaData', () => {
         expect(response).not.to.include('4321');
     });
 
+    it('SteamMetaData-workshopCache', async () => {
+        fs = memfs({}, '/', injector);
+
+        manager.config = {
+            steamMetaPath: '/metadata',
+            steamWorkshopMetaCacheTime: 300,
+        } as Partial<Config> as Config;
+
+        const requestStub = ImportMock.mockFunction(requestModule, 'request');
+        requestStub.resolves({
+            statusCode: 200,
+            body: JSON.stringify({
+                response: {
+                    result: 200,
+                    resultcount: 1,
+                    publishedfiledetails: [
+                        {
+                            publishedfileid: '1234',
+                            title: 'Test Mod',
+                            description: 'very long description',
+                            file_size: '1000',
+                            time_updated: 2000,
+                        },
+                    ],
+                },
+            }),
+        });
+
+        const steamMeta = injector.resolve(SteamMetaData);
+
+        const first = await steamMeta.getModsMetaData(['1234']);
+        expect(first[0].title).to.equal('Test Mod');
+        expect(first[0].description).to.be.undefined;
+        expect(fs.existsSync('/metadata/workshop-cache.json')).to.be.true;
+
+        // served from the persisted cache after a restart
+        steamMeta['workshopMetaData'] = undefined;
+        const cached = await steamMeta.getModsMetaData(['1234']);
+        expect(cached[0].time_updated).to.equal(2000);
+        expect(requestStub.callCount).to.equal(1);
+
+        // outdated entries are kept if the request fails
+        manager.config.steamWorkshopMetaCacheTime = 0;
+        requestStub.resolves({ statusCode: 500 });
+        const stale = await steamMeta.getModsMetaData(['1234']);
+        expect(stale[0].title).to.equal('Test Mod');
+        expect(requestStub.callCount).to.equal(2);
+
+        expect(await steamMeta.getModsMetaData(['1234', '5678'], { cachedOnly: true })).to.have.lengthOf(1);
+        expect(requestStub.callCount).to.equal(2);
+    });
+
 });
 
 describe('Test class SteamCMD', () => {
@@ -221,6 +273,9 @@ describe('Test class SteamCMD', () => {
         processes = injector.resolve(Processes) as any;
         steamMeta = injector.resolve(SteamMetaData) as any;
         eventBus = injector.resolve(EventBus);
+
+        // single instance, steamcmd and the workshop share the working dir
+        paths.sharedCwd.callsFake(() => paths.cwd());
     });
 
     it('SteamCmd-checkSteamCmd-cleanupDownloadFail', async () => {
@@ -549,6 +604,89 @@ describe('Test class SteamCMD', () => {
     });
 
     
+    it('SteamCmd-updateMods-parallel', async () => {
+
+        fs = memfs(
+            {
+                'testcwd': {
+                    'SteamCMD': {
+                        'steamcmd.sh': '',
+                        'steamcmd.exe': '',
+                    },
+                    'testserver': {},
+                },
+            },
+            '/',
+            injector,
+        );
+        paths.cwd.returns('/testcwd');
+        paths.syncDirFromTo.resolves(true);
+        paths.copyDirFromTo.resolves(true);
+        paths.findFilesInDir.resolves([]);
+
+        manager.config = {
+            steamCmdPath: 'SteamCMD',
+            steamWorkshopPath: 'testwspath',
+            updateModsMaxBatchSize: 1,
+            updateModsWorkers: 2,
+        } as any;
+        manager.getCombinedModIdList.returns(['1111111', '2222222', '3333333']);
+        manager.getServerPath.returns('/testcwd/testserver');
+
+        const localMeta: Record<string, any> = {};
+        steamMeta.getMetaDataPath.returns('/testcwd/meta');
+        steamMeta.readLocalMeta.callsFake((modId) => localMeta[modId] ?? {});
+        steamMeta.updateLocalModMeta.callsFake((modId, update) => {
+            localMeta[modId] = { ...localMeta[modId], ...update };
+        });
+        steamMeta.modNeedsUpdate.callsFake(async (mods) => mods);
+        steamMeta.getModsMetaData.resolves([
+            { 'publishedfileid': '1111111', 'file_size': String(5_000_000_000) } as PublishedFileDetail,
+            { 'publishedfileid': '2222222', 'file_size': '1000' } as PublishedFileDetail,
+            { 'publishedfileid': '3333333', 'file_size': '1000' } as PublishedFileDetail,
+        ]);
+
+        const spawnStub = processes.spawnForOutput.callsFake(async (cmd, args) => {
+            const installDir = args[args.indexOf('+force_install_dir') + 1];
+            for (let i = args.indexOf('+workshop_download_item'); i >= 0; i = args.indexOf('+workshop_download_item', i + 1)) {
+                const modId = args[i + 2];
+                fs.mkdirSync(`${installDir}/steamapps/workshop/content/${DAYZ_APP_ID}/${modId}`, { recursive: true });
+                fs.writeFileSync(
+                    `${installDir}/steamapps/workshop/content/${DAYZ_APP_ID}/${modId}/meta.cpp`,
+                    `name = "Test Mod ${modId}"`,
+                );
+            }
+            return {
+                status: 0,
+                stderr: '',
+                stdout: '',
+            };
+        });
+
+        const steamCmd = injector.resolve(SteamCMD);
+        const res = await steamCmd.updateAllMods({ install: true });
+
+        expect(res).to.be.true;
+        expect(spawnStub.callCount).to.equal(3);
+
+        // the large mod is downloaded alone, the others by the second workspace
+        expect(localMeta['1111111']?.workspace).to.be.undefined;
+        expect(localMeta['2222222'].workspace).to.equal(1);
+        expect(localMeta['3333333'].workspace).to.equal(1);
+        expect(spawnStub.getCalls().map((x) => path.dirname(x.args[0])))
+            .to.include.members([path.join('/testcwd', 'SteamCMD'), path.join('/testcwd', 'SteamCMD-1')]);
+        expect(paths.syncDirFromTo).to.be.calledWith(path.join('/testcwd', 'SteamCMD'), path.join('/testcwd', 'SteamCMD-1'));
+        expect(steamCmd.getWsModDir('2222222')).to.equal(path.join('/testcwd', 'testwspath-1', 'steamapps/workshop/content', DAYZ_APP_ID, '2222222'));
+
+        // installed while downloading
+        expect(paths.copyDirFromTo.callCount).to.equal(3);
+        const timeline = steamCmd.lastModUpdateTimeline!;
+        expect(timeline.workers).to.equal(2);
+        expect(timeline.mods).to.equal(3);
+        expect(timeline.batches.length).to.equal(3);
+        expect(timeline.batches.every((x) => x.success && x.installEnd)).to.be.true;
+    });
+
     it('SteamCmd-checkMods', async () => {
 
        fs = memfs(
@@ -723,6 +861,146 @@ describe('Test class SteamCMD', () => {
         expect(fs.readFileSync('/testcwd/testserver/keys/testkey.bikey') + '').to.equal('bikey');
     });
 
+    it('SteamCmd-installMods-sync', async () => {
+        fs = memfs(
+            {
+                'testcwd': {
+                    'testwspath/steamapps/workshop/content': {
+                        [DAYZ_APP_ID]: {
+                            '1234567': {
+                                'meta.cpp': 'name = "Test Mod"',
+                                'modKeys': {
+                                    'testkey.bikey': 'bikey',
+                                }
+                            },
+                        },
+                    },
+                    'testserver': {},
+                },
+            },
+            '/',
+            injector,
+        );
+        paths.cwd.returns('/testcwd');
+        paths.findFilesInDir.resolves([
+            `/testcwd/testwspath/steamapps/workshop/content/${DAYZ_APP_ID}/1234567/modKeys/testkey.bikey`,
+        ]);
+        paths.syncDirFromTo.resolves(true);
+        steamMeta.getMetaDataPath.returns('/testcwd/meta');
+
+        manager.config = {
+            steamWorkshopPath: 'testwspath',
+            linkModDirs: false,
+            copyModIncremental: true,
+        } as any;
+        manager.getCombinedModIdList.returns(['1234567']);
+        manager.getServerPath.returns('/testcwd/testserver');
+
+        const steamCmd = injector.resolve(SteamCMD);
+
+        const res = await steamCmd.installMods();
+        expect(res).to.be.true;
+        expect(paths.syncDirFromTo.firstCall.args).to.include(path.join('/testcwd', 'testserver', '@Test-Mod'));
+        expect(paths.copyDirFromTo).to.be.not.called;
+        
+        expect(fs.readFileSync('/testcwd/testserver/keys/testkey.bikey') + '').to.equal('bikey');
+    });
+
+    it('SteamCmd-installMods-linkFiles', async () => {
+        fs = memfs(
+            {
+                'testcwd': {
+                    'testwspath/steamapps/workshop/content': {
+                        [DAYZ_APP_ID]: {
+                            '1234567': {
+                                'meta.cpp': 'name = "Test Mod"',
+                                'modKeys': {
+                                    'testkey.bikey': 'bikey',
+                                }
+                            },
+                        },
+                    },
+                    'testserver': {},
+                },
+            },
+            '/',
+            injector,
+        );
+        paths.cwd.returns('/testcwd');
+        paths.findFilesInDir.resolves([
+            `/testcwd/testwspath/steamapps/workshop/content/${DAYZ_APP_ID}/1234567/modKeys/testkey.bikey`,
+        ]);
+        paths.syncDirFromTo.resolves(true);
+        steamMeta.getMetaDataPath.returns('/testcwd/meta');
+
+        manager.config = {
+            steamWorkshopPath: 'testwspath',
+            linkModDirs: false,
+            linkModFiles: 'symlink',
+        } as any;
+        manager.getCombinedModIdList.returns(['1234567']);
+        manager.getServerPath.returns('/testcwd/testserver');
+
+        const steamCmd = injector.resolve(SteamCMD);
+
+        const res = await steamCmd.installMods();
+        expect(res).to.be.true;
+        expect(paths.syncDirFromTo.firstCall.args).to.include(path.join('/testcwd', 'testserver', '@Test-Mod'));
+        expect(paths.syncDirFromTo.firstCall.args[2].mode).to.equal('symlink');
+        expect(paths.copyDirFromTo).to.be.not.called;
+        
+        expect(fs.readFileSync('/testcwd/testserver/keys/testkey.bikey') + '').to.equal('bikey');
+    });
+
+    it('SteamCmd-installMod-whileUpdating', async () => {
+        fs = memfs(
+            {
+                'testcwd': {
+                    'testwspath/steamapps/workshop/content': {
+                        [DAYZ_APP_ID]: {
+                            '1234567': {
+                                'meta.cpp': 'name = "Test Mod"',
+                            },
+                        },
+                    },
+                    'testserver': {},
+                },
+            },
+            '/',
+            injector,
+        );
+        paths.cwd.returns('/testcwd');
+        paths.syncDirFromTo.resolves(true);
+        steamMeta.getMetaDataPath.returns('/testcwd/meta');
+
+        manager.config = {
+            steamWorkshopPath: 'testwspath',
+            linkModFiles: 'hardlink',
+        } as any;
+        manager.getServerPath.returns('/testcwd/testserver');
+
+        let finishDownload: () => void;
+        processes.spawnForOutput.callsFake(() => new Promise((r) => {
+            finishDownload = () => r({ status: 0, stdout: '', stderr: '' });
+        }));
+
+        const steamCmd = injector.resolve(SteamCMD);
+        const update = steamCmd.updateMod(['1234567']);
+        while (!processes.spawnForOutput.called) {
+            await sleep(1);
+        }
+
+        // i.e. by another instance, which shares the workshop
+        const install = steamCmd.installMod('1234567');
+        await sleep(10);
+        expect(paths.syncDirFromTo).to.be.not.called;
+
+        finishDownload!();
+        expect(await update).to.be.true;
+        expect(await install).to.be.true;
+        expect(paths.syncDirFromTo).to.be.calledOnce;
+    });
+
     it('SteamCmd-installMods-link', async () => {
         fs = memfs(
             {
@@ -0,0 +1,211 @@
+import { expect } from '../expect';
+import * as sinon from 'sinon';
+import * as fsModule from 'fs';
+import { EventEmitter } from 'events';
+import { disableConsole, enableConsole, memfs, sleep } from '../util';
+import { DependencyContainer, Lifecycle, container } from 'tsyringe';
+import { WorkerPool } from '../../src/services/worker-pool';
+import { TaskTracker } from '../../src/services/task-tracker';
+import { InjectionTokens } from '../../src/util/apis';
+import { WorkerRequest } from '../../src/util/worker-jobs';
+
+class FakeWorker extends EventEmitter {
+    public postMessage = sinon.stub();
+    public terminate = sinon.stub().resolves(0);
+
+    public get request(): WorkerRequest {
+        return this.postMessage.lastCall?.args[0];
+    }
+
+    public respond(result?: any, error?: string): void {
+        this.emit('message', { id: this.request.id, result, error });
+    }
+}
+
+describe('Test class TaskTracker', () => {
+
+    it('TaskTracker-track', async () => {
+        const tracker = new TaskTracker();
+        let now = 1000;
+        sinon.stub(tracker, 'now').callsFake(() => now);
+
+        const short = tracker.begin('short');
+        now = 1010;
+        tracker.end(short);
+        // unknown ids are ignored
+        tracker.end(12345);
+
+        const running = tracker.begin('copyDir', true);
+        expect(tracker.getRunning().map((x) => x.id)).to.deep.equal([running]);
+
+        now = 2000;
+        expect(await tracker.track('long', () => {
+            now = 2500;
+            return 'done';
+        })).to.equal('done');
+        await expect(tracker.track('failing', async () => {
+            throw new Error('test');
+        })).to.be.rejectedWith('test');
+        expect(() => tracker.trackSync('blocking', () => {
+            now = 2550;
+            throw new Error('test');
+        })).to.throw('test');
+
+        // longest first, finished tasks only if they overlap
+        expect(tracker.getTasksBetween(2100, 2600).map((x) => x.name)).to.deep.equal(['copyDir', 'long', 'blocking', 'failing']);
+        expect(tracker.getTasksBetween(1005, 1006).map((x) => x.name)).to.deep.equal(['short', 'copyDir']);
+        expect(tracker.getRunning().length).to.equal(1);
+    });
+
+});
+
+describe('Test class WorkerPool', () => {
+
+    let injector: DependencyContainer;
+    let workers: FakeWorker[];
+
+    before(() => {
+        disableConsole();
+    });
+
+    after(() => {
+        enableConsole();
+    });
+
+    beforeEach(() => {
+        container.reset();
+        injector = container.createChildContainer();
+        injector.register(TaskTracker, TaskTracker, { lifecycle: Lifecycle.Singleton });
+        workers = [];
+    });
+
+    const createPool = (): WorkerPool => {
+        injector.register(InjectionTokens.fs, { useValue: fsModule });
+        const pool = injector.resolve(WorkerPool);
+        sinon.stub(pool, 'createWorker').callsFake(() => {
+            const worker = new FakeWorker();
+            workers.push(worker);
+            return worker as any;
+        });
+        return pool;
+    };
+
+    it('WorkerPool-inline', async () => {
+        const fs = memfs({ '/test.json': '{"a":1}' }, '/', injector);
+        const pool = injector.resolve(WorkerPool);
+        const tracker = injector.resolve(TaskTracker);
+        const trackSpy = sinon.spy(tracker, 'track');
+
+        await pool.start();
+        // workers use the real fs, so the pool stays inline with the fake one
+        pool.setSize(4);
+        expect(pool.getSize()).to.equal(0);
+
+        expect(await pool.run('readJson', '/test.json')).to.deep.equal({ a: 1 });
+        expect(trackSpy.firstCall.args[0]).to.equal('readJson /test.json');
+
+        await pool.run('copyDir', '/test.json', '/copy');
+        expect(fs.existsSync('/copy/test.json')).to.be.true;
+
+        await expect(pool.run('readJson', '/missing.json')).to.be.rejected;
+        await pool.stop();
+    });
+
+    it('WorkerPool-dispatch', async () => {
+        const pool = createPool();
+        const tracker = injector.resolve(TaskTracker);
+
+        pool.setSize();
+        expect(pool.getSize()).to.equal(WorkerPool.DEFAULT_SIZE);
+
+        const job1 = pool.run('readJson', '/1.json');
+        const job2 = pool.run('sameDirHash', '/a', '/b');
+        const job3 = pool.run('readJson', '/3.json');
+        expect(workers.length).to.equal(2);
+        expect(workers[0].request).to.include({ job: 'readJson' });
+        expect(workers[1].request.args).to.deep.equal(['/a', '/b']);
+        expect(tracker.getRunning().map((x) => x.worker)).to.deep.equal([true, true, true]);
+
+        // responses of other jobs are ignored
+        workers[0].emit('message', { id: 12345, result: 'wrong' });
+        workers[0].respond({ a: 1 });
+        expect(await job1).to.deep.equal({ a: 1 });
+
+        // idle worker takes the queued job
+        expect(workers.length).to.equal(2);
+        expect(workers[0].request.args).to.deep.equal(['/3.json']);
+        workers[0].respond(undefined, 'broken json');
+        await expect(job3).to.be.rejectedWith('broken json');
+
+        workers[1].respond(true);
+        expect(await job2).to.be.true;
+        expect(tracker.getRunning().length).to.equal(0);
+
+        // shrinking terminates idle workers
+        pool.setSize(1);
+        expect(workers[0].terminate.callCount + workers[1].terminate.callCount).to.equal(1);
+
+        await pool.stop();
+        expect(pool.getSize()).to.equal(0);
+    });
+
+    it('WorkerPool-exit', async () => {
+        const pool = createPool();
+        pool.setSize(1);
+
+        const job1 = pool.run('readJson', '/1.json');
+        const job2 = pool.run('readJson', '/2.json');
+
+        workers[0].emit('error', new Error('crashed'));
+        workers[0].emit('exit', 1);
+        await expect(job1).to.be.rejectedWith('Worker exited while running readJson');
+
+        // replaced for the queued job
+        expect(workers.length).to.equal(2);
+        expect(workers[1].request.args).to.deep.equal(['/2.json']);
+
+        // exits of removed workers are ignored
+        workers[0].emit('exit', 1);
+        expect(workers.length).to.equal(2);
+
+        const job3 = pool.run('readJson', '/3.json');
+        await pool.stop();
+
+        // stopped pools run inline
+        await sleep(1);
+        await expect(pool.run('readJson', '/missing/test.json')).to.be.rejected;
+        expect(workers.length).to.equal(2);
+
+        // running and queued jobs are finished before the worker is terminated
+        expect(workers[1].terminate.called).to.be.false;
+        workers[1].respond(2);
+        expect(await job2).to.equal(2);
+        expect(workers[1].request.args).to.deep.equal(['/3.json']);
+        workers[1].respond(3);
+        expect(await job3).to.equal(3);
+        expect(workers[1].terminate.called).to.be.true;
+    });
+
+    it('WorkerPool-reload', async () => {
+        const pool = createPool();
+        const tracker = injector.resolve(TaskTracker);
+        pool.setSize(1);
+
+        const job1 = pool.run('syncDir', '/a', '/b', {});
+        // the services are stopped and started again on config reloads
+        await pool.stop();
+        pool.setSize(2);
+        const job2 = pool.run('readJson', '/2.json');
+
+        // the running worker is kept
+        expect(workers.length).to.equal(2);
+        expect(workers[0].terminate.called).to.be.false;
+        workers[0].respond(true);
+        workers[1].respond({ a: 1 });
+        expect(await job1).to.be.true;
+        expect(await job2).to.deep.equal({ a: 1 });
+        expect(tracker.getRunning().length).to.equal(0);
+        expect(workers.some((x) => x.terminate.called)).to.be.false;
+    });
+
+});
@@ -141,3 +141,105 @@ export const fakeHttps = (
 
     return https;
 };
+
+const asciiz = (str: string): Buffer => Buffer.from(`${str}\0`);
+
+const uint32 = (...values: number[]): Buffer => {
+    const buf = Buffer.alloc(values.length * 4);
+    values.forEach((x, i) => buf.writeUInt32LE(x, i * 4));
+    return buf;
+};
+
+/**
+ * Builds a pbo archive, entries with an originalSize are marked as compressed (data must be compressed already)
+ */
+export const buildPbo = (
+    entries: { name: string; data: string | Buffer; originalSize?: number }[],
+    properties: Record<string, string> = {},
+): Buffer => {
+    const parts: Buffer[] = [asciiz(''), uint32(0x56657273, 0, 0, 0, 0)];
+    for (const key of Object.keys(properties)) {
+        parts.push(asciiz(key), asciiz(properties[key]));
+    }
+    parts.push(asciiz(''));
+    const data = entries.map((x) => Buffer.from(x.data));
+    entries.forEach((x, i) => parts.push(
+        asciiz(x.name),
+        uint32(x.originalSize ? 0x43707273 : 0, x.originalSize ?? 0, 0, 0, data[i].length),
+    ));
+    parts.push(asciiz(''), uint32(0, 0, 0, 0, 0), ...data);
+    return Buffer.concat(parts);
+};
+
+/**
+ * Binarizes a config in the structure of ConfigParser.cfg2json (integers as int, other numbers as float)
+ */
+export const rapify = (config: Record<string, any>): Buffer => {
+    const compressedInt = (value: number): Buffer => {
+        const bytes: number[] = [];
+        do {
+            bytes.push((value & 0x7f) | (value > 0x7f ? 0x80 : 0));
+            value >>= 7;
+        } while (value);
+        return Buffer.from(bytes);
+    };
+    const scalar = (value: any): Buffer => {
+        if (typeof value === 'string') {
+            return Buffer.concat([Buffer.from([0]), asciiz(value)]);
+        }
+        const buf = Buffer.alloc(5);
+        if (Number.isInteger(value)) {
+            buf[0] = 2;
+            buf.writeInt32LE(value, 1);
+        } else {
+            buf[0] = 1;
+            buf.writeFloatLE(value, 1);
+        }
+        return buf;
+    };
+    const array = (values: any[]): Buffer => Buffer.concat([
+        compressedInt(values.length),
+        ...values.map((x) => (Array.isArray(x) ? Buffer.concat([Buffer.from([3]), array(x)]) : scalar(x))),
+    ]);
+
+    const chunks: Buffer[] = [];
+    let size = 16;
+    const writeClass = (cls: Record<string, any>): number => {
+        const keys = Object.keys(cls).filter((x) => x !== '__inherited');
+        const parts = [asciiz(cls.__inherited ?? ''), compressedInt(keys.length)];
+        const children: { pos: number; cls: any }[] = [];
+        let length = parts[0].length + parts[1].length;
+        for (const key of keys) {
+            const value = cls[key];
+            let entry: Buffer;
+            const extend = /^(.*)(\+|-)=$/.exec(key);
+            if (Array.isArray(value) && extend) {
+                // 'name+=' and 'name-=' are written as array extensions with flags
+                entry = Buffer.concat([Buffer.from([5]), uint32(extend[2] === '+' ? 1 : 2), asciiz(extend[1]), array(value)]);
+            } else if (Array.isArray(value)) {
+                entry = Buffer.concat([Buffer.from([2]), asciiz(key), array(value)]);
+            } else if (typeof value === 'object') {
+                entry = Buffer.concat([Buffer.from([0]), asciiz(key), uint32(0)]);
+                children.push({ pos: length + entry.length - 4, cls: value });
+            } else {
+                // value entries are: 1, value type, name, value
+                const typed = scalar(value);
+                entry = Buffer.concat([Buffer.from([1, typed[0]]), asciiz(key), typed.subarray(1)]);
+            }
+            parts.push(entry);
+            length += entry.length;
+        }
+        const body = Buffer.concat(parts);
+        chunks.push(body);
+        const offset = size;
+        size += body.length;
+        for (const child of children) {
+            body.writeUInt32LE(writeClass(child.cls), child.pos);
+        }
+        return offset;
+    };
+    writeClass(config);
+
+    const header = Buffer.concat([Buffer.from([0, 0x72, 0x61, 0x50]), uint32(0, 8, size)]);
+    return Buffer.concat([header, ...chunks, uint32(0)]);
+};
@@ -0,0 +1,82 @@
+import { expect } from '../expect';
+import * as crypto from 'crypto';
+import { BackupStore } from '../../src/util/backup-store';
+import { memfs } from '../util';
+
+describe('Test class BackupStore', () => {
+
+    const createFs = () => {
+        const fs = memfs({
+            'mpmissions': {
+                'dayzOffline.chernarusplus': {
+                    'init.c': 'void main() {}',
+                    'storage_1': {},
+                },
+                'empty.txt': '',
+            },
+        }, '/');
+        fs.writeFileSync('/mpmissions/dayzOffline.chernarusplus/storage_1/players.db', crypto.randomBytes(3 * 1024 * 1024));
+        return fs;
+    };
+
+    it('BackupStore-dedup', async () => {
+        const fs = createFs();
+        const store = new BackupStore(fs, '/backups');
+
+        const first = await store.createBackup('/mpmissions', 'mpmissions_1');
+        expect(first.files).to.equal(3);
+        expect(first.newChunks).to.equal(first.chunks);
+        expect(first.chunks).to.be.greaterThan(3);
+
+        // unchanged files are not read again
+        const second = await store.createBackup('/mpmissions', 'mpmissions_2');
+        expect(second).to.deep.include({ files: 3, reused: 3, newChunks: 0, newBytes: 0 });
+
+        // inserting data only changes the chunks around the insert
+        const db = '/mpmissions/dayzOffline.chernarusplus/storage_1/players.db';
+        const content = fs.readFileSync(db) as Buffer;
+        fs.writeFileSync(db, Buffer.concat([content.subarray(0, 1024 * 1024), Buffer.from('inserted'), content.subarray(1024 * 1024)]));
+        const third = await store.createBackup('/mpmissions', 'mpmissions_3');
+        expect(third.reused).to.equal(2);
+        expect(third.newChunks).to.be.greaterThan(0);
+        expect(third.newChunks).to.be.lessThan(3);
+
+        expect(store.listBackups()).to.include.members(['mpmissions_1', 'mpmissions_2', 'mpmissions_3']);
+    });
+
+    it('BackupStore-restore', async () => {
+        const fs = createFs();
+        const store = new BackupStore(fs, '/backups');
+
+        await store.createBackup('/mpmissions', 'mpmissions_1');
+        await store.restore('mpmissions_1', '/restored');
+
+        for (const file of [
+            'dayzOffline.chernarusplus/init.c',
+            'dayzOffline.chernarusplus/storage_1/players.db',
+            'empty.txt',
+        ]) {
+            expect((fs.readFileSync(`/restored/${file}`) as Buffer).equals(fs.readFileSync(`/mpmissions/${file}`) as Buffer)).to.be.true;
+        }
+        expect(fs.statSync('/restored/empty.txt').mtime.getTime())
+            .to.equal(fs.statSync('/mpmissions/empty.txt').mtime.getTime());
+    });
+
+    it('BackupStore-gc', async () => {
+        const fs = createFs();
+        const store = new BackupStore(fs, '/backups');
+
+        await store.createBackup('/mpmissions', 'mpmissions_1');
+        fs.writeFileSync('/mpmissions/dayzOffline.chernarusplus/storage_1/players.db', crypto.randomBytes(1024 * 1024));
+        await store.createBackup('/mpmissions', 'mpmissions_2');
+
+        expect(await store.gc()).to.equal(0);
+
+        await store.remove('mpmissions_1');
+        expect(await store.gc()).to.be.greaterThan(0);
+
+        await store.restore('mpmissions_2', '/restored');
+        expect((fs.readFileSync('/restored/dayzOffline.chernarusplus/storage_1/players.db') as Buffer).length).to.equal(1024 * 1024);
+    });
+
+});
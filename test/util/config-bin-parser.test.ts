@@ -0,0 +1,77 @@
+import { expect } from '../expect';
+import { isConfigBin, parseConfigBin } from '../../src/util/config-bin-parser';
+import { ConfigParser } from '../../src/util/config-parser';
+import { rapify } from '../util';
+
+describe('Test config bin parser', () => {
+
+    const CONFIG_CPP = `
+        class CfgPatches
+        {
+            class Test
+            {
+                units[] = {};
+                requiredAddons[] = {"DZ_Data"};
+            };
+        };
+        class CfgVehicles
+        {
+            class Inventory_Base;
+            class Apple: Inventory_Base
+            {
+                scope = 2;
+                displayName = "Apple";
+                weight = 0.1;
+                itemSize[] = {1,2};
+                healthLevels[] = {{1,{"a.rvmat"}},{0.5,{"b.rvmat"}}};
+                class Nutrition
+                {
+                    energy = 45;
+                };
+            };
+        };
+    `;
+
+    it('ConfigBinParser-parse', () => {
+        const expected = new ConfigParser().cfg2json(CONFIG_CPP);
+        const bin = rapify(expected);
+
+        expect(isConfigBin(bin)).to.be.true;
+        expect(parseConfigBin(bin)).to.deep.equal(expected);
+        expect(parseConfigBin(bin).CfgVehicles.Apple.weight).to.equal(0.1);
+    });
+
+    it('ConfigBinParser-extend', () => {
+        const bin = rapify({
+            Apple: {
+                'inventorySlot': ['Slot1', 'Slot2', 'Slot3'],
+                'inventorySlot+=': ['Slot4'],
+                'inventorySlot-=': ['Slot2'],
+                'healthLevels-=': [[1, 'a.rvmat']],
+            },
+        });
+        const expected = new ConfigParser().cfg2json(`
+            class Apple
+            {
+                inventorySlot[] = {"Slot1","Slot2","Slot3"};
+                inventorySlot[] += {"Slot4"};
+                inventorySlot[] -= {"Slot2"};
+                healthLevels[] -= {{1,"a.rvmat"}};
+            };
+        `);
+
+        expect(parseConfigBin(bin)).to.deep.equal(expected);
+        expect(expected.Apple.inventorySlot).to.deep.equal(['Slot1', 'Slot3', 'Slot4']);
+        expect(expected.Apple.healthLevels).to.deep.equal([]);
+    });
+
+    it('ConfigBinParser-invalid', () => {
+        expect(isConfigBin(Buffer.from(CONFIG_CPP))).to.be.false;
+        expect(() => parseConfigBin(Buffer.from(CONFIG_CPP))).to.throw();
+
+        // truncated
+        const bin = rapify({ CfgVehicles: { Apple: { scope: 2 } } });
+        expect(() => parseConfigBin(bin.subarray(0, bin.length - 12))).to.throw();
+    });
+
+});
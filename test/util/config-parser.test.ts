@@ -103,7 +103,75 @@ describe('Test class config parser', () => {
         expect(stringified).to.contain('serverTime="SystemTime"');
         expect(stringified).to.contain('storeHouseStateDisabled=false');
         expect(stringified).to.contain('storageAutoFix=1');
-        
+
+    });
+
+    it('ConfigParser-legacy-parity', () => {
+        const parser = new ConfigParser();
+        expect(parser.cfg2json(DEFAULT_CFG)).to.deep.equal(parser.cfg2jsonLegacy(DEFAULT_CFG));
+    });
+
+    it('ConfigParser-config-cpp', () => {
+        const parser = new ConfigParser();
+        const includes = {
+            'items.hpp': 'class CfgVehicles { class Inventory_Base; class Apple: Inventory_Base { scope = 2; }; };',
+        };
+
+        const parsed = parser.cfg2json(`
+            #define DZ_PATCH(x) x \\
+                continued
+            #include "items.hpp"
+            /* class Commented { }; */
+            class CfgVehicles
+            {
+                class Apple
+                {
+                    displayName = "An ""Apple""";
+                    model = \\dz\\apple.p3d; // unquoted
+                    healthLevels[] = {{1.0,{"a.rvmat"}},{0.5,{"b.rvmat"}}};
+                    inventorySlot[] = {"Slot1"};
+                    inventorySlot[] += {"Slot2"};
+                    canBeSplit = TRUE;
+                    weight = -1.5e2
+                };
+                enum { A = 1, B };
+                class Removed {};
+                delete Removed;
+            };
+        `, { include: (file) => includes[file] });
+
+        const apple = parsed.CfgVehicles.Apple;
+        expect(apple.__inherited).to.equal('Inventory_Base');
+        expect(apple.scope).to.equal(2);
+        expect(apple.displayName).to.equal('An "Apple"');
+        expect(apple.model).to.equal('\\dz\\apple.p3d');
+        expect(apple.healthLevels).to.deep.equal([[1, ['a.rvmat']], [0.5, ['b.rvmat']]]);
+        expect(apple.inventorySlot).to.deep.equal(['Slot1', 'Slot2']);
+        expect(apple.canBeSplit).to.be.true;
+        expect(apple.weight).to.equal(-150);
+        expect(parsed.CfgVehicles.Removed).to.be.undefined;
+        expect(parsed.Commented).to.be.undefined;
+        expect(parsed.CfgVehicles.Inventory_Base).to.be.undefined;
+    });
+
+    it('ConfigParser-crlf', () => {
+        const parser = new ConfigParser();
+        const parsed = parser.cfg2json(
+            '#define MACRO(x) x \\\r\n    continued;\r\nhostname = "A ""quoted"" name";\r\nmotd[] = {"say ""hi"""};\r\n',
+        );
+        expect(parsed).to.deep.equal({ hostname: 'A "quoted" name', motd: ['say "hi"'] });
+
+        // serverDZ.cfg round trips
+        const stringified = parser.json2cfg(parsed);
+        expect(stringified).to.contain('hostname="A ""quoted"" name";');
+        expect(parser.cfg2json(stringified)).to.deep.equal(parsed);
+    });
+
+    it('ConfigParser-errors', () => {
+        const parser = new ConfigParser();
+        expect(() => parser.cfg2json('class A\n{\n x = 1;\n')).to.throw(/input:4/);
+        expect(() => parser.cfg2json('x = "open;')).to.throw(/Unterminated/);
+        expect(() => parser.cfg2json('x[] = {1, 2')).to.throw(/array/);
     });
 
 });
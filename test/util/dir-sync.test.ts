@@ -0,0 +1,184 @@
+import { expect } from '../expect';
+import { DirSync } from '../../src/util/dir-sync';
+import { memfs } from '../util';
+
+describe('Test class DirSync', () => {
+
+    const createFs = () => memfs({
+        'source': {
+            'Addons': {
+                'Mod.pbo': 'pbo',
+                'Mod.pbo.key.bisign': 'sign',
+            },
+            'meta.cpp': 'name = "Test Mod"',
+        },
+        'meta': {},
+    }, '/');
+
+    it('DirSync-initial', async () => {
+        const fs = createFs();
+
+        const result = await new DirSync(fs, '/source', '/target', { manifestPath: '/meta/sync.json' }).sync();
+
+        expect(result).to.deep.equal({ copied: 3, removed: 0, unchanged: 0 });
+        expect(fs.readFileSync('/target/Addons/Mod.pbo') + '').to.equal('pbo');
+        expect(fs.readFileSync('/target/meta.cpp') + '').to.equal('name = "Test Mod"');
+        expect(JSON.parse(fs.readFileSync('/meta/sync.json') + '').files['meta.cpp'].hash).to.be.not.empty;
+    });
+
+    it('DirSync-unchanged', async () => {
+        const fs = createFs();
+        const sync = new DirSync(fs, '/source', '/target', { manifestPath: '/meta/sync.json' });
+
+        await sync.sync();
+        const result = await sync.sync();
+
+        expect(result).to.deep.equal({ copied: 0, removed: 0, unchanged: 3 });
+    });
+
+    it('DirSync-changed', async () => {
+        const fs = createFs();
+        const sync = new DirSync(fs, '/source', '/target', { manifestPath: '/meta/sync.json', concurrency: 1 });
+
+        await sync.sync();
+
+        // same size but different content
+        fs.writeFileSync('/source/Addons/Mod.pbo', 'PBO');
+        // touched but same content
+        fs.utimesSync('/source/meta.cpp', new Date(), new Date(Date.now() + 10000));
+        // changed in the target
+        fs.writeFileSync('/target/Addons/Mod.pbo.key.bisign', 'broken');
+
+        const result = await sync.sync();
+
+        expect(result).to.deep.equal({ copied: 2, removed: 0, unchanged: 1 });
+        expect(fs.readFileSync('/target/Addons/Mod.pbo') + '').to.equal('PBO');
+        expect(fs.readFileSync('/target/Addons/Mod.pbo.key.bisign') + '').to.equal('sign');
+    });
+
+    it('DirSync-removed', async () => {
+        const fs = createFs();
+        fs.mkdirSync('/target/Old/Nested', { recursive: true });
+        fs.writeFileSync('/target/Old/Nested/old.pbo', 'old');
+        fs.writeFileSync('/target/old.txt', 'old');
+
+        const result = await new DirSync(fs, '/source', '/target', { manifestPath: '/meta/sync.json' }).sync();
+
+        expect(result).to.deep.equal({ copied: 3, removed: 2, unchanged: 0 });
+        expect(fs.existsSync('/target/old.txt')).to.be.false;
+        expect(fs.existsSync('/target/Old')).to.be.false;
+        expect(fs.existsSync('/target/Addons')).to.be.true;
+    });
+
+    it('DirSync-lowerCase', async () => {
+        const fs = createFs();
+        const sync = new DirSync(fs, '/source', '/target', { manifestPath: '/meta/sync.json', lowerCaseTarget: true });
+
+        await sync.sync();
+        const result = await sync.sync();
+
+        expect(result).to.deep.equal({ copied: 0, removed: 0, unchanged: 3 });
+        expect(fs.readdirSync('/target')).to.include.members(['addons', 'meta.cpp']);
+        expect(fs.readdirSync('/target/addons')).to.include.members(['mod.pbo', 'mod.pbo.key.bisign']);
+    });
+
+    it('DirSync-linked', async () => {
+        const fs = createFs();
+        fs.symlinkSync('/source', '/target');
+
+        const result = await new DirSync(fs, '/source', '/target', { manifestPath: '/meta/sync.json' }).sync();
+
+        expect(result.copied).to.equal(3);
+        expect(fs.lstatSync('/target').isSymbolicLink()).to.be.false;
+        expect(fs.existsSync('/source/meta.cpp')).to.be.true;
+    });
+
+    it('DirSync-hardlink', async () => {
+        const fs = createFs();
+        const sync = new DirSync(fs, '/source', '/target', { manifestPath: '/meta/sync.json', lowerCaseTarget: true, mode: 'hardlink' });
+
+        expect(await sync.sync()).to.deep.equal({ copied: 3, removed: 0, unchanged: 0 });
+        expect(fs.statSync('/target/addons/mod.pbo').ino).to.equal(fs.statSync('/source/Addons/Mod.pbo').ino);
+        // source is left untouched
+        expect(fs.readdirSync('/source/Addons')).to.include('Mod.pbo');
+
+        // replaced in the source (i.e. by an update)
+        fs.unlinkSync('/source/Addons/Mod.pbo');
+        fs.writeFileSync('/source/Addons/Mod.pbo', 'new');
+
+        expect(await sync.sync()).to.deep.equal({ copied: 1, removed: 0, unchanged: 2 });
+        expect(fs.readFileSync('/target/addons/mod.pbo') + '').to.equal('new');
+    });
+
+    it('DirSync-symlink', async () => {
+        const fs = createFs();
+        const sync = new DirSync(fs, '/source', '/target', { manifestPath: '/meta/sync.json', lowerCaseTarget: true, mode: 'symlink' });
+
+        expect(await sync.sync()).to.deep.equal({ copied: 3, removed: 0, unchanged: 0 });
+        expect(fs.readlinkSync('/target/addons/mod.pbo') + '').to.equal('/source/Addons/Mod.pbo');
+        expect(await sync.sync()).to.deep.equal({ copied: 0, removed: 0, unchanged: 3 });
+
+        // switching back to copies must not write through the links
+        const copy = new DirSync(fs, '/source', '/target', { manifestPath: '/meta/sync.json', lowerCaseTarget: true });
+        fs.writeFileSync('/source/meta.cpp', 'changed');
+        expect(await copy.sync()).to.deep.equal({ copied: 3, removed: 0, unchanged: 0 });
+        expect(fs.lstatSync('/target/addons/mod.pbo').isSymbolicLink()).to.be.false;
+        expect(fs.readFileSync('/source/Addons/Mod.pbo') + '').to.equal('pbo');
+    });
+
+    it('DirSync-exclude', async () => {
+        const fs = createFs();
+        fs.mkdirSync('/target/mpmissions', { recursive: true });
+        fs.writeFileSync('/target/Addons', 'was a file');
+        fs.writeFileSync('/target/mpmissions/storage', 'state');
+        fs.symlinkSync('/elsewhere', '/source/link');
+
+        const result = await new DirSync(fs, '/source', '/target', { manifestPath: '/meta/sync.json', exclude: ['mpmissions', 'meta.cpp'] }).sync();
+
+        expect(result).to.deep.equal({ copied: 3, removed: 0, unchanged: 0 });
+        expect(fs.existsSync('/target/meta.cpp')).to.be.false;
+        expect(fs.readFileSync('/target/mpmissions/storage') + '').to.equal('state');
+        expect(fs.readFileSync('/target/Addons/Mod.pbo') + '').to.equal('pbo');
+        expect(fs.readlinkSync('/target/link') + '').to.equal('/elsewhere');
+    });
+
+    it('DirSync-replace', async () => {
+        const fs = createFs();
+        const sync = new DirSync(fs, '/source', '/target', { manifestPath: '/meta/sync.json' });
+        await sync.sync();
+
+        // i.e. a running server or another instance still uses the old file
+        fs.linkSync('/target/Addons/Mod.pbo', '/meta/open.pbo');
+        fs.writeFileSync('/source/Addons/Mod.pbo', 'new pbo');
+
+        expect(await sync.sync()).to.deep.equal({ copied: 1, removed: 0, unchanged: 2 });
+        expect(fs.readFileSync('/target/Addons/Mod.pbo') + '').to.equal('new pbo');
+        expect(fs.readFileSync('/meta/open.pbo') + '').to.equal('pbo');
+        // no leftover temp files
+        expect(fs.readdirSync('/target/Addons')).to.have.members(['Mod.pbo', 'Mod.pbo.key.bisign']);
+    });
+
+    it('DirSync-excludeInRemovedDir', async () => {
+        const fs = createFs();
+        fs.mkdirSync('/target/Old', { recursive: true });
+        fs.writeFileSync('/target/Old/old.pbo', 'old');
+        fs.writeFileSync('/target/Old/keep.txt', 'keep');
+
+        const result = await new DirSync(fs, '/source', '/target', { manifestPath: '/meta/sync.json', exclude: ['Old/keep.txt'] }).sync();
+
+        expect(result).to.deep.equal({ copied: 3, removed: 1, unchanged: 0 });
+        expect(fs.readdirSync('/target/Old')).to.deep.equal(['keep.txt']);
+    });
+
+    it('DirSync-caseCollision', async () => {
+        const fs = createFs();
+        fs.writeFileSync('/source/Meta.cpp', 'other');
+
+        const result = await new DirSync(fs, '/source', '/target', { manifestPath: '/meta/sync.json', lowerCaseTarget: true }).sync();
+
+        expect(result.copied).to.equal(3);
+        expect(result.collisions).to.have.length(1);
+        expect(fs.readdirSync('/target').filter((x) => x === 'meta.cpp')).to.have.length(1);
+    });
+
+});
@@ -0,0 +1,138 @@
+import { expect } from '../expect';
+import * as sinon from 'sinon';
+import { DiscordChannelQueue, DiscordQueueOptions } from '../../src/util/discord-queue';
+import { sleep } from '../util';
+
+describe('Test class DiscordChannelQueue', () => {
+
+    let options: DiscordQueueOptions;
+
+    beforeEach(() => {
+        options = {
+            coalesceWindow: 20,
+            maxQueueSize: 100,
+            rateLimit: 2,
+            rateLimitWindow: 200,
+        };
+    });
+
+    it('DiscordChannelQueue-coalesce', async () => {
+        const send = sinon.stub().resolves();
+        const queue = new DiscordChannelQueue(send, () => options, sinon.stub());
+
+        const embed = { title: 'embed' } as any;
+        await Promise.all([
+            queue.push('line 1', undefined, true),
+            queue.push('line 2', undefined, true),
+            queue.push(undefined, [embed], false),
+        ]);
+
+        expect(send.callCount).to.equal(1);
+        expect(send.firstCall.args[0]).to.deep.equal({ content: 'line 1\nline 2', embeds: [embed] });
+        expect(queue.getStats()).to.include({ depth: 0, sent: 3, requests: 1, dropped: 0, failed: 0 });
+        expect(queue.getStats().maxLatency).to.be.greaterThanOrEqual(15);
+    });
+
+    it('DiscordChannelQueue-split', async () => {
+        const send = sinon.stub().resolves();
+        const queue = new DiscordChannelQueue(send, () => options, sinon.stub());
+
+        const long = 'x'.repeat(1500);
+        const embeds = new Array(8).fill({ title: 'embed' });
+        await Promise.all([
+            queue.push(long, undefined, false),
+            queue.push(long, undefined, false),
+            queue.push(undefined, embeds, false),
+        ]);
+
+        expect(send.callCount).to.equal(2);
+        expect(send.firstCall.args[0]).to.deep.equal({ content: long });
+        expect(send.secondCall.args[0]).to.deep.equal({ content: long, embeds });
+    });
+
+    it('DiscordChannelQueue-too long', async () => {
+        const send = sinon.stub().resolves();
+        const queue = new DiscordChannelQueue(send, () => options, sinon.stub());
+
+        const line = 'x'.repeat(1500);
+        const embed = { title: 'embed' } as any;
+        await Promise.all([
+            queue.push(`${line}\n${line}`, [embed], false),
+            queue.push('y'.repeat(4500), undefined, false),
+        ]);
+
+        const sent = send.getCalls().map((x) => x.args[0]);
+        expect(sent.every((x) => !x.content || x.content.length <= DiscordChannelQueue.MAX_CONTENT_LENGTH)).to.be.true;
+        expect(sent[0]).to.deep.equal({ content: line });
+        expect(sent[1]).to.deep.equal({ content: line, embeds: [embed] });
+        expect(sent.slice(2).map((x) => x.content).join('')).to.equal('y'.repeat(4500));
+    });
+
+    it('DiscordChannelQueue-rate limit', async () => {
+        const send = sinon.stub().resolves();
+        const queue = new DiscordChannelQueue(send, () => options, sinon.stub());
+
+        options.coalesceWindow = 0;
+        await queue.push('msg 0', undefined, false);
+        await queue.push('msg 1', undefined, false);
+        expect(send.callCount).to.equal(2);
+
+        const pending = [queue.push('msg 2', undefined, false)];
+        await sleep(20);
+        pending.push(queue.push('msg 3', undefined, false));
+        await sleep(20);
+        // budget is used up, both wait for the next window and are sent together
+        expect(send.callCount).to.equal(2);
+        expect(queue.getStats().depth).to.equal(2);
+
+        await Promise.all(pending);
+        expect(send.callCount).to.equal(3);
+        expect(send.thirdCall.args[0]).to.deep.equal({ content: 'msg 2\nmsg 3' });
+    });
+
+    it('DiscordChannelQueue-overload', async () => {
+        const send = sinon.stub().resolves();
+        const queue = new DiscordChannelQueue(send, () => options, sinon.stub());
+
+        options.maxQueueSize = 2;
+        const pushed = [
+            queue.push('important', undefined, false),
+            queue.push('chat 1', undefined, true),
+            queue.push('chat 2', undefined, true),
+            queue.push('chat 3', undefined, true),
+        ];
+        await Promise.all(pushed);
+
+        expect(send.callCount).to.equal(1);
+        expect(send.firstCall.args[0].content).to.equal('(2 messages were dropped because of rate limits)\nimportant\nchat 3');
+        expect(queue.getStats()).to.include({ sent: 2, dropped: 2 });
+    });
+
+    it('DiscordChannelQueue-failed', async () => {
+        const send = sinon.stub().rejects(new Error('Missing Permissions'));
+        const onError = sinon.stub();
+        const queue = new DiscordChannelQueue(send, () => options, onError);
+
+        await queue.push('test', undefined, false);
+
+        expect(onError.callCount).to.equal(1);
+        expect(queue.getStats()).to.include({ sent: 0, failed: 1 });
+    });
+
+    it('DiscordChannelQueue-drain', async () => {
+        const send = sinon.stub().resolves();
+        const queue = new DiscordChannelQueue(send, () => options, sinon.stub());
+
+        options.coalesceWindow = 10000;
+        const pushed = queue.push('test', undefined, false);
+        await queue.drain();
+        await pushed;
+        expect(send.callCount).to.equal(1);
+
+        const disposed = queue.push('test', undefined, false);
+        queue.dispose();
+        await disposed;
+        expect(send.callCount).to.equal(1);
+    });
+
+});
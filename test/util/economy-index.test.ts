@@ -0,0 +1,74 @@
+import { expect } from '../expect';
+import { EconomyIndex } from '../../src/util/economy-index';
+import { parseXml } from '../../src/util/xml-parser';
+
+describe('Test class EconomyIndex', () => {
+
+    it('EconomyIndex-types', () => {
+        const index = new EconomyIndex(parseXml(`
+<types>
+    <type name="AKM">
+        <category name="weapons"/>
+        <usage name="Military"/>
+        <tag name="shelves"/>
+    </type>
+    <type name="M4A1">
+        <category name="weapons"/>
+        <usage name="Military"/>
+        <usage name="Police"/>
+        <value name="Tier4"/>
+    </type>
+    <type name="Apple">
+        <category name="food"/>
+        <usage name="Farm"/>
+    </type>
+</types>`));
+
+        expect(index.type).to.equal('types');
+        expect(index.query({}).total).to.equal(3);
+        expect(index.query({ name: 'akm' }).items.map((x) => x.$.name)).to.deep.equal(['AKM']);
+        expect(index.query({ category: 'weapons', usage: 'police' }).items.map((x) => x.$.name)).to.deep.equal(['M4A1']);
+        expect(index.query({ tag: 'shelves' }).total).to.equal(1);
+        expect(index.query({ value: 'Tier4', category: 'food' }).total).to.equal(0);
+        expect(index.query({ usage: 'Military', offset: 1, limit: 1 })).to.deep.include({ total: 2 });
+        expect(index.query({ usage: 'Military', offset: 1, limit: 1 }).items.map((x) => x.$.name)).to.deep.equal(['M4A1']);
+    });
+
+    it('EconomyIndex-positions', () => {
+        const events = new EconomyIndex(parseXml(`
+<eventposdef>
+    <event name="StaticHeliCrash">
+        <pos x="100" z="100" a="0"/>
+        <pos x="7000" z="7000" a="0"/>
+    </event>
+    <event name="AnimalBear">
+        <pos x="1200" z="300" a="0"/>
+    </event>
+    <event name="Empty"/>
+</eventposdef>`));
+
+        expect(events.type).to.equal('eventspawns');
+        expect(events.query({ bbox: [0, 0, 1000, 1000] }).items.map((x) => x.$.name)).to.deep.equal(['StaticHeliCrash']);
+        expect(events.query({ bbox: [0, 0, 2000, 2000] }).total).to.equal(2);
+        expect(events.query({ bbox: [0, 0, 2000, 2000], name: 'AnimalBear' }).total).to.equal(1);
+        expect(events.query({ bbox: [0, 0, 400, 400] }).items.map((x) => x.$.name)).to.deep.equal(['StaticHeliCrash']);
+        expect(events.query({ bbox: [8000, 8000, 9000, 9000] }).total).to.equal(0);
+
+        // huge boxes only visit the indexed cells
+        const start = Date.now();
+        expect(events.query({ bbox: [-1e9, -1e9, 1e9, 1e9] }).total).to.equal(2);
+        expect(events.query({ bbox: [-Infinity, -Infinity, Infinity, Infinity] }).total).to.equal(2);
+        expect(events.query({ bbox: [-1e9, 0, 1e9, 1000] }).items.map((x) => x.$.name)).to.deep.equal(['StaticHeliCrash', 'AnimalBear']);
+        expect(Date.now() - start).to.be.lessThan(1000);
+
+        const groups = new EconomyIndex(parseXml(`
+<map>
+    <group name="Land_House" pos="5000.5 12.3 4000.2" rpy="0 0 0" a="0"/>
+    <group name="Land_Barn" pos="10 1 10" rpy="0 0 0" a="0"/>
+</map>`));
+
+        expect(groups.type).to.equal('mapgrouppos');
+        expect(groups.query({ bbox: [4900, 3900, 5100, 4100] }).items.map((x) => x.$.name)).to.deep.equal(['Land_House']);
+    });
+
+});
@@ -0,0 +1,68 @@
+import { expect } from '../expect';
+import { memfs } from '../util';
+import { GuidList } from '../../src/util/guid-list';
+import { FSAPI } from '../../src/util/apis';
+
+describe('Test class GuidList', () => {
+
+    let fs: FSAPI;
+
+    beforeEach(() => {
+        fs = memfs(
+            {
+                test: {
+                    'ban.txt': '// banned players\r\nguid1 // cheater\r\nguid2\r\nguid1',
+                    'priority.txt': 'id1;id2\nid3;',
+                },
+            },
+            '/',
+        );
+    });
+
+    it('GuidList-read', () => {
+        const list = new GuidList(fs, '/test/ban.txt');
+        expect(list.values()).to.deep.equal(['guid1', 'guid2']);
+        expect(() => (list.values() as string[]).push('guid3')).to.throw();
+        expect(list.values().length).to.equal(2);
+        expect(list.has('guid2')).to.be.true;
+        expect(list.has('guid3')).to.be.false;
+
+        const priority = new GuidList(fs, '/test/priority.txt', ';');
+        expect(priority.values()).to.deep.equal(['id1', 'id2', 'id3']);
+    });
+
+    it('GuidList-add-remove', () => {
+        const list = new GuidList(fs, '/test/ban.txt');
+        expect(list.add(['guid2', 'guid3', 'guid4', 'guid3'])).to.equal(2);
+        expect(fs.readFileSync('/test/ban.txt', 'utf-8')).to.equal(
+            '// banned players\r\nguid1 // cheater\r\nguid2\r\nguid1\r\nguid3\r\nguid4\r\n',
+        );
+
+        expect(list.remove(['guid1', 'guid5'])).to.equal(1);
+        expect(list.values()).to.deep.equal(['guid2', 'guid3', 'guid4']);
+        expect(fs.readFileSync('/test/ban.txt', 'utf-8')).to.equal(
+            '// banned players\r\nguid2\r\nguid3\r\nguid4',
+        );
+
+        const priority = new GuidList(fs, '/test/priority.txt', ';');
+        expect(priority.add(['id4'])).to.equal(1);
+        expect(fs.readFileSync('/test/priority.txt', 'utf-8')).to.equal('id1;id2\nid3;id4');
+        priority.remove(['id2']);
+        expect(fs.readFileSync('/test/priority.txt', 'utf-8')).to.equal('id1;id3;id4');
+    });
+
+    it('GuidList-reload', async () => {
+        const list = new GuidList(fs, '/test/ban.txt');
+        expect(list.values().length).to.equal(2);
+
+        // not reloaded until invalidated
+        await new Promise((r) => setTimeout(r, 5));
+        fs.writeFileSync('/test/ban.txt', 'guid5\r\n');
+        expect(list.values().length).to.equal(2);
+
+        list.invalidate();
+        expect(list.values()).to.deep.equal(['guid5']);
+        expect(list.export()).to.equal('guid5');
+    });
+
+});
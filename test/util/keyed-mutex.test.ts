@@ -0,0 +1,45 @@
+import { expect } from '../expect';
+import { sleep } from '../util';
+import { KeyedMutex } from '../../src/util/keyed-mutex';
+
+describe('Test class KeyedMutex', () => {
+
+    it('KeyedMutex', async () => {
+        const mutex = new KeyedMutex();
+        const order: string[] = [];
+        const task = (name: string, time: number) => async () => {
+            order.push(`${name}-start`);
+            await sleep(time);
+            order.push(`${name}-end`);
+            return name;
+        };
+
+        const results = await Promise.all([
+            mutex.runExclusive('a', task('a1', 20)),
+            mutex.runExclusive('a', task('a2', 0)),
+            mutex.runExclusive('b', task('b1', 0)),
+        ]);
+
+        expect(results).to.deep.equal(['a1', 'a2', 'b1']);
+        // same keys wait for each other, other keys do not
+        expect(order.indexOf('a2-start')).to.be.greaterThan(order.indexOf('a1-end'));
+        expect(order.indexOf('b1-end')).to.be.lessThan(order.indexOf('a1-end'));
+        expect(mutex.isLocked('a')).to.be.false;
+        expect(mutex.isLocked('b')).to.be.false;
+    });
+
+    it('KeyedMutex-error', async () => {
+        const mutex = new KeyedMutex();
+
+        const failed = mutex.runExclusive('a', async () => {
+            throw new Error('test');
+        });
+        const next = mutex.runExclusive('a', async () => 'next');
+        expect(mutex.isLocked('a')).to.be.true;
+
+        await expect(failed).to.be.rejectedWith('test');
+        expect(await next).to.equal('next');
+        expect(mutex.isLocked('a')).to.be.false;
+    });
+
+});
@@ -0,0 +1,65 @@
+import { expect } from '../expect';
+import { PboReader, lzssDecompress } from '../../src/util/pbo-reader';
+import { buildPbo, memfs } from '../util';
+
+describe('Test class PboReader', () => {
+
+    // "abc" as literals followed by a back reference of 6 bytes, 3 bytes back + checksum
+    const compressed = Buffer.from([0x07, 0x61, 0x62, 0x63, 0x03, 0x03, 0, 0, 0, 0]);
+
+    it('PboReader-lzss', () => {
+        expect(lzssDecompress(compressed, 9).toString()).to.equal('abcabcabc');
+        // references before the start are spaces
+        expect(lzssDecompress(Buffer.from([0x00, 0x05, 0x00]), 3).toString()).to.equal('   ');
+        expect(() => lzssDecompress(Buffer.from([0xff, 0x61]), 5)).to.throw();
+    });
+
+    it('PboReader-entries', async () => {
+        const fs = memfs({}, '/');
+        fs.writeFileSync('/test.pbo', buildPbo(
+            [
+                { name: 'config.cpp', data: 'class CfgPatches {};' },
+                { name: 'data\\packed.txt', data: compressed, originalSize: 9 },
+                { name: 'empty.txt', data: '' },
+            ],
+            { prefix: 'dz\\test', product: 'dayz' },
+        ));
+
+        const pbo = await PboReader.open(fs, '/test.pbo');
+        try {
+            expect(pbo.prefix).to.equal('dz\\test');
+            expect(pbo.properties.product).to.equal('dayz');
+            expect(pbo.entries.map((x) => x.name)).to.deep.equal(['config.cpp', 'data\\packed.txt', 'empty.txt']);
+
+            expect((await pbo.readEntry('CONFIG.cpp')).toString()).to.equal('class CfgPatches {};');
+            expect((await pbo.readEntry('data/packed.txt')).toString()).to.equal('abcabcabc');
+            expect((await pbo.readEntry('empty.txt')).length).to.equal(0);
+            expect(await pbo.readEntry('missing.txt')).to.be.undefined;
+        } finally {
+            await pbo.close();
+        }
+    });
+
+    it('PboReader-large-header', async () => {
+        const fs = memfs({}, '/');
+        const entries = [];
+        for (let i = 0; i < 5000; i++) {
+            entries.push({ name: `data\\some\\deeply\\nested\\path\\file_${i}.paa`, data: `${i}` });
+        }
+        fs.writeFileSync('/large.pbo', buildPbo(entries));
+
+        const pbo = await PboReader.open(fs, '/large.pbo');
+        try {
+            expect(pbo.entries.length).to.equal(5000);
+            expect((await pbo.readEntry('data\\some\\deeply\\nested\\path\\file_4999.paa')).toString()).to.equal('4999');
+        } finally {
+            await pbo.close();
+        }
+    });
+
+    it('PboReader-invalid', async () => {
+        const fs = memfs({ 'broken.pbo': 'not a pbo' }, '/');
+        await expect(PboReader.open(fs, '/broken.pbo')).to.be.rejected;
+    });
+
+});
@@ -0,0 +1,68 @@
+import { expect } from '../expect';
+import { PromRegistry } from '../../src/util/prometheus';
+
+describe('Test class PromRegistry', () => {
+
+    it('PromRegistry-counter-gauge', () => {
+        const registry = new PromRegistry();
+        const counter = registry.counter('test_total', 'Some\ncounter');
+        const gauge = registry.gauge('test_gauge', 'Some gauge');
+        registry.gauge('test_empty', 'Not rendered without values');
+
+        counter.inc({ type: 'ADM' });
+        counter.inc({ type: 'ADM' }, 2);
+        counter.inc({ type: 'say "hi"\\' });
+        gauge.set(5);
+        gauge.set(1, { b: 'x', a: 'y' });
+        gauge.inc({ b: 'x', a: 'y' });
+
+        expect(counter.get({ type: 'ADM' })).to.equal(3);
+        expect(() => counter.inc(undefined, -1)).to.throw();
+        expect(() => registry.gauge('test_gauge', 'duplicate')).to.throw();
+
+        expect(registry.render()).to.equal([
+            '# HELP test_total Some\\ncounter',
+            '# TYPE test_total counter',
+            'test_total{type="ADM"} 3',
+            'test_total{type="say \\"hi\\"\\\\"} 1',
+            '# HELP test_gauge Some gauge',
+            '# TYPE test_gauge gauge',
+            'test_gauge 5',
+            'test_gauge{a="y",b="x"} 2',
+            '',
+        ].join('\n'));
+
+        gauge.remove();
+        counter.reset();
+        expect(registry.render()).to.equal('# HELP test_gauge Some gauge\n# TYPE test_gauge gauge\ntest_gauge{a="y",b="x"} 2\n');
+    });
+
+    it('PromRegistry-histogram', () => {
+        const registry = new PromRegistry();
+        const histogram = registry.histogram('test_seconds', 'Some histogram', [1, 0.1]);
+        let collected = 0;
+        registry.addCollector(() => collected++);
+
+        histogram.observe(0.05, { op: 'a' });
+        histogram.observe(0.5, { op: 'a' });
+        histogram.observe(5, { op: 'a' });
+        const duration = histogram.startTimer({ op: 'b' })({ result: 'success' });
+
+        expect(duration).to.be.lessThan(1);
+        expect(histogram.getCount({ op: 'a' })).to.equal(3);
+        expect(histogram.getCount({ op: 'b', result: 'success' })).to.equal(1);
+
+        const lines = registry.render().split('\n');
+        expect(collected).to.equal(1);
+        expect(lines).to.include.members([
+            '# TYPE test_seconds histogram',
+            'test_seconds_bucket{op="a",le="0.1"} 1',
+            'test_seconds_bucket{op="a",le="1"} 2',
+            'test_seconds_bucket{op="a",le="+Inf"} 3',
+            'test_seconds_sum{op="a"} 5.55',
+            'test_seconds_count{op="a"} 3',
+            'test_seconds_bucket{op="b",result="success",le="+Inf"} 1',
+        ]);
+    });
+
+});
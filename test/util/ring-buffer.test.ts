@@ -0,0 +1,28 @@
+import { expect } from '../expect';
+import { RingBuffer } from '../../src/util/ring-buffer';
+
+describe('Test class RingBuffer', () => {
+
+    it('RingBuffer', () => {
+        const buffer = new RingBuffer<number>(3);
+        expect(buffer.last()).to.be.undefined;
+        expect(buffer.toArray()).to.be.empty;
+
+        buffer.push(1);
+        buffer.push(2);
+        expect(buffer.size).to.equal(2);
+        expect(buffer.toArray()).to.deep.equal([1, 2]);
+
+        buffer.push(3);
+        buffer.push(4);
+        expect(buffer.size).to.equal(3);
+        expect(buffer.last()).to.equal(4);
+        expect(buffer.toArray()).to.deep.equal([2, 3, 4]);
+        expect(buffer.toArray((x) => x > 2)).to.deep.equal([3, 4]);
+
+        buffer.clear();
+        expect(buffer.size).to.equal(0);
+        expect(buffer.toArray()).to.be.empty;
+    });
+
+});
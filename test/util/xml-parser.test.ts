@@ -0,0 +1,49 @@
+import { expect } from '../expect';
+import { parseXml } from '../../src/util/xml-parser';
+
+describe('Test xml parser', () => {
+
+    it('parseXml', () => {
+        const parsed = parseXml(`<?xml version="1.0" encoding="UTF-8" standalone="yes" ?>
+<!-- comment with <tags> -->
+<types>
+    <type name="AKM">
+        <nominal>10</nominal>
+        <flags count_in_cargo="0" count_in_map="1"/>
+        <category name="weapons"/>
+        <usage name="Military"/>
+        <usage name="Police"/>
+        <empty></empty>
+    </type>
+    <type name="Tom &amp; Jerry's &lt;Snack&gt;">
+        <note lang="en">text <![CDATA[with <raw> content]]></note>
+    </type>
+</types>`);
+
+        expect(parsed).to.deep.equal({
+            types: {
+                type: [
+                    {
+                        $: { name: 'AKM' },
+                        nominal: ['10'],
+                        flags: [{ $: { count_in_cargo: '0', count_in_map: '1' } }],
+                        category: [{ $: { name: 'weapons' } }],
+                        usage: [{ $: { name: 'Military' } }, { $: { name: 'Police' } }],
+                        empty: [''],
+                    },
+                    {
+                        $: { name: 'Tom & Jerry\'s <Snack>' },
+                        note: [{ $: { lang: 'en' }, _: 'text with <raw> content' }],
+                    },
+                ],
+            },
+        });
+    });
+
+    it('parseXml-invalid', () => {
+        expect(() => parseXml('<types><type></types>')).to.throw();
+        expect(() => parseXml('<types><type>')).to.throw();
+        expect(() => parseXml('<types><!-- comment')).to.throw();
+    });
+
+});
@@ -6,3 +6,5 @@ export * from '../../../../../src/types/log-reader';
 export * from '../../../../../src/types/server-info';
 export * from '../../../../../src/types/websocket';
 export * from '../../../../../src/types/ingame-report';
+export * from '../../../../../src/types/restart-tracer';
+export * from '../../../../../src/types/cluster';
@@ -1,6 +1,6 @@
 import { HttpClient } from '@angular/common/http';
 import { Injectable } from '@angular/core';
-import { LogType, LogTypeEnum, MetricType, MetricTypeEnum, MetricWrapper, ServerInfo, SystemReport, isSameServerInfo } from '../models';
+import { IngameFrameTimesMetric, LogType, LogTypeEnum, MetricType, MetricTypeEnum, MetricWrapper, ServerInfo, SystemReport, isSameServerInfo } from '../models';
 import { AuthService } from '../../auth/services/auth.service';
 import Chart from 'chart.js';
 import { BehaviorSubject, Observable, of, Subject, Subscription, timer } from 'rxjs';
@@ -378,6 +378,87 @@ export class AppCommonService {
 
     }
 
+    public frameTimeChart(): Observable<Chart.ChartConfiguration> {
+
+        const dataset = (label: string, color: string, yAxisID: string, data: number[]): Chart.ChartDataSets => ({
+            label,
+            yAxisID,
+            data,
+            fill: false,
+            lineTension: 0.2,
+            borderColor: color,
+            pointRadius: 1,
+            pointBackgroundColor: color,
+            pointHitRadius: 5,
+        });
+
+        return this.getApiFetcher<MetricTypeEnum.INGAME_FRAMETIMES, MetricWrapper<IngameFrameTimesMetric>>(MetricTypeEnum.INGAME_FRAMETIMES)!.data.pipe(
+            map((values) => {
+                const lastTime = values?.length ? values[values.length - 1].timestamp : 0;
+                const data = values?.filter((x) => (lastTime - x.timestamp) < 3 * 60 * 60 * 1000) ?? [];
+                return {
+                    type: 'line',
+                    data: {
+                        labels: data.map((x) => {
+                            return new Date(x.timestamp).toLocaleTimeString();
+                        }),
+                        datasets: [
+                            dataset('p50 (ms)', 'rgba(40,167,69,1)', 'frametime', data.map((x) => x.value.p50)),
+                            dataset('p95 (ms)', 'rgba(255,193,7,1)', 'frametime', data.map((x) => x.value.p95)),
+                            dataset('p99 (ms)', 'rgba(220,53,69,1)', 'frametime', data.map((x) => x.value.p99)),
+                            dataset('max (ms)', 'rgba(108,117,125,1)', 'frametime', data.map((x) => x.value.max)),
+                            dataset('Players', 'rgba(2,117,216,1)', 'count', data.map((x) => x.value.players)),
+                            dataset('Vehicles', 'rgba(23,162,184,1)', 'count', data.map((x) => x.value.vehicles)),
+                        ],
+                    },
+                    options: {
+                        animation: {
+                            duration: 0,
+                        },
+                        scales: {
+                            xAxes: [
+                                {
+                                    gridLines: {
+                                        display: false,
+                                    },
+                                    ticks: {
+                                        maxTicksLimit: 7,
+                                    },
+                                },
+                            ],
+                            yAxes: [
+                                {
+                                    id: 'frametime',
+                                    position: 'left',
+                                    ticks: {
+                                        min: 0,
+                                    },
+                                    gridLines: {
+                                        color: 'rgba(0, 0, 0, .125)',
+                                    },
+                                },
+                                {
+                                    id: 'count',
+                                    position: 'right',
+                                    ticks: {
+                                        min: 0,
+                                    },
+                                    gridLines: {
+                                        display: false,
+                                    },
+                                },
+                            ],
+                        },
+                        legend: {
+                            display: true,
+                        },
+                    },
+                };
+            }),
+        );
+
+    }
+
     public fetchServerInfo(): Observable<ServerInfo> {
         return this.httpClient.get<ServerInfo>(
             `/api/serverinfo`,
@@ -409,6 +490,36 @@ export class AppCommonService {
         );
     }
 
+    /**
+     * fetches a mission xml, which was already parsed (and cached) by the server
+     */
+    public fetchMissionEconomy(file: string): Observable<any> {
+        return this.httpClient.get(
+            `/api/readmissioneconomy`,
+            {
+                headers: this.getAuthHeaders(),
+                withCredentials: true,
+                params: {
+                    file,
+                },
+            },
+        );
+    }
+
+    public fetchMissionEconomyFiles(files: string[]): Observable<any[]> {
+        return this.httpClient.post<any[]>(
+            `/api/readmissioneconomyfiles`,
+            {
+                files,
+            },
+            {
+                headers: this.getAuthHeaders(),
+                withCredentials: true,
+                observe: 'body',
+            },
+        );
+    }
+
     public fetchMissionFiles(files: string[]): Observable<string[]> {
         return this.httpClient.post<string[]>(
             `/api/readmissionfiles`,
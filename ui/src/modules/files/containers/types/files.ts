@@ -33,8 +33,13 @@ export abstract class FileWrapperBase {
         }
     }
 
-    public async parse(content: string): Promise<void> {
-        if (this.contentType === 'xml') {
+    /**
+     * @param content raw file content or the already parsed content (i.e. from the server side economy cache)
+     */
+    public async parse(content: string | any): Promise<void> {
+        if (typeof content !== 'string') {
+            this.content = content;
+        } else if (this.contentType === 'xml') {
             this.content = await xml.parseStringPromise(content);
         } else {
             this.content = JSON.parse(content);
@@ -55,7 +60,7 @@ export class TypesFileWrapper extends FileWrapperBase {
         super(file);
     }
 
-    public override async parse(content: string): Promise<void> {
+    public override async parse(content: string | any): Promise<void> {
         await super.parse(content);
 
         this.content.types.type = this.content.types.type.map((type) => {
@@ -427,14 +427,14 @@ export class TypesComponent implements OnInit {
                 }
             }
 
-            const typesFilesContents = await this.appCommon.fetchMissionFiles(typesFiles).toPromise();
+            const typesFilesContents = await this.appCommon.fetchMissionEconomyFiles(typesFiles).toPromise();
             for (let i = 0; i < typesFiles.length; i++) {
                 const file = new TypesFileWrapper(typesFiles[i]);
                 await file.parse(typesFilesContents[i]);
                 this.files.push(file);
             }
 
-            const spawnableTypesFilesContents = await this.appCommon.fetchMissionFiles(spawnableTypesFiles).toPromise();
+            const spawnableTypesFilesContents = await this.appCommon.fetchMissionEconomyFiles(spawnableTypesFiles).toPromise();
             for (let i = 0; i < spawnableTypesFiles.length; i++) {
                 const file = new SpawnableTypesFileWrapper(spawnableTypesFiles[i]);
                 await file.parse(spawnableTypesFilesContents[i]);
@@ -1,5 +1,7 @@
 import { ChangeDetectionStrategy, Component, OnInit } from '@angular/core';
-import { MetricType, MetricWrapper, MetricTypeEnum } from '../../../app-common/models';
+import { AgentInfo, IngameReportProfilerZone, MetricType, MetricWrapper, MetricTypeEnum, RestartCycle, RestartSpan, Rollout } from '../../../app-common/models';
+import { BehaviorSubject, combineLatest, Observable, of, timer } from 'rxjs';
+import { catchError, map, shareReplay, switchMap } from 'rxjs/operators';
 import { ApiFetcher, AppCommonService } from '../../../app-common/services/app-common.service';
 
 @Component({
@@ -10,9 +12,47 @@ import { ApiFetcher, AppCommonService } from '../../../app-common/services/app-c
 })
 export class SystemComponent implements OnInit {
 
+    public readonly PROFILER_ZONES_SHOWN = 10;
+    public readonly RESTART_CYCLES_SHOWN = 10;
+    public readonly CLUSTER_REFRESH = 10000;
+
+    public profilerZones$: Observable<IngameReportProfilerZone[]>;
+    public restartCycles$: Observable<RestartCycle[]>;
+    public agents$: Observable<AgentInfo[]>;
+    public rollouts$: Observable<Rollout[]>;
+
+    private clusterRefresh$ = new BehaviorSubject<void>(undefined);
+
     public constructor(
         public commonService: AppCommonService,
-    ) {}
+    ) {
+        this.profilerZones$ = this.getProfilerFetcher().latestData.pipe(
+            map((x) => (x?.value ?? []).slice(0, this.PROFILER_ZONES_SHOWN)),
+        );
+        this.restartCycles$ = this.getRestartCycleFetcher().data.pipe(
+            map((x) => (x ?? []).slice(-this.RESTART_CYCLES_SHOWN).map((y) => y.value).reverse()),
+        );
+        this.agents$ = this.pollCluster<AgentInfo[]>('agents');
+        this.rollouts$ = this.pollCluster<Rollout[]>('rollouts').pipe(
+            map((x) => x.slice().reverse()),
+        );
+    }
+
+    private pollCluster<T extends any[]>(resource: string): Observable<T> {
+        return combineLatest([timer(0, this.CLUSTER_REFRESH), this.clusterRefresh$]).pipe(
+            switchMap(() => this.commonService.apiGET(resource).pipe(
+                map((x) => (!!x ? JSON.parse(x) : []) as T),
+                catchError(() => of([] as any as T)),
+            )),
+            shareReplay({ bufferSize: 1, refCount: true }),
+        );
+    }
+
+    public startRollout(command: string): void {
+        this.commonService.apiPOST('rollout', { command }).subscribe(
+            () => this.clusterRefresh$.next(),
+        );
+    }
 
     public ngOnInit(): void {
         // ignore
@@ -30,4 +70,16 @@ export class SystemComponent implements OnInit {
         return this.getFetcher(MetricTypeEnum.SYSTEM);
     }
 
+    public getProfilerFetcher(): ApiFetcher<MetricType, MetricWrapper<IngameReportProfilerZone[]>> {
+        return this.commonService.getApiFetcher<MetricType, MetricWrapper<IngameReportProfilerZone[]>>(MetricTypeEnum.INGAME_PROFILER);
+    }
+
+    public getRestartCycleFetcher(): ApiFetcher<MetricType, MetricWrapper<RestartCycle>> {
+        return this.commonService.getApiFetcher<MetricType, MetricWrapper<RestartCycle>>(MetricTypeEnum.RESTART_CYCLE);
+    }
+
+    public getRegression(cycle: RestartCycle, span: RestartSpan): number | undefined {
+        return cycle.regressions?.find((x) => x.phase === span.phase)?.baseline;
+    }
+
 }
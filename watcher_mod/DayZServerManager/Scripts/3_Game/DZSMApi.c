@@ -5,6 +5,7 @@ class DZSMApiOptions
 	bool useApiForReport = false;
 	float reportInterval = 30.0;
 	bool dataDump = false;
+	float heartbeatInterval = 1.0;
 };
 
 static ref DZSMApiOptions m_dzsmApiOptions = null;
@@ -0,0 +1,97 @@
+class DZSMFrameTimeReport
+{
+	int frames;
+	float avg;
+	float p50;
+	float p95;
+	float p99;
+	float max;
+	ref array<float> bucketBounds;
+	ref array<int> buckets;
+};
+
+// fixed bucket histogram, so recording a frame does not allocate and stays cheap enough to run every frame
+class DZSMFrameTimeHistogram
+{
+	// upper bounds of the buckets in ms, the last bucket catches everything above
+	static ref array<float> m_BucketBounds = {
+		5, 10, 15, 20, 25, 33, 40, 50, 66, 100, 150, 200, 300, 500, 1000
+	};
+
+	private ref array<int> m_Buckets;
+	private int m_Frames;
+	private float m_Total;
+	private float m_Max;
+
+	void DZSMFrameTimeHistogram()
+	{
+		Reset();
+	}
+
+	void Reset()
+	{
+		m_Buckets = new array<int>;
+		for (int i = 0; i <= m_BucketBounds.Count(); i++)
+		{
+			m_Buckets.Insert(0);
+		}
+		m_Frames = 0;
+		m_Total = 0;
+		m_Max = 0;
+	}
+
+	void Record(float timeslice)
+	{
+		float ms = timeslice * 1000.0;
+		int bucket = 0;
+		int bucketCount = m_BucketBounds.Count();
+		while (bucket < bucketCount && ms > m_BucketBounds[bucket])
+		{
+			bucket++;
+		}
+		m_Buckets[bucket] = m_Buckets[bucket] + 1;
+
+		m_Frames++;
+		m_Total += ms;
+		if (ms > m_Max)
+		{
+			m_Max = ms;
+		}
+	}
+
+	// returns the upper bound of the bucket containing the percentile, capped by the max frame time
+	float Percentile(float percentile)
+	{
+		int target = Math.Ceil(m_Frames * percentile);
+		int seen = 0;
+		for (int i = 0; i < m_BucketBounds.Count(); i++)
+		{
+			seen += m_Buckets[i];
+			if (seen >= target)
+			{
+				return Math.Min(m_BucketBounds[i], m_Max);
+			}
+		}
+		return m_Max;
+	}
+
+	// returns the aggregates since the last flush and starts a new interval
+	DZSMFrameTimeReport Flush()
+	{
+		DZSMFrameTimeReport report = new DZSMFrameTimeReport;
+		report.frames = m_Frames;
+		if (m_Frames > 0)
+		{
+			report.avg = m_Total / m_Frames;
+			report.p50 = Percentile(0.5);
+			report.p95 = Percentile(0.95);
+			report.p99 = Percentile(0.99);
+			report.max = m_Max;
+		}
+		report.bucketBounds = m_BucketBounds;
+		report.buckets = m_Buckets;
+
+		Reset();
+		return report;
+	}
+};
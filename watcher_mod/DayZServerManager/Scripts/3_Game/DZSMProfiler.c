@@ -0,0 +1,100 @@
+class DZSMProfilerZoneReport
+{
+	string name;
+	int count;
+	// times in ms
+	float total;
+	float max;
+};
+
+class DZSMProfilerZone
+{
+	int count;
+	// float, so long report intervals do not overflow
+	float totalTicks;
+	int maxTicks;
+
+	int depth;
+	int startTicks;
+};
+
+// Named profiler zones, which can be used by any server mod:
+//
+//   DZSMProfiler.Begin("MyMod.Update");
+//   ...
+//   DZSMProfiler.End("MyMod.Update");
+//
+// Only counters are kept per zone and aggregated per report interval, so zones can stay enabled in production.
+// Nested begins of the same zone (i.e. recursion) are only measured by the outermost begin/end pair.
+class DZSMProfiler
+{
+	// TickCount is in 100ns units
+	static const float TICKS_PER_MS = 10000.0;
+
+	private static ref map<string, ref DZSMProfilerZone> m_Zones = new map<string, ref DZSMProfilerZone>;
+
+	static void Begin(string name)
+	{
+		DZSMProfilerZone zone;
+		if (!m_Zones.Find(name, zone))
+		{
+			zone = new DZSMProfilerZone;
+			m_Zones.Set(name, zone);
+		}
+
+		if (zone.depth == 0)
+		{
+			zone.startTicks = TickCount(0);
+		}
+		zone.depth++;
+	}
+
+	static void End(string name)
+	{
+		DZSMProfilerZone zone;
+		if (!m_Zones.Find(name, zone) || zone.depth <= 0)
+		{
+			return;
+		}
+
+		zone.depth--;
+		if (zone.depth > 0)
+		{
+			return;
+		}
+
+		int ticks = TickCount(zone.startTicks);
+		zone.count++;
+		zone.totalTicks += ticks;
+		if (ticks > zone.maxTicks)
+		{
+			zone.maxTicks = ticks;
+		}
+	}
+
+	// returns the aggregates of all zones hit since the last flush and starts a new interval
+	static array<ref DZSMProfilerZoneReport> Flush()
+	{
+		array<ref DZSMProfilerZoneReport> reports = new array<ref DZSMProfilerZoneReport>;
+		foreach (string name, DZSMProfilerZone zone : m_Zones)
+		{
+			if (zone.count == 0)
+			{
+				continue;
+			}
+
+			DZSMProfilerZoneReport report = new DZSMProfilerZoneReport;
+			report.name = name;
+			report.count = zone.count;
+			report.total = zone.totalTicks / TICKS_PER_MS;
+			report.max = zone.maxTicks / TICKS_PER_MS;
+			reports.Insert(report);
+
+			// open zones keep their start, so they are counted in the interval they end in
+			zone.count = 0;
+			zone.totalTicks = 0;
+			zone.maxTicks = 0;
+		}
+		return reports;
+	}
+};
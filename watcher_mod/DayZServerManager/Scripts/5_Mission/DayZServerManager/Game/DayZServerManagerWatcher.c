@@ -813,6 +813,8 @@ class ServerManagerEntryContainer
 {
 	ref array<ref ServerManagerEntry> players = new array<ref ServerManagerEntry>;
 	ref array<ref ServerManagerEntry> vehicles = new array<ref ServerManagerEntry>;
+	ref DZSMFrameTimeReport frameTimes;
+	ref array<ref DZSMProfilerZoneReport> profilerZones;
 
 	void ServerManagerEntryContainer()
 	{
@@ -846,6 +848,11 @@ class DayZServerManagerWatcher
 	private RestApi m_RestApi;
     private RestContext m_RestContext;
 
+	private float m_HeartbeatTime = 0;
+	private int m_HeartbeatCounter = 0;
+
+	private ref DZSMFrameTimeHistogram m_FrameTimes = new DZSMFrameTimeHistogram;
+
     void DayZServerManagerWatcher()
     {
 		Print("DZSM ~ DayZServerManagerWatcher()");
@@ -872,25 +879,39 @@ class DayZServerManagerWatcher
 			Print("DZSM ~ DayZServerManagerWatcher() - DATA DUMP");
 			
 			Print("DZSM ~ DayZServerManagerWatcher() - AMMO DUMP");
+			DZSMProfiler.Begin("DZSM.DZSMAmmoDump");
 			DZSMAmmoDump();
+			DZSMProfiler.End("DZSM.DZSMAmmoDump");
 
 			Print("DZSM ~ DayZServerManagerWatcher() - MAG DUMP");
+			DZSMProfiler.Begin("DZSM.DZSMMagDump");
 			DZSMMagDump();
+			DZSMProfiler.End("DZSM.DZSMMagDump");
 
 			Print("DZSM ~ DayZServerManagerWatcher() - WEAPON DUMP");
+			DZSMProfiler.Begin("DZSM.DZSMWeaponDump");
 			DZSMWeaponDump();
+			DZSMProfiler.End("DZSM.DZSMWeaponDump");
 
 			Print("DZSM ~ DayZServerManagerWatcher() - CLOTHING DUMP");
+			DZSMProfiler.Begin("DZSM.DZSMClothingDump");
 			DZSMClothingDump();
+			DZSMProfiler.End("DZSM.DZSMClothingDump");
 
 			Print("DZSM ~ DayZServerManagerWatcher() - ITEM DUMP");
+			DZSMProfiler.Begin("DZSM.DZSMItemDump");
 			DZSMItemDump();
+			DZSMProfiler.End("DZSM.DZSMItemDump");
 			
 			Print("DZSM ~ DayZServerManagerWatcher() - CONTAINER DUMP");
+			DZSMProfiler.Begin("DZSM.DZSMContainerDump");
 			DZSMContainerDump();
+			DZSMProfiler.End("DZSM.DZSMContainerDump");
 
 			Print("DZSM ~ DayZServerManagerWatcher() - ZOMBIE DUMP");
+			DZSMProfiler.Begin("DZSM.DZSMZombieDump");
 			DZSMZombieDump();
+			DZSMProfiler.End("DZSM.DZSMZombieDump");
 
 			Print("DZSM ~ DayZServerManagerWatcher() - DATA DUMP DONE");
 		}
@@ -979,6 +1000,37 @@ class DayZServerManagerWatcher
 		Print("DZSM ~ DayZServerManagerWatcher() - CRASH TEST DONE");
 	}
 
+	void OnUpdate(float timeslice)
+	{
+		m_FrameTimes.Record(timeslice);
+		Heartbeat(timeslice);
+	}
+
+	// called every frame, so the heartbeat stops as soon as the script thread hangs
+	void Heartbeat(float timeslice)
+	{
+		float interval = GetDZSMApiOptions().heartbeatInterval;
+		if (interval <= 0)
+		{
+			return;
+		}
+
+		m_HeartbeatTime += timeslice;
+		if (m_HeartbeatTime < interval)
+		{
+			return;
+		}
+		m_HeartbeatTime = 0;
+		m_HeartbeatCounter++;
+
+		FileHandle heartbeatFile = OpenFile("$profile:DZSM-HEARTBEAT.txt", FileMode.WRITE);
+		if (heartbeatFile != 0)
+		{
+			FPrint(heartbeatFile, m_HeartbeatCounter.ToString());
+			CloseFile(heartbeatFile);
+		}
+	}
+
     float GetInterval()
 	{
 		return GetDZSMApiOptions().reportInterval;
@@ -1007,6 +1059,7 @@ class DayZServerManagerWatcher
 		#ifdef DZSM_DEBUG
 		Print("DZSM ~ TICK");
 		#endif
+		DZSMProfiler.Begin("DZSM.Tick");
 		int i;
 		
 		ref ServerManagerEntryContainer container = new ServerManagerEntryContainer;
@@ -1076,6 +1129,15 @@ class DayZServerManagerWatcher
 			}
 		}
 
+		// close the zone before flushing, so this tick is part of its own report
+		DZSMProfiler.End("DZSM.Tick");
+
+		container.frameTimes = m_FrameTimes.Flush();
+		container.profilerZones = DZSMProfiler.Flush();
+
+		// serializing the report happens after the flush, so it is reported with the next tick
+		DZSMProfiler.Begin("DZSM.TickReport");
+
 		DZSMApiOptions apiOptions = GetDZSMApiOptions();
 		if (apiOptions.useApiForReport)
 		{
@@ -1100,6 +1162,8 @@ class DayZServerManagerWatcher
 		#ifdef DZSM_DEBUG
 		Print("DZSM ~ Cleanup Done");
 		#endif
+
+		DZSMProfiler.End("DZSM.TickReport");
 	}
 
 }
@@ -1130,4 +1194,14 @@ modded class MissionServer
         	m_dayZServerManagerWatcher = new DayZServerManagerWatcher();
 		}
 	}
+
+	override void OnUpdate(float timeslice)
+	{
+		super.OnUpdate(timeslice);
+
+		if (m_dayZServerManagerWatcher)
+		{
+			m_dayZServerManagerWatcher.OnUpdate(timeslice);
+		}
+	}
 };
\ No newline at end of file